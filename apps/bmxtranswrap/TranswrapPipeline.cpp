@@ -0,0 +1,514 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <deque>
+
+#include "TranswrapPipeline.h"
+#include <bmx/essence_parser/SoundConversion.h>
+#include <bmx/apps/AppUtils.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+using namespace mxfpp;
+
+
+
+namespace bmx
+{
+
+
+class TranswrapEditUnitQueue
+{
+public:
+    TranswrapEditUnitQueue()
+    {
+        mClosed = false;
+        mAborted = false;
+    }
+
+    void Push(TranswrapEditUnit *edit_unit)
+    {
+        MutexLocker locker(&mMutex);
+        mQueue.push_back(edit_unit);
+        mCondition.Signal();
+    }
+
+    // returns 0 once the queue is closed and empty, or immediately if aborted
+    TranswrapEditUnit* Pop()
+    {
+        MutexLocker locker(&mMutex);
+        while (mQueue.empty() && !mClosed && !mAborted)
+            mCondition.Wait(&mMutex);
+        if (mAborted || mQueue.empty())
+            return 0;
+
+        TranswrapEditUnit *edit_unit = mQueue.front();
+        mQueue.pop_front();
+        return edit_unit;
+    }
+
+    void Close(bool abort)
+    {
+        MutexLocker locker(&mMutex);
+        mClosed = true;
+        if (abort)
+            mAborted = true;
+        mCondition.Broadcast();
+    }
+
+private:
+    Mutex mMutex;
+    Condition mCondition;
+    deque<TranswrapEditUnit*> mQueue;
+    bool mClosed;
+    bool mAborted;
+};
+
+
+class TranswrapStageThread : public Thread
+{
+public:
+    TranswrapStageThread(TranswrapEditUnitQueue *input, TranswrapEditUnitQueue *output,
+                         TranswrapReader *reader, TranswrapSoundConverter *converter)
+    : Thread()
+    {
+        mInput = input;
+        mOutput = output;
+        mReader = reader;
+        mConverter = converter;
+    }
+
+protected:
+    virtual void Run()
+    {
+        try
+        {
+            TranswrapEditUnit *edit_unit;
+            while ((edit_unit = mInput->Pop())) {
+                if (mReader) {
+                    if (!mReader->Read(edit_unit))
+                        break;
+                } else {
+                    mConverter->Convert(edit_unit);
+                }
+                mOutput->Push(edit_unit);
+            }
+        }
+        catch (const MXFException &ex)
+        {
+            mOutput->Close(false);
+            BMX_EXCEPTION(("%s", ex.getMessage().c_str()));
+        }
+        catch (...)
+        {
+            mOutput->Close(false);
+            throw;
+        }
+
+        mOutput->Close(false);
+    }
+
+private:
+    TranswrapEditUnitQueue *mInput;
+    TranswrapEditUnitQueue *mOutput;
+    TranswrapReader *mReader;
+    TranswrapSoundConverter *mConverter;
+};
+
+
+};
+
+
+
+TranswrapEditUnit::TranswrapEditUnit()
+{
+    num_read = 0;
+}
+
+TranswrapEditUnit::~TranswrapEditUnit()
+{
+    Reset();
+
+    size_t i;
+    for (i = 0; i < mSoundSamples.size(); i++)
+        delete mSoundSamples[i];
+}
+
+void TranswrapEditUnit::Reset()
+{
+    size_t i;
+    for (i = 0; i < frames.size(); i++) {
+        if (frames[i])
+            frames[i]->Release();
+    }
+    frames.clear();
+    num_read = 0;
+}
+
+ByteArray* TranswrapEditUnit::GetSoundBuffer(size_t track_index)
+{
+    if (track_index >= mSoundSamples.size())
+        mSoundSamples.resize(track_index + 1, 0);
+    if (!mSoundSamples[track_index]) {
+        SoundSamples *samples = new SoundSamples;
+        samples->channel_size = 0;
+        samples->num_samples = 0;
+        mSoundSamples[track_index] = samples;
+    }
+
+    return &mSoundSamples[track_index]->buffer;
+}
+
+void TranswrapEditUnit::SetSoundSamples(size_t track_index, uint32_t channel_size, uint32_t num_samples)
+{
+    GetSoundBuffer(track_index);
+    mSoundSamples[track_index]->channel_size = channel_size;
+    mSoundSamples[track_index]->num_samples = num_samples;
+}
+
+unsigned char* TranswrapEditUnit::GetSoundChannelData(size_t track_index, uint32_t channel_index)
+{
+    BMX_ASSERT(track_index < mSoundSamples.size() && mSoundSamples[track_index]);
+    SoundSamples *samples = mSoundSamples[track_index];
+    BMX_ASSERT((channel_index + 1) * samples->channel_size <= samples->buffer.GetSize());
+    return samples->buffer.GetBytes() + channel_index * samples->channel_size;
+}
+
+uint32_t TranswrapEditUnit::GetSoundChannelSize(size_t track_index) const
+{
+    BMX_ASSERT(track_index < mSoundSamples.size() && mSoundSamples[track_index]);
+    return mSoundSamples[track_index]->channel_size;
+}
+
+uint32_t TranswrapEditUnit::GetSoundNumSamples(size_t track_index) const
+{
+    BMX_ASSERT(track_index < mSoundSamples.size() && mSoundSamples[track_index]);
+    return mSoundSamples[track_index]->num_samples;
+}
+
+
+
+TranswrapReader::TranswrapReader(MXFReader *reader, const vector<MXFInputTrack*> &input_tracks, Rational frame_rate,
+                                 const vector<uint32_t> &sample_sequence, uint32_t max_samples_per_read)
+{
+    BMX_ASSERT(!sample_sequence.empty());
+    BMX_ASSERT(max_samples_per_read == 1 || (sample_sequence.size() == 1 && sample_sequence[0] == 1));
+
+    mReader = reader;
+    mInputTracks = input_tracks;
+    mFrameRate = frame_rate;
+    mSampleSequence = sample_sequence;
+    mSampleSequenceOffset = 0;
+    mMaxSamplesPerRead = max_samples_per_read;
+    mIOMutex = 0;
+    mReadDuration = reader->GetReadDuration();
+    mTotalRead = 0;
+    mReadEnd = false;
+    mRealtime = false;
+    mRTFactor = 1.0;
+    mRTStart = 0;
+    mGrowingFile = false;
+    mRetries = 0;
+    mRetryDelay = 0.0;
+    mRateAfterFail = 1.0;
+    mRetryCount = 0;
+    mWatcher = 0;
+    mReadFailure = false;
+    mFailureNumRead = 0;
+    mFailureStart = 0;
+}
+
+TranswrapReader::~TranswrapReader()
+{
+}
+
+void TranswrapReader::SetRealtime(float rt_factor)
+{
+    mRealtime = true;
+    mRTFactor = rt_factor;
+    mRTStart = get_tick_count();
+}
+
+void TranswrapReader::SetGrowingFile(unsigned int retries, float retry_delay, float rate_after_fail)
+{
+    mGrowingFile = true;
+    mRetries = retries;
+    mRetryDelay = retry_delay;
+    mRateAfterFail = rate_after_fail;
+}
+
+void TranswrapReader::SetGrowingFileWatcher(GrowingFileWatcher *watcher)
+{
+    mWatcher = watcher;
+}
+
+void TranswrapReader::SetIOMutex(Mutex *mutex)
+{
+    mIOMutex = mutex;
+}
+
+bool TranswrapReader::Read(TranswrapEditUnit *edit_unit)
+{
+    BMX_ASSERT(edit_unit->frames.empty());
+
+    if (mReadEnd || (mReadDuration >= 0 && mTotalRead >= mReadDuration))
+        return false;
+
+    // limit the rate at which edit units are read
+    if (mTotalRead > 0) {
+        if (mReadFailure)
+            rt_sleep(mRateAfterFail, mFailureStart, mFrameRate, mTotalRead - mFailureNumRead);
+        else if (mRealtime)
+            rt_sleep(mRTFactor, mRTStart, mFrameRate, mTotalRead);
+    }
+
+    uint32_t num_read;
+    bool read_failed = false;
+    while (true) {
+        {
+            MutexLocker locker(mIOMutex);
+            num_read = ReadSamples();
+        }
+        if (num_read > 0)
+            break;
+
+        if (!mGrowingFile || !mReader->ReadError() || mRetryCount >= mRetries) {
+            mReadEnd = true;
+            return false;
+        }
+        read_failed = true;
+        mReadFailure = true;
+        if (mWatcher) {
+            if (!mWatcher->Wait((uint32_t)(mRetryDelay * 1000)))
+                mRetryCount++;
+        } else {
+            mRetryCount++;
+            if (mRetryDelay > 0.0) {
+                rt_sleep(1.0f / mRetryDelay, get_tick_count(), mFrameRate,
+                         mFrameRate.numerator / mFrameRate.denominator);
+            }
+        }
+    }
+    if (mGrowingFile && read_failed) {
+        mFailureNumRead = mTotalRead;
+        mFailureStart   = get_tick_count();
+        mRetryCount     = 0;
+    }
+
+    size_t i;
+    for (i = 0; i < mInputTracks.size(); i++) {
+        Frame *frame = mInputTracks[i]->GetFrameBuffer()->GetLastFrame(true);
+        BMX_ASSERT(frame);
+        edit_unit->frames.push_back(frame);
+    }
+    edit_unit->num_read = num_read;
+
+    mTotalRead += num_read;
+    if (mMaxSamplesPerRead > 1 && num_read < mMaxSamplesPerRead)
+        mReadEnd = true;
+
+    return true;
+}
+
+uint32_t TranswrapReader::ReadSamples()
+{
+    uint32_t num_read;
+
+    if (mMaxSamplesPerRead == 1) {
+        uint32_t num_frame_samples = mSampleSequence[mSampleSequenceOffset];
+        mSampleSequenceOffset = (mSampleSequenceOffset + 1) % mSampleSequence.size();
+
+        num_read = mReader->Read(num_frame_samples);
+        if (num_read != num_frame_samples)
+            num_read = 0;
+    } else {
+        num_read = mReader->Read(mMaxSamplesPerRead);
+    }
+
+    return num_read;
+}
+
+
+
+TranswrapSoundConverter::TranswrapSoundConverter(const vector<MXFInputTrack*> &input_tracks,
+                                                 bool ignore_d10_aes3_flags)
+{
+    mInputTracks = input_tracks;
+    mIgnoreD10AES3Flags = ignore_d10_aes3_flags;
+
+    size_t i;
+    for (i = 0; i < input_tracks.size(); i++) {
+        const MXFTrackInfo *input_track_info = input_tracks[i]->GetTrackInfo();
+        const MXFSoundTrackInfo *input_sound_info = dynamic_cast<const MXFSoundTrackInfo*>(input_track_info);
+        mConvertTrack.push_back((input_sound_info && input_sound_info->channel_count > 1) ||
+                                input_track_info->essence_type == D10_AES3_PCM);
+    }
+}
+
+TranswrapSoundConverter::~TranswrapSoundConverter()
+{
+}
+
+void TranswrapSoundConverter::Convert(TranswrapEditUnit *edit_unit)
+{
+    BMX_ASSERT(edit_unit->frames.size() == mInputTracks.size());
+
+    size_t i;
+    for (i = 0; i < mInputTracks.size(); i++) {
+        Frame *frame = edit_unit->frames[i];
+        if (!mConvertTrack[i] || !frame->IsComplete())
+            continue;
+
+        MXFInputTrack *input_track = mInputTracks[i];
+        const MXFSoundTrackInfo *input_sound_info = dynamic_cast<const MXFSoundTrackInfo*>(input_track->GetTrackInfo());
+        BMX_ASSERT(input_sound_info);
+        uint32_t bits_per_sample     = input_sound_info->bits_per_sample;
+        uint16_t channel_block_align = (bits_per_sample + 7) / 8;
+        uint32_t channel_count       = input_sound_info->channel_count;
+
+        uint32_t num_samples;
+        if (input_sound_info->essence_type == D10_AES3_PCM)
+            num_samples = get_aes3_sample_count(frame->GetBytes(), frame->GetSize());
+        else
+            num_samples = frame->GetSize() / (channel_count * channel_block_align);
+        uint32_t channel_size = num_samples * channel_block_align;
+
+        // convert only the channels that are mapped to an output track, in a single pass
+        ByteArray *sound_buffer = edit_unit->GetSoundBuffer(i);
+        sound_buffer->Allocate(channel_size * channel_count);
+        sound_buffer->SetSize(channel_size * channel_count);
+        mChannelData.assign(channel_count, 0);
+        size_t k;
+        for (k = 0; k < input_track->GetOutputTrackCount(); k++) {
+            uint32_t input_channel_index = input_track->GetInputChannelIndex(k);
+            BMX_CHECK(input_channel_index < channel_count);
+            mChannelData[input_channel_index] = sound_buffer->GetBytes() + input_channel_index * channel_size;
+        }
+
+        if (input_sound_info->essence_type == D10_AES3_PCM) {
+            convert_aes3_to_pcm_channels(frame->GetBytes(), frame->GetSize(), mIgnoreD10AES3Flags,
+                                         bits_per_sample, (uint8_t)channel_count,
+                                         &mChannelData[0], channel_size);
+        } else {
+            deinterleave_audio_channels(frame->GetBytes(), frame->GetSize(),
+                                        bits_per_sample, (uint16_t)channel_count,
+                                        &mChannelData[0], channel_size);
+        }
+
+        edit_unit->SetSoundSamples(i, channel_size, num_samples);
+    }
+}
+
+
+
+TranswrapPipeline::TranswrapPipeline(TranswrapReader *reader, TranswrapSoundConverter *converter, uint32_t depth)
+{
+    BMX_CHECK(depth > 0);
+
+    mFreeQueue    = new TranswrapEditUnitQueue();
+    mReadQueue    = new TranswrapEditUnitQueue();
+    mConvertQueue = new TranswrapEditUnitQueue();
+
+    // the queues between the stages are limited by the number of edit units. The additional
+    // 3 edit units are for the reader, converter and writer
+    uint32_t i;
+    for (i = 0; i < depth + 3; i++) {
+        mEditUnits.push_back(new TranswrapEditUnit());
+        mFreeQueue->Push(mEditUnits.back());
+    }
+
+    mReadThread    = new TranswrapStageThread(mFreeQueue, mReadQueue, reader, 0);
+    mConvertThread = new TranswrapStageThread(mReadQueue, mConvertQueue, 0, converter);
+}
+
+TranswrapPipeline::~TranswrapPipeline()
+{
+    Stop();
+
+    delete mReadThread;
+    delete mConvertThread;
+    delete mFreeQueue;
+    delete mReadQueue;
+    delete mConvertQueue;
+
+    size_t i;
+    for (i = 0; i < mEditUnits.size(); i++)
+        delete mEditUnits[i];
+}
+
+void TranswrapPipeline::Start()
+{
+    mConvertThread->Start();
+    mReadThread->Start();
+}
+
+void TranswrapPipeline::Stop()
+{
+    mFreeQueue->Close(true);
+    mReadQueue->Close(true);
+    mConvertQueue->Close(true);
+
+    mReadThread->Join();
+    mConvertThread->Join();
+
+    size_t i;
+    for (i = 0; i < mEditUnits.size(); i++)
+        mEditUnits[i]->Reset();
+}
+
+TranswrapEditUnit* TranswrapPipeline::Pop()
+{
+    return mConvertQueue->Pop();
+}
+
+void TranswrapPipeline::Recycle(TranswrapEditUnit *edit_unit)
+{
+    edit_unit->Reset();
+    mFreeQueue->Push(edit_unit);
+}
+
+bool TranswrapPipeline::HaveError() const
+{
+    return mReadThread->HaveError() || mConvertThread->HaveError();
+}
+
+string TranswrapPipeline::GetErrorMessage() const
+{
+    if (mReadThread->HaveError())
+        return mReadThread->GetErrorMessage();
+    else
+        return mConvertThread->GetErrorMessage();
+}
+
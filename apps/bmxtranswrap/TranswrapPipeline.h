@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_TRANSWRAP_PIPELINE_H_
+#define BMX_TRANSWRAP_PIPELINE_H_
+
+#include <vector>
+#include <string>
+
+#include <bmx/mxf_reader/MXFReader.h>
+#include <bmx/apps/GrowingFileWatcher.h>
+#include <bmx/ByteArray.h>
+#include <bmx/Thread.h>
+
+#include "MXFInputTrack.h"
+
+
+namespace bmx
+{
+
+
+class TranswrapEditUnitQueue;
+class TranswrapStageThread;
+
+
+// the frames read for one or more edit units, one frame for each input track, and the
+// audio samples converted from multi-channel and AES-3 frames for each input channel
+
+class TranswrapEditUnit
+{
+public:
+    TranswrapEditUnit();
+    ~TranswrapEditUnit();
+
+    void Reset();
+
+    // the channels are stored one after the other in the track's sound buffer
+    ByteArray* GetSoundBuffer(size_t track_index);
+    void SetSoundSamples(size_t track_index, uint32_t channel_size, uint32_t num_samples);
+    unsigned char* GetSoundChannelData(size_t track_index, uint32_t channel_index);
+    uint32_t GetSoundChannelSize(size_t track_index) const;
+    uint32_t GetSoundNumSamples(size_t track_index) const;
+
+public:
+    uint32_t num_read;
+    std::vector<Frame*> frames;
+
+private:
+    struct SoundSamples
+    {
+        ByteArray buffer;
+        uint32_t channel_size;
+        uint32_t num_samples;
+    };
+
+    std::vector<SoundSamples*> mSoundSamples;
+};
+
+
+// reads the next edit unit and takes the frames from the input track frame buffers.
+// Retries reads of growing files and limits the read rate to realtime if required
+
+class TranswrapReader
+{
+public:
+    TranswrapReader(MXFReader *reader, const std::vector<MXFInputTrack*> &input_tracks, Rational frame_rate,
+                    const std::vector<uint32_t> &sample_sequence, uint32_t max_samples_per_read);
+    ~TranswrapReader();
+
+    void SetRealtime(float rt_factor);
+    void SetGrowingFile(unsigned int retries, float retry_delay, float rate_after_fail);
+    // wait for the input files to grow instead of sleeping for the retry delay. Only waits that time out count as retries
+    void SetGrowingFileWatcher(GrowingFileWatcher *watcher);
+    void SetIOMutex(Mutex *mutex);
+
+    bool Read(TranswrapEditUnit *edit_unit);
+
+    unsigned int GetRetryCount() const { return mRetryCount; }
+
+private:
+    uint32_t ReadSamples();
+
+private:
+    MXFReader *mReader;
+    std::vector<MXFInputTrack*> mInputTracks;
+    Rational mFrameRate;
+    std::vector<uint32_t> mSampleSequence;
+    uint32_t mSampleSequenceOffset;
+    uint32_t mMaxSamplesPerRead;
+    Mutex *mIOMutex;
+
+    int64_t mReadDuration;
+    int64_t mTotalRead;
+    bool mReadEnd;
+
+    bool mRealtime;
+    float mRTFactor;
+    uint32_t mRTStart;
+
+    bool mGrowingFile;
+    unsigned int mRetries;
+    float mRetryDelay;
+    float mRateAfterFail;
+    unsigned int mRetryCount;
+    GrowingFileWatcher *mWatcher;
+    bool mReadFailure;
+    int64_t mFailureNumRead;
+    uint32_t mFailureStart;
+};
+
+
+// deinterleaves multi-channel audio and converts AES-3 to PCM for the mapped input channels
+
+class TranswrapSoundConverter
+{
+public:
+    TranswrapSoundConverter(const std::vector<MXFInputTrack*> &input_tracks, bool ignore_d10_aes3_flags);
+    ~TranswrapSoundConverter();
+
+    bool IsConverted(size_t track_index) const { return mConvertTrack[track_index]; }
+
+    void Convert(TranswrapEditUnit *edit_unit);
+
+private:
+    std::vector<MXFInputTrack*> mInputTracks;
+    std::vector<bool> mConvertTrack;
+    std::vector<unsigned char*> mChannelData;
+    bool mIgnoreD10AES3Flags;
+};
+
+
+// runs the reader and sound converter in separate threads. Edit units are passed between
+// the stages and to the writer, in read order, using queues limited to <depth> edit units
+
+class TranswrapPipeline
+{
+public:
+    TranswrapPipeline(TranswrapReader *reader, TranswrapSoundConverter *converter, uint32_t depth);
+    ~TranswrapPipeline();
+
+    void Start();
+    void Stop();
+
+    TranswrapEditUnit* Pop();
+    void Recycle(TranswrapEditUnit *edit_unit);
+
+    bool HaveError() const;
+    std::string GetErrorMessage() const;
+
+private:
+    std::vector<TranswrapEditUnit*> mEditUnits;
+    TranswrapEditUnitQueue *mFreeQueue;
+    TranswrapEditUnitQueue *mReadQueue;
+    TranswrapEditUnitQueue *mConvertQueue;
+    TranswrapStageThread *mReadThread;
+    TranswrapStageThread *mConvertThread;
+};
+
+
+};
+
+
+
+#endif
@@ -45,8 +45,10 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <memory>
 
 #include "MXFInputTrack.h"
+#include "TranswrapPipeline.h"
 #include "../writers/OutputTrack.h"
 #include "../writers/TrackMapper.h"
 #include <bmx/mxf_reader/MXFFileReader.h>
@@ -63,15 +65,21 @@
 #include <bmx/st436/RDD6Metadata.h>
 #include <bmx/URI.h>
 #include <bmx/MXFHTTPFile.h>
+#include <bmx/MXFMMapFile.h>
+#include <bmx/MXFStreamFile.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/Version.h>
 #include <bmx/as11/AS11Labels.h>
 #include <bmx/as10/AS10ShimNames.h>
 #include <bmx/as10/AS10MPEG2Validator.h>
 #include <bmx/as10/AS10RDD9Validator.h>
+#include <bmx/apps/AppBatch.h>
+#include <bmx/apps/GrowingFileWatcher.h>
 #include <bmx/apps/AppMCALabelHelper.h>
 #include <bmx/apps/AppMXFFileFactory.h>
+#include <bmx/apps/AppStats.h>
 #include <bmx/apps/AppUtils.h>
 #include <bmx/apps/AS11Helper.h>
 #include <bmx/apps/AS10Helper.h>
@@ -91,6 +99,8 @@ using namespace mxfpp;
 
 #define DEFAULT_ST436_MANIFEST_COUNT    2
 
+#define DEFAULT_PREFETCH_MAX_SIZE       256
+
 
 typedef struct
 {
@@ -121,6 +131,8 @@ static const uint8_t DEFAULT_RDD6_SDID      = 4;            /* first channel pai
 
 static const uint32_t DEFAULT_HTTP_MIN_READ = 64 * 1024;
 
+static bool BATCH_MODE = false;
+
 
 namespace bmx
 {
@@ -229,7 +241,7 @@ static void construct_anc_rdd6_sub_frame(RDD6MetadataFrame *rdd6_frame,
                                          bool is_first_sub_frame,
                                          bmx::ByteArray *rdd6_buffer,
                                          uint8_t sdid, uint16_t line_number,
-                                         bmx::ByteArray *anc_buffer)
+                                         bmx::ByteArray *anc_buffer, vector<CDataBuffer> *anc_data_array)
 {
     rdd6_buffer->SetSize(0);
     rdd6_frame->ConstructST2020(rdd6_buffer, sdid, is_first_sub_frame);
@@ -244,14 +256,13 @@ static void construct_anc_rdd6_sub_frame(RDD6MetadataFrame *rdd6_frame,
     line.payload_size          = rdd6_buffer->GetSize(); // alignment left to ST436Element::Construct
     output_element.lines.push_back(line);
 
-    anc_buffer->SetSize(0);
-    output_element.Construct(anc_buffer);
+    output_element.Construct(anc_buffer, anc_data_array);
 }
 
 static void construct_anc_rdd6(RDD6MetadataFrame *rdd6_frame,
                                bmx::ByteArray *rdd6_first_buffer, bmx::ByteArray *rdd6_second_buffer,
                                uint8_t sdid, uint16_t *line_numbers,
-                               bmx::ByteArray *anc_buffer)
+                               bmx::ByteArray *anc_buffer, vector<CDataBuffer> *anc_data_array)
 {
     rdd6_first_buffer->SetSize(0);
     rdd6_second_buffer->SetSize(0);
@@ -274,31 +285,11 @@ static void construct_anc_rdd6(RDD6MetadataFrame *rdd6_frame,
     line.payload_size          = rdd6_second_buffer->GetSize(); // alignment left to ST436Element::Construct
     output_element.lines.push_back(line);
 
-    anc_buffer->SetSize(0);
-    output_element.Construct(anc_buffer);
+    output_element.Construct(anc_buffer, anc_data_array);
 }
 
-static uint32_t read_samples(MXFReader *reader, const vector<uint32_t> &sample_sequence,
-                             uint32_t *sample_sequence_offset, uint32_t max_samples_per_read)
-{
-    uint32_t num_read;
-
-    if (max_samples_per_read == 1) {
-        uint32_t num_frame_samples = sample_sequence[*sample_sequence_offset];
-        *sample_sequence_offset = (*sample_sequence_offset + 1) % sample_sequence.size();
-
-        num_read = reader->Read(num_frame_samples);
-        if (num_read != num_frame_samples)
-            num_read = 0;
-    } else {
-        BMX_ASSERT(sample_sequence.size() == 1 && sample_sequence[0] == 1);
-        num_read = reader->Read(max_samples_per_read);
-    }
-
-    return num_read;
-}
-
-static void write_anc_samples(OutputTrack *output_track, Frame *frame, set<ANCDataType> &filter, bmx::ByteArray &anc_buffer)
+static void write_anc_samples(OutputTrack *output_track, Frame *frame, set<ANCDataType> &filter,
+                              bmx::ByteArray &anc_buffer, vector<CDataBuffer> &anc_data_array)
 {
     BMX_CHECK(frame->num_samples == 1);
 
@@ -319,10 +310,10 @@ static void write_anc_samples(OutputTrack *output_track, Frame *frame, set<ANCDa
             output_element.lines.push_back(input_element.lines[i]);
     }
 
-    anc_buffer.SetSize(0);
-    output_element.Construct(&anc_buffer);
+    // the line payloads reference the frame data and are not copied
+    output_element.Construct(&anc_buffer, &anc_data_array);
 
-    output_track->WriteSamples(0, anc_buffer.GetBytes(), anc_buffer.GetSize(), 1);
+    output_track->WriteSample(0, &anc_data_array[0], (uint32_t)anc_data_array.size());
 }
 
 static void disable_tracks(MXFReader *reader, const set<size_t> &track_indexes,
@@ -340,10 +331,20 @@ static void disable_tracks(MXFReader *reader, const set<size_t> &track_indexes,
     }
 }
 
+static void set_pooled_frame_factories(MXFReader *reader)
+{
+    // frames are returned to the pool on Release() and reused with their data capacity kept
+    size_t i;
+    for (i = 0; i < reader->GetNumTrackReaders(); i++)
+        reader->GetTrackReader(i)->GetFrameBuffer()->SetFrameFactory(new PooledFrameFactory(), true);
+}
+
 static void usage(const char *cmd)
 {
     fprintf(stderr, "%s\n", get_app_version_info(APP_NAME).c_str());
     fprintf(stderr, "Usage: %s <<options>> [<<input options>> <mxf input>]+\n", cmd);
+    fprintf(stderr, "       %s --batch <job file> [<batch options>]\n", cmd);
+    fprintf(stderr, "   Use '%s --batch -h' to show the batch job file format and options\n", cmd);
     fprintf(stderr, "   Use <mxf input> '-' for standard input\n");
     fprintf(stderr, "Options (* means option is required):\n");
     fprintf(stderr, "  -h | --help             Show usage and exit\n");
@@ -354,6 +355,7 @@ static void usage(const char *cmd)
     fprintf(stderr, "  -t <type>               Clip type: as02, as11op1a, as11d10, as11rdd9, op1a, avid, d10, rdd9, as10, wave. Default is op1a\n");
     fprintf(stderr, "* -o <name>               as02: <name> is a bundle name\n");
     fprintf(stderr, "                          as11op1a/as11d10/op1a/d10/rdd9/as10/wave: <name> is a filename\n");
+    fprintf(stderr, "                          as11op1a/as11rdd9/op1a/rdd9/as10: <name> '-' writes to stdout. Output to stdout, a pipe or a socket is written in a single pass\n");
     fprintf(stderr, "                          avid: <name> is a filename prefix\n");
     fprintf(stderr, "  --prod-info <cname>\n");
     fprintf(stderr, "              <pname>\n");
@@ -392,9 +394,12 @@ static void usage(const char *cmd)
     fprintf(stderr, "  --gf-delay <sec>        Set the delay (in seconds) between a failure to read and a retry. The default is %f.\n", DEFAULT_GF_RETRY_DELAY);
     fprintf(stderr, "  --gf-rate <factor>      Limit the read rate to realtime rate x <factor> after a read failure. The default is %f\n", DEFAULT_GF_RATE_AFTER_FAIL);
     fprintf(stderr, "                          <factor> value 1.0 results in realtime rate, value < 1.0 slower and > 1.0 faster\n");
+    fprintf(stderr, "  --gf-follow             Support growing files. Wait for the input files to grow rather than sleeping between retries\n");
+    fprintf(stderr, "                          --gf-delay sets the maximum wait and only waits that time out count towards --gf-retries\n");
     if (mxf_http_is_supported()) {
         fprintf(stderr, " --http-min-read <bytes>\n");
         fprintf(stderr, "                          Set the minimum number of bytes to read when accessing a file over HTTP. The default is %u.\n", DEFAULT_HTTP_MIN_READ);
+        fprintf(stderr, "                          This is the size of the cached blocks. Sequential reads are followed by parallel read-ahead requests\n");
     }
     fprintf(stderr, "  --no-precharge          Don't output clip/track with precharge. Adjust the start position and duration instead\n");
     fprintf(stderr, "  --no-rollout            Don't output clip/track with rollout. Adjust the duration instead\n");
@@ -407,7 +412,20 @@ static void usage(const char *cmd)
     fprintf(stderr, "  --mmap-file             Use memory-mapped file I/O for the MXF files\n");
     fprintf(stderr, "                          Note: this may reduce file I/O performance and was found to be slower over network drives\n");
 #endif
+#else
+    if (mxf_mmap_is_supported())
+        fprintf(stderr, "  --mmap-file             Use memory-mapped file I/O for the MXF files\n");
 #endif
+    fprintf(stderr, "  --cp-read <count>       Read up to <count> indexed, contiguous frame wrapped content packages in a single file read. Default is 0 (disabled)\n");
+    fprintf(stderr, "  --prefetch <depth>      Read ahead up to <depth> reads in a background thread. Default is 0 (disabled)\n");
+    fprintf(stderr, "  --prefetch-mem <size>   Limit the prefetched frame data to <size> MiB. Default is %u\n", DEFAULT_PREFETCH_MAX_SIZE);
+    fprintf(stderr, "  --index-cache           Read and write a sidecar index cache (<file>.bmxidx) next to each MXF file to speed up re-opening\n");
+    fprintf(stderr, "  --index-cache-dir <dir>\n");
+    fprintf(stderr, "                          Read and write the sidecar index cache files in <dir>\n");
+    fprintf(stderr, "  --pipeline <depth>      Read, convert audio and write in separate threads, queuing up to <depth> edit units. Default is 0 (disabled)\n");
+    fprintf(stderr, "  --stats                 Print per-stage time, byte and call counters and latency histograms to stderr when done\n");
+    fprintf(stderr, "  --stats-format <fmt>    Set the stats output format, 'text' or 'xml'. Default is 'text'\n");
+    fprintf(stderr, "  --stats-file <name>     Write the stats to file <name> instead of stderr\n");
     fprintf(stderr, "  --avcihead <format> <file> <offset>\n");
     fprintf(stderr, "                          Default AVC-Intra sequence header data (512 bytes) to use when the input file does not have it\n");
     fprintf(stderr, "                          <format> is a comma separated list of one or more of the following integer values:\n");
@@ -550,6 +568,8 @@ static void usage(const char *cmd)
     fprintf(stderr, "    --body-part             Create separate body partitions for essence data\n");
     fprintf(stderr, "                            and don't create separate body partitions for index table segments\n");
     fprintf(stderr, "    --repeat-index          Repeat the index table segments in the footer partition\n");
+    fprintf(stderr, "    --live-update <interval>  Allow the file to be read whilst it is being written. Start a body partition with the index table segments\n");
+    fprintf(stderr, "                            and update the header metadata duration at least every <interval> frames, or (floating point) seconds with 's' suffix\n");
     fprintf(stderr, "    --clip-wrap             Use clip wrapping for a single sound track\n");
     fprintf(stderr, "    --mp-track-num          Use the material package track number property to define a track order. By default the track number is set to 0\n");
     fprintf(stderr, "    --aes-3                 Use AES-3 audio mapping\n");
@@ -600,6 +620,9 @@ static void usage(const char *cmd)
     fprintf(stderr, "    --ignore-d10-aes3-flags   Ignore D10 AES3 audio validity flags and assume they are all valid\n");
     fprintf(stderr, "                              This workarounds an issue with Avid transfer manager which sets channel flags 4 to 8 to invalid\n");
     fprintf(stderr, "\n");
+    fprintf(stderr, "  as02/avid:\n");
+    fprintf(stderr, "    --parallel-write        Write each essence file in a separate thread. Entire file MD5 checksums are also calculated in parallel\n");
+    fprintf(stderr, "\n");
     fprintf(stderr, "  op1a/avid:\n");
     fprintf(stderr, "    --force-no-avci-head    Strip AVCI header (512 bytes, sequence and picture parameter sets) if present\n");
     fprintf(stderr, "\n");
@@ -662,7 +685,7 @@ static void usage(const char *cmd)
     fprintf(stderr, "    '0,1,s2' : 2 input channels plus 2 silence channels mapped to a single output track\n");
 }
 
-int main(int argc, const char** argv)
+static int transwrap_main(int argc, const char** argv)
 {
     Rational timecode_rate = FRAME_RATE_25;
     bool timecode_rate_set = false;
@@ -719,6 +742,7 @@ int main(int argc, const char** argv)
     vector<AVCIHeaderInput> avci_header_inputs;
     bool show_progress = false;
     bool single_pass = false;
+    bool stdout_output = false;
     bool output_file_md5 = false;
     BMX_OPT_PROP_DECL_DEF(Rational, user_aspect_ratio, ASPECT_RATIO_16_9);
     bool set_bs_aspect_ratio = false;
@@ -762,10 +786,13 @@ int main(int argc, const char** argv)
     bool min_part = false;
     bool body_part = false;
     bool repeat_index = false;
+    const char *live_update_interval_str = 0;
+    int64_t live_update_interval = 0;
     bool clip_wrap = false;
     bool realtime = false;
     float rt_factor = 1.0;
     bool growing_file = false;
+    bool gf_follow = false;
     unsigned int gf_retries = DEFAULT_GF_RETRIES;
     float gf_retry_delay = DEFAULT_GF_RETRY_DELAY;
     float gf_rate_after_fail = DEFAULT_GF_RATE_AFTER_FAIL;
@@ -781,9 +808,20 @@ int main(int argc, const char** argv)
     bool replace_avid_avcihead = false;
     bool avid_gf = false;
     int64_t avid_gf_duration = -1;
+    bool parallel_write = false;
     set<ANCDataType> pass_anc;
     bool pass_vbi = false;
     uint32_t st436_manifest_count = DEFAULT_ST436_MANIFEST_COUNT;
+    uint32_t cp_read_count = 0;
+    uint32_t prefetch_depth = 0;
+    uint32_t prefetch_max_size = DEFAULT_PREFETCH_MAX_SIZE;
+    bool index_cache = false;
+    bool regtest = false;
+    bool print_stats = false;
+    bool stats_xml = false;
+    const char *stats_filename = "";
+    const char *index_cache_dir = "";
+    uint32_t pipeline_depth = 0;
     uint32_t anc_const_size = 0;
     uint32_t anc_max_size = 0;
     bool st2020_max_size = false;
@@ -794,7 +832,7 @@ int main(int argc, const char** argv)
     uint8_t rdd6_sdid = DEFAULT_RDD6_SDID;
     uint32_t http_min_read = DEFAULT_HTTP_MIN_READ;
     bool mp_track_num = false;
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
     bool use_mmap_file = false;
 #endif
     vector<EmbedXMLInfo> embed_xml;
@@ -1059,6 +1097,11 @@ int main(int argc, const char** argv)
         {
             growing_file = true;
         }
+        else if (strcmp(argv[cmdln_index], "--gf-follow") == 0)
+        {
+            growing_file = true;
+            gf_follow = true;
+        }
         else if (strcmp(argv[cmdln_index], "--gf-retries") == 0)
         {
             if (cmdln_index + 1 >= argc)
@@ -1162,13 +1205,130 @@ int main(int argc, const char** argv)
         {
             input_file_flags |= MXF_WIN32_FLAG_SEQUENTIAL_SCAN;
         }
+#endif
 #if !defined(__MINGW32__)
         else if (strcmp(argv[cmdln_index], "--mmap-file") == 0)
         {
             use_mmap_file = true;
         }
 #endif
-#endif
+        else if (strcmp(argv[cmdln_index], "--cp-read") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            cp_read_count = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--prefetch") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            prefetch_depth = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--prefetch-mem") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1 || uvalue == 0)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            prefetch_max_size = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats") == 0)
+        {
+            print_stats = true;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats-format") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (!parse_stats_format(argv[cmdln_index + 1], &stats_xml))
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            print_stats = true;
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats-file") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            stats_filename = argv[cmdln_index + 1];
+            print_stats = true;
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--index-cache") == 0)
+        {
+            index_cache = true;
+        }
+        else if (strcmp(argv[cmdln_index], "--index-cache-dir") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            index_cache = true;
+            index_cache_dir = argv[cmdln_index + 1];
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--pipeline") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            pipeline_depth = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
         else if (strcmp(argv[cmdln_index], "--avcihead") == 0)
         {
             if (cmdln_index + 3 >= argc)
@@ -1898,6 +2058,17 @@ int main(int argc, const char** argv)
         {
             repeat_index = true;
         }
+        else if (strcmp(argv[cmdln_index], "--live-update") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            live_update_interval_str = argv[cmdln_index + 1];
+            cmdln_index++;
+        }
         else if (strcmp(argv[cmdln_index], "--clip-wrap") == 0)
         {
             clip_wrap = true;
@@ -2112,6 +2283,10 @@ int main(int argc, const char** argv)
         {
             avid_gf = true;
         }
+        else if (strcmp(argv[cmdln_index], "--parallel-write") == 0)
+        {
+            parallel_write = true;
+        }
         else if (strcmp(argv[cmdln_index], "--avid-gf-dur") == 0)
         {
             if (cmdln_index + 1 >= argc)
@@ -2240,7 +2415,7 @@ int main(int argc, const char** argv)
             }
             else if (strcmp(argv[cmdln_index], "--regtest") == 0)
             {
-                BMX_REGRESSION_TEST = true;
+                regtest = true;
             }
             else
             {
@@ -2338,15 +2513,59 @@ int main(int argc, const char** argv)
         as10_shim = get_as10_shim(as10_shim_name);
     }
 
-    LOG_LEVEL = log_level;
-    if (log_filename) {
-        if (!open_log_file(log_filename))
+    if (mxf_stream_file_is_stream(output_name)) {
+        if (clip_type != CW_OP1A_CLIP_TYPE && clip_type != CW_RDD9_CLIP_TYPE) {
+            usage(argv[0]);
+            fprintf(stderr, "Writing to stdout, a pipe or a socket is only supported for op1a and rdd9 clip types\n");
             return 1;
+        }
+        single_pass = true;
+        stdout_output = (strcmp(output_name, "-") == 0);
+        if (show_progress && stdout_output) {
+            usage(argv[0]);
+            fprintf(stderr, "Progress printing to stdout is not supported when writing to stdout\n");
+            return 1;
+        }
     }
 
-    connect_libmxf_logging();
+    if (BATCH_MODE) {
+        // logging, the regression test mode and the stats counters are process-wide and so are set up once
+        // for all the jobs in the batch. Output to stdout from concurrent jobs would be interleaved
+        if (log_filename) {
+            log_error("The -l option is not supported in batch jobs\n");
+            return 1;
+        }
+        if (regtest) {
+            log_error("The --regtest option is not supported in batch jobs; use it as a batch option\n");
+            return 1;
+        }
+        if (print_stats) {
+            log_error("The --stats options are not supported in batch jobs\n");
+            return 1;
+        }
+        if (stdout_output) {
+            log_error("Writing to stdout is not supported in batch jobs\n");
+            return 1;
+        }
+        if (show_progress) {
+            log_error("Progress printing (-p) is not supported in batch jobs\n");
+            return 1;
+        }
+    } else {
+        LOG_LEVEL = log_level;
+        if (log_filename) {
+            if (!open_log_file(log_filename))
+                return 1;
+        } else if (stdout_output) {
+            // stdout is reserved for the MXF data
+            set_stderr_log_file();
+        }
+
+        connect_libmxf_logging();
+    }
 
-    if (BMX_REGRESSION_TEST) {
+    if (regtest) {
+        BMX_REGRESSION_TEST = true;
         mxf_set_regtest_funcs();
         mxf_avid_set_regtest_funcs();
     }
@@ -2355,6 +2574,9 @@ int main(int argc, const char** argv)
         log_info("%s\n", get_app_version_info(APP_NAME).c_str());
 
 
+    if (print_stats)
+        stats_enable(true);
+
     int cmd_result = 0;
     try
     {
@@ -2390,7 +2612,7 @@ int main(int argc, const char** argv)
         if (rw_interleave)
             file_factory.SetRWInterleave(rw_interleave_size);
         file_factory.SetHTTPMinReadSize(http_min_read);
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
         file_factory.SetUseMMapFile(use_mmap_file);
 #endif
 
@@ -2403,6 +2625,9 @@ int main(int argc, const char** argv)
                 grp_file_reader->SetFileFactory(&file_factory, false);
                 grp_file_reader->GetPackageResolver()->SetFileFactory(&file_factory, false);
                 grp_file_reader->SetST436ManifestFrameCount(st436_manifest_count);
+                grp_file_reader->SetContentPackageReadCount(cp_read_count);
+                grp_file_reader->SetPrefetch(prefetch_depth, (uint64_t)prefetch_max_size * 1024 * 1024);
+                grp_file_reader->SetIndexCache(index_cache, index_cache_dir);
                 result = grp_file_reader->Open(input_filenames[i]);
                 if (result != MXFFileReader::MXF_RESULT_SUCCESS) {
                     log_error("Failed to open MXF file '%s': %s\n", input_filenames[i],
@@ -2426,6 +2651,9 @@ int main(int argc, const char** argv)
                 seq_file_reader->SetFileFactory(&file_factory, false);
                 seq_file_reader->GetPackageResolver()->SetFileFactory(&file_factory, false);
                 seq_file_reader->SetST436ManifestFrameCount(st436_manifest_count);
+                seq_file_reader->SetContentPackageReadCount(cp_read_count);
+                seq_file_reader->SetPrefetch(prefetch_depth, (uint64_t)prefetch_max_size * 1024 * 1024);
+                seq_file_reader->SetIndexCache(index_cache, index_cache_dir);
                 result = seq_file_reader->Open(input_filenames[i]);
                 if (result != MXFFileReader::MXF_RESULT_SUCCESS) {
                     log_error("Failed to open MXF file '%s': %s\n", input_filenames[i],
@@ -2446,6 +2674,9 @@ int main(int argc, const char** argv)
             file_reader->SetFileFactory(&file_factory, false);
             file_reader->GetPackageResolver()->SetFileFactory(&file_factory, false);
             file_reader->SetST436ManifestFrameCount(st436_manifest_count);
+            file_reader->SetContentPackageReadCount(cp_read_count);
+            file_reader->SetPrefetch(prefetch_depth, (uint64_t)prefetch_max_size * 1024 * 1024);
+            file_reader->SetIndexCache(index_cache, index_cache_dir);
             if (pass_dm && clip_sub_type == AS11_CLIP_SUB_TYPE)
                 AS11Info::RegisterExtensions(file_reader->GetHeaderMetadata());
             if (pass_dm && clip_sub_type == AS10_CLIP_SUB_TYPE)
@@ -2471,6 +2702,7 @@ int main(int argc, const char** argv)
         }
 
         reader->SetEmptyFrames(true);
+        set_pooled_frame_factories(reader);
 
         Rational frame_rate = reader->GetEditRate();
 
@@ -2481,6 +2713,7 @@ int main(int argc, const char** argv)
         RDD6MetadataFrame rdd6_frame;
         bmx::ByteArray rdd6_first_buffer, rdd6_second_buffer;
         bmx::ByteArray anc_buffer;
+        vector<CDataBuffer> anc_data_array;
         uint32_t rdd6_const_size = 0;
         bool rdd6_pair_in_frame = true;
         if (rdd6_filename) {
@@ -2509,8 +2742,9 @@ int main(int argc, const char** argv)
 
             if (rdd6_pair_in_frame) {
                 rdd6_frame.UpdateStaticFrame(&rdd6_static_sequence);
-                construct_anc_rdd6(&rdd6_frame, &rdd6_first_buffer, &rdd6_second_buffer, rdd6_sdid, rdd6_lines, &anc_buffer);
-                rdd6_const_size = anc_buffer.GetSize();
+                construct_anc_rdd6(&rdd6_frame, &rdd6_first_buffer, &rdd6_second_buffer, rdd6_sdid, rdd6_lines,
+                                   &anc_buffer, &anc_data_array);
+                rdd6_const_size = dba_get_total_size(&anc_data_array[0], (uint32_t)anc_data_array.size());
             } // else the individual RDD-6 sub-frames have different sizes
         }
 
@@ -2684,10 +2918,26 @@ int main(int argc, const char** argv)
         int16_t precharge = 0;
         int16_t rollout = 0;
         if (!reader->IsComplete()) {
-            if (start_set || duration >= 0) {
-                log_error("The --start and --dur options are not yet supported for incomplete files\n");
+            if (duration >= 0) {
+                log_error("The --dur option is not yet supported for incomplete files\n");
                 throw false;
             }
+            if (start_set) {
+                // the precharge is unknown until the index entries have been read and so the output would start
+                // with undecodable frames if the start position is not a key frame
+                for (i = 0; i < reader->GetNumTrackReaders(); i++) {
+                    if (reader->GetTrackReader(i)->IsEnabled() &&
+                        is_inter_frame_essence_type(reader->GetTrackReader(i)->GetTrackInfo()->essence_type))
+                    {
+                        log_error("The --start option is not supported for incomplete files with inter-frame "
+                                  "coded essence\n");
+                        throw false;
+                    }
+                }
+                // the start position is found by reading forwards if it is not indexed, e.g. in a stream
+                read_start = start;
+                reader->Seek(read_start);
+            }
             if (check_end) {
                 log_error("Checking last frame is present (--check-end) is not supported for incomplete files\n");
                 throw false;
@@ -2789,6 +3039,16 @@ int main(int argc, const char** argv)
             partition_interval_set = true;
         }
 
+        if (live_update_interval_str) {
+            if (!parse_partition_interval(live_update_interval_str, frame_rate, &live_update_interval) ||
+                live_update_interval <= 0)
+            {
+                usage(argv[0]);
+                log_error("Invalid value '%s' for option '--live-update'\n", live_update_interval_str);
+                throw false;
+            }
+        }
+
         if (segmentation_filename &&
             !as11_helper.ParseSegmentationFile(segmentation_filename, frame_rate))
         {
@@ -2933,6 +3193,10 @@ int main(int argc, const char** argv)
 
             if (BMX_OPT_PROP_IS_SET(head_fill))
                 as02_clip->ReserveHeaderMetadataSpace(head_fill);
+            if (parallel_write) {
+                as02_clip->SetParallelTrackWrite(true);
+                bundle->GetManifest()->SetParallelMICCalc(true);
+            }
 
             bundle->GetManifest()->SetDefaultMICType(mic_type);
             bundle->GetManifest()->SetDefaultMICScope(ENTIRE_FILE_MIC_SCOPE);
@@ -2965,11 +3229,15 @@ int main(int argc, const char** argv)
                 op1a_clip->SetClipWrapped(clip_wrap);
             if (partition_interval_set)
                 op1a_clip->SetPartitionInterval(partition_interval);
+            if (live_update_interval > 0)
+                op1a_clip->SetLiveUpdateInterval(live_update_interval);
             op1a_clip->SetOutputStartOffset(- precharge);
             op1a_clip->SetOutputEndOffset(- rollout);
         } else if (clip_type == CW_AVID_CLIP_TYPE) {
             AvidClip *avid_clip = clip->GetAvidClip();
 
+            if (parallel_write)
+                avid_clip->SetParallelTrackWrite(true);
             if (avid_gf) {
                 if (avid_gf_duration < 0)
                     avid_clip->SetGrowingDuration(reader->GetReadDuration());
@@ -3726,7 +3994,6 @@ int main(int argc, const char** argv)
         BMX_ASSERT(!output_tracks.empty());
         BMX_CHECK(!is_sound_frame_rate || output_tracks[0]->GetClipTrack()->GetEssenceType() == WAVE_PCM);
         vector<uint32_t> sample_sequence;
-        uint32_t sample_sequence_offset = 0;
         uint32_t max_samples_per_read = 1;
         if (is_sound_frame_rate) {
             // read sample sequence required for output frame rate
@@ -3740,25 +4007,51 @@ int main(int argc, const char** argv)
         BMX_ASSERT(max_samples_per_read == 1 || (precharge == 0 && rollout == 0));
 
 
-        // realtime transwrapping
+        // edit unit reader, including realtime transwrapping and growing input file retries
 
-        uint32_t rt_start = 0;
+        TranswrapReader edit_unit_reader(reader, input_tracks, frame_rate, sample_sequence, max_samples_per_read);
         if (realtime)
-            rt_start = get_tick_count();
+            edit_unit_reader.SetRealtime(rt_factor);
+        GrowingFileWatcher gf_watcher;
+        if (growing_file) {
+            edit_unit_reader.SetGrowingFile(gf_retries, gf_retry_delay, gf_rate_after_fail);
+            if (gf_follow) {
+                for (i = 0; i < input_filenames.size(); i++) {
+                    if (!gf_watcher.AddFile(input_filenames[i]))
+                        log_warn("Input '%s' is not a local file that can be followed\n", input_filenames[i]);
+                }
+                if (gf_watcher.HaveFiles())
+                    edit_unit_reader.SetGrowingFileWatcher(&gf_watcher);
+            }
+        }
+
+        TranswrapSoundConverter sound_converter(input_tracks, ignore_d10_aes3_flags);
 
 
-        // growing input files
+        // pipelined transwrapping
+        // reads are serialized with writes if the file reads and writes are interleaved.
+        // The pipeline is owned here so that its threads are stopped before the reader and converter they use
+        // are destroyed if the write loop throws
 
-        unsigned int gf_retry_count = 0;
-        bool gf_read_failure = false;
-        int64_t gf_failure_num_read = 0;
-        uint32_t gf_failure_start = 0;
+        Mutex pipeline_io_mutex;
+        Mutex *write_io_mutex = 0;
+        auto_ptr<TranswrapPipeline> pipeline;
+        if (pipeline_depth > 0) {
+            if (rw_interleave) {
+                edit_unit_reader.SetIOMutex(&pipeline_io_mutex);
+                write_io_mutex = &pipeline_io_mutex;
+            }
+            pipeline.reset(new TranswrapPipeline(&edit_unit_reader, &sound_converter, pipeline_depth));
+        }
 
 
         // create clip file(s) and write samples
 
         clip->PrepareWrite();
 
+        if (pipeline.get())
+            pipeline->Start();
+
         float next_progress_update;
         init_progress(&next_progress_update);
 
@@ -3769,32 +4062,28 @@ int main(int argc, const char** argv)
         int64_t duration_at_rollout_start = -1;
         int64_t container_duration;
         int64_t prev_container_duration = -1;
-        bmx::ByteArray sound_buffer;
-        while (read_duration < 0 || total_read < read_duration) {
-            uint32_t num_read = read_samples(reader, sample_sequence, &sample_sequence_offset, max_samples_per_read);
-            if (num_read == 0) {
-                if (!growing_file || !reader->ReadError() || gf_retry_count >= gf_retries)
+        TranswrapEditUnit serial_edit_unit;
+        while (true) {
+            TranswrapEditUnit *edit_unit;
+            if (pipeline.get()) {
+                edit_unit = pipeline->Pop();
+                if (!edit_unit)
                     break;
-                gf_retry_count++;
-                gf_read_failure = true;
-                if (gf_retry_delay > 0.0) {
-                    rt_sleep(1.0f / gf_retry_delay, get_tick_count(), frame_rate,
-                             frame_rate.numerator / frame_rate.denominator);
-                }
-                continue;
-            }
-            if (growing_file && gf_retry_count > 0) {
-                gf_failure_num_read = total_read;
-                gf_failure_start    = get_tick_count();
-                gf_retry_count      = 0;
+            } else {
+                edit_unit = &serial_edit_unit;
+                if (!edit_unit_reader.Read(edit_unit))
+                    break;
+                sound_converter.Convert(edit_unit);
             }
+            uint32_t num_read = edit_unit->num_read;
+
+            MutexLocker write_io_locker(write_io_mutex);
 
             // check whether sufficient frame data is available
             // if the frame is empty then check zero PCM sample padding is possible
             for (i = 0; i < input_tracks.size(); i++) {
                 MXFInputTrack *input_track = input_tracks[i];
-                Frame *frame = input_track->GetFrameBuffer()->GetLastFrame(false);
-                BMX_ASSERT(frame);
+                Frame *frame = edit_unit->frames[i];
                 if (!frame->IsComplete()) {
                     if (!frame->IsEmpty()) {
                         log_warn("Partially complete frames not yet supported\n");
@@ -3829,9 +4118,7 @@ int main(int argc, const char** argv)
             uint32_t first_sound_num_samples = 0;
             for (i = 0; i < input_tracks.size(); i++) {
                 MXFInputTrack *input_track = input_tracks[i];
-
-                Frame *frame = input_track->GetFrameBuffer()->GetLastFrame(true);
-                BMX_ASSERT(frame);
+                Frame *frame = edit_unit->frames[i];
 
                 if (clip_type == CW_AVID_CLIP_TYPE && convert_ess_marks) {
                     const vector<FrameMetadata*> *metadata = frame->GetMetadata(SDTI_CP_PACKAGE_METADATA_FMETA_ID);
@@ -3855,7 +4142,6 @@ int main(int argc, const char** argv)
                 for (k = 0; k < input_track->GetOutputTrackCount(); k++) {
                     OutputTrack *output_track = input_track->GetOutputTrack(k);
                     uint32_t output_channel_index = input_track->GetOutputChannelIndex(k);
-                    uint32_t input_channel_index = input_track->GetInputChannelIndex(k);
 
                     const MXFTrackInfo *input_track_info = input_track->GetTrackInfo();
                     const MXFSoundTrackInfo *input_sound_info = dynamic_cast<const MXFSoundTrackInfo*>(input_track_info);
@@ -3879,31 +4165,19 @@ int main(int argc, const char** argv)
                         num_samples = frame->request_num_samples;
                         output_track->WritePaddingSamples(output_channel_index, num_samples);
                     }
-                    else if ((input_sound_info && input_sound_info->channel_count > 1) ||
-                             input_track_info->essence_type == D10_AES3_PCM)
+                    else if (sound_converter.IsConverted(i))
                     {
-                        sound_buffer.Allocate(frame->GetSize()); // more than enough
-                        if (input_track_info->essence_type == D10_AES3_PCM) {
-                            convert_aes3_to_pcm(frame->GetBytes(), frame->GetSize(), ignore_d10_aes3_flags,
-                                                bits_per_sample, input_channel_index,
-                                                sound_buffer.GetBytes(), sound_buffer.GetAllocatedSize());
-                            num_samples = get_aes3_sample_count(frame->GetBytes(), frame->GetSize());
-                        } else {
-                            deinterleave_audio(frame->GetBytes(), frame->GetSize(),
-                                               bits_per_sample,
-                                               input_sound_info->channel_count, input_channel_index,
-                                               sound_buffer.GetBytes(), sound_buffer.GetAllocatedSize());
-                            num_samples = frame->GetSize() / (input_sound_info->channel_count * channel_block_align);
-                        }
-
+                        // multi-channel or AES-3 audio that was deinterleaved / converted by the sound converter
+                        uint32_t input_channel_index = input_track->GetInputChannelIndex(k);
+                        num_samples = edit_unit->GetSoundNumSamples(i);
                         output_track->WriteSamples(output_channel_index,
-                                                   sound_buffer.GetBytes(),
-                                                   num_samples * channel_block_align,
+                                                   edit_unit->GetSoundChannelData(i, input_channel_index),
+                                                   edit_unit->GetSoundChannelSize(i),
                                                    num_samples);
                     }
                     else if (input_track_info->essence_type == ANC_DATA)
                     {
-                        write_anc_samples(output_track, frame, pass_anc, anc_buffer);
+                        write_anc_samples(output_track, frame, pass_anc, anc_buffer, anc_data_array);
                     }
                     else
                     {
@@ -3920,8 +4194,6 @@ int main(int argc, const char** argv)
                     if (input_sound_info && first_sound_num_samples == 0 && num_samples > 0)
                         first_sound_num_samples = num_samples;
                 }
-
-                delete frame;
             }
 
             // write samples for silence tracks
@@ -3945,39 +4217,48 @@ int main(int argc, const char** argv)
                     rdd6_frame.UpdateStaticFrame(&rdd6_static_sequence);
 
                 if (rdd6_pair_in_frame) {
-                    construct_anc_rdd6(&rdd6_frame, &rdd6_first_buffer, &rdd6_second_buffer, rdd6_sdid, rdd6_lines, &anc_buffer);
+                    construct_anc_rdd6(&rdd6_frame, &rdd6_first_buffer, &rdd6_second_buffer, rdd6_sdid, rdd6_lines,
+                                       &anc_buffer, &anc_data_array);
                 } else {
                     if (even_frame)
-                        construct_anc_rdd6_sub_frame(&rdd6_frame, true, &rdd6_first_buffer, rdd6_sdid, rdd6_lines[0], &anc_buffer);
+                        construct_anc_rdd6_sub_frame(&rdd6_frame, true, &rdd6_first_buffer, rdd6_sdid, rdd6_lines[0],
+                                                     &anc_buffer, &anc_data_array);
                     else
-                        construct_anc_rdd6_sub_frame(&rdd6_frame, false, &rdd6_second_buffer, rdd6_sdid, rdd6_lines[1], &anc_buffer);
+                        construct_anc_rdd6_sub_frame(&rdd6_frame, false, &rdd6_second_buffer, rdd6_sdid, rdd6_lines[1],
+                                                     &anc_buffer, &anc_data_array);
                 }
-                output_tracks.back()->WriteSamples(0, anc_buffer.GetBytes(), anc_buffer.GetSize(), 1);
+                output_tracks.back()->WriteSample(0, &anc_data_array[0], (uint32_t)anc_data_array.size());
 
                 if (rdd6_pair_in_frame || !even_frame)
                     rdd6_static_sequence.UpdateForNextStaticFrame();
                 even_frame = !even_frame;
             }
 
+            if (pipeline.get())
+                pipeline->Recycle(edit_unit);
+            else
+                edit_unit->Reset();
+
 
             total_read += num_read;
 
 
             if (show_progress)
                 print_progress(total_read, read_duration, &next_progress_update);
-
-            if (max_samples_per_read > 1 && num_read < max_samples_per_read)
-                break;
-
-            if (gf_read_failure)
-                rt_sleep(gf_rate_after_fail, gf_failure_start, frame_rate, total_read - gf_failure_num_read);
-            else if (realtime)
-                rt_sleep(rt_factor, rt_start, frame_rate, total_read);
+        }
+        serial_edit_unit.Reset();
+        if (pipeline.get()) {
+            pipeline->Stop();
+            bool pipeline_error = pipeline->HaveError();
+            string pipeline_error_message = pipeline->GetErrorMessage();
+            pipeline.reset();
+            if (pipeline_error)
+                BMX_EXCEPTION(("Transwrap pipeline failed: %s", pipeline_error_message.c_str()));
         }
         if (reader->ReadError()) {
             bmx::log(reader->IsComplete() ? ERROR_LOG : WARN_LOG,
                      "A read error occurred: %s\n", reader->ReadErrorMessage().c_str());
-            if (gf_retry_count >= gf_retries)
+            if (edit_unit_reader.GetRetryCount() >= gf_retries)
                 log_warn("Reached maximum growing file retries, %u\n", gf_retries);
             if (reader->IsComplete())
                 cmd_result = 1;
@@ -4099,9 +4380,22 @@ int main(int argc, const char** argv)
     }
 
 
+    if (print_stats && !write_stats(stats_filename, stats_xml))
+        cmd_result = 1;
+
     if (log_filename)
         close_log_file();
 
 
     return cmd_result;
 }
+
+int main(int argc, const char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        BATCH_MODE = true;
+        return run_app_batch(APP_NAME, transwrap_main, argc, argv);
+    }
+
+    return transwrap_main(argc, argv);
+}
@@ -283,11 +283,12 @@ void APPInfoOutput::CompleteEventTimecodes()
             break;
         }
 
-        delete frame;
+        frame->Release();
         frame = 0;
     }
 
-    delete frame;
+    if (frame)
+        frame->Release();
 }
 
 void APPInfoOutput::WriteInfo(AppInfoWriter *info_writer, bool include_events)
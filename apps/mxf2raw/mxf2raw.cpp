@@ -59,12 +59,17 @@
 #include <bmx/MD5.h>
 #include <bmx/CRC32.h>
 #include <bmx/MXFHTTPFile.h>
+#include <bmx/MXFMMapFile.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/URI.h>
 #include <bmx/Version.h>
 #include <bmx/apps/AppUtils.h>
+#include <bmx/apps/AppBatch.h>
+#include <bmx/apps/GrowingFileWatcher.h>
 #include <bmx/apps/AppMXFFileFactory.h>
+#include <bmx/apps/AppStats.h>
 #include <bmx/apps/AppTextInfoWriter.h>
 #include <bmx/apps/AppXMLInfoWriter.h>
 #include "AS11InfoOutput.h"
@@ -85,6 +90,8 @@ using namespace mxfpp;
 
 #define DEFAULT_ST436_MANIFEST_COUNT    2
 
+#define DEFAULT_PREFETCH_MAX_SIZE       256
+
 #define CHECK_FPRINTF(fname, pr)                                                                    \
     do {                                                                                            \
         if (pr < 0) {                                                                               \
@@ -130,6 +137,7 @@ typedef struct
 
 
 static LogData LOG_DATA;
+static bool BATCH_MODE = false;
 
 static const char *APP_NAME                     = "mxf2raw";
 static const char *XML_INFO_WRITER_NAMESPACE    = "http://bbc.co.uk/rd/bmx/201312";
@@ -402,6 +410,14 @@ static void disable_tracks(MXFReader *reader, const set<size_t> &track_indexes,
     }
 }
 
+static void set_pooled_frame_factories(MXFReader *reader)
+{
+    // frames are returned to the pool on Release() and reused with their data capacity kept
+    size_t i;
+    for (i = 0; i < reader->GetNumTrackReaders(); i++)
+        reader->GetTrackReader(i)->GetFrameBuffer()->SetFrameFactory(new PooledFrameFactory(), true);
+}
+
 static string get_d10_sound_flags(uint8_t flags)
 {
     char buf[10];
@@ -1559,6 +1575,8 @@ static void usage(const char *cmd)
 {
     fprintf(stderr, "%s\n", get_app_version_info(APP_NAME).c_str());
     fprintf(stderr, "Usage: %s <<options>> [<<input options>> <filename>]+\n", cmd);
+    fprintf(stderr, "       %s --batch <job file> [<batch options>]\n", cmd);
+    fprintf(stderr, "   Use '%s --batch -h' to show the batch job file format and options\n", cmd);
     fprintf(stderr, "   Use <filename> '-' for standard input\n");
     fprintf(stderr, "Options:\n");
     fprintf(stderr, " -h | --help           Show usage and exit\n");
@@ -1633,15 +1651,31 @@ static void usage(const char *cmd)
     fprintf(stderr, " --mmap-file           Use memory-mapped file I/O for the MXF files\n");
     fprintf(stderr, "                       Note: this may reduce file I/O performance and was found to be slower over network drives\n");
 #endif
+#else
+    if (mxf_mmap_is_supported())
+        fprintf(stderr, " --mmap-file           Use memory-mapped file I/O for the MXF files\n");
 #endif
+    fprintf(stderr, " --cp-read <count>     Read up to <count> indexed, contiguous frame wrapped content packages in a single file read. Default is 0 (disabled)\n");
+    fprintf(stderr, " --prefetch <depth>    Read ahead up to <depth> reads in a background thread. Default is 0 (disabled)\n");
+    fprintf(stderr, " --prefetch-mem <size> Limit the prefetched frame data to <size> MiB. Default is %u\n", DEFAULT_PREFETCH_MAX_SIZE);
+    fprintf(stderr, " --index-cache         Read and write a sidecar index cache (<file>.bmxidx) next to each MXF file to speed up re-opening\n");
+    fprintf(stderr, " --index-cache-dir <dir>\n");
+    fprintf(stderr, "                       Read and write the sidecar index cache files in <dir>\n");
+    fprintf(stderr, " --stats               Print per-stage time, byte and call counters and latency histograms to stderr when done\n");
+    fprintf(stderr, "                       The stats are also included in the --info output\n");
+    fprintf(stderr, " --stats-format <fmt>  Set the stats output format, 'text' or 'xml'. Default is 'text'\n");
+    fprintf(stderr, " --stats-file <name>   Write the stats to file <name> instead of stderr\n");
     fprintf(stderr, " --gf                  Support growing files. Retry reading a frame when it fails\n");
     fprintf(stderr, " --gf-retries <max>    Set the maximum times to retry reading a frame. The default is %u.\n", DEFAULT_GF_RETRIES);
     fprintf(stderr, " --gf-delay <sec>      Set the delay (in seconds) between a failure to read and a retry. The default is %f.\n", DEFAULT_GF_RETRY_DELAY);
     fprintf(stderr, " --gf-rate <factor>    Limit the read rate to realtime rate x <factor> after a read failure. The default is %f\n", DEFAULT_GF_RATE_AFTER_FAIL);
     fprintf(stderr, "                       <factor> value 1.0 results in realtime rate, value < 1.0 slower and > 1.0 faster\n");
+    fprintf(stderr, " --gf-follow           Support growing files. Wait for the input files to grow rather than sleeping between retries\n");
+    fprintf(stderr, "                       --gf-delay sets the maximum wait and only waits that time out count towards --gf-retries\n");
     if (mxf_http_is_supported()) {
         fprintf(stderr, " --http-min-read <bytes>\n");
         fprintf(stderr, "                       Set the minimum number of bytes to read when accessing a file over HTTP. The default is %u.\n", DEFAULT_HTTP_MIN_READ);
+        fprintf(stderr, "                       This is the size of the cached blocks. Sequential reads are followed by parallel read-ahead requests\n");
     }
     fprintf(stderr, "\n");
     fprintf(stderr, " --text-out <prefix>   Extract text based objects to files starting with <prefix>\n");
@@ -1657,7 +1691,7 @@ static void usage(const char *cmd)
     fprintf(stderr, "\n");
 }
 
-int main(int argc, const char** argv)
+static int mxf2raw_main(int argc, const char** argv)
 {
     std::vector<const char *> input_filenames;
     const char *log_filename = 0;
@@ -1684,6 +1718,11 @@ int main(int argc, const char** argv)
     const char *all_tc_filename = 0;
     bool do_avid_info = false;
     uint32_t st436_manifest_count = DEFAULT_ST436_MANIFEST_COUNT;
+    uint32_t cp_read_count = 0;
+    uint32_t prefetch_depth = 0;
+    uint32_t prefetch_max_size = DEFAULT_PREFETCH_MAX_SIZE;
+    bool index_cache = false;
+    const char *index_cache_dir = "";
     const char *rdd6_filename = 0;
     int64_t rdd6_frame_min = 0;
     int64_t rdd6_frame_max = 0;
@@ -1708,15 +1747,20 @@ int main(int argc, const char** argv)
     bool realtime = false;
     float rt_factor = 1.0;
     bool growing_file = false;
+    bool gf_follow = false;
     unsigned int gf_retries = DEFAULT_GF_RETRIES;
     float gf_retry_delay = DEFAULT_GF_RETRY_DELAY;
     float gf_rate_after_fail = DEFAULT_GF_RATE_AFTER_FAIL;
     uint32_t http_min_read = DEFAULT_HTTP_MIN_READ;
     ChecksumType checkum_type;
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
     bool use_mmap_file = false;
 #endif
     const char *text_output_prefix = 0;
+    bool regtest = false;
+    bool print_stats = false;
+    bool stats_xml = false;
+    const char *stats_filename = "";
     bool mca_detail = false;
     unsigned int uvalue;
     int cmdln_index;
@@ -2103,17 +2147,122 @@ int main(int argc, const char** argv)
         {
             file_flags &= ~MXF_WIN32_FLAG_SEQUENTIAL_SCAN;
         }
+#endif
 #if !defined(__MINGW32__)
         else if (strcmp(argv[cmdln_index], "--mmap-file") == 0)
         {
             use_mmap_file = true;
         }
 #endif
-#endif
+        else if (strcmp(argv[cmdln_index], "--cp-read") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            cp_read_count = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--prefetch") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            prefetch_depth = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--prefetch-mem") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1 || uvalue == 0)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            prefetch_max_size = (uint32_t)(uvalue);
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--index-cache") == 0)
+        {
+            index_cache = true;
+        }
+        else if (strcmp(argv[cmdln_index], "--index-cache-dir") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            index_cache = true;
+            index_cache_dir = argv[cmdln_index + 1];
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats") == 0)
+        {
+            print_stats = true;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats-format") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (!parse_stats_format(argv[cmdln_index + 1], &stats_xml))
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            print_stats = true;
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats-file") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            stats_filename = argv[cmdln_index + 1];
+            print_stats = true;
+            cmdln_index++;
+        }
         else if (strcmp(argv[cmdln_index], "--gf") == 0)
         {
             growing_file = true;
         }
+        else if (strcmp(argv[cmdln_index], "--gf-follow") == 0)
+        {
+            growing_file = true;
+            gf_follow = true;
+        }
         else if (strcmp(argv[cmdln_index], "--gf-retries") == 0)
         {
             if (cmdln_index + 1 >= argc)
@@ -2195,7 +2344,7 @@ int main(int argc, const char** argv)
         }
         else if (strcmp(argv[cmdln_index], "--regtest") == 0)
         {
-            BMX_REGRESSION_TEST = true;
+            regtest = true;
         }
         else
         {
@@ -2273,10 +2422,34 @@ int main(int argc, const char** argv)
     }
 
 
-    LOG_LEVEL = log_level;
-    if (log_filename && !open_log_file(log_filename))
-        return 1;
-    if (do_write_info) {
+    if (BATCH_MODE) {
+        // logging is set up once for all the jobs in the batch and log messages are not intercepted
+        // because the log functions are shared by the jobs. The regression test mode and the stats counters
+        // are also process-wide. Info written to stdout by concurrent jobs would be interleaved
+        if (log_filename) {
+            log_error("The -l option is not supported in batch jobs\n");
+            return 1;
+        }
+        if (regtest) {
+            log_error("The --regtest option is not supported in batch jobs; use it as a batch option\n");
+            return 1;
+        }
+        if (print_stats) {
+            log_error("The --stats options are not supported in batch jobs\n");
+            return 1;
+        }
+        if (do_write_info && !info_filename) {
+            log_error("Writing info to stdout is not supported in batch jobs; use --info-file\n");
+            return 1;
+        }
+    } else {
+        LOG_LEVEL = log_level;
+        if (log_filename && !open_log_file(log_filename))
+            return 1;
+        if (regtest)
+            BMX_REGRESSION_TEST = true;
+    }
+    if (do_write_info && !BATCH_MODE) {
         // intercept log messages for adding to structured info output
         if (log_filename)
             LOG_DATA.vlog2 = bmx::vlog2;
@@ -2287,7 +2460,11 @@ int main(int argc, const char** argv)
         bmx::vlog2 = mxf2raw_vlog2;
     }
 
-    connect_libmxf_logging();
+    if (!BATCH_MODE)
+        connect_libmxf_logging();
+
+    if (print_stats)
+        stats_enable(true);
 
 
     int cmd_result = 0;
@@ -2318,6 +2495,9 @@ int main(int argc, const char** argv)
             cmd_result = 1;
         }
 
+        if (print_stats && !write_stats(stats_filename, stats_xml))
+            cmd_result = 1;
+
         if (log_filename)
             close_log_file();
 
@@ -2353,7 +2533,7 @@ int main(int argc, const char** argv)
             file_factory.SetInputChecksumTypes(file_checksum_types);
         file_factory.SetInputFlags(file_flags);
         file_factory.SetHTTPMinReadSize(http_min_read);
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
         file_factory.SetUseMMapFile(use_mmap_file);
 #endif
 
@@ -2366,6 +2546,9 @@ int main(int argc, const char** argv)
                 grp_file_reader->SetFileFactory(&file_factory, false);
                 grp_file_reader->GetPackageResolver()->SetFileFactory(&file_factory, false);
                 grp_file_reader->SetST436ManifestFrameCount(st436_manifest_count);
+                grp_file_reader->SetContentPackageReadCount(cp_read_count);
+                grp_file_reader->SetPrefetch(prefetch_depth, (uint64_t)prefetch_max_size * 1024 * 1024);
+                grp_file_reader->SetIndexCache(index_cache, index_cache_dir);
                 result = grp_file_reader->Open(input_filenames[i]);
                 if (result != MXFFileReader::MXF_RESULT_SUCCESS) {
                     log_error("Failed to open MXF file '%s': %s\n", get_input_filename(input_filenames[i]),
@@ -2389,6 +2572,9 @@ int main(int argc, const char** argv)
                 seq_file_reader->SetFileFactory(&file_factory, false);
                 seq_file_reader->GetPackageResolver()->SetFileFactory(&file_factory, false);
                 seq_file_reader->SetST436ManifestFrameCount(st436_manifest_count);
+                seq_file_reader->SetContentPackageReadCount(cp_read_count);
+                seq_file_reader->SetPrefetch(prefetch_depth, (uint64_t)prefetch_max_size * 1024 * 1024);
+                seq_file_reader->SetIndexCache(index_cache, index_cache_dir);
                 result = seq_file_reader->Open(input_filenames[i]);
                 if (result != MXFFileReader::MXF_RESULT_SUCCESS) {
                     log_error("Failed to open MXF file '%s': %s\n", get_input_filename(input_filenames[i]),
@@ -2409,6 +2595,9 @@ int main(int argc, const char** argv)
             file_reader->SetFileFactory(&file_factory, false);
             file_reader->GetPackageResolver()->SetFileFactory(&file_factory, false);
             file_reader->SetST436ManifestFrameCount(st436_manifest_count);
+            file_reader->SetContentPackageReadCount(cp_read_count);
+            file_reader->SetPrefetch(prefetch_depth, (uint64_t)prefetch_max_size * 1024 * 1024);
+            file_reader->SetIndexCache(index_cache, index_cache_dir);
             if (do_as11_info)
                 as11_register_extensions(file_reader);
             if (do_as10_info)
@@ -2440,6 +2629,8 @@ int main(int argc, const char** argv)
                 log_debug("Input file is not seekable\n");
         }
 
+        set_pooled_frame_factories(reader);
+
         mxfRational edit_rate = reader->GetEditRate();
 
 
@@ -2463,10 +2654,29 @@ int main(int argc, const char** argv)
         int64_t max_precharge = 0;
         int64_t max_rollout = 0;
         if (!reader->IsComplete()) {
-            if (start_set || duration >= 0) {
-                log_error("The --start and --dur options are not yet supported for incomplete files\n");
+            if (duration >= 0) {
+                log_error("The --dur option is not yet supported for incomplete files\n");
                 throw false;
             }
+            if (start_set) {
+                // the precharge is unknown until the index entries have been read and so the output would start
+                // with undecodable frames if the start position is not a key frame
+                if (!no_precharge) {
+                    size_t i;
+                    for (i = 0; i < reader->GetNumTrackReaders(); i++) {
+                        if (reader->GetTrackReader(i)->IsEnabled() &&
+                            is_inter_frame_essence_type(reader->GetTrackReader(i)->GetTrackInfo()->essence_type))
+                        {
+                            log_error("The --start option is not supported for incomplete files with inter-frame "
+                                      "coded essence, unless precharge is disabled using --nopc\n");
+                            throw false;
+                        }
+                    }
+                }
+                // the partitions written to a growing file since it was opened are picked up when seeking and
+                // a stream is read and skipped up to the start position
+                reader->Seek(start);
+            }
             if (check_end) {
                 log_error("Checking last frame is present (--check-end) is not supported for incomplete files\n");
                 last_frame_result = false;
@@ -2661,11 +2871,23 @@ int main(int argc, const char** argv)
             // growing file
             unsigned int gf_retry_count = 0;
             bool gf_read_failure = false;
+            bool gf_read_failed = false;
             int64_t gf_failure_num_read = 0;
             uint32_t gf_failure_start = 0;
+            GrowingFileWatcher gf_watcher;
+            if (gf_follow) {
+                size_t i;
+                for (i = 0; i < input_filenames.size(); i++) {
+                    if (!gf_watcher.AddFile(input_filenames[i])) {
+                        log_warn("Input '%s' is not a local file that can be followed\n",
+                                 get_input_filename(input_filenames[i]));
+                    }
+                }
+            }
 
             // read data
             bmx::ByteArray sound_buffer;
+            vector<unsigned char*> channel_buffers;
             int64_t total_num_read = 0;
             while (true)
             {
@@ -2673,15 +2895,23 @@ int main(int argc, const char** argv)
                 if (num_read == 0) {
                     if (!growing_file || !reader->ReadError() || gf_retry_count >= gf_retries)
                         break;
-                    gf_retry_count++;
                     gf_read_failure = true;
-                    if (gf_retry_delay > 0.0) {
-                        rt_sleep(1.0f / gf_retry_delay, get_tick_count(), edit_rate,
-                                 edit_rate.numerator / edit_rate.denominator);
+                    gf_read_failed = true;
+                    if (gf_watcher.HaveFiles()) {
+                        // only waits that time out without the input growing count as retries
+                        if (!gf_watcher.Wait((uint32_t)(gf_retry_delay * 1000)))
+                            gf_retry_count++;
+                    } else {
+                        gf_retry_count++;
+                        if (gf_retry_delay > 0.0) {
+                            rt_sleep(1.0f / gf_retry_delay, get_tick_count(), edit_rate,
+                                     edit_rate.numerator / edit_rate.denominator);
+                        }
                     }
                     continue;
                 }
-                if (growing_file && gf_retry_count > 0) {
+                if (growing_file && gf_read_failed) {
+                    gf_read_failed      = false;
                     gf_failure_num_read = total_num_read;
                     gf_failure_start    = get_tick_count();
                     gf_retry_count      = 0;
@@ -2699,7 +2929,7 @@ int main(int argc, const char** argv)
                         if (!frame)
                             break;
                         if (frame->IsEmpty()) {
-                            delete frame;
+                            frame->Release();
                             continue;
                         }
 
@@ -2783,23 +3013,33 @@ int main(int argc, const char** argv)
                             size_t file_index = track_raw_file_map[i];
                             const MXFSoundTrackInfo *sound_info = dynamic_cast<const MXFSoundTrackInfo*>(track_info);
                             if (sound_info && deinterleave && sound_info->channel_count > 1) {
-                                sound_buffer.Allocate(frame->GetSize()); // more than enough
+                                // deinterleave all channels in a single pass into per-channel buffers
+                                uint32_t channel_size;
+                                if (sound_info->essence_type == D10_AES3_PCM) {
+                                    channel_size = sound_info->block_align / sound_info->channel_count *
+                                                        get_aes3_sample_count(frame->GetBytes(), frame->GetSize());
+                                } else {
+                                    channel_size = frame->GetSize() / sound_info->channel_count;
+                                }
+                                sound_buffer.Allocate(channel_size * sound_info->channel_count);
+                                channel_buffers.resize(sound_info->channel_count);
                                 uint32_t c;
+                                for (c = 0; c < sound_info->channel_count; c++)
+                                    channel_buffers[c] = sound_buffer.GetBytes() + c * channel_size;
+
+                                if (sound_info->essence_type == D10_AES3_PCM) {
+                                    convert_aes3_to_pcm_channels(frame->GetBytes(), frame->GetSize(), false,
+                                                                 sound_info->bits_per_sample, sound_info->channel_count,
+                                                                 &channel_buffers[0], channel_size);
+                                } else {
+                                    deinterleave_audio_channels(frame->GetBytes(), frame->GetSize(),
+                                                                sound_info->bits_per_sample, sound_info->channel_count,
+                                                                &channel_buffers[0], channel_size);
+                                }
+
                                 for (c = 0; c < sound_info->channel_count; c++) {
-                                    if (sound_info->essence_type == D10_AES3_PCM) {
-                                        convert_aes3_to_pcm(frame->GetBytes(), frame->GetSize(), false,
-                                                            sound_info->bits_per_sample, c,
-                                                            sound_buffer.GetBytes(), sound_buffer.GetAllocatedSize());
-                                        sound_buffer.SetSize(sound_info->block_align / sound_info->channel_count *
-                                                                get_aes3_sample_count(frame->GetBytes(), frame->GetSize()));
-                                    } else {
-                                        deinterleave_audio(frame->GetBytes(), frame->GetSize(),
-                                                           sound_info->bits_per_sample, sound_info->channel_count, c,
-                                                           sound_buffer.GetBytes(), sound_buffer.GetAllocatedSize());
-                                        sound_buffer.SetSize(frame->GetSize() / sound_info->channel_count);
-                                    }
                                     write_data(raw_files[file_index], raw_filenames[file_index],
-                                               sound_buffer.GetBytes(), sound_buffer.GetSize(),
+                                               channel_buffers[c], channel_size,
                                                (wrap_klv_mask.find(track_info->data_def) != wrap_klv_mask.end()),
                                                &frame->element_key);
                                     file_index++;
@@ -2829,7 +3069,7 @@ int main(int argc, const char** argv)
                             }
                         }
 
-                        delete frame;
+                        frame->Release();
                     }
                 }
 
@@ -2942,7 +3182,7 @@ int main(int argc, const char** argv)
                         if (!frame)
                             break;
                         if (frame->IsEmpty()) {
-                            delete frame;
+                            frame->Release();
                             continue;
                         }
 
@@ -2959,7 +3199,7 @@ int main(int argc, const char** argv)
                             have_anc_data = true;
                         }
 
-                        delete frame;
+                        frame->Release();
                     }
                 }
             }
@@ -3094,6 +3334,9 @@ int main(int argc, const char** argv)
                 info_writer->EndSection();
             }
 
+            if (print_stats)
+                write_stats_info(info_writer);
+
             if (!LOG_DATA.messages.empty()) {
                 info_writer->StartArrayItem("log_messages", LOG_DATA.messages.size());
                 write_log_messages(info_writer);
@@ -3131,6 +3374,9 @@ int main(int argc, const char** argv)
         cmd_result = 1;
     }
 
+    if (print_stats && !write_stats(stats_filename, stats_xml))
+        cmd_result = 1;
+
     if (log_filename)
         close_log_file();
     else if (cmd_result != 0 && !LOG_DATA.messages.empty())
@@ -3140,3 +3386,12 @@ int main(int argc, const char** argv)
     return cmd_result;
 }
 
+int main(int argc, const char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        BATCH_MODE = true;
+        return run_app_batch(APP_NAME, mxf2raw_main, argc, argv);
+    }
+
+    return mxf2raw_main(argc, argv);
+}
@@ -68,10 +68,14 @@
 #include <bmx/wave/WaveReader.h>
 #include <bmx/essence_parser/SoundConversion.h>
 #include <bmx/URI.h>
+#include <bmx/MXFStreamFile.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/Version.h>
 #include <bmx/apps/AppUtils.h>
+#include <bmx/apps/AppMXFFileFactory.h>
+#include <bmx/apps/AppStats.h>
 #include <bmx/as11/AS11Labels.h>
 #include <bmx/as10/AS10ShimNames.h>
 #include <bmx/as10/AS10MPEG2Validator.h>
@@ -211,8 +215,11 @@ static uint32_t read_samples(RawInput *input, uint32_t max_samples_per_read)
     // flush last frame from wave reader buffer
     if (input->wave_reader) {
         uint32_t i;
-        for (i = 0; i < input->wave_reader->GetNumTracks(); i++)
-            delete input->wave_reader->GetTrack(i)->GetFrameBuffer()->GetLastFrame(true);
+        for (i = 0; i < input->wave_reader->GetNumTracks(); i++) {
+            Frame *frame = input->wave_reader->GetTrack(i)->GetFrameBuffer()->GetLastFrame(true);
+            if (frame)
+                frame->Release();
+        }
     }
 
     if (max_samples_per_read == 1) {
@@ -232,7 +239,7 @@ static uint32_t read_samples(RawInput *input, uint32_t max_samples_per_read)
     }
 }
 
-static bool open_raw_reader(RawInput *input)
+static bool open_raw_reader(RawInput *input, uint32_t parse_threads)
 {
     if (input->raw_reader) {
         input->raw_reader->Reset();
@@ -275,6 +282,8 @@ static bool open_raw_reader(RawInput *input)
     }
     if (input->ess_max_length > 0)
         input->raw_reader->SetMaxReadLength(input->ess_max_length);
+    if (parse_threads > 1)
+        input->raw_reader->SetParseThreads(parse_threads);
 
     return true;
 }
@@ -345,6 +354,7 @@ static void usage(const char *cmd)
     fprintf(stderr, "  -t <type>               Clip type: as02, as11op1a, as11d10, op1a, avid, d10, rdd9, as10, wave. Default is op1a\n");
     fprintf(stderr, "* -o <name>               as02: <name> is a bundle name\n");
     fprintf(stderr, "                          as11op1a/as11d10/op1a/d10/rdd9/as10/wave: <name> is a filename\n");
+    fprintf(stderr, "                          as11op1a/op1a/rdd9/as10: <name> '-' writes to stdout. Output to stdout, a pipe or a socket is written in a single pass\n");
     fprintf(stderr, "                          avid: <name> is a filename prefix\n");
     fprintf(stderr, "  --prod-info <cname>\n");
     fprintf(stderr, "              <pname>\n");
@@ -394,6 +404,11 @@ static void usage(const char *cmd)
     fprintf(stderr, "                          The dumps consists of a list output tracks, where each output track channel\n");
     fprintf(stderr, "                          is shown as '<output track channel> <- <input channel>\n");
     fprintf(stderr, "  --dump-track-map-exit   Same as --dump-track-map, but exit immediately afterwards\n");
+    fprintf(stderr, "  --parse-threads <n>     Use <n> threads to locate frame boundaries in raw essence input. Default is 1\n");
+    fprintf(stderr, "                          This applies to MPEG-2 Long GOP video essence. Other essence types are parsed in a single thread\n");
+    fprintf(stderr, "  --stats                 Print per-stage time, byte and call counters and latency histograms to stderr when done\n");
+    fprintf(stderr, "  --stats-format <fmt>    Set the stats output format, 'text' or 'xml'. Default is 'text'\n");
+    fprintf(stderr, "  --stats-file <name>     Write the stats to file <name> instead of stderr\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "  as11op1a/as11d10/as11rdd9/op1a/rdd9/d10:\n");
     fprintf(stderr, "    --head-fill <bytes>     Reserve minimum <bytes> at the end of the header metadata using a KLV Fill\n");
@@ -440,6 +455,8 @@ static void usage(const char *cmd)
     fprintf(stderr, "    --body-part             Create separate body partitions for essence data\n");
     fprintf(stderr, "                            and don't create separate body partitions for index table segments\n");
     fprintf(stderr, "    --repeat-index          Repeat the index table segments in the footer partition\n");
+    fprintf(stderr, "    --live-update <interval>  Allow the file to be read whilst it is being written. Start a body partition with the index table segments\n");
+    fprintf(stderr, "                            and update the header metadata duration at least every <interval> frames, or (floating point) seconds with 's' suffix\n");
     fprintf(stderr, "    --clip-wrap             Use clip wrapping for a single sound track\n");
     fprintf(stderr, "    --mp-track-num          Use the material package track number property to define a track order. By default the track number is set to 0\n");
     fprintf(stderr, "    --aes-3                 Use AES-3 audio mapping\n");
@@ -504,6 +521,9 @@ static void usage(const char *cmd)
     fprintf(stderr, "    --avid-gf-dur <dur>     Set the duration which should be shown whilst the file is growing\n");
     fprintf(stderr, "                            Avid will show 'Capture in Progress' when this option is used\n");
     fprintf(stderr, "\n");
+    fprintf(stderr, "  as02/avid:\n");
+    fprintf(stderr, "    --parallel-write        Write each essence file in a separate thread. Entire file MD5 checksums are also calculated in parallel\n");
+    fprintf(stderr, "\n");
     fprintf(stderr, "  op1a/avid:\n");
     fprintf(stderr, "    --force-no-avci-head    Strip AVCI header (512 bytes, sequence and picture parameter sets) if present\n");
     fprintf(stderr, "\n");
@@ -727,6 +747,7 @@ int main(int argc, const char** argv)
     bool do_print_version = false;
     vector<AVCIHeaderInput> avci_header_inputs;
     bool single_pass = false;
+    bool stdout_output = false;
     bool file_md5 = false;
     uint8_t d10_mute_sound_flags = 0;
     uint8_t d10_invalid_sound_flags = 0;
@@ -742,6 +763,8 @@ int main(int argc, const char** argv)
     bool min_part = false;
     bool body_part = false;
     bool repeat_index = false;
+    const char *live_update_interval_str = 0;
+    int64_t live_update_interval = 0;
     bool clip_wrap = false;
     bool allow_no_avci_head = false;
     bool force_no_avci_head = false;
@@ -758,6 +781,7 @@ int main(int argc, const char** argv)
     bool ps_avcihead = false;
     bool avid_gf = false;
     int64_t avid_gf_duration = -1;
+    bool parallel_write = false;
     int64_t regtest_end = -1;
     bool have_anc = false;
     bool have_vbi = false;
@@ -767,6 +791,10 @@ int main(int argc, const char** argv)
     TrackMapper track_mapper;
     bool dump_track_map = false;
     bool dump_track_map_exit = false;
+    uint32_t parse_threads = 1;
+    bool print_stats = false;
+    bool stats_xml = false;
+    const char *stats_filename = "";
     vector<pair<string, string> > track_mca_labels;
     bool use_avc_subdesc = false;
     UL audio_layout_mode_label = g_Null_UL;
@@ -1255,6 +1283,17 @@ int main(int argc, const char** argv)
         {
             repeat_index = true;
         }
+        else if (strcmp(argv[cmdln_index], "--live-update") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            live_update_interval_str = argv[cmdln_index + 1];
+            cmdln_index++;
+        }
         else if (strcmp(argv[cmdln_index], "--mp-track-num") == 0)
         {
             mp_track_num = true;
@@ -1522,6 +1561,10 @@ int main(int argc, const char** argv)
         {
             avid_gf = true;
         }
+        else if (strcmp(argv[cmdln_index], "--parallel-write") == 0)
+        {
+            parallel_write = true;
+        }
         else if (strcmp(argv[cmdln_index], "--avid-gf-dur") == 0)
         {
             if (cmdln_index + 1 >= argc)
@@ -1579,6 +1622,56 @@ int main(int argc, const char** argv)
             dump_track_map = true;
             dump_track_map_exit = true;
         }
+        else if (strcmp(argv[cmdln_index], "--parse-threads") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1 || uvalue == 0)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            parse_threads = uvalue;
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats") == 0)
+        {
+            print_stats = true;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats-format") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (!parse_stats_format(argv[cmdln_index + 1], &stats_xml))
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            print_stats = true;
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--stats-file") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            stats_filename = argv[cmdln_index + 1];
+            print_stats = true;
+            cmdln_index++;
+        }
         else if (strcmp(argv[cmdln_index], "--head-fill") == 0)
         {
             if (cmdln_index + 1 >= argc)
@@ -3371,6 +3464,16 @@ int main(int argc, const char** argv)
         as10_shim = get_as10_shim(as10_shim_name);
     }
 
+    if (mxf_stream_file_is_stream(output_name)) {
+        if (clip_type != CW_OP1A_CLIP_TYPE && clip_type != CW_RDD9_CLIP_TYPE) {
+            usage(argv[0]);
+            fprintf(stderr, "Writing to stdout, a pipe or a socket is only supported for op1a and rdd9 clip types\n");
+            return 1;
+        }
+        single_pass = true;
+        stdout_output = (strcmp(output_name, "-") == 0);
+    }
+
     if (clip_type != CW_AVID_CLIP_TYPE)
         allow_no_avci_head = false;
     if (clip_type != CW_AVID_CLIP_TYPE && clip_type != CW_OP1A_CLIP_TYPE)
@@ -3388,6 +3491,9 @@ int main(int argc, const char** argv)
     if (log_filename) {
         if (!open_log_file(log_filename))
             return 1;
+    } else if (stdout_output) {
+        // stdout is reserved for the MXF data
+        set_stderr_log_file();
     }
 
     connect_libmxf_logging();
@@ -3401,6 +3507,9 @@ int main(int argc, const char** argv)
         log_info("%s\n", get_app_version_info(APP_NAME).c_str());
 
 
+    if (print_stats)
+        stats_enable(true);
+
     int cmd_result = 0;
     try
     {
@@ -3482,7 +3591,7 @@ int main(int argc, const char** argv)
                     input->bits_per_sample = input->wave_reader->GetQuantizationBits();
                     input->channel_count   = input->wave_reader->GetNumTracks();
                 } else {
-                    if (!open_raw_reader(input))
+                    if (!open_raw_reader(input, parse_threads))
                         throw false;
                 }
                 continue;
@@ -3501,7 +3610,7 @@ int main(int argc, const char** argv)
                 continue;
             }
 
-            if (!open_raw_reader(input))
+            if (!open_raw_reader(input, parse_threads))
                 throw false;
 
             if (input->essence_type_group == DV_ESSENCE_GROUP ||
@@ -3860,7 +3969,7 @@ int main(int argc, const char** argv)
                 // re-open the raw reader to use the special AVCI reader
                 delete input->raw_reader;
                 input->raw_reader = 0;
-                if (!open_raw_reader(input))
+                if (!open_raw_reader(input, parse_threads))
                     throw false;
             }
             else if (input->essence_type_group == AVC_ESSENCE_GROUP ||
@@ -3940,6 +4049,16 @@ int main(int argc, const char** argv)
             partition_interval_set = true;
         }
 
+        if (live_update_interval_str) {
+            if (!parse_partition_interval(live_update_interval_str, frame_rate, &live_update_interval) ||
+                live_update_interval <= 0)
+            {
+                usage(argv[0]);
+                log_error("Invalid value '%s' for option '--live-update'\n", live_update_interval_str);
+                throw false;
+            }
+        }
+
         if (segmentation_filename &&
             !as11_helper.ParseSegmentationFile(segmentation_filename, frame_rate))
         {
@@ -4027,7 +4146,7 @@ int main(int argc, const char** argv)
             if (avid_gf)
                 flavour |= AVID_GROWING_FILE_FLAVOUR;
         }
-        DefaultMXFFileFactory file_factory;
+        AppMXFFileFactory file_factory;
         ClipWriter *clip = 0;
         switch (clip_type)
         {
@@ -4080,6 +4199,10 @@ int main(int argc, const char** argv)
 
             if (BMX_OPT_PROP_IS_SET(head_fill))
                 as02_clip->ReserveHeaderMetadataSpace(head_fill);
+            if (parallel_write) {
+                as02_clip->SetParallelTrackWrite(true);
+                bundle->GetManifest()->SetParallelMICCalc(true);
+            }
 
             bundle->GetManifest()->SetDefaultMICType(mic_type);
             bundle->GetManifest()->SetDefaultMICScope(ENTIRE_FILE_MIC_SCOPE);
@@ -4109,11 +4232,15 @@ int main(int argc, const char** argv)
                 op1a_clip->SetClipWrapped(clip_wrap);
             if (partition_interval_set)
                 op1a_clip->SetPartitionInterval(partition_interval);
+            if (live_update_interval > 0)
+                op1a_clip->SetLiveUpdateInterval(live_update_interval);
             op1a_clip->SetOutputStartOffset(output_start_offset);
             op1a_clip->SetOutputEndOffset(- output_end_offset);
         } else if (clip_type == CW_AVID_CLIP_TYPE) {
             AvidClip *avid_clip = clip->GetAvidClip();
 
+            if (parallel_write)
+                avid_clip->SetParallelTrackWrite(true);
             if (avid_gf && avid_gf_duration >= 0)
                 avid_clip->SetGrowingDuration(avid_gf_duration);
 
@@ -4662,7 +4789,7 @@ int main(int argc, const char** argv)
             RawInputTrack *input_track = input_tracks[i];
             RawInput *input = input_track->GetRawInput();
 
-            if (!input->is_wave && !open_raw_reader(input))
+            if (!input->is_wave && !open_raw_reader(input, parse_threads))
                 throw false;
 
             ClipWriterTrack *clip_track = input_track->GetOutputTrack(0)->GetClipTrack();
@@ -4900,6 +5027,7 @@ int main(int argc, const char** argv)
 
         // write samples
         bmx::ByteArray pcm_buffer;
+        vector<unsigned char*> pcm_channel_buffers;
         int64_t total_read = 0;
         while (duration < 0 || total_read < duration) {
             // break if reached end of partial file regression test
@@ -4931,7 +5059,23 @@ int main(int argc, const char** argv)
                 RawInputTrack *input_track = input_tracks[i];
                 RawInput *input = input_track->GetRawInput();
 
+                // deinterleave the mapped channels in a single pass
                 size_t k;
+                uint32_t pcm_channel_size = 0;
+                if (input->raw_reader && input->essence_type == WAVE_PCM && input->channel_count > 1) {
+                    pcm_channel_size = input->raw_reader->GetSampleDataSize() / input->channel_count;
+                    pcm_buffer.Allocate(pcm_channel_size * input->channel_count);
+                    pcm_channel_buffers.assign(input->channel_count, 0);
+                    for (k = 0; k < input_track->GetOutputTrackCount(); k++) {
+                        uint32_t input_channel_index = input_track->GetInputChannelIndex(k);
+                        pcm_channel_buffers[input_channel_index] = pcm_buffer.GetBytes() +
+                                                                       input_channel_index * pcm_channel_size;
+                    }
+                    deinterleave_audio_channels(input->raw_reader->GetSampleData(), input->raw_reader->GetSampleDataSize(),
+                                                input->bits_per_sample, input->channel_count,
+                                                &pcm_channel_buffers[0], pcm_channel_size);
+                }
+
                 for (k = 0; k < input_track->GetOutputTrackCount(); k++) {
                     OutputTrack *output_track = input_track->GetOutputTrack(k);
                     uint32_t output_channel_index = input_track->GetOutputChannelIndex(k);
@@ -4942,13 +5086,8 @@ int main(int argc, const char** argv)
                         if (max_samples_per_read > 1 && num_samples > min_num_samples)
                             num_samples = min_num_samples;
                         if (input->essence_type == WAVE_PCM && input->channel_count > 1) {
-                            pcm_buffer.Allocate(input->raw_reader->GetSampleDataSize() / input->channel_count);
-                            deinterleave_audio(input->raw_reader->GetSampleData(), input->raw_reader->GetSampleDataSize(),
-                                               input->bits_per_sample, input->channel_count, input_channel_index,
-                                               pcm_buffer.GetBytes(), pcm_buffer.GetAllocatedSize());
-                            pcm_buffer.SetSize(input->raw_reader->GetSampleDataSize() / input->channel_count);
                             output_track->WriteSamples(output_channel_index,
-                                                       pcm_buffer.GetBytes(), pcm_buffer.GetSize(),
+                                                       pcm_channel_buffers[input_channel_index], pcm_channel_size,
                                                        num_samples);
                         } else {
                             output_track->WriteSamples(output_channel_index,
@@ -5054,6 +5193,9 @@ int main(int argc, const char** argv)
     }
 
 
+    if (print_stats && !write_stats(stats_filename, stats_xml))
+        cmd_result = 1;
+
     if (log_filename)
         close_log_file();
 
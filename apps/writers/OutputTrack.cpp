@@ -225,6 +225,19 @@ void OutputTrack::WriteSamples(uint32_t output_channel_index,
         iter->second.have_sample_data = false;
 }
 
+void OutputTrack::WriteSample(uint32_t output_channel_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    // the sample pieces can only be passed on as-is if there is no interleaving or filtering
+    if (mInputMaps.size() <= 1 && !mFilter) {
+        BMX_ASSERT(mInputMaps.empty() || mInputMaps.count(output_channel_index));
+        mClipWriterTrack->WriteSample(data_array, array_size);
+    } else {
+        uint32_t size;
+        const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+        WriteSamples(output_channel_index, (unsigned char*)data, size, 1);
+    }
+}
+
 void OutputTrack::WritePaddingSamples(uint32_t output_channel_index, uint32_t num_samples)
 {
     WriteSamples(output_channel_index, 0, 0, num_samples);
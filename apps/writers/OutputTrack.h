@@ -79,6 +79,7 @@ public:
 
 public:
     void WriteSamples(uint32_t output_channel_index, unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t output_channel_index, const CDataBuffer *data_array, uint32_t array_size);
     void WritePaddingSamples(uint32_t output_channel_index, uint32_t num_samples);
 
     void WriteSilenceSamples(uint32_t num_samples);
@@ -111,6 +112,7 @@ private:
     int64_t mRemSkipPrecharge;
     EssenceFilter *mFilter;
     ByteArray mSampleBuffer;
+    ByteArray mSampleArrayBuffer;
     uint32_t mNumSamples;
     size_t mAvailableChannelCount;
     OutputTrackSoundInfo mSoundInfo;
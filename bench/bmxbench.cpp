@@ -0,0 +1,1284 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#define __STDC_FORMAT_MACROS
+#define __STDC_LIMIT_MACROS
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+#include <bmx/clip_writer/ClipWriter.h>
+#include <bmx/mxf_reader/MXFFileReader.h>
+#include <bmx/essence_parser/AVCEssenceParser.h>
+#include <bmx/essence_parser/MPEG2EssenceParser.h>
+#include <bmx/essence_parser/VC2EssenceParser.h>
+#include <bmx/essence_parser/FileEssenceSource.h>
+#include <bmx/essence_parser/RawEssenceReader.h>
+#include <bmx/essence_parser/SoundConversion.h>
+#include <bmx/wave/WaveFileIO.h>
+#include <bmx/apps/AppMXFFileFactory.h>
+#include <bmx/MXFMMapFile.h>
+#include <bmx/Checksum.h>
+#include <bmx/Version.h>
+#include <bmx/Utils.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+#include "EssenceParserUtils.h"
+
+using namespace std;
+using namespace bmx;
+using namespace mxfpp;
+
+
+#define DEFAULT_INDEX_SEGMENTS      100000
+#define DEFAULT_PARSE_THREADS       4
+#define NUM_RANDOM_READS            500
+#define NUM_INDEX_SEEKS             20000
+
+#define D10_50_FRAME_SIZE           250000
+#define PCM_FRAME_SAMPLES           1920
+#define PCM_BLOCK_ALIGN             3
+#define PCM_FRAME_SIZE              (PCM_FRAME_SAMPLES * PCM_BLOCK_ALIGN)
+#define SOUND_MAX_CHANNELS          16
+#define SOUND_NUM_FRAMES            20000
+#define CHECKSUM_BUFFER_SIZE        (16 * 1024 * 1024)
+#define CHECKSUM_NUM_UPDATES        32
+#define VC2_PICTURE_DATA_SIZE       200000
+#define VC2_NUM_FRAMES              250
+
+
+
+typedef struct
+{
+    string essence_dir;
+    string temp_dir;
+    string input;
+    uint32_t index_segments;
+    uint32_t parse_threads;
+} BenchConfig;
+
+typedef struct
+{
+    int64_t frames;
+    int64_t bytes;
+    double seconds;
+    uint64_t allocs;
+    uint64_t alloc_bytes;
+} BenchResult;
+
+typedef void (*BenchFunction)(const BenchConfig &config, BenchResult *result);
+
+typedef struct
+{
+    const char *name;
+    BenchFunction function;
+    const char *description;
+} BenchInfo;
+
+typedef struct
+{
+    uint32_t offset;
+    uint32_t size;
+} FrameInfo;
+
+
+
+// count the heap allocations made whilst a benchmark is being measured
+// libMXF allocates through the C allocator and so malloc, calloc and realloc are replaced where the C library
+// supports it (glibc). Otherwise only the C++ operator new allocations are counted
+
+#if defined(__GLIBC__)
+#define BENCH_COUNT_C_ALLOCS    1
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+#else
+#define BENCH_COUNT_C_ALLOCS    0
+#endif
+
+static bool g_count_allocs = false;
+static uint64_t g_num_allocs = 0;
+static uint64_t g_alloc_bytes = 0;
+
+static void count_alloc(size_t size)
+{
+    if (!g_count_allocs)
+        return;
+#if defined(__GNUC__)
+    __sync_fetch_and_add(&g_num_allocs, 1);
+    __sync_fetch_and_add(&g_alloc_bytes, (uint64_t)size);
+#else
+    g_num_allocs++;
+    g_alloc_bytes += size;
+#endif
+}
+
+#if BENCH_COUNT_C_ALLOCS
+
+extern "C" void* malloc(size_t size) __THROW
+{
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size) __THROW
+{
+    count_alloc(num * size);
+    return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void *ptr, size_t size) __THROW
+{
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr) __THROW
+{
+    __libc_free(ptr);
+}
+
+#endif
+
+static void* counted_alloc(size_t size)
+{
+#if !BENCH_COUNT_C_ALLOCS
+    count_alloc(size);
+#endif
+    void *ptr = malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+#if __cplusplus >= 201103L
+#define BENCH_NEW_THROW
+#define BENCH_DELETE_THROW  noexcept
+#else
+#define BENCH_NEW_THROW     throw(std::bad_alloc)
+#define BENCH_DELETE_THROW  throw()
+#endif
+
+void* operator new(size_t size) BENCH_NEW_THROW
+{
+    return counted_alloc(size);
+}
+
+void* operator new[](size_t size) BENCH_NEW_THROW
+{
+    return counted_alloc(size);
+}
+
+void operator delete(void *ptr) BENCH_DELETE_THROW
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) BENCH_DELETE_THROW
+{
+    free(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *ptr, size_t) BENCH_DELETE_THROW
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) BENCH_DELETE_THROW
+{
+    free(ptr);
+}
+#endif
+
+
+
+static double get_time_sec()
+{
+#if HAVE_CLOCK_GETTIME
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+        return 0.0;
+    return now.tv_sec + now.tv_nsec / 1000000000.0;
+#elif defined(_WIN32)
+    LARGE_INTEGER freq, now;
+    if (!QueryPerformanceFrequency(&freq) || !QueryPerformanceCounter(&now))
+        return 0.0;
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timeval now;
+    if (gettimeofday(&now, 0) != 0)
+        return 0.0;
+    return now.tv_sec + now.tv_usec / 1000000.0;
+#endif
+}
+
+static int64_t get_peak_rss_kb()
+{
+#if defined(_WIN32)
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; // bytes
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static double g_start_time = 0.0;
+
+static void start_measure(BenchResult *result)
+{
+    memset(result, 0, sizeof(*result));
+    g_num_allocs = 0;
+    g_alloc_bytes = 0;
+    g_count_allocs = true;
+    g_start_time = get_time_sec();
+}
+
+static void end_measure(BenchResult *result)
+{
+    result->seconds = get_time_sec() - g_start_time;
+    g_count_allocs = false;
+    result->allocs = g_num_allocs;
+    result->alloc_bytes = g_alloc_bytes;
+}
+
+static void print_result(const char *name, const BenchResult &result)
+{
+    double mb_per_sec = 0.0;
+    double frames_per_sec = 0.0;
+    if (result.seconds > 0.0) {
+        mb_per_sec = result.bytes / (1024.0 * 1024.0) / result.seconds;
+        frames_per_sec = result.frames / result.seconds;
+    }
+
+    // one JSON object per line
+    printf("{\"benchmark\": \"%s\", \"version\": \"%s\", \"frames\": %" PRId64 ", \"bytes\": %" PRId64 ", "
+           "\"seconds\": %.6f, \"mb_per_sec\": %.3f, \"frames_per_sec\": %.3f, "
+           "\"allocs\": %" PRIu64 ", \"alloc_bytes\": %" PRIu64 ", \"allocs_scope\": \"%s\", "
+           "\"peak_rss_kb\": %" PRId64 "}\n",
+           name, get_bmx_version_string().c_str(), result.frames, result.bytes,
+           result.seconds, mb_per_sec, frames_per_sec,
+           result.allocs, result.alloc_bytes, (BENCH_COUNT_C_ALLOCS ? "c,cxx" : "cxx"), get_peak_rss_kb());
+    fflush(stdout);
+}
+
+
+
+static string get_essence_filename(const BenchConfig &config, const char *name)
+{
+    return config.essence_dir + "/" + name;
+}
+
+static string get_temp_filename(const BenchConfig &config, const char *name)
+{
+    return config.temp_dir + "/" + name;
+}
+
+static void read_essence_file(const BenchConfig &config, const char *name, vector<unsigned char> *data)
+{
+    string filename = get_essence_filename(config, name);
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file)
+        BMX_EXCEPTION(("Failed to open essence file '%s': %s", filename.c_str(), bmx_strerror(errno).c_str()));
+
+    unsigned char buffer[65536];
+    size_t num_read;
+    while ((num_read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data->insert(data->end(), buffer, buffer + num_read);
+    fclose(file);
+
+    BMX_CHECK_M(!data->empty(), ("Essence file '%s' is empty", filename.c_str()));
+}
+
+static void parse_frames(EssenceParser *parser, const vector<unsigned char> &data, vector<FrameInfo> *frames)
+{
+    uint32_t data_size = (uint32_t)data.size();
+    uint32_t offset = parser->ParseFrameStart(&data[0], data_size);
+    BMX_CHECK_M(offset != ESSENCE_PARSER_NULL_OFFSET, ("Failed to find start of first frame"));
+
+    while (offset < data_size) {
+        uint32_t frame_size = parser->ParseFrameSize(&data[offset], data_size - offset);
+        if (frame_size == ESSENCE_PARSER_NULL_FRAME_SIZE)
+            break;
+        else if (frame_size == ESSENCE_PARSER_NULL_OFFSET)
+            frame_size = data_size - offset; // last frame
+
+        FrameInfo frame = {offset, frame_size};
+        frames->push_back(frame);
+        offset += frame_size;
+    }
+}
+
+static void split_fixed_frames(const vector<unsigned char> &data, uint32_t frame_size, vector<FrameInfo> *frames)
+{
+    uint32_t offset;
+    for (offset = 0; offset + frame_size <= data.size(); offset += frame_size) {
+        FrameInfo frame = {offset, frame_size};
+        frames->push_back(frame);
+    }
+}
+
+static uint32_t next_random(uint32_t *state)
+{
+    *state = (*state) * 1103515245 + 12345;
+    return ((*state) >> 8);
+}
+
+
+
+static void write_clip(const BenchConfig &config, ClipWriterType clip_type, bool clip_wrapped, const string &name,
+                       BenchResult *result)
+{
+    // OP-1A clip wrapping is limited to a single sound track
+    BMX_ASSERT(!clip_wrapped || clip_type == CW_OP1A_CLIP_TYPE);
+    int num_sound_tracks = (clip_wrapped ? 1 : 2);
+
+    vector<unsigned char> video_data;
+    vector<FrameInfo> video_frames;
+    EssenceType video_type = UNKNOWN_ESSENCE_TYPE;
+    if (clip_wrapped) {
+        // no video
+    } else if (clip_type == CW_D10_CLIP_TYPE) {
+        read_essence_file(config, "d10.raw", &video_data);
+        split_fixed_frames(video_data, D10_50_FRAME_SIZE, &video_frames);
+        video_type = D10_50;
+    } else if (clip_type != CW_WAVE_CLIP_TYPE) {
+        read_essence_file(config, "mpeg2lg.raw", &video_data);
+        MPEG2EssenceParser parser;
+        parse_frames(&parser, video_data, &video_frames);
+        video_type = MPEG2LG_422P_HL_1080I;
+    }
+
+    vector<unsigned char> pcm_data;
+    vector<FrameInfo> pcm_frames;
+    read_essence_file(config, "pcm.raw", &pcm_data);
+    split_fixed_frames(pcm_data, PCM_FRAME_SIZE, &pcm_frames);
+
+    size_t num_frames = pcm_frames.size();
+    if (video_type != UNKNOWN_ESSENCE_TYPE && video_frames.size() < num_frames)
+        num_frames = video_frames.size();
+    BMX_CHECK(num_frames > 0);
+
+
+    start_measure(result);
+
+    DefaultMXFFileFactory file_factory;
+    string filename = get_temp_filename(config, name.c_str());
+    ClipWriter *clip = 0;
+    switch (clip_type)
+    {
+        case CW_AS02_CLIP_TYPE:
+            clip = ClipWriter::OpenNewAS02Clip(filename, true, FRAME_RATE_25, &file_factory, false);
+            break;
+        case CW_OP1A_CLIP_TYPE:
+            clip = ClipWriter::OpenNewOP1AClip(OP1A_DEFAULT_FLAVOUR, file_factory.OpenNew(filename), FRAME_RATE_25);
+            break;
+        case CW_AVID_CLIP_TYPE:
+            clip = ClipWriter::OpenNewAvidClip(AVID_DEFAULT_FLAVOUR, FRAME_RATE_25, &file_factory, false);
+            break;
+        case CW_D10_CLIP_TYPE:
+            clip = ClipWriter::OpenNewD10Clip(D10_DEFAULT_FLAVOUR, file_factory.OpenNew(filename), FRAME_RATE_25);
+            break;
+        case CW_RDD9_CLIP_TYPE:
+            clip = ClipWriter::OpenNewRDD9Clip(0, file_factory.OpenNew(filename), FRAME_RATE_25);
+            break;
+        case CW_WAVE_CLIP_TYPE:
+            clip = ClipWriter::OpenNewWaveClip(WaveFileIO::OpenNew(filename));
+            break;
+        case CW_UNKNOWN_CLIP_TYPE:
+            BMX_ASSERT(false);
+            break;
+    }
+
+    try
+    {
+        if (clip_wrapped)
+            clip->GetOP1AClip()->SetClipWrapped(true);
+
+        uint32_t video_track_index = 0;
+        uint32_t first_sound_track_index = 0;
+        if (video_type != UNKNOWN_ESSENCE_TYPE) {
+            if (clip_type == CW_AVID_CLIP_TYPE)
+                clip->CreateTrack(video_type, filename + "_v1.mxf");
+            else
+                clip->CreateTrack(video_type);
+            first_sound_track_index = 1;
+        }
+
+        int i;
+        for (i = 0; i < num_sound_tracks; i++) {
+            ClipWriterTrack *track;
+            if (clip_type == CW_AVID_CLIP_TYPE) {
+                char suffix[16];
+                bmx_snprintf(suffix, sizeof(suffix), "_a%d.mxf", i + 1);
+                track = clip->CreateTrack(WAVE_PCM, filename + suffix);
+            } else {
+                track = clip->CreateTrack(WAVE_PCM);
+            }
+            track->SetSamplingRate(SAMPLING_RATE_48K);
+            track->SetQuantizationBits(PCM_BLOCK_ALIGN * 8);
+            if (clip_type == CW_D10_CLIP_TYPE)
+                track->SetSequenceOffset(0);
+        }
+
+        clip->PrepareHeaderMetadata();
+        clip->PrepareWrite();
+
+        size_t f;
+        for (f = 0; f < num_frames; f++) {
+            if (video_type != UNKNOWN_ESSENCE_TYPE) {
+                clip->WriteSamples(video_track_index, &video_data[video_frames[f].offset], video_frames[f].size, 1);
+                result->bytes += video_frames[f].size;
+            }
+            for (i = 0; i < num_sound_tracks; i++) {
+                clip->WriteSamples(first_sound_track_index + i, &pcm_data[pcm_frames[f].offset],
+                                   pcm_frames[f].size, PCM_FRAME_SAMPLES);
+                result->bytes += pcm_frames[f].size;
+            }
+            result->frames++;
+        }
+
+        clip->CompleteWrite();
+        delete clip;
+    }
+    catch (...)
+    {
+        delete clip;
+        throw;
+    }
+
+    end_measure(result);
+}
+
+static string prepare_read_file(const BenchConfig &config, bool clip_wrapped)
+{
+    if (!config.input.empty())
+        return config.input;
+
+    const char *name = (clip_wrapped ? "read_op1a_clip.mxf" : "read_op1a.mxf");
+    string filename = get_temp_filename(config, name);
+    if (!check_file_exists(filename)) {
+        BenchResult result;
+        write_clip(config, CW_OP1A_CLIP_TYPE, clip_wrapped, name, &result);
+    }
+
+    return filename;
+}
+
+static string prepare_index_file(const BenchConfig &config)
+{
+    // a file with a body partition and index table segment per frame
+
+    string filename = get_temp_filename(config, "index_op1a.mxf");
+    if (check_file_exists(filename))
+        return filename;
+
+    vector<unsigned char> anc_data;
+    read_essence_file(config, "anc.raw", &anc_data);
+
+    DefaultMXFFileFactory file_factory;
+    ClipWriter *clip = ClipWriter::OpenNewOP1AClip(OP1A_DEFAULT_FLAVOUR, file_factory.OpenNew(filename),
+                                                   FRAME_RATE_25);
+    try
+    {
+        clip->GetOP1AClip()->SetPartitionInterval(1);
+        clip->CreateTrack(ANC_DATA); // no constant or max data size results in a VBE index table
+
+        clip->PrepareHeaderMetadata();
+        clip->PrepareWrite();
+
+        uint32_t i;
+        for (i = 0; i < config.index_segments; i++)
+            clip->WriteSamples(0, &anc_data[0], (uint32_t)anc_data.size(), 1);
+
+        clip->CompleteWrite();
+        delete clip;
+    }
+    catch (...)
+    {
+        delete clip;
+        throw;
+    }
+
+    return filename;
+}
+
+static void open_reader(MXFFileReader *reader, const string &filename, bool use_mmap)
+{
+    AppMXFFileFactory *file_factory = new AppMXFFileFactory();
+#if !defined(__MINGW32__)
+    file_factory->SetUseMMapFile(use_mmap);
+#else
+    (void)use_mmap;
+#endif
+    reader->SetFileFactory(file_factory, true);
+
+    MXFFileReader::OpenResult result = reader->Open(filename);
+    if (result != MXFFileReader::MXF_RESULT_SUCCESS) {
+        BMX_EXCEPTION(("Failed to open MXF file '%s': %s", filename.c_str(),
+                       MXFFileReader::ResultToString(result).c_str()));
+    }
+
+    size_t i;
+    for (i = 0; i < reader->GetNumTrackReaders(); i++)
+        reader->GetTrackReader(i)->GetFrameBuffer()->SetFrameFactory(new PooledFrameFactory(), true);
+}
+
+static void release_frames(MXFFileReader *reader, BenchResult *result)
+{
+    size_t i;
+    for (i = 0; i < reader->GetNumTrackReaders(); i++) {
+        while (true) {
+            Frame *frame = reader->GetTrackReader(i)->GetFrameBuffer()->GetLastFrame(true);
+            if (!frame)
+                break;
+            result->bytes += frame->GetSize();
+            frame->Release();
+        }
+    }
+}
+
+static void read_file(const BenchConfig &config, bool clip_wrapped, bool use_mmap, bool random_access,
+                      BenchResult *result)
+{
+    string filename = prepare_read_file(config, clip_wrapped);
+
+    start_measure(result);
+
+    MXFFileReader reader;
+    open_reader(&reader, filename, use_mmap);
+
+    if (random_access) {
+        BMX_CHECK(reader.IsSeekable() && reader.GetDuration() > 0);
+        uint32_t random_state = 1;
+        int i;
+        for (i = 0; i < NUM_RANDOM_READS; i++) {
+            reader.Seek((int64_t)(next_random(&random_state) % reader.GetDuration()));
+            if (reader.Read(1) == 1)
+                result->frames++;
+            release_frames(&reader, result);
+        }
+    } else {
+        while (reader.Read(1) == 1) {
+            result->frames++;
+            release_frames(&reader, result);
+        }
+    }
+
+    end_measure(result);
+}
+
+
+
+static void bench_write_op1a(const BenchConfig &config, BenchResult *result)
+{
+    write_clip(config, CW_OP1A_CLIP_TYPE, false, "write_op1a.mxf", result);
+}
+
+static void bench_write_as02(const BenchConfig &config, BenchResult *result)
+{
+    write_clip(config, CW_AS02_CLIP_TYPE, false, "write_as02", result);
+}
+
+static void bench_write_avid(const BenchConfig &config, BenchResult *result)
+{
+    write_clip(config, CW_AVID_CLIP_TYPE, false, "write_avid", result);
+}
+
+static void bench_write_d10(const BenchConfig &config, BenchResult *result)
+{
+    write_clip(config, CW_D10_CLIP_TYPE, false, "write_d10.mxf", result);
+}
+
+static void bench_write_rdd9(const BenchConfig &config, BenchResult *result)
+{
+    write_clip(config, CW_RDD9_CLIP_TYPE, false, "write_rdd9.mxf", result);
+}
+
+static void bench_write_wave(const BenchConfig &config, BenchResult *result)
+{
+    write_clip(config, CW_WAVE_CLIP_TYPE, false, "write_wave.wav", result);
+}
+
+static void bench_read_seq(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, false, false, false, result);
+}
+
+static void bench_read_seq_mmap(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, false, true, false, result);
+}
+
+static void bench_read_random(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, false, false, true, result);
+}
+
+static void bench_read_random_mmap(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, false, true, true, result);
+}
+
+static void bench_read_seq_clip(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, true, false, false, result);
+}
+
+static void bench_read_seq_clip_mmap(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, true, true, false, result);
+}
+
+static void bench_read_random_clip(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, true, false, true, result);
+}
+
+static void bench_read_random_clip_mmap(const BenchConfig &config, BenchResult *result)
+{
+    read_file(config, true, true, true, result);
+}
+
+static void bench_index_open(const BenchConfig &config, BenchResult *result)
+{
+    string filename = prepare_index_file(config);
+
+    start_measure(result);
+
+    MXFFileReader reader;
+    open_reader(&reader, filename, false);
+    result->frames = reader.GetDuration();
+
+    end_measure(result);
+}
+
+static void bench_index_seek(const BenchConfig &config, BenchResult *result)
+{
+    string filename = prepare_index_file(config);
+
+    MXFFileReader reader;
+    open_reader(&reader, filename, false);
+    BMX_CHECK(reader.GetDuration() > 0);
+
+    start_measure(result);
+
+    uint32_t random_state = 1;
+    int i;
+    for (i = 0; i < NUM_INDEX_SEEKS; i++) {
+        reader.Seek((int64_t)(next_random(&random_state) % reader.GetDuration()));
+        if (reader.Read(1) == 1)
+            result->frames++;
+        release_frames(&reader, result);
+    }
+
+    end_measure(result);
+}
+
+static void bench_parse_start_code(const BenchConfig &config, BenchResult *result)
+{
+    vector<unsigned char> data;
+    read_essence_file(config, "mpeg2lg.raw", &data);
+
+    start_measure(result);
+
+    uint32_t data_size = (uint32_t)data.size();
+    uint32_t offset = 0;
+    uint32_t prefix_offset;
+    while (offset < data_size &&
+           (prefix_offset = find_start_code_prefix(&data[offset], data_size - offset)) != ESSENCE_PARSER_NULL_OFFSET)
+    {
+        offset += prefix_offset + 3;
+        result->frames++; // start codes
+    }
+    result->bytes = data_size;
+
+    end_measure(result);
+}
+
+static void parse_essence(const char *name, EssenceParser *parser, const BenchConfig &config, BenchResult *result)
+{
+    vector<unsigned char> data;
+    read_essence_file(config, name, &data);
+    vector<FrameInfo> frames;
+    frames.reserve(data.size() / 1000);
+
+    start_measure(result);
+
+    parse_frames(parser, data, &frames);
+    result->frames = frames.size();
+    result->bytes = data.size();
+
+    end_measure(result);
+}
+
+static void bench_parse_mpeg2lg(const BenchConfig &config, BenchResult *result)
+{
+    MPEG2EssenceParser parser;
+    parse_essence("mpeg2lg.raw", &parser, config, result);
+}
+
+static void bench_parse_avci(const BenchConfig &config, BenchResult *result)
+{
+    AVCEssenceParser parser;
+    parse_essence("avci.raw", &parser, config, result);
+}
+
+static void bench_parse_avci200_1080i(const BenchConfig &config, BenchResult *result)
+{
+    AVCEssenceParser parser;
+    parse_essence("avci200_1080i.raw", &parser, config, result);
+}
+
+static void bench_parse_avci200_1080p(const BenchConfig &config, BenchResult *result)
+{
+    AVCEssenceParser parser;
+    parse_essence("avci200_1080p.raw", &parser, config, result);
+}
+
+static void bench_parse_avci200_720p(const BenchConfig &config, BenchResult *result)
+{
+    AVCEssenceParser parser;
+    parse_essence("avci200_720p.raw", &parser, config, result);
+}
+
+static void set_vc2_parse_info(uint8_t parse_code, uint32_t next_parse_offset, uint32_t prev_parse_offset,
+                               vector<unsigned char> *data)
+{
+    static const unsigned char parse_info_prefix[4] = {0x42, 0x42, 0x43, 0x44};
+
+    data->insert(data->end(), parse_info_prefix, parse_info_prefix + sizeof(parse_info_prefix));
+    data->push_back(parse_code);
+    int i;
+    for (i = 3; i >= 0; i--)
+        data->push_back((unsigned char)(next_parse_offset >> (8 * i)));
+    for (i = 3; i >= 0; i--)
+        data->push_back((unsigned char)(prev_parse_offset >> (8 * i)));
+}
+
+static void create_vc2_data(vector<unsigned char> *data)
+{
+    // the sequence and picture headers are the ones written by create_test_essence (-t 54)
+    // the pictures are followed by VC2_PICTURE_DATA_SIZE bytes of random data and their next parse offset
+    // is 0 so that the parser has to search for the next parse info
+    static const unsigned char sequence_header[] = {0x70, 0x85, 0x58, 0x84, 0x3f};
+    static const unsigned char picture_header[] = {0x00, 0x00, 0x00, 0x00, 0x2d, 0x50, 0x18, 0x08, 0x1b, 0x7f, 0x10};
+    uint32_t picture_unit_size = 13 + sizeof(picture_header) + VC2_PICTURE_DATA_SIZE;
+    uint32_t random_state = 1;
+    uint32_t prev_unit_size;
+
+    data->reserve(VC2_NUM_FRAMES * (picture_unit_size + 13) + 13 + sizeof(sequence_header));
+
+    set_vc2_parse_info(0x00, 13 + sizeof(sequence_header), 0, data);
+    data->insert(data->end(), sequence_header, sequence_header + sizeof(sequence_header));
+    prev_unit_size = 13 + sizeof(sequence_header);
+
+    uint32_t i, j;
+    for (i = 0; i < VC2_NUM_FRAMES; i++) {
+        set_vc2_parse_info(0xe8, 0, prev_unit_size, data);
+        data->insert(data->end(), picture_header, picture_header + sizeof(picture_header));
+        for (j = 0; j < VC2_PICTURE_DATA_SIZE; j++)
+            data->push_back((unsigned char)next_random(&random_state));
+
+        set_vc2_parse_info(0x30, 13, picture_unit_size, data); // padding
+        prev_unit_size = 13;
+    }
+}
+
+static void bench_parse_vc2(const BenchConfig &config, BenchResult *result)
+{
+    (void)config;
+
+    vector<unsigned char> data;
+    create_vc2_data(&data);
+    vector<FrameInfo> frames;
+    frames.reserve(VC2_NUM_FRAMES);
+
+    VC2EssenceParser parser;
+
+    start_measure(result);
+
+    parse_frames(&parser, data, &frames);
+    result->frames = frames.size();
+    result->bytes = data.size();
+
+    end_measure(result);
+}
+
+static void read_raw_essence(const BenchConfig &config, uint32_t parse_threads, BenchResult *result)
+{
+    string filename = get_essence_filename(config, "mpeg2lg.raw");
+
+    start_measure(result);
+
+    FileEssenceSource *file_source = new FileEssenceSource();
+    if (!file_source->Open(filename, 0)) {
+        string error = file_source->GetStrError();
+        delete file_source;
+        BMX_EXCEPTION(("Failed to open essence file '%s': %s", filename.c_str(), error.c_str()));
+    }
+    RawEssenceReader reader(file_source);
+    reader.SetEssenceParser(new MPEG2EssenceParser());
+    reader.SetParseThreads(parse_threads);
+
+    while (reader.ReadSamples(1) == 1) {
+        result->frames++;
+        result->bytes += reader.GetSampleDataSize();
+    }
+
+    end_measure(result);
+}
+
+static void bench_raw_read_mpeg2lg(const BenchConfig &config, BenchResult *result)
+{
+    read_raw_essence(config, 1, result);
+}
+
+static void bench_raw_read_mpeg2lg_mt(const BenchConfig &config, BenchResult *result)
+{
+    read_raw_essence(config, config.parse_threads, result);
+}
+
+typedef enum
+{
+    SOUND_DEINTERLEAVE,
+    SOUND_DEINTERLEAVE_CHANNELS,
+    SOUND_INTERLEAVE,
+    SOUND_AES3_TO_PCM,
+    SOUND_AES3_TO_PCM_CHANNELS,
+    SOUND_AES3_TO_MC_PCM
+} SoundConversionType;
+
+static void create_sound_data(uint32_t block_align, uint16_t channel_count,
+                              vector<unsigned char> *interleaved, vector<unsigned char> *aes3,
+                              vector<vector<unsigned char> > *channels)
+{
+    uint32_t random_state = 1;
+    uint32_t i;
+
+    interleaved->resize(PCM_FRAME_SAMPLES * block_align * channel_count);
+    for (i = 0; i < interleaved->size(); i++)
+        (*interleaved)[i] = (unsigned char)next_random(&random_state);
+
+    // AES3 header is 4 bytes: flags, sample count (little endian) and channel valid flags
+    // followed by 4 bytes per sample for each of the 8 channels
+    aes3->resize(4 + PCM_FRAME_SAMPLES * 8 * 4);
+    for (i = 4; i < aes3->size(); i++)
+        (*aes3)[i] = (unsigned char)next_random(&random_state);
+    (*aes3)[0] = 0;
+    (*aes3)[1] = (unsigned char)(PCM_FRAME_SAMPLES & 0xff);
+    (*aes3)[2] = (unsigned char)((PCM_FRAME_SAMPLES >> 8) & 0xff);
+    (*aes3)[3] = 0xff;
+
+    channels->resize(channel_count);
+    for (i = 0; i < channel_count; i++)
+        (*channels)[i].resize(PCM_FRAME_SAMPLES * block_align);
+}
+
+static void convert_sound(SoundConversionType type, uint32_t bits_per_sample, uint16_t channel_count,
+                          BenchResult *result)
+{
+    BMX_ASSERT(channel_count <= SOUND_MAX_CHANNELS);
+    BMX_ASSERT(type < SOUND_AES3_TO_PCM || channel_count <= 8);
+
+    uint32_t block_align = (bits_per_sample + 7) / 8;
+    uint32_t channel_size = PCM_FRAME_SAMPLES * block_align;
+    vector<unsigned char> interleaved;
+    vector<unsigned char> aes3;
+    vector<vector<unsigned char> > channels;
+    create_sound_data(block_align, channel_count, &interleaved, &aes3, &channels);
+
+    unsigned char *channel_data[SOUND_MAX_CHANNELS];
+    uint16_t c;
+    for (c = 0; c < channel_count; c++)
+        channel_data[c] = &channels[c][0];
+
+    start_measure(result);
+
+    int i;
+    for (i = 0; i < SOUND_NUM_FRAMES; i++) {
+        switch (type)
+        {
+            case SOUND_DEINTERLEAVE:
+                for (c = 0; c < channel_count; c++) {
+                    deinterleave_audio(&interleaved[0], (uint32_t)interleaved.size(), bits_per_sample,
+                                       channel_count, c, channel_data[c], channel_size);
+                }
+                break;
+            case SOUND_DEINTERLEAVE_CHANNELS:
+                deinterleave_audio_channels(&interleaved[0], (uint32_t)interleaved.size(), bits_per_sample,
+                                            channel_count, channel_data, channel_size);
+                break;
+            case SOUND_INTERLEAVE:
+                for (c = 0; c < channel_count; c++) {
+                    interleave_audio(channel_data[c], channel_size, bits_per_sample,
+                                     channel_count, c, &interleaved[0], (uint32_t)interleaved.size());
+                }
+                break;
+            case SOUND_AES3_TO_PCM:
+                for (c = 0; c < channel_count; c++) {
+                    convert_aes3_to_pcm(&aes3[0], (uint32_t)aes3.size(), false, bits_per_sample, (uint8_t)c,
+                                        channel_data[c], channel_size);
+                }
+                break;
+            case SOUND_AES3_TO_PCM_CHANNELS:
+                convert_aes3_to_pcm_channels(&aes3[0], (uint32_t)aes3.size(), false, bits_per_sample,
+                                             (uint8_t)channel_count, channel_data, channel_size);
+                break;
+            case SOUND_AES3_TO_MC_PCM:
+                convert_aes3_to_mc_pcm(&aes3[0], (uint32_t)aes3.size(), false, bits_per_sample,
+                                       (uint8_t)channel_count, &interleaved[0], (uint32_t)interleaved.size());
+                break;
+        }
+    }
+    result->frames = SOUND_NUM_FRAMES;
+    result->bytes = (int64_t)SOUND_NUM_FRAMES * channel_size * channel_count;
+
+    end_measure(result);
+}
+
+#define SOUND_BENCH(name, type, bits_per_sample, channel_count)                     \
+    static void bench_sound_##name(const BenchConfig &config, BenchResult *result)  \
+    {                                                                                \
+        (void)config;                                                                \
+        convert_sound(type, bits_per_sample, channel_count, result);                 \
+    }
+
+SOUND_BENCH(deinterleave_16bit_2ch, SOUND_DEINTERLEAVE, 16, 2)
+SOUND_BENCH(deinterleave_16bit_8ch, SOUND_DEINTERLEAVE, 16, 8)
+SOUND_BENCH(deinterleave_16bit_16ch, SOUND_DEINTERLEAVE, 16, 16)
+SOUND_BENCH(deinterleave_24bit_2ch, SOUND_DEINTERLEAVE, 24, 2)
+SOUND_BENCH(deinterleave_24bit_8ch, SOUND_DEINTERLEAVE, 24, 8)
+SOUND_BENCH(deinterleave_24bit_16ch, SOUND_DEINTERLEAVE, 24, 16)
+SOUND_BENCH(deinterleave_channels_16bit_2ch, SOUND_DEINTERLEAVE_CHANNELS, 16, 2)
+SOUND_BENCH(deinterleave_channels_16bit_8ch, SOUND_DEINTERLEAVE_CHANNELS, 16, 8)
+SOUND_BENCH(deinterleave_channels_16bit_16ch, SOUND_DEINTERLEAVE_CHANNELS, 16, 16)
+SOUND_BENCH(deinterleave_channels_24bit_2ch, SOUND_DEINTERLEAVE_CHANNELS, 24, 2)
+SOUND_BENCH(deinterleave_channels_24bit_8ch, SOUND_DEINTERLEAVE_CHANNELS, 24, 8)
+SOUND_BENCH(deinterleave_channels_24bit_16ch, SOUND_DEINTERLEAVE_CHANNELS, 24, 16)
+SOUND_BENCH(interleave_16bit_2ch, SOUND_INTERLEAVE, 16, 2)
+SOUND_BENCH(interleave_16bit_8ch, SOUND_INTERLEAVE, 16, 8)
+SOUND_BENCH(interleave_16bit_16ch, SOUND_INTERLEAVE, 16, 16)
+SOUND_BENCH(interleave_24bit_2ch, SOUND_INTERLEAVE, 24, 2)
+SOUND_BENCH(interleave_24bit_8ch, SOUND_INTERLEAVE, 24, 8)
+SOUND_BENCH(interleave_24bit_16ch, SOUND_INTERLEAVE, 24, 16)
+SOUND_BENCH(aes3_to_pcm_16bit_2ch, SOUND_AES3_TO_PCM, 16, 2)
+SOUND_BENCH(aes3_to_pcm_16bit_8ch, SOUND_AES3_TO_PCM, 16, 8)
+SOUND_BENCH(aes3_to_pcm_24bit_2ch, SOUND_AES3_TO_PCM, 24, 2)
+SOUND_BENCH(aes3_to_pcm_24bit_8ch, SOUND_AES3_TO_PCM, 24, 8)
+SOUND_BENCH(aes3_to_pcm_channels_16bit_2ch, SOUND_AES3_TO_PCM_CHANNELS, 16, 2)
+SOUND_BENCH(aes3_to_pcm_channels_16bit_8ch, SOUND_AES3_TO_PCM_CHANNELS, 16, 8)
+SOUND_BENCH(aes3_to_pcm_channels_24bit_2ch, SOUND_AES3_TO_PCM_CHANNELS, 24, 2)
+SOUND_BENCH(aes3_to_pcm_channels_24bit_8ch, SOUND_AES3_TO_PCM_CHANNELS, 24, 8)
+SOUND_BENCH(aes3_to_mc_pcm_16bit_8ch, SOUND_AES3_TO_MC_PCM, 16, 8)
+SOUND_BENCH(aes3_to_mc_pcm_24bit_8ch, SOUND_AES3_TO_MC_PCM, 24, 8)
+
+static void calc_checksum(ChecksumType type, BenchResult *result)
+{
+    vector<unsigned char> data(CHECKSUM_BUFFER_SIZE);
+    uint32_t random_state = 1;
+    size_t i;
+    for (i = 0; i < data.size(); i++)
+        data[i] = (unsigned char)next_random(&random_state);
+
+    start_measure(result);
+
+    Checksum checksum(type);
+    int u;
+    for (u = 0; u < CHECKSUM_NUM_UPDATES; u++)
+        checksum.Update(&data[0], (uint32_t)data.size());
+    checksum.Final();
+    result->bytes = (int64_t)CHECKSUM_BUFFER_SIZE * CHECKSUM_NUM_UPDATES;
+
+    end_measure(result);
+}
+
+static void bench_checksum_crc32(const BenchConfig &config, BenchResult *result)
+{
+    (void)config;
+    calc_checksum(CRC32_CHECKSUM, result);
+}
+
+static void bench_checksum_md5(const BenchConfig &config, BenchResult *result)
+{
+    (void)config;
+    calc_checksum(MD5_CHECKSUM, result);
+}
+
+static void bench_checksum_sha1(const BenchConfig &config, BenchResult *result)
+{
+    (void)config;
+    calc_checksum(SHA1_CHECKSUM, result);
+}
+
+
+static const BenchInfo BENCHMARKS[] =
+{
+    {"write_op1a",                             bench_write_op1a,                             "Write an OP-1A file with MPEG-2 LG video and 2 PCM tracks"},
+    {"write_as02",                             bench_write_as02,                             "Write an AS-02 bundle with MPEG-2 LG video and 2 PCM tracks"},
+    {"write_avid",                             bench_write_avid,                             "Write Avid files with MPEG-2 LG video and 2 PCM tracks"},
+    {"write_d10",                              bench_write_d10,                              "Write a D-10 file with D-10 50 video and 2 PCM tracks"},
+    {"write_rdd9",                             bench_write_rdd9,                             "Write an RDD9 file with MPEG-2 LG video and 2 PCM tracks"},
+    {"write_wave",                             bench_write_wave,                             "Write a Wave file with 2 PCM tracks"},
+    {"read_seq",                               bench_read_seq,                               "Read all frames from an MXF file using stdio"},
+    {"read_seq_mmap",                          bench_read_seq_mmap,                          "Read all frames from an MXF file using mmap"},
+    {"read_random",                            bench_read_random,                            "Read frames at random positions from an MXF file using stdio"},
+    {"read_random_mmap",                       bench_read_random_mmap,                       "Read frames at random positions from an MXF file using mmap"},
+    {"read_seq_clip",                          bench_read_seq_clip,                          "Read all frames from a clip wrapped MXF file using stdio"},
+    {"read_seq_clip_mmap",                     bench_read_seq_clip_mmap,                     "Read all frames from a clip wrapped MXF file using mmap"},
+    {"read_random_clip",                       bench_read_random_clip,                       "Read frames at random positions from a clip wrapped MXF file using stdio"},
+    {"read_random_clip_mmap",                  bench_read_random_clip_mmap,                  "Read frames at random positions from a clip wrapped MXF file using mmap"},
+    {"index_open",                             bench_index_open,                             "Open an MXF file with an index table segment per frame"},
+    {"index_seek",                             bench_index_seek,                             "Seek and read in an MXF file with an index table segment per frame"},
+    {"parse_start_code",                       bench_parse_start_code,                       "Find the start code prefixes in MPEG-2 LG essence"},
+    {"parse_mpeg2lg",                          bench_parse_mpeg2lg,                          "Parse the frame sizes in MPEG-2 LG essence"},
+    {"parse_avci",                             bench_parse_avci,                             "Parse the frame sizes in AVC-Intra 100 essence"},
+    {"parse_avci200_1080i",                    bench_parse_avci200_1080i,                    "Parse the frame sizes in AVC-Intra 200 1080i essence"},
+    {"parse_avci200_1080p",                    bench_parse_avci200_1080p,                    "Parse the frame sizes in AVC-Intra 200 1080p essence"},
+    {"parse_avci200_720p",                     bench_parse_avci200_720p,                     "Parse the frame sizes in AVC-Intra 200 720p essence"},
+    {"parse_vc2",                              bench_parse_vc2,                              "Parse the frame sizes in VC-2 essence, searching for the end of each picture"},
+    {"raw_read_mpeg2lg",                       bench_raw_read_mpeg2lg,                       "Read MPEG-2 LG frames from a raw essence file"},
+    {"raw_read_mpeg2lg_mt",                    bench_raw_read_mpeg2lg_mt,                    "Read MPEG-2 LG frames from a raw essence file using parse threads"},
+    {"sound_deinterleave_16bit_2ch",           bench_sound_deinterleave_16bit_2ch,           "Deinterleave 2 channel 16-bit PCM, one channel at a time"},
+    {"sound_deinterleave_16bit_8ch",           bench_sound_deinterleave_16bit_8ch,           "Deinterleave 8 channel 16-bit PCM, one channel at a time"},
+    {"sound_deinterleave_16bit_16ch",          bench_sound_deinterleave_16bit_16ch,          "Deinterleave 16 channel 16-bit PCM, one channel at a time"},
+    {"sound_deinterleave_24bit_2ch",           bench_sound_deinterleave_24bit_2ch,           "Deinterleave 2 channel 24-bit PCM, one channel at a time"},
+    {"sound_deinterleave_24bit_8ch",           bench_sound_deinterleave_24bit_8ch,           "Deinterleave 8 channel 24-bit PCM, one channel at a time"},
+    {"sound_deinterleave_24bit_16ch",          bench_sound_deinterleave_24bit_16ch,          "Deinterleave 16 channel 24-bit PCM, one channel at a time"},
+    {"sound_deinterleave_channels_16bit_2ch",  bench_sound_deinterleave_channels_16bit_2ch,  "Deinterleave 2 channel 16-bit PCM, all channels in one pass"},
+    {"sound_deinterleave_channels_16bit_8ch",  bench_sound_deinterleave_channels_16bit_8ch,  "Deinterleave 8 channel 16-bit PCM, all channels in one pass"},
+    {"sound_deinterleave_channels_16bit_16ch", bench_sound_deinterleave_channels_16bit_16ch, "Deinterleave 16 channel 16-bit PCM, all channels in one pass"},
+    {"sound_deinterleave_channels_24bit_2ch",  bench_sound_deinterleave_channels_24bit_2ch,  "Deinterleave 2 channel 24-bit PCM, all channels in one pass"},
+    {"sound_deinterleave_channels_24bit_8ch",  bench_sound_deinterleave_channels_24bit_8ch,  "Deinterleave 8 channel 24-bit PCM, all channels in one pass"},
+    {"sound_deinterleave_channels_24bit_16ch", bench_sound_deinterleave_channels_24bit_16ch, "Deinterleave 16 channel 24-bit PCM, all channels in one pass"},
+    {"sound_interleave_16bit_2ch",             bench_sound_interleave_16bit_2ch,             "Interleave 2 channel 16-bit PCM"},
+    {"sound_interleave_16bit_8ch",             bench_sound_interleave_16bit_8ch,             "Interleave 8 channel 16-bit PCM"},
+    {"sound_interleave_16bit_16ch",            bench_sound_interleave_16bit_16ch,            "Interleave 16 channel 16-bit PCM"},
+    {"sound_interleave_24bit_2ch",             bench_sound_interleave_24bit_2ch,             "Interleave 2 channel 24-bit PCM"},
+    {"sound_interleave_24bit_8ch",             bench_sound_interleave_24bit_8ch,             "Interleave 8 channel 24-bit PCM"},
+    {"sound_interleave_24bit_16ch",            bench_sound_interleave_24bit_16ch,            "Interleave 16 channel 24-bit PCM"},
+    {"sound_aes3_to_pcm_16bit_2ch",            bench_sound_aes3_to_pcm_16bit_2ch,            "Convert 2 channels of AES3 to 16-bit PCM, one channel at a time"},
+    {"sound_aes3_to_pcm_16bit_8ch",            bench_sound_aes3_to_pcm_16bit_8ch,            "Convert 8 channels of AES3 to 16-bit PCM, one channel at a time"},
+    {"sound_aes3_to_pcm_24bit_2ch",            bench_sound_aes3_to_pcm_24bit_2ch,            "Convert 2 channels of AES3 to 24-bit PCM, one channel at a time"},
+    {"sound_aes3_to_pcm_24bit_8ch",            bench_sound_aes3_to_pcm_24bit_8ch,            "Convert 8 channels of AES3 to 24-bit PCM, one channel at a time"},
+    {"sound_aes3_to_pcm_channels_16bit_2ch",   bench_sound_aes3_to_pcm_channels_16bit_2ch,   "Convert 2 channels of AES3 to 16-bit PCM, all channels in one pass"},
+    {"sound_aes3_to_pcm_channels_16bit_8ch",   bench_sound_aes3_to_pcm_channels_16bit_8ch,   "Convert 8 channels of AES3 to 16-bit PCM, all channels in one pass"},
+    {"sound_aes3_to_pcm_channels_24bit_2ch",   bench_sound_aes3_to_pcm_channels_24bit_2ch,   "Convert 2 channels of AES3 to 24-bit PCM, all channels in one pass"},
+    {"sound_aes3_to_pcm_channels_24bit_8ch",   bench_sound_aes3_to_pcm_channels_24bit_8ch,   "Convert 8 channels of AES3 to 24-bit PCM, all channels in one pass"},
+    {"sound_aes3_to_mc_pcm_16bit_8ch",         bench_sound_aes3_to_mc_pcm_16bit_8ch,         "Convert 8 channels of AES3 to interleaved 16-bit PCM"},
+    {"sound_aes3_to_mc_pcm_24bit_8ch",         bench_sound_aes3_to_mc_pcm_24bit_8ch,         "Convert 8 channels of AES3 to interleaved 24-bit PCM"},
+    {"checksum_crc32",                         bench_checksum_crc32,                         "Calculate a CRC-32 checksum"},
+    {"checksum_md5",                           bench_checksum_md5,                           "Calculate an MD5 checksum"},
+    {"checksum_sha1",                          bench_checksum_sha1,                          "Calculate a SHA-1 checksum"},
+};
+
+
+
+static void usage(const char *cmd)
+{
+    size_t i;
+
+    fprintf(stderr, "%s\n", get_bmx_library_name().c_str());
+    fprintf(stderr, "Usage: %s <<options>> [<name>]*\n", cmd);
+    fprintf(stderr, "Runs the named benchmarks, or all benchmarks if none are named, and writes a JSON object\n");
+    fprintf(stderr, "per benchmark to stdout\n");
+    fprintf(stderr, "The allocs and alloc_bytes fields count the C malloc, calloc and realloc calls and the C++ new\n");
+    fprintf(stderr, "calls if allocs_scope is \"c,cxx\", or only the C++ new calls if allocs_scope is \"cxx\"\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -h | --help             Show usage and exit\n");
+    fprintf(stderr, "  -l | --list             List the benchmark names and exit\n");
+    fprintf(stderr, "  -e <dir>                Directory containing the essence files. Default '.'\n");
+    fprintf(stderr, "                          The files are created by test/create_test_essence:\n");
+    fprintf(stderr, "                              mpeg2lg.raw (-t 14), d10.raw (-t 11), pcm.raw (-t 42), avci.raw (-t 7),\n");
+    fprintf(stderr, "                              avci200_1080i.raw (-t 46), avci200_1080p.raw (-t 47),\n");
+    fprintf(stderr, "                              avci200_720p.raw (-t 48) and anc.raw (-t 43 -d 1)\n");
+    fprintf(stderr, "  -t <dir>                Directory for the output files. Default '.'\n");
+    fprintf(stderr, "  -i <name>               MXF filename or URL for the read benchmarks\n");
+    fprintf(stderr, "                          Default is a frame or clip wrapped OP-1A file written to the output directory\n");
+    fprintf(stderr, "  --index-segs <count>    Number of index table segments in the index benchmark file. Default %u\n",
+            DEFAULT_INDEX_SEGMENTS);
+    fprintf(stderr, "  --parse-threads <n>     Number of parse threads in the raw_read_mpeg2lg_mt benchmark. Default %u\n",
+            DEFAULT_PARSE_THREADS);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Benchmarks:\n");
+    for (i = 0; i < BMX_ARRAY_SIZE(BENCHMARKS); i++)
+        fprintf(stderr, "  %-40s %s\n", BENCHMARKS[i].name, BENCHMARKS[i].description);
+}
+
+int main(int argc, const char **argv)
+{
+    BenchConfig config;
+    config.essence_dir = ".";
+    config.temp_dir = ".";
+    config.index_segments = DEFAULT_INDEX_SEGMENTS;
+    config.parse_threads = DEFAULT_PARSE_THREADS;
+    vector<const BenchInfo*> benchmarks;
+    unsigned int uvalue;
+    int cmdln_index;
+    size_t i;
+
+    for (cmdln_index = 1; cmdln_index < argc; cmdln_index++)
+    {
+        if (strcmp(argv[cmdln_index], "-h") == 0 ||
+            strcmp(argv[cmdln_index], "--help") == 0)
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (strcmp(argv[cmdln_index], "-l") == 0 ||
+                 strcmp(argv[cmdln_index], "--list") == 0)
+        {
+            for (i = 0; i < BMX_ARRAY_SIZE(BENCHMARKS); i++)
+                printf("%s\n", BENCHMARKS[i].name);
+            return 0;
+        }
+        else if (strcmp(argv[cmdln_index], "-e") == 0 ||
+                 strcmp(argv[cmdln_index], "-t") == 0 ||
+                 strcmp(argv[cmdln_index], "-i") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (argv[cmdln_index][1] == 'e')
+                config.essence_dir = argv[cmdln_index + 1];
+            else if (argv[cmdln_index][1] == 't')
+                config.temp_dir = argv[cmdln_index + 1];
+            else
+                config.input = argv[cmdln_index + 1];
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--index-segs") == 0 ||
+                 strcmp(argv[cmdln_index], "--parse-threads") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            if (sscanf(argv[cmdln_index + 1], "%u", &uvalue) != 1 || uvalue == 0)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            if (strcmp(argv[cmdln_index], "--index-segs") == 0)
+                config.index_segments = uvalue;
+            else
+                config.parse_threads = uvalue;
+            cmdln_index++;
+        }
+        else if (argv[cmdln_index][0] == '-')
+        {
+            usage(argv[0]);
+            fprintf(stderr, "Unknown option '%s'\n", argv[cmdln_index]);
+            return 1;
+        }
+        else
+        {
+            for (i = 0; i < BMX_ARRAY_SIZE(BENCHMARKS); i++) {
+                if (strcmp(argv[cmdln_index], BENCHMARKS[i].name) == 0)
+                    break;
+            }
+            if (i >= BMX_ARRAY_SIZE(BENCHMARKS))
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Unknown benchmark '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+            benchmarks.push_back(&BENCHMARKS[i]);
+        }
+    }
+
+    if (benchmarks.empty()) {
+        for (i = 0; i < BMX_ARRAY_SIZE(BENCHMARKS); i++)
+            benchmarks.push_back(&BENCHMARKS[i]);
+    }
+
+
+    int cmd_result = 0;
+    for (i = 0; i < benchmarks.size(); i++) {
+        const BenchInfo *info = benchmarks[i];
+        if ((strcmp(info->name, "read_seq_mmap") == 0 || strcmp(info->name, "read_random_mmap") == 0 ||
+                strcmp(info->name, "read_seq_clip_mmap") == 0 || strcmp(info->name, "read_random_clip_mmap") == 0) &&
+            !mxf_mmap_is_supported())
+        {
+            log_info("Skipping benchmark '%s': mmap is not supported\n", info->name);
+            continue;
+        }
+
+        try
+        {
+            BenchResult result;
+            info->function(config, &result);
+            print_result(info->name, result);
+        }
+        catch (const MXFException &ex)
+        {
+            g_count_allocs = false;
+            log_error("Benchmark '%s' failed: MXF exception caught: %s\n", info->name, ex.getMessage().c_str());
+            cmd_result = 1;
+        }
+        catch (const BMXException &ex)
+        {
+            g_count_allocs = false;
+            log_error("Benchmark '%s' failed: BMX exception caught: %s\n", info->name, ex.what());
+            cmd_result = 1;
+        }
+    }
+
+    return cmd_result;
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# runs each benchmark in a separate process so that the peak RSS applies to a single benchmark
+# the results are written to stdout as a JSON object per line
+# the allocs and alloc_bytes counts include the C allocator calls (libMXF) only where the JSON allocs_scope
+# field is "c,cxx" (glibc). Where it is "cxx" only the C++ operator new allocations are counted
+# usage: run_bench.sh [<duration>]
+
+testdir=../test
+benchdir=.
+tmpdir=/tmp/bmxbench_temp$$
+
+duration=$1
+if test -z "$duration"; then
+    duration=250
+fi
+
+
+create_essence()
+{
+    $testdir/create_test_essence -t 14 -d $duration $tmpdir/mpeg2lg.raw &&
+        $testdir/create_test_essence -t 11 -d $duration $tmpdir/d10.raw &&
+        $testdir/create_test_essence -t 42 -d $duration $tmpdir/pcm.raw &&
+        $testdir/create_test_essence -t 7 -d $duration $tmpdir/avci.raw &&
+        $testdir/create_test_essence -t 46 -d $duration $tmpdir/avci200_1080i.raw &&
+        $testdir/create_test_essence -t 47 -d $duration $tmpdir/avci200_1080p.raw &&
+        $testdir/create_test_essence -t 48 -d $duration $tmpdir/avci200_720p.raw &&
+        $testdir/create_test_essence -t 43 -d 1 $tmpdir/anc.raw
+}
+
+run_benchmarks()
+{
+    res=0
+    for name in `$benchdir/bmxbench --list`; do
+        $benchdir/bmxbench -e $tmpdir -t $tmpdir $name || res=1
+    done
+    return $res
+}
+
+
+mkdir -p $tmpdir
+
+create_essence &&
+    run_benchmarks
+res=$?
+
+rm -Rf $tmpdir
+
+exit $res
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_CHUNK_QUEUE_WORKER_H_
+#define BMX_CHUNK_QUEUE_WORKER_H_
+
+#include <deque>
+#include <vector>
+#include <string>
+
+#include <bmx/ByteArray.h>
+#include <bmx/Thread.h>
+
+
+
+namespace bmx
+{
+
+
+// Processes data in a worker thread so that the processing overlaps with the caller's work.
+// Write() copies the data into chunks that are queued for the worker. The number of chunks is
+// bounded and Write() blocks if the worker falls behind. The worker is only started once the first
+// chunk is full; Flush() processes a partial chunk in the caller's thread if there is no worker.
+// Once ProcessChunk() fails or throws the remaining chunks are discarded and Write() and Flush()
+// return false.
+// The sub-class destructor must call StopWorker() because ProcessChunk() is called by the worker
+
+class ChunkQueueWorker
+{
+public:
+    ChunkQueueWorker(uint32_t chunk_size, size_t max_chunks);
+    virtual ~ChunkQueueWorker();
+
+    bool Write(const unsigned char *data, uint32_t size);
+    bool Flush();
+    void StopWorker();
+
+    bool HaveFailed();
+    std::string GetWorkerErrorMessage() const;
+
+protected:
+    virtual bool ProcessChunk(const unsigned char *data, uint32_t size) = 0;
+
+private:
+    class Worker;
+    friend class Worker;
+
+    ByteArray* GetFreeChunk();
+    void SubmitChunk(ByteArray *chunk);
+    void RunWorker();
+    void CompleteChunk(ByteArray *chunk, bool failed);
+
+private:
+    uint32_t mChunkSize;
+    size_t mMaxChunks;
+
+    Worker *mWorker;
+    Mutex mMutex;
+    Condition mCondition;
+    std::vector<ByteArray*> mChunks;
+    std::vector<ByteArray*> mFreeChunks;
+    std::deque<ByteArray*> mQueuedChunks;
+    ByteArray *mCurrentChunk;
+    bool mWorkerBusy;
+    bool mStopWorker;
+    bool mFailed;
+};
+
+
+};
+
+
+
+#endif
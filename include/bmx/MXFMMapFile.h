@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_MXF_MMAP_FILE_H_
+#define BMX_MXF_MMAP_FILE_H_
+
+#include <string>
+
+#include <mxf/mxf_file.h>
+
+
+#define MXF_MMAP_DEFAULT_WINDOW_SIZE     (64 * 1024 * 1024)
+
+
+
+namespace bmx
+{
+
+
+bool mxf_mmap_is_supported();
+
+// the window size is rounded up to a multiple of the system page size
+// output files are extended in window size steps, with the blocks reserved using posix_fallocate(), and truncated
+// to the written size when closed. Output is written using pwrite() if the blocks can't be reserved
+
+MXFFile* mxf_mmap_file_open_read(const std::string &filename, uint32_t window_size = MXF_MMAP_DEFAULT_WINDOW_SIZE);
+MXFFile* mxf_mmap_file_open_new(const std::string &filename, uint32_t window_size = MXF_MMAP_DEFAULT_WINDOW_SIZE);
+MXFFile* mxf_mmap_file_open_modify(const std::string &filename, uint32_t window_size = MXF_MMAP_DEFAULT_WINDOW_SIZE);
+
+
+};
+
+
+
+#endif
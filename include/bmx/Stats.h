@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_STATS_H_
+#define BMX_STATS_H_
+
+
+#include <bmx/BMXTypes.h>
+
+
+// bucket i counts calls that took less than 2^i microseconds; the last bucket counts the remainder
+#define STATS_NUM_LATENCY_BUCKETS   24
+
+
+
+namespace bmx
+{
+
+
+typedef enum
+{
+    STATS_FILE_READ = 0,
+    STATS_FILE_WRITE,
+    STATS_FILE_SEEK,
+    STATS_MXF_READ,
+    STATS_ESSENCE_READ,
+    STATS_ESSENCE_PARSE,
+    STATS_SOUND_CONVERSION,
+    STATS_CHECKSUM,
+    STATS_CLIP_WRITE,
+    STATS_NUM_COUNTERS,
+} StatsCounter;
+
+typedef struct
+{
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t nsec;
+    uint64_t latency[STATS_NUM_LATENCY_BUCKETS];
+} StatsCounterValue;
+
+
+// the counters are process wide and are disabled by default
+// enable them before any work starts; the counters can be updated from multiple threads
+
+extern bool STATS_ENABLED;
+
+void stats_enable(bool enable);
+void stats_reset();
+
+const char* stats_counter_name(StatsCounter counter);
+void stats_get_counter(StatsCounter counter, StatsCounterValue *value);
+
+int64_t stats_get_time_nsec();
+void stats_add(StatsCounter counter, int64_t nsec, int64_t bytes);
+
+
+
+class StatsTimer
+{
+public:
+    StatsTimer(StatsCounter counter, bool enable = true)
+    {
+        mCounter = counter;
+        mBytes = 0;
+        mStart = ((STATS_ENABLED && enable) ? stats_get_time_nsec() : -1);
+    }
+    ~StatsTimer()
+    {
+        if (mStart >= 0)
+            stats_add(mCounter, stats_get_time_nsec() - mStart, mBytes);
+    }
+
+    void AddBytes(int64_t bytes) { mBytes += bytes; }
+
+private:
+    StatsCounter mCounter;
+    int64_t mStart;
+    int64_t mBytes;
+};
+
+
+};
+
+
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_THREAD_H_
+#define BMX_THREAD_H_
+
+
+#include <string>
+
+
+
+namespace bmx
+{
+
+
+// a mutex that must not be locked recursively by the same thread
+
+class Mutex
+{
+public:
+    friend class Condition;
+
+public:
+    Mutex();
+    ~Mutex();
+
+    void Lock();
+    void Unlock();
+
+private:
+    struct Data;
+    Data *mData;
+};
+
+
+// locks the mutex for the lifetime of the locker. The mutex may be null
+
+class MutexLocker
+{
+public:
+    MutexLocker(Mutex *mutex);
+    ~MutexLocker();
+
+private:
+    Mutex *mMutex;
+};
+
+
+class Condition
+{
+public:
+    Condition();
+    ~Condition();
+
+    void Wait(Mutex *mutex);
+    void Signal();
+    void Broadcast();
+
+private:
+    struct Data;
+    Data *mData;
+};
+
+
+class Thread
+{
+public:
+    Thread();
+    virtual ~Thread();
+
+    void Start();
+    void Join();
+
+    bool IsRunning() const { return mRunning; }
+
+    bool HaveError() const                      { return mHaveError; }
+    const std::string& GetErrorMessage() const  { return mErrorMessage; }
+
+protected:
+    // implemented by the sub-class. An exception thrown by Run() is logged and recorded
+    virtual void Run() = 0;
+
+private:
+    void RunThread();
+
+private:
+    struct Data;
+    Data *mData;
+    bool mRunning;
+    bool mHaveError;
+    std::string mErrorMessage;
+};
+
+
+};
+
+
+
+#endif
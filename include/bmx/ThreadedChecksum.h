@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_THREADED_CHECKSUM_H_
+#define BMX_THREADED_CHECKSUM_H_
+
+#include <bmx/Checksum.h>
+#include <bmx/ChunkQueueWorker.h>
+
+
+
+namespace bmx
+{
+
+
+// Calculates a checksum in a worker thread so that the calculation overlaps with the caller's I/O.
+// Update() copies the data into chunks that are queued for the worker. The number of chunks is
+// bounded and Update() blocks if the worker falls behind. The worker is only started once the
+// first chunk is full
+
+class ThreadedChecksum : private ChunkQueueWorker
+{
+public:
+    ThreadedChecksum(ChecksumType type);
+    ~ThreadedChecksum();
+
+    void Update(const unsigned char *data, uint32_t size);
+    void Final();
+
+    ChecksumType GetType() const { return mChecksum.GetType(); }
+
+    size_t GetDigestSize() const;
+    void GetDigest(unsigned char *digest, size_t size) const;
+    std::string GetDigestString() const;
+
+private:
+    virtual bool ProcessChunk(const unsigned char *data, uint32_t size);
+
+private:
+    Checksum mChecksum;
+    bool mFinal;
+};
+
+
+};
+
+
+
+#endif
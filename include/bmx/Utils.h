@@ -97,6 +97,7 @@ bool check_file_exists(std::string filename);
 bool check_is_dir(std::string name);
 bool check_is_abs_path(std::string name);
 bool check_ends_with_dir_separator(std::string name);
+bool get_file_status(std::string filename, int64_t *size, int64_t *modified_time); // modified_time in nanoseconds
 
 std::string trim_string(std::string value);
 std::vector<std::string> split_string(std::string value, char separator, bool allow_empty);
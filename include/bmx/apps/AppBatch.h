@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_APP_BATCH_H_
+#define BMX_APP_BATCH_H_
+
+#include <string>
+#include <vector>
+
+#include <bmx/apps/AppInfoWriter.h>
+#include <bmx/Thread.h>
+
+
+
+namespace bmx
+{
+
+
+typedef int (*AppMainFunc)(int argc, const char **argv);
+
+
+class AppBatch
+{
+public:
+    AppBatch(const std::string &app_name, AppMainFunc main_func);
+    ~AppBatch();
+
+    bool ReadJobFile(const std::string &filename);
+
+    void Run(uint32_t num_threads);
+
+    size_t GetNumJobs() const       { return mJobs.size(); }
+    size_t GetNumFailedJobs() const;
+
+    void WriteSummary(AppInfoWriter *info_writer);
+
+public:
+    void RunJobs();
+
+private:
+    typedef struct
+    {
+        size_t line_number;
+        std::vector<std::string> args;
+        int exit_code;
+        uint32_t duration_msec;
+        bool done;
+    } Job;
+
+private:
+    std::string mAppName;
+    AppMainFunc mMainFunc;
+    std::string mJobFilename;
+    std::vector<Job> mJobs;
+    uint32_t mNumThreads;
+    uint32_t mDurationMsec;
+
+    Mutex mJobMutex;
+    size_t mNextJob;
+};
+
+
+// runs '<app> --batch <job file> [<batch options>]' and returns the app exit code
+
+int run_app_batch(const char *app_name, AppMainFunc main_func, int argc, const char **argv);
+
+
+};
+
+
+
+#endif
@@ -66,7 +66,7 @@ public:
     void SetInputFlags(int flags);
     void SetRWInterleave(uint32_t rw_interleave_size);
     void SetHTTPMinReadSize(uint32_t size);
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
     void SetUseMMapFile(bool enable);
 #endif
 
@@ -105,7 +105,7 @@ private:
     std::vector<InputChecksumFile> mInputChecksumFiles;
     MXFRWInterleaver *mRWInterleaver;
     uint32_t mHTTPMinReadSize;
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
     bool mUseMMapFile;
 #endif
 };
@@ -129,6 +129,8 @@ bool parse_vc2_mode(const char *mode_str, int *vc2_mode_flags);
 
 std::string create_mxf_track_filename(const char *prefix, uint32_t track_number, MXFDataDefEnum data_def);
 
+bool is_inter_frame_essence_type(EssenceType essence_type);
+
 bool have_avci_header_data(EssenceType essence_type, Rational sample_rate,
                            std::vector<AVCIHeaderInput> &avci_header_inputs);
 bool read_avci_header_data(EssenceType essence_type, Rational sample_rate,
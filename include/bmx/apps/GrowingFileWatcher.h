@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_GROWING_FILE_WATCHER_H_
+#define BMX_GROWING_FILE_WATCHER_H_
+
+#include <string>
+#include <vector>
+
+#include <bmx/BMXTypes.h>
+
+
+
+namespace bmx
+{
+
+
+// waits for input files that are being written by another process to grow
+// the size of each file is compared with the size at the previous wake-up (the watermark). inotify is used
+// where available to wake up as soon as data is written or the writer closes the file, otherwise the sizes
+// are polled at a short interval
+
+class GrowingFileWatcher
+{
+public:
+    GrowingFileWatcher();
+    ~GrowingFileWatcher();
+
+    // returns false if the file is not a local file that can be watched, e.g. stdin or a URL
+    bool AddFile(const std::string &filename);
+
+    bool HaveFiles() const { return !mFiles.empty(); }
+
+    // returns true if a file has grown beyond its watermark, or false if the timeout was reached.
+    // Once all the files were closed by the writer the sizes are polled for the rest of the timeout, in case
+    // a file is re-opened or replaced
+    bool Wait(uint32_t timeout_msec);
+
+private:
+    bool CheckGrowth();
+    void WaitForEvents(uint32_t timeout_msec);
+
+private:
+    struct WatchedFile
+    {
+        std::string filename;
+        int watch_desc;
+        int64_t size;
+        bool closed;
+    };
+
+    int mNotifyFd;
+    std::vector<WatchedFile> mFiles;
+};
+
+
+};
+
+
+
+#endif
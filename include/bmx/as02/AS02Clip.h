@@ -61,12 +61,14 @@ public:
     void SetCreationDate(mxfTimestamp creation_date);                   // default generated ('now')
     void SetGenerationUID(mxfUUID generation_uid);                      // default generated
     void ReserveHeaderMetadataSpace(uint32_t min_bytes);                // default 8192
+    void SetParallelTrackWrite(bool enable);                            // default false; each file written by a thread
 
 public:
     AS02Track* CreateTrack(EssenceType essence_type);
 
     virtual void PrepareWrite();
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
     virtual void CompleteWrite();
 
     virtual UniqueIdHelper* GetTrackIdHelper() = 0;
@@ -94,6 +96,7 @@ protected:
     std::string mVersionString;
     mxfUUID mProductUID;
     uint32_t mReserveMinBytes;
+    bool mParallelTrackWrite;
     mxfTimestamp mCreationDate;
     mxfUUID mGenerationUID;
 
@@ -139,6 +139,7 @@ public:
 
     void SetDefaultMICType(MICType type);
     void SetDefaultMICScope(MICScope scope);
+    void SetParallelMICCalc(bool enable);       // default false; entire file checksums calculated in parallel
 
     void SetBundleName(std::string name);
     void SetBundleId(std::string uuid_str);
@@ -157,6 +158,9 @@ public:
 public:
     void Write(AS02Bundle *bundle, std::string filename);
 
+private:
+    void CompleteInfoParallel(AS02Bundle *bundle, std::vector<AS02ManifestFile> *files);
+
 private:
     std::string mBundleName;
     std::string mBundleId;
@@ -165,6 +169,7 @@ private:
     std::vector<std::string> mAnnotations;
     MICType mDefaultMICType;
     MICScope mDefaultMICScope;
+    bool mParallelMICCalc;
     std::map<std::string, AS02ManifestFile> mFiles;
 };
 
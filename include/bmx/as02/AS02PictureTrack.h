@@ -55,9 +55,9 @@ public:
 
 public:
     virtual void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
-    virtual void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
 
 protected:
+    void WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size);
     void HandlePartitionInterval(bool can_start_partition);
 
 protected:
@@ -35,7 +35,9 @@
 
 #include <bmx/as02/AS02Bundle.h>
 #include <bmx/mxf_helper/MXFDescriptorHelper.h>
-#include <bmx/Checksum.h>
+#include <bmx/frame/DataBufferArray.h>
+#include <bmx/ByteArray.h>
+#include <bmx/ThreadedChecksum.h>
 
 
 
@@ -72,6 +74,7 @@ public:
 public:
     virtual void PrepareWrite();
     virtual void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples) = 0;
+    virtual void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
     void UpdatePackageMetadata(mxfpp::GenericPackage *package);
@@ -167,7 +170,9 @@ private:
     uint32_t mLowerLevelTrackId;
     std::string mLowerLevelURI;
 
-    Checksum mEssenceOnlyChecksum;
+    ThreadedChecksum mEssenceOnlyChecksum;
+
+    ByteArray mSampleArrayBuffer;
 };
 
 
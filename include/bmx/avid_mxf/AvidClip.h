@@ -76,6 +76,7 @@ public:
     void SetMaterialPackageCreationDate(mxfTimestamp creation_date);    // default file creation date
     void SetMaterialPackageUID(mxfUMID package_uid);                    // default generated
     void SetGrowingDuration(int64_t duration);                          // default -1; requires growing file flavour
+    void SetParallelTrackWrite(bool enable);                            // default false; each file written by a thread
 
 public:
     void SetUserComment(std::string name, std::string value);
@@ -102,6 +103,7 @@ public:
 public:
     void PrepareWrite();
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
     int64_t GetDuration() const;
@@ -149,6 +151,7 @@ private:
     std::vector<AvidLocator> mLocators;
     bool mMaxLocatorsExceeded;
     int64_t mGrowingDuration;
+    bool mParallelTrackWrite;
 
     mxfTimestamp mCreationDate;
     mxfUUID mGenerationUID;
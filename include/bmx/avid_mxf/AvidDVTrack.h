@@ -49,6 +49,9 @@ public:
 
     void SetComponentDepth(uint32_t depth);  // default 8; alternative is 10 for DV 100 only
 
+public:
+    virtual void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
+
 private:
     DVMXFDescriptorHelper *mDVDescriptorHelper;
 };
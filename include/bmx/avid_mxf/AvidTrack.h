@@ -38,6 +38,8 @@
 #include <libMXF++/extensions/TaggedValue.h>
 
 #include <bmx/mxf_helper/MXFDescriptorHelper.h>
+#include <bmx/frame/DataBufferArray.h>
+#include <bmx/ByteArray.h>
 
 
 
@@ -70,6 +72,7 @@ public:
 public:
     virtual void PrepareWrite();
     virtual void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    virtual void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
     virtual uint32_t GetSampleSize();
@@ -120,6 +123,8 @@ protected:
 
     void WriteCBEIndexTable(mxfpp::Partition *partition, uint32_t edit_unit_size, mxfpp::IndexTableSegment *&mIndexSegment);
 
+    void WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size);
+
 protected:
     AvidClip *mClip;
     uint32_t mTrackIndex;
@@ -164,6 +169,9 @@ private:
     void CreateFile();
 
     mxfpp::TimecodeComponent* GetTimecodeComponent(mxfpp::GenericPackage *package);
+
+private:
+    ByteArray mSampleArrayBuffer;
 };
 
 
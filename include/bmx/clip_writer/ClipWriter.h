@@ -84,6 +84,7 @@ public:
     void PrepareHeaderMetadata();
     void PrepareWrite();
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
 public:
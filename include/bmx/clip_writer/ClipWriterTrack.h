@@ -125,6 +125,7 @@ public:
 
 public:
     void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
 
 public:
     bool IsPicture() const;
@@ -90,6 +90,7 @@ public:
     void PrepareWrite();
     void WriteUserTimecode(Timecode user_timecode);
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
 public:
@@ -121,6 +122,8 @@ private:
     void UpdatePackageMetadata();
     void UpdateTrackMetadata(mxfpp::GenericPackage *package, int64_t duration);
 
+    void WriteContentPackages();
+
 private:
     int mFlavour;
     mxfpp::File *mMXFFile;
@@ -66,6 +66,7 @@ public:
 
 public:
     virtual void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
 
 public:
     uint32_t GetTrackIndex() const { return mTrackIndex; }
@@ -87,6 +88,7 @@ protected:
     virtual void PrepareWrite() = 0;
     virtual void WriteSamplesInt(const unsigned char *data, uint32_t size, uint32_t num_samples);
     virtual void WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size);
+    virtual void WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size);
 
 protected:
     D10File *mD10File;
@@ -99,6 +101,9 @@ protected:
 
     EssenceType mEssenceType;
     MXFDescriptorHelper *mDescriptorHelper;
+
+private:
+    ByteArray mSampleArrayBuffer;
 };
 
 
@@ -54,6 +54,10 @@ public:
     virtual uint32_t ParseFrameSize(const unsigned char *data, uint32_t data_size) = 0;
 
     virtual void ParseFrameInfo(const unsigned char *data, uint32_t data_size) = 0;
+
+    // returns a new parser that can locate frame boundaries independently of this parser, e.g. in another
+    // thread, or null if the parser doesn't support it. The default is null
+    virtual EssenceParser* Clone() const { return 0; }
 };
 
 
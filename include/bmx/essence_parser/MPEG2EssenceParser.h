@@ -53,6 +53,8 @@ public:
     virtual void ParseFrameInfo(const unsigned char *data, uint32_t data_size);
     virtual void ParseFrameAllInfo(const unsigned char *data, uint32_t data_size);
 
+    virtual EssenceParser* Clone() const;
+
 public:
     // bitstream properties
     bool HaveSequenceHeader() const             { return mHaveSequenceHeader; }
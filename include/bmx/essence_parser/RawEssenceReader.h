@@ -33,6 +33,8 @@
 #define BMX_RAW_ESSENCE_READER_H_
 
 
+#include <deque>
+
 #include <bmx/essence_parser/EssenceParser.h>
 #include <bmx/essence_parser/EssenceSource.h>
 #include <bmx/ByteArray.h>
@@ -56,6 +58,10 @@ public:
     virtual void SetEssenceParser(EssenceParser *essence_parser);
     void SetCheckMaxSampleSize(uint32_t size);
 
+    // locate sample boundaries in large blocks of data using <num_threads> threads
+    // this only applies if the essence parser supports EssenceParser::Clone
+    void SetParseThreads(uint32_t num_threads);
+
     uint32_t GetFixedSampleSize() const     { return mFixedSampleSize; }
     EssenceParser* GetEssenceParser() const { return mEssenceParser; }
     EssenceSource* GetEssenceSource() const { return mEssenceSource; }
@@ -63,7 +69,7 @@ public:
 public:
     virtual uint32_t ReadSamples(uint32_t num_samples);
 
-    virtual unsigned char* GetSampleData() const        { return mSampleBuffer.GetBytes(); }
+    virtual unsigned char* GetSampleData() const        { return mSampleBuffer.GetBytes() + mSampleDataOffset; }
     uint32_t GetSampleDataSize() const                  { return mSampleDataSize; }
     uint32_t GetNumSamples() const                      { return mNumSamples; }
     uint32_t GetSampleSize() const;
@@ -72,6 +78,8 @@ public:
 
 protected:
     bool ReadAndParseSample();
+    bool ReadParsedSample();
+    bool ParseSampleBlock();
     uint32_t ReadBytes(uint32_t size);
     void ShiftSampleData(uint32_t to_offset, uint32_t from_offset);
 
@@ -86,10 +94,14 @@ protected:
     EssenceParser *mEssenceParser;
 
     ByteArray mSampleBuffer;
+    uint32_t mSampleDataOffset;
     uint32_t mSampleDataSize;
     uint32_t mNumSamples;
     bool mReadFirstSample;
     bool mLastSampleRead;
+
+    uint32_t mParseThreads;
+    std::deque<uint32_t> mParsedSampleSizes;
 };
 
 
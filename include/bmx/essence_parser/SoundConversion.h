@@ -56,6 +56,18 @@ void deinterleave_audio(const unsigned char *input_data, uint32_t input_data_siz
                         uint32_t bits_per_sample, uint16_t channel_count, uint16_t channel_num,
                         unsigned char *output_data, uint32_t output_data_size);
 
+// convert / deinterleave all channels in a single pass through the input data
+// pcm_data / output_data has a buffer of pcm_data_size / output_data_size for each channel
+// A null buffer pointer results in the channel being skipped
+
+uint32_t convert_aes3_to_pcm_channels(const unsigned char *aes3_data, uint32_t aes3_data_size, bool ignore_valid_flags,
+                                      uint32_t bits_per_sample, uint8_t channel_count,
+                                      unsigned char * const *pcm_data, uint32_t pcm_data_size);
+
+void deinterleave_audio_channels(const unsigned char *input_data, uint32_t input_data_size,
+                                 uint32_t bits_per_sample, uint16_t channel_count,
+                                 unsigned char * const *output_data, uint32_t output_data_size);
+
 void interleave_audio(const unsigned char *input_data, uint32_t input_data_size,
                       uint32_t bits_per_sample, uint16_t channel_count, uint16_t channel_num,
                       unsigned char *output_data, uint32_t output_data_size);
@@ -185,7 +185,6 @@ private:
     ParseInfo mCurrentParseInfo;
     std::vector<ParseInfo> mParseInfos;
     int mPictureCount;
-    uint32_t mSearchState;
     uint32_t mSearchCount;
     std::map<uint8_t, bool> mSecondaryParseInfoLocs;
 
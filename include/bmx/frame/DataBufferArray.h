@@ -46,10 +46,16 @@ typedef struct
     uint32_t size;
 } CDataBuffer;
 
+class ByteArray;
+
 
 uint32_t dba_get_total_size(const CDataBuffer *data_array, uint32_t array_size);
 void dba_copy_data(unsigned char *dest, uint32_t dest_size, const CDataBuffer *data_array, uint32_t array_size);
 
+// returns the sample data in a single buffer, copying the pieces into gather_buffer if there are more than 1
+const unsigned char* dba_gather_data(ByteArray *gather_buffer, const CDataBuffer *data_array, uint32_t array_size,
+                                     uint32_t *size);
+
 
 };
 
@@ -82,6 +82,9 @@ public:
 
     virtual Frame* Clone() = 0;
 
+    // frames must be released rather than deleted because they may be owned by a pool
+    virtual void Release();
+
 public:
     bool IsEmpty() const    { return num_samples == 0; }
     bool IsComplete() const { return num_samples == request_num_samples; }
@@ -114,6 +117,9 @@ public:
 
     mxfKey element_key;
 
+protected:
+    void Reset();
+
 protected:
     std::map<std::string, std::vector<FrameMetadata*> > mMetadata;
 };
@@ -159,6 +165,52 @@ public:
 };
 
 
+class FramePool;
+
+class PooledFrame : public Frame
+{
+public:
+    friend class FramePool;
+
+public:
+    virtual ~PooledFrame();
+
+    virtual uint32_t GetSize() const;
+    virtual const unsigned char* GetBytes() const;
+
+    virtual void Grow(uint32_t min_size);
+    virtual uint32_t GetSizeAvailable() const;
+    virtual unsigned char* GetBytesAvailable() const;
+    virtual void SetSize(uint32_t size);
+    virtual void IncrementSize(uint32_t inc);
+
+    virtual Frame* Clone();
+
+    virtual void Release();
+
+private:
+    PooledFrame(FramePool *pool);
+    PooledFrame(const PooledFrame &from);
+
+private:
+    FramePool *mPool;
+    ByteArray mData;
+};
+
+
+class PooledFrameFactory : public FrameFactory
+{
+public:
+    PooledFrameFactory(uint32_t max_free_frames = 32);
+    virtual ~PooledFrameFactory();
+
+    virtual Frame* CreateFrame();
+
+private:
+    FramePool *mPool;
+};
+
+
 };
 
 
@@ -90,6 +90,8 @@ public:
     void SetClipWrapped(bool enable);                                   // default false (frame wrapped)
     void SetAddSystemItem(bool enable);                                 // default false, no system item
     void SetRepeatIndexTable(bool enable);                              // default false. Repeat index table in Footer if true
+    void SetLiveUpdateInterval(int64_t frame_count);                    // default 0 (disabled). Max frames between
+                                                                        // index partitions and header duration updates
 
 public:
     void SetOutputStartOffset(int64_t offset);
@@ -103,6 +105,7 @@ public:
     void PrepareWrite();
     void WriteUserTimecode(Timecode user_timecode);
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
 public:
@@ -140,6 +143,7 @@ private:
 
     void UpdatePackageMetadata();
     void UpdateTrackMetadata(mxfpp::GenericPackage *package, int64_t origin, int64_t duration);
+    void UpdateLiveHeaderMetadata();
 
     void WriteContentPackages(bool end_of_samples);
 
@@ -197,6 +201,10 @@ private:
     int64_t mPartitionInterval;
     int64_t mPartitionFrameCount;
 
+    int64_t mLiveUpdateInterval;
+    bool mLiveUpdateHeader;
+    std::vector<mxfpp::Sequence*> mLiveUpdateSequences;
+
     uint32_t mKAGSize;
     uint32_t mEssencePartitionKAGSize;
 
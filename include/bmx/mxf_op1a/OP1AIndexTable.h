@@ -33,9 +33,9 @@
 #define BMX_OP1A_INDEX_TABLE_H_
 
 #include <vector>
-#include <set>
+#include <map>
 
-#include <bmx/ByteArray.h>
+#include <bmx/BMXTypes.h>
 
 
 
@@ -98,6 +98,7 @@ public:
 
     bool RequireUpdatesAtEnd(int64_t end_offset) const;
     bool RequireUpdatesAtPos(int64_t position) const;
+    void ClearRequiredUpdate(int64_t position);
     void IgnoreRequiredUpdates();
 
 public:
@@ -110,11 +111,34 @@ public:
 
     uint32_t element_size;
 
-    std::set<int64_t> require_updates;
     int64_t last_add_index_entry_pos;
 
 private:
-    std::map<int64_t, OP1AIndexEntry> mIndexEntryCache;
+    // ring buffer of index entries waiting for the content package, indexed by position
+    std::vector<OP1AIndexEntry> mIndexEntryCache;
+    std::vector<int64_t> mIndexEntryCachePositions;
+    size_t mIndexEntryCacheCount;
+
+    // ascending positions of cached or written index entries that are waiting for an update
+    std::vector<int64_t> mRequireUpdates;
+};
+
+
+class OP1AIndexEntryArena
+{
+public:
+    OP1AIndexEntryArena();
+    ~OP1AIndexEntryArena();
+
+    void SetChunkSize(uint32_t size);
+    uint32_t GetChunkSize() const { return mChunkSize; }
+
+    unsigned char* AllocateChunk();
+    void FreeChunk(unsigned char *chunk);
+
+private:
+    uint32_t mChunkSize;
+    std::vector<unsigned char*> mFreeChunks;
 };
 
 
@@ -124,11 +148,12 @@ public:
     OP1AIndexTableSegment(uint32_t index_sid, uint32_t body_sid, mxfRational edit_rate, int64_t start_position,
                           uint32_t index_entry_size, uint32_t slice_count, bool force_write_slice_count,
                           mxfOptBool single_index_location, mxfOptBool single_essence_location,
-                          mxfOptBool forward_index_direction);
+                          mxfOptBool forward_index_direction, OP1AIndexEntryArena *arena);
     ~OP1AIndexTableSegment();
 
     bool RequireNewSegment(uint8_t flags);
-    void AddIndexEntry(const OP1AIndexEntry *entry, int64_t stream_offset, std::vector<uint32_t> slice_cp_offsets);
+    void AddIndexEntry(const OP1AIndexEntry *entry, int64_t stream_offset,
+                       const std::vector<uint32_t> &slice_cp_offsets);
     void UpdateIndexEntry(int64_t segment_position, int8_t temporal_offset);
     void UpdateIndexEntry(int64_t segment_position, int8_t temporal_offset, int8_t key_frame_offset, uint8_t flags);
 
@@ -137,11 +162,17 @@ public:
     uint32_t GetDuration() const;
 
     mxfpp::IndexTableSegment* GetSegment() { return &mSegment; }
-    ByteArray* GetEntries() { return &mEntries; }
+    void WriteEntries(mxfpp::File *mxf_file);
+
+private:
+    unsigned char* GetEntryBytes(int64_t segment_position);
 
 private:
     mxfpp::IndexTableSegment mSegment;
-    ByteArray mEntries;
+    OP1AIndexEntryArena *mArena;
+    std::vector<unsigned char*> mEntryChunks;
+    uint32_t mChunkNumEntries;
+    uint32_t mNumEntries;
     uint32_t mIndexEntrySize;
 };
 
@@ -188,7 +219,7 @@ public:
 
     bool CanStartPartition();
 
-    void UpdateIndex(uint32_t size, std::vector<uint32_t> element_sizes);
+    void UpdateIndex(uint32_t size, const std::vector<uint32_t> &element_sizes);
     void UpdateIndex(uint32_t size, uint32_t num_samples);
 
 public:
@@ -204,11 +235,11 @@ public:
     void IgnoreRequiredUpdates(uint32_t track_index);
 
 private:
-    void CreateDeltaEntries(std::vector<uint32_t> &element_sizes);
-    void CheckDeltaEntries(std::vector<uint32_t> &element_sizes);
+    void CreateDeltaEntries(const std::vector<uint32_t> &element_sizes);
+    void CheckDeltaEntries(const std::vector<uint32_t> &element_sizes);
 
-    void UpdateCBEIndex(uint32_t size, std::vector<uint32_t> &element_sizes);
-    void UpdateVBEIndex(std::vector<uint32_t> &element_sizes);
+    void UpdateCBEIndex(uint32_t size, const std::vector<uint32_t> &element_sizes);
+    void UpdateVBEIndex(const std::vector<uint32_t> &element_sizes);
 
     void WriteCBESegments(mxfpp::File *mxf_file, mxfpp::Partition *partition, bool final_write);
     void WriteVBESegments(mxfpp::File *mxf_file, mxfpp::Partition *partition, std::vector<OP1AIndexTableSegment*> &segments);
@@ -232,7 +263,9 @@ private:
     uint32_t mIndexEntrySize;
 
     std::vector<OP1ADeltaEntry> mDeltaEntries;
+    std::vector<uint32_t> mSliceCPOffsets;
 
+    OP1AIndexEntryArena mEntryArena;
     OP1AIndexTableSegment *mAVCIFirstIndexSegment;
     std::vector<OP1AIndexTableSegment*> mIndexSegments;
     int64_t mDuration;
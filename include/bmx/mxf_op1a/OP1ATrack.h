@@ -69,6 +69,7 @@ public:
 
 public:
     void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
 
 public:
     uint32_t GetTrackIndex() const { return mTrackIndex; }
@@ -94,6 +95,7 @@ protected:
     virtual void PrepareWrite(uint8_t track_count) = 0;
     virtual void WriteSamplesInt(const unsigned char *data, uint32_t size, uint32_t num_samples);
     virtual void WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size);
+    virtual void WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size);
     virtual void CompleteWrite() {}
 
     void CompleteEssenceKeyAndTrackNum(uint8_t track_count);
@@ -120,6 +122,7 @@ protected:
     MXFDescriptorHelper *mDescriptorHelper;
 
 private:
+    ByteArray mSampleArrayBuffer;
     bool mHaveLowerLevelSourcePackage;
     mxfpp::SourcePackage *mLowerLevelSourcePackage;
     mxfUMID mLowerLevelSourcePackageUID;
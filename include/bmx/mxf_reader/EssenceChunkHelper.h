@@ -43,6 +43,7 @@ namespace bmx
 
 
 class MXFFileReader;
+class MXFIndexCache;
 
 
 class EssenceChunk
@@ -68,9 +69,14 @@ public:
 
     void CreateEssenceChunkIndex(int64_t first_edit_unit_size);
 
+    void WriteIndexCache(MXFIndexCache *cache);
+    void ReadIndexCache(MXFIndexCache *cache);
+
     void AppendChunk(size_t partition_id, int64_t file_position, const mxfKey *element_key, uint8_t element_llen,
                      uint64_t element_len);
     void UpdateLastChunk(int64_t file_position, bool is_end);
+    void ExtendLastChunk(int64_t essence_offset);
+    void DiscardChunks(int64_t essence_offset);
     void SetIsComplete();
 
     size_t GetNumIndexedPartitions() const { return mNumIndexedPartitions; }
@@ -35,11 +35,14 @@
 
 #include <vector>
 #include <deque>
+#include <map>
+#include <string>
 
 #include <bmx/frame/Frame.h>
 #include <bmx/mxf_reader/FrameMetadataReader.h>
 #include <bmx/mxf_reader/EssenceChunkHelper.h>
 #include <bmx/mxf_reader/IndexTableHelper.h>
+#include <bmx/Thread.h>
 
 
 
@@ -48,6 +51,8 @@ namespace bmx
 
 
 class MXFFileReader;
+class MXFTrackReader;
+class MXFIndexCache;
 
 
 class EssenceReaderBuffer
@@ -62,6 +67,9 @@ public:
 
     Frame* GetFrame(uint32_t track_index);
     void PushFrames(uint32_t actual_read_num_samples);
+    void TakeFrames(uint32_t actual_read_num_samples, std::vector<Frame*> *frames);
+
+    void Reset();
 
     size_t GetBufferSize() const { return mRequestSampleCounts.size(); }
 
@@ -83,24 +91,33 @@ private:
     int64_t mStartPosition;
     size_t mCurrentFrame;
     bool mBufferFrames;
+    std::vector<Frame*> mPushFrames;
 };
 
 
 class EssenceReader
 {
 public:
-    EssenceReader(MXFFileReader *file_reader, bool file_is_complete);
+    // the index table and essence container layout are restored from 'index_cache' if it was loaded from
+    // file, or else written to 'index_cache' once they have been extracted from the complete file
+    EssenceReader(MXFFileReader *file_reader, bool file_is_complete, MXFIndexCache *index_cache = 0);
     ~EssenceReader();
 
     void SetReadLimits(int64_t start_position, int64_t duration);
     void SetBufferFrames(bool enable);
+    void SetContentPackageReadCount(uint32_t count);
+
+    // reads ahead up to 'depth' reads, limited to 'max_size' bytes, in a background thread.
+    // The frame factories used by the track frame buffers must be thread-safe
+    void SetPrefetch(uint32_t depth, uint64_t max_size);
+    void PausePrefetch(bool pause);
 
     uint32_t Read(uint32_t num_samples);
     void Seek(int64_t position);
 
     mxfRational GetEditRate() const    { return mIndexTableHelper.GetEditRate(); };
     int64_t GetPosition() const        { return mPosition; }
-    int64_t GetIndexedDuration() const { return mIndexTableHelper.GetDuration(); }
+    int64_t GetIndexedDuration() const;
 
     bool GetIndexEntry(MXFIndexEntryExt *entry, int64_t position);
 
@@ -108,9 +125,76 @@ public:
 
     bool IsComplete() const;
 
+    // true if the file is not seekable and the frame wrapped essence is read in a single forward pass, keeping
+    // only the index information from the current read position onwards
+    bool IsStreaming() const { return mStreaming; }
+
+    // picks up the partitions and index table segments written to a growing file since the last call by
+    // following the partition pack links back from the end of the file. Returns true if partitions were added
+    bool DiscoverPartitions();
+
+    Mutex* GetFileMutex() { return &mReadMutex; }
+
+private:
+    typedef std::vector<std::pair<uint32_t, MXFTrackReader*> > ElementTrackReaders;
+
+    class PrefetchThread : public Thread
+    {
+    public:
+        PrefetchThread(EssenceReader *reader) : mReader(reader) {}
+
+    protected:
+        virtual void Run() { mReader->RunPrefetch(); }
+
+    private:
+        EssenceReader *mReader;
+    };
+
+    typedef struct
+    {
+        int64_t position;
+        uint32_t num_samples;
+        uint32_t num_read;
+        std::vector<Frame*> frames;
+        uint64_t size;
+        bool read_error;
+        std::string error_message;
+    } PrefetchRead;
+
+    typedef struct
+    {
+        int64_t position;
+        int64_t previous_position;
+        uint64_t header_byte_count;
+        uint64_t index_byte_count;
+        uint32_t index_sid;
+        uint32_t body_sid;
+    } DiscoveredPartition;
+
 private:
+    void InternalSetReadLimits(int64_t start_position, int64_t duration);
+    int64_t InternalLegitimisePosition(int64_t position) const;
+    bool InternalIsComplete() const;
+
+    uint32_t ReadSamples(int64_t position, uint32_t num_samples);
+    uint32_t ReadPrefetched(uint32_t num_samples);
+
+    void UpdatePrefetch();
+    void StartPrefetch();
+    void StopPrefetch();
+    void RestartPrefetch(int64_t position, uint32_t num_samples);
+    bool IsPrefetchPosition(int64_t position, uint32_t num_samples);
+    void ClearPrefetchQueue();
+    void DeletePrefetchRead(PrefetchRead *read);
+    void RunPrefetch();
+    bool PrefetchReadSamples(PrefetchRead *read);
+
     uint32_t ReadClipWrappedSamples(uint32_t num_samples);
     uint32_t ReadFrameWrappedSamples(uint32_t num_samples);
+    void ReadBufferedContentPackage(int64_t start_position, ElementTrackReaders *enabled_track_readers);
+    void FillContentPackageBuffer(int64_t cp_file_position, int64_t cp_size);
+    Frame* GetElementFrame(int64_t start_position, ElementTrackReaders *enabled_track_readers,
+                           const mxfKey *key, uint8_t llen, int64_t cp_file_position, int64_t element_offset);
 
     void GetEditUnit(int64_t position, mxfKey *element_key, int64_t *file_position, int64_t *size);
     void GetEditUnitGroup(int64_t position, uint32_t max_samples, mxfKey *element_key, int64_t *file_position,
@@ -131,11 +215,20 @@ private:
     bool ReadNonfirstEssenceKL(mxfKey *key, uint8_t *llen, uint64_t *len);
     bool SeekContentPackageStart();
 
-    void ReadNextPartition(const mxfKey *key, uint8_t llen, uint64_t len);
+    size_t ReadNextPartition(const mxfKey *key, uint8_t llen, uint64_t len);
+    size_t FindPartition(int64_t file_position);
+
+    bool InternalDiscoverPartitions();
+    bool FindLastPartition(int64_t min_position, int64_t file_size, DiscoveredPartition *partition);
+    bool ReadDiscoveredPartition(int64_t position, int64_t file_size, DiscoveredPartition *partition);
+    bool AddDiscoveredPartition(const DiscoveredPartition &partition, int64_t file_size,
+                                std::vector<size_t> *index_partition_ids);
 
     void SetHaveFooter();
     void SetFileIsComplete();
 
+    void DiscardIndex(int64_t position);
+
     void SetNextKL(const mxfKey *key, uint8_t llen, uint64_t len);
     void ResetNextKL();
     void ResetState();
@@ -144,6 +237,7 @@ private:
     MXFFileReader *mFileReader;
     mxfpp::File *mFile;
     bool mFileIsComplete;
+    bool mStreaming;
 
     EssenceChunkHelper mEssenceChunkHelper;
     IndexTableHelper mIndexTableHelper;
@@ -153,10 +247,12 @@ private:
     int64_t mReadStartPosition;
     int64_t mReadDuration;
     int64_t mPosition;
+    int64_t mReadPosition;
     uint32_t mImageStartOffset;
     uint32_t mImageEndOffset;
 
     EssenceReaderBuffer mReadFrameBuffer;
+    ElementTrackReaders mElementTrackReaders;
 
     int64_t mBasePosition;
     int64_t mFilePosition;
@@ -169,6 +265,28 @@ private:
     int64_t mLastKnownBasePosition;
     bool mHaveFooter;
     bool mBaseReadError;
+    int64_t mDiscoverFileSize;
+
+    uint32_t mCPReadCount;
+    ByteArray mCPBuffer;
+    int64_t mCPBufferFilePosition;
+    mxfpp::File *mCPBufferFile;
+
+    bool mBufferFrames;
+    mutable Mutex mReadMutex;           // guards the reader state and file when prefetching
+    uint32_t mPrefetchDepth;
+    uint64_t mPrefetchMaxSize;
+    bool mPrefetchPaused;
+    PrefetchThread *mPrefetchThread;
+    Mutex mPrefetchMutex;               // guards the prefetch queue and the members below
+    Condition mPrefetchCondition;
+    std::deque<PrefetchRead*> mPrefetchQueue;
+    uint64_t mPrefetchQueueSize;
+    int64_t mPrefetchPosition;
+    uint32_t mPrefetchNumSamples;
+    uint32_t mPrefetchGeneration;
+    bool mPrefetchIdle;
+    bool mPrefetchStop;
 };
 
 
@@ -54,6 +54,7 @@ class FrameMetadataChildReader
 public:
     virtual ~FrameMetadataChildReader() {}
 
+    virtual void SetFile(mxfpp::File *file) = 0;
     virtual void Reset() = 0;
     virtual bool ProcessFrameMetadata(const mxfKey *key, uint64_t len) = 0;
     virtual void InsertFrameMetadata(Frame *frame, uint32_t track_number) = 0;
@@ -66,6 +67,7 @@ public:
     SystemScheme1Reader(mxfpp::File *file, Rational frame_rate, bool is_bbc_preservation_file);
     virtual ~SystemScheme1Reader();
 
+    virtual void SetFile(mxfpp::File *file) { mFile = file; }
     virtual void Reset();
     virtual bool ProcessFrameMetadata(const mxfKey *key, uint64_t len);
     virtual void InsertFrameMetadata(Frame *frame, uint32_t track_number);
@@ -88,6 +90,7 @@ public:
     SDTICPSystemMetadataReader(mxfpp::File *file);
     virtual ~SDTICPSystemMetadataReader();
 
+    virtual void SetFile(mxfpp::File *file) { mFile = file; }
     virtual void Reset();
     virtual bool ProcessFrameMetadata(const mxfKey *key, uint64_t len);
     virtual void InsertFrameMetadata(Frame *frame, uint32_t track_number);
@@ -104,6 +107,7 @@ public:
     SDTICPPackageMetadataReader(mxfpp::File *file);
     virtual ~SDTICPPackageMetadataReader();
 
+    virtual void SetFile(mxfpp::File *file) { mFile = file; }
     virtual void Reset();
     virtual bool ProcessFrameMetadata(const mxfKey *key, uint64_t len);
     virtual void InsertFrameMetadata(Frame *frame, uint32_t track_number);
@@ -120,6 +124,7 @@ public:
     FrameMetadataReader(MXFFileReader *file_reader);
     ~FrameMetadataReader();
 
+    void SetFile(mxfpp::File *file);
     void Reset();
     bool ProcessFrameMetadata(const mxfKey *key, uint64_t len);
     void InsertFrameMetadata(Frame *frame, uint32_t track_number);
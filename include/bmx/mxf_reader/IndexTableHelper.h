@@ -46,6 +46,7 @@ namespace bmx
 
 
 class MXFFileReader;
+class MXFIndexCache;
 
 
 class IndexTableHelperSegment : public mxfpp::IndexTableSegment
@@ -84,8 +85,12 @@ public:
 
     void CopyIndexEntries(const IndexTableHelperSegment *segment, uint32_t duration);
 
+    void WriteIndexCache(MXFIndexCache *cache);
+    void ReadIndexCache(MXFIndexCache *cache);
+
 private:
     unsigned char *mIndexEntries;
+    int64_t *mStreamOffsets;
     uint32_t mAllocIndexEntries;
     uint32_t mNumIndexEntries;
     uint32_t mEntriesStart;
@@ -108,13 +113,18 @@ public:
 
     void ExtractIndexTable();
 
+    void WriteIndexCache(MXFIndexCache *cache);
+    void ReadIndexCache(MXFIndexCache *cache);
+
     void SetEssenceDataSize(int64_t size);
 
     void SetEditRate(Rational edit_rate);
     void SetConstantEditUnitSize(Rational edit_rate, uint32_t size);
 
     int64_t ReadIndexTableSegment(uint64_t len);
+    void AppendPartitionIndexSegments(const std::vector<size_t> &partition_ids);
     void UpdateIndex(int64_t position, int64_t essence_offset, int64_t size);
+    void DiscardSegments(int64_t position);
     void SetIsComplete();
 
 public:
@@ -142,8 +152,20 @@ private:
     void InsertCBEIndexSegment(std::auto_ptr<IndexTableHelperSegment> &new_segment_ap);
     void InsertVBEIndexSegment(std::auto_ptr<IndexTableHelperSegment> &new_segment_ap);
 
+    size_t FindSegment(int64_t position);
+
     IndexTableHelperSegment* CreateStartSegment(IndexTableHelperSegment *segment, uint32_t duration);
 
+    IndexTableHelperSegment* ReadSegment(mxfpp::File *file, uint64_t len);
+    int64_t InsertSegment(IndexTableHelperSegment *segment);
+    void InsertSegments(std::vector<IndexTableHelperSegment*> &segments);
+
+    void ReadPartitionIndexSegments(mxfpp::File *file, size_t partition_id,
+                                    std::vector<IndexTableHelperSegment*> *segments);
+    void ReadIndexPartitions(const std::vector<size_t> &partition_ids);
+    int64_t GetIndexReadEnd(size_t partition_id);
+    bool IsCompleteIndexTable(const std::vector<IndexTableHelperSegment*> &segments, uint64_t max_body_offset);
+
 private:
     MXFFileReader *mFileReader;
     mxfpp::File *mFile;
@@ -152,6 +174,8 @@ private:
 
     std::vector<IndexTableHelperSegment*> mSegments;
     size_t mLastEditUnitSegment;
+    std::vector<int64_t> mSegmentStarts;
+    bool mSegmentStartsValid;
 
     uint32_t mEditUnitSize;
 
@@ -159,6 +183,7 @@ private:
 
     Rational mEditRate;
     int64_t mDuration;
+    int64_t mDiscardedDuration;
 };
 
 
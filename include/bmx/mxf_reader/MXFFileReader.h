@@ -44,6 +44,7 @@
 #include <bmx/mxf_reader/MXFFileTrackReader.h>
 #include <bmx/mxf_reader/EssenceReader.h>
 #include <bmx/mxf_reader/MXFPackageResolver.h>
+#include <bmx/mxf_reader/MXFIndexCache.h>
 #include <bmx/mxf_helper/MXFFileFactory.h>
 #include <bmx/URI.h>
 
@@ -91,6 +92,9 @@ public:
     void SetFileFactory(MXFFileFactory *factory, bool take_ownership);
     virtual void SetEmptyFrames(bool enable);
     void SetST436ManifestFrameCount(uint32_t count);     // default: 2 frames used to extract manifest
+    void SetContentPackageReadCount(uint32_t count);     // default: 0, i.e. read content packages KL by KL
+    void SetPrefetch(uint32_t depth, uint64_t max_size); // default: depth 0, i.e. no prefetch thread
+    void SetIndexCache(bool enable, const std::string &cache_dir = ""); // default: disabled. Empty dir: next to file
     virtual void SetFileIndex(MXFFileIndex *file_index, bool take_ownership);
     virtual void SetMCALabelIndex(MXFMCALabelIndex *label_index, bool take_ownership);
 
@@ -134,6 +138,10 @@ public:
     bool IsClipWrapped()              { return mWrappingType == MXF_CLIP_WRAPPED; }
     bool IsFrameWrapped()             { return mWrappingType == MXF_FRAME_WRAPPED; }
 
+    // growing files: picks up the partitions and index table segments written since the last update and
+    // returns the number of edit units that are indexed, i.e. available for random access
+    int64_t UpdateIndexedDuration();
+
     size_t GetFileId() const        { return mFileId; }
     std::string GetFilename() const { return GetFileIndex()->GetFilename(mFileId); }
     URI GetRelativeURI() const      { return GetFileIndex()->GetRelativeURI(mFileId); }
@@ -211,6 +219,9 @@ private:
     void CheckRequireFrameInfo();
     void ExtractFrameInfo();
 
+    MXFIndexCache* ReadIndexCache(const std::string &cache_filename, int64_t file_size, int64_t modified_time);
+    void WritePartitionsIndexCache(MXFIndexCache *cache);
+
     void StartRead();
     void CompleteRead();
     void AbortRead();
@@ -257,6 +268,11 @@ private:
 
     uint32_t mRequireFrameInfoCount;
     uint32_t mST436ManifestCount;
+    uint32_t mCPReadCount;
+    uint32_t mPrefetchDepth;
+    uint64_t mPrefetchMaxSize;
+    bool mIndexCacheEnabled;
+    std::string mIndexCacheDir;
 
     std::set<mxfpp::SourcePackage*> mMCALabelIndexedPackages;
 };
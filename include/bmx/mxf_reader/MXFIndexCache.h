@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BMX_MXF_INDEX_CACHE_H_
+#define BMX_MXF_INDEX_CACHE_H_
+
+#include <string>
+
+#include <bmx/BMXTypes.h>
+#include <bmx/ByteArray.h>
+
+
+
+namespace bmx
+{
+
+
+/* Sidecar file holding the partition list, index table segments and essence container layout
+   extracted from a complete MXF file. The cache is keyed by the MXF file's size, modification
+   time and footer partition position and is discarded if any of these differ. */
+
+class MXFIndexCache
+{
+public:
+    static std::string GetCacheFilename(const std::string &mxf_filename, const std::string &cache_dir);
+
+public:
+    MXFIndexCache();
+    ~MXFIndexCache();
+
+    void SetFileInfo(int64_t file_size, int64_t modified_time, int64_t footer_position);
+
+    bool Read(const std::string &filename);
+    bool Write(const std::string &filename);
+
+    bool IsLoaded() const { return mIsLoaded; }
+    bool MatchesFile(int64_t file_size, int64_t modified_time) const;
+    int64_t GetFooterPosition() const { return mFooterPosition; }
+
+public:
+    void WriteUInt8(uint8_t value);
+    void WriteUInt16(uint16_t value);
+    void WriteUInt32(uint32_t value);
+    void WriteUInt64(uint64_t value);
+    void WriteInt64(int64_t value);
+    void WriteUL(const UL *value);
+    void WriteRational(Rational value);
+
+    uint8_t ReadUInt8();
+    uint16_t ReadUInt16();
+    uint32_t ReadUInt32();
+    uint64_t ReadUInt64();
+    int64_t ReadInt64();
+    void ReadUL(UL *value);
+    Rational ReadRational();
+
+private:
+    const unsigned char* ReadBytes(uint32_t size);
+
+private:
+    int64_t mFileSize;
+    int64_t mModifiedTime;
+    int64_t mFooterPosition;
+    bool mIsLoaded;
+    ByteArray mData;
+    uint32_t mReadPosition;
+};
+
+
+};
+
+
+
+#endif
@@ -39,6 +39,7 @@
 #include <libMXF++/MXF.h>
 
 #include <bmx/ByteArray.h>
+#include <bmx/frame/DataBufferArray.h>
 #include <bmx/rdd9_mxf/RDD9IndexTable.h>
 
 
@@ -107,6 +108,7 @@ public:
                                   RDD9ContentPackageElement *element, int64_t position);
 
     uint32_t WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
 
     RDD9ContentPackageElement::ElementType GetElementType() const { return mElement->GetElementType(); }
     bool IsComplete() const;
@@ -143,6 +145,7 @@ public:
 
     void WriteUserTimecode(Timecode user_timecode);
     uint32_t WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
 
     uint32_t GetSoundSampleCount() const;
 
@@ -189,6 +192,7 @@ public:
 public:
     void WriteUserTimecode(Timecode user_timecode);
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
 
 public:
     int64_t GetPosition() const             { return mPosition; }
@@ -54,6 +54,7 @@ public:
 protected:
     virtual void PrepareWrite(uint8_t track_count);
     virtual void WriteSamplesInt(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    virtual void WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size);
 
 protected:
     DataMXFDescriptorHelper *mDataDescriptorHelper;
@@ -37,6 +37,7 @@
 
 #include <bmx/BMXTypes.h>
 #include <bmx/ByteArray.h>
+#include <bmx/frame/DataBufferArray.h>
 
 
 
@@ -98,6 +99,7 @@ public:
     ~ST436Line();
 
     void Construct(ByteArray *data);
+    void ConstructHeader(unsigned char *header_data);
     void Parse(const unsigned char *data, uint64_t *size_inout);
 
 public:
@@ -119,6 +121,7 @@ public:
     ~ST436Element();
 
     void Construct(ByteArray *data);
+    void Construct(ByteArray *header_data, std::vector<CDataBuffer> *data_array); // payloads are not copied
     void Parse(const unsigned char *data, uint64_t size);
 
 public:
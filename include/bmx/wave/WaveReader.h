@@ -105,6 +105,8 @@ private:
     int64_t mDataStartFilePosition;
     int64_t mPosition;
     ByteArray mReadBuffer;
+    std::vector<Frame*> mTrackFrames;
+    std::vector<unsigned char*> mTrackFrameData;
 };
 
 
@@ -34,6 +34,7 @@
 
 
 #include <bmx/wave/WaveIO.h>
+#include <bmx/frame/DataBufferArray.h>
 
 
 
@@ -57,6 +58,7 @@ public:
 
 public:
     void WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(const CDataBuffer *data_array, uint32_t array_size);
 
 public:
     uint32_t GetSampleSize() const;
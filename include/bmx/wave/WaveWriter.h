@@ -66,6 +66,7 @@ public:
 public:
     void PrepareWrite();
     void WriteSamples(uint32_t track_index, const unsigned char *data, uint32_t size, uint32_t num_samples);
+    void WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size);
     void CompleteWrite();
 
 public:
@@ -117,6 +118,8 @@ private:
     bool mUseRF64;
     int64_t mSetSize;
     int64_t mSetDataSize;
+
+    ByteArray mSampleArrayBuffer;
 };
 
 
@@ -0,0 +1,518 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#define __STDC_FORMAT_MACROS
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include <bmx/apps/AppBatch.h>
+#include <bmx/apps/AppTextInfoWriter.h>
+#include <bmx/apps/AppXMLInfoWriter.h>
+#include <bmx/apps/AppUtils.h>
+#include <bmx/MXFUtils.h>
+#include <bmx/Utils.h>
+#include <bmx/Version.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+#include <mxf/mxf_utils.h>
+#include <mxf/mxf_avid.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#define MAX_BATCH_THREADS   64
+
+
+extern bool BMX_REGRESSION_TEST;
+
+
+
+class BatchWorker : public Thread
+{
+public:
+    BatchWorker(AppBatch *batch)
+    : Thread()
+    {
+        mBatch = batch;
+    }
+    virtual ~BatchWorker()
+    {
+        Join();
+    }
+
+protected:
+    virtual void Run()
+    {
+        mBatch->RunJobs();
+    }
+
+private:
+    AppBatch *mBatch;
+};
+
+
+
+static bool parse_job_line(const string &line, vector<string> *args)
+{
+    string arg;
+    bool have_arg = false;
+    char quote = 0;
+    size_t i;
+    for (i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quote) {
+            if (c == quote)
+                quote = 0;
+            else if (c == '\\' && quote == '"' && i + 1 < line.size() &&
+                     (line[i + 1] == '"' || line[i + 1] == '\\'))
+                arg.append(1, line[++i]);
+            else
+                arg.append(1, c);
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+            have_arg = true;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (have_arg) {
+                args->push_back(arg);
+                arg.clear();
+                have_arg = false;
+            }
+        } else if (c == '#' && !have_arg) {
+            break;
+        } else {
+            arg.append(1, c);
+            have_arg = true;
+        }
+    }
+    if (quote)
+        return false;
+    if (have_arg)
+        args->push_back(arg);
+
+    return true;
+}
+
+static string get_job_command(const vector<string> &args)
+{
+    string command;
+    size_t i;
+    for (i = 0; i < args.size(); i++) {
+        if (i > 0)
+            command.append(" ");
+        if (args[i].empty() || args[i].find_first_of(" \t'\"#") != string::npos) {
+            command.append("\"");
+            size_t c;
+            for (c = 0; c < args[i].size(); c++) {
+                if (args[i][c] == '"' || args[i][c] == '\\')
+                    command.append("\\");
+                command.append(1, args[i][c]);
+            }
+            command.append("\"");
+        } else {
+            command.append(args[i]);
+        }
+    }
+
+    return command;
+}
+
+static void batch_usage(const char *cmd)
+{
+    fprintf(stderr, "Usage: %s --batch <job file> [<batch options>]\n", cmd);
+    fprintf(stderr, "   Runs the jobs listed in <job file> in this process\n");
+    fprintf(stderr, "   Each line in <job file> contains the options and inputs for a single %s invocation\n", cmd);
+    fprintf(stderr, "   Arguments are separated by white space and may be quoted using \"...\" or '...'\n");
+    fprintf(stderr, "   Empty lines and lines starting with '#' are ignored\n");
+    fprintf(stderr, "   The logging options apply to the whole batch: the -l option is not supported in jobs and --log-level is ignored\n");
+    fprintf(stderr, "   The --regtest and --stats options are not supported in jobs. Jobs must not write to stdout, e.g. use --info-file\n");
+    fprintf(stderr, "Batch options:\n");
+    fprintf(stderr, " -h | --help             Show usage and exit\n");
+    fprintf(stderr, " -l <file>               Log filename. Default log to stderr\n");
+    fprintf(stderr, " --log-level <level>     Set the log level. 0=debug, 1=info, 2=warning, 3=error. Default is 1\n");
+    fprintf(stderr, " --threads <n>           Run up to <n> jobs at the same time. Default is 1\n");
+    fprintf(stderr, " --summary <file>        Write the summary of the job results to <file>. Default is stdout\n");
+    fprintf(stderr, " --summary-format <fmt>  Set the summary format, 'text' or 'xml'. Default is 'text'\n");
+    fprintf(stderr, " --regtest               Run all the jobs in regression test mode\n");
+    fprintf(stderr, "The exit code is 0 if all jobs succeeded and 1 otherwise\n");
+}
+
+
+
+AppBatch::AppBatch(const string &app_name, AppMainFunc main_func)
+{
+    mAppName = app_name;
+    mMainFunc = main_func;
+    mNumThreads = 1;
+    mDurationMsec = 0;
+    mNextJob = 0;
+}
+
+AppBatch::~AppBatch()
+{
+}
+
+bool AppBatch::ReadJobFile(const string &filename)
+{
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file) {
+        log_error("Failed to open job file '%s': %s\n", filename.c_str(), bmx_strerror(errno).c_str());
+        return false;
+    }
+
+    mJobFilename = filename;
+    mJobs.clear();
+
+    bool result = true;
+    string line;
+    size_t line_number = 1;
+    int c;
+    do {
+        c = fgetc(file);
+        if (c == EOF || c == '\n') {
+            Job job;
+            job.line_number   = line_number;
+            job.exit_code     = 0;
+            job.duration_msec = 0;
+            job.done          = false;
+            if (!parse_job_line(line, &job.args)) {
+                log_error("Unterminated quote in job file '%s' line %" PRIszt "\n", filename.c_str(), line_number);
+                result = false;
+                break;
+            }
+            if (!job.args.empty())
+                mJobs.push_back(job);
+
+            line.clear();
+            line_number++;
+        } else {
+            line.append(1, (char)c);
+        }
+    }
+    while (c != EOF);
+
+    if (result && ferror(file)) {
+        log_error("Failed to read job file '%s': %s\n", filename.c_str(), bmx_strerror(errno).c_str());
+        result = false;
+    }
+
+    fclose(file);
+
+    return result;
+}
+
+void AppBatch::Run(uint32_t num_threads)
+{
+    mNumThreads = num_threads;
+    if (mNumThreads == 0)
+        mNumThreads = 1;
+    if (mNumThreads > mJobs.size())
+        mNumThreads = (uint32_t)mJobs.size();
+    if (mNumThreads > MAX_BATCH_THREADS)
+        mNumThreads = MAX_BATCH_THREADS;
+    mNextJob = 0;
+
+    uint32_t start_tick = get_tick_count();
+
+    // the calling thread is worker 0
+    vector<BatchWorker*> workers;
+    try
+    {
+        uint32_t i;
+        for (i = 1; i < mNumThreads; i++) {
+            workers.push_back(new BatchWorker(this));
+            workers.back()->Start();
+        }
+
+        RunJobs();
+
+        for (i = 0; i < workers.size(); i++)
+            delete workers[i];
+    }
+    catch (...)
+    {
+        // stop the other workers taking new jobs
+        {
+            MutexLocker locker(&mJobMutex);
+            mNextJob = mJobs.size();
+        }
+        size_t i;
+        for (i = 0; i < workers.size(); i++)
+            delete workers[i];
+        throw;
+    }
+
+    mDurationMsec = delta_tick_count(start_tick, get_tick_count());
+}
+
+void AppBatch::RunJobs()
+{
+    while (true) {
+        Job *job;
+        {
+            MutexLocker locker(&mJobMutex);
+            if (mNextJob >= mJobs.size())
+                break;
+            job = &mJobs[mNextJob];
+            mNextJob++;
+        }
+
+        vector<const char*> argv;
+        argv.push_back(mAppName.c_str());
+        size_t i;
+        for (i = 0; i < job->args.size(); i++)
+            argv.push_back(job->args[i].c_str());
+        argv.push_back(0);
+
+        uint32_t start_tick = get_tick_count();
+        try
+        {
+            job->exit_code = mMainFunc((int)job->args.size() + 1, &argv[0]);
+        }
+        catch (const BMXException &ex)
+        {
+            log_error("Job at line %" PRIszt " failed: %s\n", job->line_number, ex.what());
+            job->exit_code = 1;
+        }
+        catch (...)
+        {
+            log_error("Job at line %" PRIszt " failed: unknown exception\n", job->line_number);
+            job->exit_code = 1;
+        }
+        job->duration_msec = delta_tick_count(start_tick, get_tick_count());
+        job->done = true;
+    }
+}
+
+size_t AppBatch::GetNumFailedJobs() const
+{
+    size_t count = 0;
+    size_t i;
+    for (i = 0; i < mJobs.size(); i++) {
+        if (!mJobs[i].done || mJobs[i].exit_code != 0)
+            count++;
+    }
+
+    return count;
+}
+
+void AppBatch::WriteSummary(AppInfoWriter *info_writer)
+{
+    info_writer->StartSection("batch");
+    info_writer->WriteStringItem("app", mAppName);
+    info_writer->WriteStringItem("job_file", mJobFilename);
+    info_writer->WriteIntegerItem("threads", mNumThreads);
+    info_writer->WriteIntegerItem("job_count", (uint64_t)mJobs.size());
+    info_writer->WriteIntegerItem("failed_count", (uint64_t)GetNumFailedJobs());
+    info_writer->WriteFormatItem("seconds", "%.3f", mDurationMsec / 1000.0);
+
+    info_writer->StartArrayItem("jobs", mJobs.size());
+    size_t i;
+    for (i = 0; i < mJobs.size(); i++) {
+        const Job &job = mJobs[i];
+        info_writer->StartArrayElement("job", i);
+        info_writer->WriteIntegerItem("line", (uint64_t)job.line_number);
+        info_writer->WriteStringItem("command", get_job_command(job.args));
+        if (job.done) {
+            info_writer->WriteBoolItem("success", job.exit_code == 0);
+            info_writer->WriteIntegerItem("exit_code", (int32_t)job.exit_code);
+            info_writer->WriteFormatItem("seconds", "%.3f", job.duration_msec / 1000.0);
+        } else {
+            info_writer->WriteBoolItem("success", false);
+        }
+        info_writer->EndArrayElement();
+    }
+    info_writer->EndArrayItem();
+
+    info_writer->EndSection();
+}
+
+
+
+int bmx::run_app_batch(const char *app_name, AppMainFunc main_func, int argc, const char **argv)
+{
+    const char *job_filename = 0;
+    const char *log_filename = 0;
+    LogLevel log_level = INFO_LOG;
+    uint32_t num_threads = 1;
+    const char *summary_filename = 0;
+    bool summary_xml = false;
+    bool regtest = false;
+    unsigned int uvalue;
+    int cmdln_index;
+
+    for (cmdln_index = 1; cmdln_index < argc; cmdln_index++)
+    {
+        if (strcmp(argv[cmdln_index], "-h") == 0 ||
+            strcmp(argv[cmdln_index], "--help") == 0)
+        {
+            batch_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    for (cmdln_index = 1; cmdln_index < argc; cmdln_index++)
+    {
+        if (strcmp(argv[cmdln_index], "--batch") == 0 ||
+                 strcmp(argv[cmdln_index], "-l") == 0 ||
+                 strcmp(argv[cmdln_index], "--log-level") == 0 ||
+                 strcmp(argv[cmdln_index], "--threads") == 0 ||
+                 strcmp(argv[cmdln_index], "--summary") == 0 ||
+                 strcmp(argv[cmdln_index], "--summary-format") == 0)
+        {
+            if (cmdln_index + 1 >= argc)
+            {
+                batch_usage(argv[0]);
+                fprintf(stderr, "Missing argument for option '%s'\n", argv[cmdln_index]);
+                return 1;
+            }
+
+            bool valid = true;
+            if (strcmp(argv[cmdln_index], "--batch") == 0) {
+                job_filename = argv[cmdln_index + 1];
+            } else if (strcmp(argv[cmdln_index], "-l") == 0) {
+                log_filename = argv[cmdln_index + 1];
+            } else if (strcmp(argv[cmdln_index], "--log-level") == 0) {
+                valid = parse_log_level(argv[cmdln_index + 1], &log_level);
+            } else if (strcmp(argv[cmdln_index], "--threads") == 0) {
+                valid = (sscanf(argv[cmdln_index + 1], "%u", &uvalue) == 1 && uvalue > 0);
+                num_threads = uvalue;
+            } else if (strcmp(argv[cmdln_index], "--summary") == 0) {
+                summary_filename = argv[cmdln_index + 1];
+            } else {
+                if (strcmp(argv[cmdln_index + 1], "text") == 0)
+                    summary_xml = false;
+                else if (strcmp(argv[cmdln_index + 1], "xml") == 0)
+                    summary_xml = true;
+                else
+                    valid = false;
+            }
+            if (!valid)
+            {
+                batch_usage(argv[0]);
+                fprintf(stderr, "Invalid value '%s' for option '%s'\n", argv[cmdln_index + 1], argv[cmdln_index]);
+                return 1;
+            }
+            cmdln_index++;
+        }
+        else if (strcmp(argv[cmdln_index], "--regtest") == 0)
+        {
+            regtest = true;
+        }
+        else
+        {
+            batch_usage(argv[0]);
+            fprintf(stderr, "Unknown batch option '%s'\n", argv[cmdln_index]);
+            return 1;
+        }
+    }
+
+    if (!job_filename) {
+        batch_usage(argv[0]);
+        fprintf(stderr, "Missing --batch <job file>\n");
+        return 1;
+    }
+
+    LOG_LEVEL = log_level;
+    if (log_filename) {
+        if (!open_log_file(log_filename))
+            return 1;
+    }
+
+    connect_libmxf_logging();
+
+    if (regtest) {
+        BMX_REGRESSION_TEST = true;
+        mxf_set_regtest_funcs();
+        mxf_avid_set_regtest_funcs();
+    }
+
+
+    int cmd_result = 0;
+    try
+    {
+        AppBatch batch(app_name, main_func);
+        if (!batch.ReadJobFile(job_filename))
+            throw false;
+
+        batch.Run(num_threads);
+
+        AppInfoWriter *info_writer;
+        if (summary_filename) {
+            if (summary_xml)
+                info_writer = AppXMLInfoWriter::Open(summary_filename);
+            else
+                info_writer = AppTextInfoWriter::Open(summary_filename);
+            if (!info_writer)
+                throw false;
+        } else {
+            if (summary_xml)
+                info_writer = new AppXMLInfoWriter(stdout);
+            else
+                info_writer = new AppTextInfoWriter(stdout);
+        }
+
+        info_writer->Start("bmx");
+        batch.WriteSummary(info_writer);
+        info_writer->End();
+        delete info_writer;
+
+        if (batch.GetNumFailedJobs() > 0)
+            cmd_result = 1;
+    }
+    catch (const BMXException &ex)
+    {
+        log_error("BMX exception caught: %s\n", ex.what());
+        cmd_result = 1;
+    }
+    catch (const bool &ex)
+    {
+        (void)ex;
+        cmd_result = 1;
+    }
+    catch (...)
+    {
+        log_error("Unknown exception caught\n");
+        cmd_result = 1;
+    }
+
+
+    if (log_filename)
+        close_log_file();
+
+
+    return cmd_result;
+}
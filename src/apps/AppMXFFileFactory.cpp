@@ -39,6 +39,10 @@
 
 #include <bmx/apps/AppMXFFileFactory.h>
 #include <bmx/MXFHTTPFile.h>
+#include <bmx/MXFMMapFile.h>
+#include <bmx/MXFStatsFile.h>
+#include <bmx/MXFStreamFile.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -54,7 +58,7 @@ AppMXFFileFactory::AppMXFFileFactory()
     mInputFlags = 0;
     mRWInterleaver = 0;
     mHTTPMinReadSize = 64 * 1024;
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
     mUseMMapFile = false;
 #endif
 }
@@ -98,7 +102,7 @@ void AppMXFFileFactory::SetHTTPMinReadSize(uint32_t size)
     mHTTPMinReadSize = size;
 }
 
-#if defined(_WIN32) && !defined(__MINGW32__)
+#if !defined(__MINGW32__)
 void AppMXFFileFactory::SetUseMMapFile(bool enable)
 {
     mUseMMapFile = enable;
@@ -114,16 +118,26 @@ File* AppMXFFileFactory::OpenNew(string filename)
 
     try
     {
+        if (mxf_stream_file_is_stream(filename)) {
+            mxf_file = mxf_stream_file_open_new(filename);
+        } else {
 #if defined(_WIN32)
 #if !defined(__MINGW32__)
-        if (mUseMMapFile)
-            BMX_CHECK(mxf_win32_mmap_open_new(filename.c_str(), 0, &mxf_file));
-        else
+            if (mUseMMapFile)
+                BMX_CHECK(mxf_win32_mmap_open_new(filename.c_str(), 0, &mxf_file));
+            else
 #endif
-            BMX_CHECK(mxf_win32_file_open_new(filename.c_str(), 0, &mxf_file));
+                BMX_CHECK(mxf_win32_file_open_new(filename.c_str(), 0, &mxf_file));
 #else
-        BMX_CHECK(mxf_disk_file_open_new(filename.c_str(), &mxf_file));
+            if (mUseMMapFile)
+                mxf_file = mxf_mmap_file_open_new(filename);
+            else
+                BMX_CHECK(mxf_disk_file_open_new(filename.c_str(), &mxf_file));
 #endif
+        }
+
+        if (STATS_ENABLED)
+            mxf_file = mxf_stats_file_open(mxf_file);
 
         if (mRWInterleaver) {
             MXFFile *intl_mxf_file;
@@ -163,11 +177,17 @@ File* AppMXFFileFactory::OpenRead(string filename)
 #endif
                     BMX_CHECK(mxf_win32_file_open_read(filename.c_str(), mInputFlags, &mxf_file));
 #else
-                BMX_CHECK(mxf_disk_file_open_read(filename.c_str(), &mxf_file));
+                if (mUseMMapFile)
+                    mxf_file = mxf_mmap_file_open_read(filename);
+                else
+                    BMX_CHECK(mxf_disk_file_open_read(filename.c_str(), &mxf_file));
 #endif
             }
         }
 
+        if (STATS_ENABLED)
+            mxf_file = mxf_stats_file_open(mxf_file);
+
         if (!mInputChecksumTypes.empty()) {
             URI abs_uri;
             if (!uri_str.empty()) {
@@ -227,9 +247,15 @@ File* AppMXFFileFactory::OpenModify(string filename)
 #endif
             BMX_CHECK(mxf_win32_file_open_modify(filename.c_str(), 0, &mxf_file));
 #else
-        BMX_CHECK(mxf_disk_file_open_modify(filename.c_str(), &mxf_file));
+        if (mUseMMapFile)
+            mxf_file = mxf_mmap_file_open_modify(filename);
+        else
+            BMX_CHECK(mxf_disk_file_open_modify(filename.c_str(), &mxf_file));
 #endif
 
+        if (STATS_ENABLED)
+            mxf_file = mxf_stats_file_open(mxf_file);
+
         if (mRWInterleaver) {
             MXFFile *intl_mxf_file;
             BMX_CHECK(mxf_rw_intl_open(mRWInterleaver, mxf_file, 1, &intl_mxf_file));
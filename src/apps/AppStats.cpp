@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+
+#include <bmx/apps/AppStats.h>
+#include <bmx/apps/AppTextInfoWriter.h>
+#include <bmx/apps/AppXMLInfoWriter.h>
+#include <bmx/Stats.h>
+
+using namespace std;
+using namespace bmx;
+
+
+
+bool bmx::parse_stats_format(const char *format_str, bool *xml_format)
+{
+    if (strcmp(format_str, "text") == 0)
+        *xml_format = false;
+    else if (strcmp(format_str, "xml") == 0)
+        *xml_format = true;
+    else
+        return false;
+
+    return true;
+}
+
+void bmx::write_stats_info(AppInfoWriter *info_writer)
+{
+    StatsCounterValue value;
+    size_t i;
+
+    info_writer->RegisterCCName("mxf_read", "MXFRead");
+
+    info_writer->StartSection("stats");
+    for (i = 0; i < STATS_NUM_COUNTERS; i++) {
+        stats_get_counter((StatsCounter)i, &value);
+        if (value.calls == 0)
+            continue;
+
+        double seconds = value.nsec / 1000000000.0;
+
+        info_writer->StartSection(stats_counter_name((StatsCounter)i));
+        info_writer->WriteIntegerItem("calls", value.calls);
+        info_writer->WriteIntegerItem("bytes", value.bytes);
+        info_writer->WriteFormatItem("seconds", "%.6f", seconds);
+        info_writer->WriteFormatItem("mean_usec", "%.3f", value.nsec / 1000.0 / value.calls);
+        if (value.bytes > 0 && seconds > 0.0)
+            info_writer->WriteFormatItem("mb_per_sec", "%.2f", value.bytes / (1024.0 * 1024.0) / seconds);
+
+        size_t num_buckets = 0;
+        size_t b;
+        for (b = 0; b < STATS_NUM_LATENCY_BUCKETS; b++) {
+            if (value.latency[b] > 0)
+                num_buckets++;
+        }
+        info_writer->StartArrayItem("latency", num_buckets);
+        size_t index = 0;
+        for (b = 0; b < STATS_NUM_LATENCY_BUCKETS; b++) {
+            if (value.latency[b] == 0)
+                continue;
+            info_writer->StartArrayElement("bucket", index);
+            if (b == STATS_NUM_LATENCY_BUCKETS - 1)
+                info_writer->WriteIntegerItem("min_usec", (uint64_t)1 << (b - 1));
+            else
+                info_writer->WriteIntegerItem("max_usec", (uint64_t)1 << b);
+            info_writer->WriteIntegerItem("count", value.latency[b]);
+            info_writer->EndArrayElement();
+            index++;
+        }
+        info_writer->EndArrayItem();
+
+        info_writer->EndSection();
+    }
+    info_writer->EndSection();
+}
+
+bool bmx::write_stats(const string &filename, bool xml_format)
+{
+    AppInfoWriter *info_writer;
+    if (filename.empty()) {
+        if (xml_format)
+            info_writer = new AppXMLInfoWriter(stderr);
+        else
+            info_writer = new AppTextInfoWriter(stderr);
+    } else {
+        if (xml_format)
+            info_writer = AppXMLInfoWriter::Open(filename);
+        else
+            info_writer = AppTextInfoWriter::Open(filename);
+        if (!info_writer)
+            return false;
+    }
+
+    info_writer->Start("bmx");
+    write_stats_info(info_writer);
+    info_writer->End();
+
+    delete info_writer;
+
+    return true;
+}
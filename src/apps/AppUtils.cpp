@@ -990,6 +990,34 @@ string bmx::create_mxf_track_filename(const char *prefix, uint32_t track_number,
     return filename.append(buffer);
 }
 
+bool bmx::is_inter_frame_essence_type(EssenceType essence_type)
+{
+    switch (essence_type)
+    {
+        case AVC_BASELINE:
+        case AVC_CONSTRAINED_BASELINE:
+        case AVC_MAIN:
+        case AVC_EXTENDED:
+        case AVC_HIGH:
+        case AVC_HIGH_10:
+        case AVC_HIGH_422:
+        case AVC_HIGH_444:
+        case MPEG2LG_422P_HL_1080I:
+        case MPEG2LG_422P_HL_1080P:
+        case MPEG2LG_422P_HL_720P:
+        case MPEG2LG_MP_HL_1920_1080I:
+        case MPEG2LG_MP_HL_1920_1080P:
+        case MPEG2LG_MP_HL_1440_1080I:
+        case MPEG2LG_MP_HL_1440_1080P:
+        case MPEG2LG_MP_HL_720P:
+        case MPEG2LG_MP_H14_1080I:
+        case MPEG2LG_MP_H14_1080P:
+            return true;
+        default:
+            return false;
+    }
+}
+
 
 bool bmx::have_avci_header_data(EssenceType essence_type, Rational sample_rate,
                                 vector<AVCIHeaderInput> &avci_header_inputs)
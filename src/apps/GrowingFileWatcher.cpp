@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(HAVE_SYS_INOTIFY_H)
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+#include <bmx/apps/GrowingFileWatcher.h>
+#include <bmx/apps/AppUtils.h>
+#include <bmx/Utils.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#define POLL_INTERVAL_MSEC      20
+
+
+
+static bool get_file_size(const string &filename, int64_t *size)
+{
+#if defined(_WIN32)
+    struct _stati64 stat_buf;
+    if (_stati64(filename.c_str(), &stat_buf) != 0 || !(stat_buf.st_mode & _S_IFREG))
+        return false;
+#else
+    struct stat stat_buf;
+    if (stat(filename.c_str(), &stat_buf) != 0 || !S_ISREG(stat_buf.st_mode))
+        return false;
+#endif
+
+    *size = stat_buf.st_size;
+    return true;
+}
+
+
+
+GrowingFileWatcher::GrowingFileWatcher()
+{
+    mNotifyFd = -1;
+}
+
+GrowingFileWatcher::~GrowingFileWatcher()
+{
+#if defined(HAVE_SYS_INOTIFY_H)
+    if (mNotifyFd >= 0)
+        close(mNotifyFd);
+#endif
+}
+
+bool GrowingFileWatcher::AddFile(const string &filename)
+{
+    WatchedFile file;
+    file.filename   = filename;
+    file.watch_desc = -1;
+    file.closed     = false;
+    if (filename.empty() || !get_file_size(filename, &file.size))
+        return false;
+
+#if defined(HAVE_SYS_INOTIFY_H)
+    if (mFiles.empty()) {
+        mNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mNotifyFd < 0)
+            log_warn("Failed to initialise inotify, falling back to polling file sizes: %s\n", bmx_strerror(errno).c_str());
+    }
+    if (mNotifyFd >= 0) {
+        file.watch_desc = inotify_add_watch(mNotifyFd, filename.c_str(), IN_MODIFY | IN_CLOSE_WRITE);
+        if (file.watch_desc < 0) {
+            log_warn("Failed to add inotify watch for '%s', falling back to polling file sizes: %s\n",
+                     filename.c_str(), bmx_strerror(errno).c_str());
+        }
+    }
+#endif
+
+    mFiles.push_back(file);
+    return true;
+}
+
+bool GrowingFileWatcher::Wait(uint32_t timeout_msec)
+{
+    uint32_t start = get_tick_count();
+    while (true) {
+        if (CheckGrowth())
+            return true;
+
+        uint32_t elapsed = delta_tick_count(start, get_tick_count());
+        if (elapsed >= timeout_msec)
+            break;
+        uint32_t remaining = timeout_msec - elapsed;
+
+        // a closed file generates no more events unless it is re-opened and so wait at most the poll
+        // interval, draining any events, before checking the sizes again
+        bool all_closed = !mFiles.empty();
+        size_t i;
+        for (i = 0; i < mFiles.size(); i++) {
+            if (!mFiles[i].closed) {
+                all_closed = false;
+                break;
+            }
+        }
+        if (all_closed && remaining > POLL_INTERVAL_MSEC)
+            remaining = POLL_INTERVAL_MSEC;
+
+        WaitForEvents(remaining);
+    }
+
+    // the writer may re-open the files before the next wait
+    size_t i;
+    for (i = 0; i < mFiles.size(); i++)
+        mFiles[i].closed = false;
+
+    return false;
+}
+
+bool GrowingFileWatcher::CheckGrowth()
+{
+    bool grown = false;
+    size_t i;
+    for (i = 0; i < mFiles.size(); i++) {
+        int64_t size;
+        if (get_file_size(mFiles[i].filename, &size) && size > mFiles[i].size) {
+            mFiles[i].size = size;
+            grown = true;
+        }
+    }
+
+    return grown;
+}
+
+void GrowingFileWatcher::WaitForEvents(uint32_t timeout_msec)
+{
+    bool have_unwatched = mFiles.empty();
+    size_t i;
+    for (i = 0; i < mFiles.size(); i++) {
+        if (mFiles[i].watch_desc < 0) {
+            have_unwatched = true;
+            break;
+        }
+    }
+
+    // unwatched files are polled
+    if (have_unwatched || mNotifyFd < 0) {
+        sleep_msec(timeout_msec < POLL_INTERVAL_MSEC ? timeout_msec : POLL_INTERVAL_MSEC);
+        return;
+    }
+
+#if defined(HAVE_SYS_INOTIFY_H)
+    struct pollfd poll_fd;
+    poll_fd.fd      = mNotifyFd;
+    poll_fd.events  = POLLIN;
+    poll_fd.revents = 0;
+    int result = poll(&poll_fd, 1, (int)timeout_msec);
+    if (result < 0 && errno != EINTR) {
+        log_warn("Failed to poll for inotify events: %s\n", bmx_strerror(errno).c_str());
+        sleep_msec(timeout_msec < POLL_INTERVAL_MSEC ? timeout_msec : POLL_INTERVAL_MSEC);
+        return;
+    }
+    if (result <= 0)
+        return;
+
+    // drain the events. The file sizes are checked by the caller and so only whether the writer has closed
+    // the file is recorded here
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    while (true) {
+        ssize_t num_read = read(mNotifyFd, buffer, sizeof(buffer));
+        if (num_read <= 0)
+            break;
+
+        ssize_t offset = 0;
+        while (offset < num_read) {
+            const struct inotify_event *event = (const struct inotify_event*)&buffer[offset];
+            for (i = 0; i < mFiles.size(); i++) {
+                if (mFiles[i].watch_desc == event->wd) {
+                    if (event->mask & IN_CLOSE_WRITE)
+                        mFiles[i].closed = true;
+                    else if (event->mask & IN_MODIFY)
+                        mFiles[i].closed = false;
+                }
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+}
@@ -34,9 +34,11 @@
 #endif
 
 #include <algorithm>
+#include <memory>
 
 #include <bmx/as02/AS02Clip.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/MXFAsyncWriteFile.h>
 #include <bmx/Utils.h>
 #include <bmx/Version.h>
 #include <bmx/BMXException.h>
@@ -66,6 +68,7 @@ AS02Clip::AS02Clip(AS02Bundle *bundle, string filepath, mxfRational frame_rate)
     mVersionString = get_bmx_mxf_version_string();
     mProductUID = get_bmx_product_uid();
     mReserveMinBytes = 8192;
+    mParallelTrackWrite = false;
     mxf_get_timestamp_now(&mCreationDate);
     mxf_generate_uuid(&mGenerationUID);
     mNextVideoTrackNumber = 1;
@@ -114,6 +117,11 @@ void AS02Clip::ReserveHeaderMetadataSpace(uint32_t min_bytes)
     mReserveMinBytes = min_bytes;
 }
 
+void AS02Clip::SetParallelTrackWrite(bool enable)
+{
+    mParallelTrackWrite = enable;
+}
+
 AS02Track* AS02Clip::CreateTrack(EssenceType essence_type)
 {
     bool is_video = (essence_type != WAVE_PCM);
@@ -128,8 +136,12 @@ AS02Track* AS02Clip::CreateTrack(EssenceType essence_type)
     }
     filepath = mBundle->CreateEssenceComponentFilepath(mClipFilename, is_video, track_number, &rel_uri);
 
-    mTracks.push_back(AS02Track::OpenNew(this, mBundle->GetFileFactory()->OpenNew(filepath), rel_uri,
-                                         (uint32_t)mTracks.size(), essence_type));
+    auto_ptr<File> file(mBundle->GetFileFactory()->OpenNew(filepath));
+    if (mParallelTrackWrite) {
+        file->swapCFile(mxf_async_write_file_open(file->getCFile()));
+    }
+
+    mTracks.push_back(AS02Track::OpenNew(this, file.release(), rel_uri, (uint32_t)mTracks.size(), essence_type));
     mTrackMap[mTracks.back()->GetTrackIndex()] = mTracks.back();
 
     return mTracks.back();
@@ -168,6 +180,13 @@ void AS02Clip::WriteSamples(uint32_t track_index, const unsigned char *data, uin
     mTrackMap[track_index]->WriteSamples(data, size, num_samples);
 }
 
+void AS02Clip::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_CHECK(track_index < mTracks.size());
+
+    mTrackMap[track_index]->WriteSample(data_array, array_size);
+}
+
 void AS02Clip::CompleteWrite()
 {
     size_t i;
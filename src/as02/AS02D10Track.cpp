@@ -85,7 +85,7 @@ void AS02D10Track::WriteSamples(const unsigned char *data, uint32_t size, uint32
     uint32_t i;
     for (i = 0; i < num_samples; i++) {
         mWriterHelper.ProcessFrame(&data[i * sample_size], sample_size, &data_array, &data_array_size);
-        AS02PictureTrack::WriteSample(data_array, data_array_size);
+        WriteSampleInt(data_array, data_array_size);
     }
 }
 
@@ -42,6 +42,7 @@
 #include <bmx/as02/AS02Manifest.h>
 #include <bmx/as02/AS02Bundle.h>
 #include <bmx/Checksum.h>
+#include <bmx/Thread.h>
 #include <bmx/XMLUtils.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
@@ -53,6 +54,8 @@ using namespace bmx;
 
 static const char AS02_V10_NAMESPACE[] = "http://www.amwa.tv/as-02/1.0/manifest";
 
+#define MAX_MIC_CALC_THREADS    8
+
 
 typedef struct
 {
@@ -300,10 +303,53 @@ void AS02ManifestFile::Write(XMLWriter *xml_writer)
 
 
 
+class CompleteInfoWorker : public Thread
+{
+public:
+    CompleteInfoWorker(vector<AS02ManifestFile> *files, size_t *next_index, Mutex *mutex, AS02Bundle *bundle,
+                       MICType default_mic_type, MICScope default_mic_scope)
+    : Thread()
+    {
+        mFiles = files;
+        mNextIndex = next_index;
+        mMutex = mutex;
+        mBundle = bundle;
+        mDefaultMICType = default_mic_type;
+        mDefaultMICScope = default_mic_scope;
+    }
+
+protected:
+    virtual void Run()
+    {
+        while (true) {
+            size_t index;
+            {
+                MutexLocker locker(mMutex);
+                if (*mNextIndex >= mFiles->size())
+                    break;
+                index = (*mNextIndex)++;
+            }
+
+            (*mFiles)[index].CompleteInfo(mBundle, mDefaultMICType, mDefaultMICScope);
+        }
+    }
+
+private:
+    vector<AS02ManifestFile> *mFiles;
+    size_t *mNextIndex;
+    Mutex *mMutex;
+    AS02Bundle *mBundle;
+    MICType mDefaultMICType;
+    MICScope mDefaultMICScope;
+};
+
+
+
 AS02Manifest::AS02Manifest()
 {
     mDefaultMICType = MD5_MIC_TYPE;
     mDefaultMICScope = ESSENCE_ONLY_MIC_SCOPE;
+    mParallelMICCalc = false;
     memset(&mCreationDate, 0, sizeof(mCreationDate));
 }
 
@@ -321,6 +367,11 @@ void AS02Manifest::SetDefaultMICScope(MICScope scope)
     mDefaultMICScope = scope;
 }
 
+void AS02Manifest::SetParallelMICCalc(bool enable)
+{
+    mParallelMICCalc = enable;
+}
+
 void AS02Manifest::SetBundleName(string name)
 {
     mBundleName = name;
@@ -379,8 +430,12 @@ void AS02Manifest::Write(AS02Bundle *bundle, string filename)
         sort(ordered_files.begin(), ordered_files.end());
 
         size_t i;
-        for (i = 0; i < ordered_files.size(); i++)
-            ordered_files[i].CompleteInfo(bundle, mDefaultMICType, mDefaultMICScope);
+        if (mParallelMICCalc && ordered_files.size() > 1) {
+            CompleteInfoParallel(bundle, &ordered_files);
+        } else {
+            for (i = 0; i < ordered_files.size(); i++)
+                ordered_files[i].CompleteInfo(bundle, mDefaultMICType, mDefaultMICScope);
+        }
 
         mCreationDate = generate_timestamp_now();
 
@@ -417,3 +472,32 @@ void AS02Manifest::Write(AS02Bundle *bundle, string filename)
     }
 }
 
+
+void AS02Manifest::CompleteInfoParallel(AS02Bundle *bundle, vector<AS02ManifestFile> *files)
+{
+    // the files are shared between the workers and each file's info is completed by a single worker
+    size_t num_workers = files->size();
+    if (num_workers > MAX_MIC_CALC_THREADS)
+        num_workers = MAX_MIC_CALC_THREADS;
+
+    Mutex mutex;
+    size_t next_index = 0;
+    vector<CompleteInfoWorker*> workers;
+    size_t i;
+    for (i = 0; i < num_workers; i++) {
+        workers.push_back(new CompleteInfoWorker(files, &next_index, &mutex, bundle,
+                                                 mDefaultMICType, mDefaultMICScope));
+        workers.back()->Start();
+    }
+
+    string error_message;
+    for (i = 0; i < workers.size(); i++) {
+        workers[i]->Join();
+        if (workers[i]->HaveError() && error_message.empty())
+            error_message = workers[i]->GetErrorMessage();
+        delete workers[i];
+    }
+
+    if (!error_message.empty())
+        BMX_EXCEPTION(("Failed to complete manifest file info: %s", error_message.c_str()));
+}
@@ -92,11 +92,11 @@ void AS02PictureTrack::WriteSamples(const unsigned char *data, uint32_t size, ui
     for (i = 0; i < num_samples; i++) {
         data_array[0].data = (unsigned char*)&data[i * mSampleSize];
         data_array[0].size = mSampleSize;
-        WriteSample(data_array, 1);
+        WriteSampleInt(data_array, 1);
     }
 }
 
-void AS02PictureTrack::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+void AS02PictureTrack::WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size)
 {
     BMX_ASSERT(mMXFFile);
     BMX_CHECK(data_array && array_size > 0);
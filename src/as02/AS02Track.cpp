@@ -49,6 +49,7 @@
 #include <bmx/as02/AS02PCMTrack.h>
 #include <bmx/as02/AS02Clip.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/MXFAsyncWriteFile.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -195,6 +196,7 @@ AS02Track* AS02Track::OpenNew(AS02Clip *clip, File *file, string rel_uri, uint32
 
 AS02Track::AS02Track(AS02Clip *clip, uint32_t track_index, EssenceType essence_type,
                      File *mxf_file, string rel_uri)
+: mEssenceOnlyChecksum(MD5_CHECKSUM)
 {
     mClip = clip;
     mTrackIndex = track_index;
@@ -232,8 +234,6 @@ AS02Track::AS02Track(AS02Clip *clip, uint32_t track_index, EssenceType essence_t
     mManifestFile = clip->GetBundle()->GetManifest()->RegisterFile(rel_uri, ESSENCE_COMPONENT_FILE_ROLE);
     mManifestFile->SetId(mFileSourcePackageUID);
 
-    mEssenceOnlyChecksum.Init(MD5_CHECKSUM);
-
     // use fill key with correct version number
     g_KLVFill_key = g_CompliantKLVFill_key;
 
@@ -321,6 +321,16 @@ void AS02Track::PrepareWrite()
     CreateFile();
 }
 
+void AS02Track::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_CHECK(data_array && array_size > 0);
+
+    // tracks that pass the sample data through unchanged override this method to avoid the copy
+    uint32_t size;
+    const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+    WriteSamples(data, size, 1);
+}
+
 void AS02Track::CompleteWrite()
 {
     BMX_ASSERT(mMXFFile);
@@ -413,6 +423,12 @@ void AS02Track::CompleteWrite()
     mMXFFile->updateBodyPartitions(&MXF_PP_K(ClosedComplete, Body));
 
 
+    // wait for the asynchronous writes. A failure is thrown here, whereas the close only logs it
+
+    if (mClip->mParallelTrackWrite)
+        mxf_async_write_file_flush(mMXFFile->getCFile());
+
+
     // done with the file
     delete mMXFFile;
     mMXFFile = 0;
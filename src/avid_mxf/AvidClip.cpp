@@ -36,6 +36,7 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <memory>
 
 #include <libMXF++/MXF.h>
 
@@ -44,6 +45,7 @@
 #include <bmx/avid_mxf/AvidClip.h>
 #include "AvidRGBColors.h"
 #include <bmx/MXFUtils.h>
+#include <bmx/MXFAsyncWriteFile.h>
 #include <bmx/Utils.h>
 #include <bmx/Version.h>
 #include <bmx/BMXException.h>
@@ -92,6 +94,7 @@ AvidClip::AvidClip(int flavour, mxfRational frame_rate, MXFFileFactory *file_fac
     mProductUID = get_bmx_product_uid();
     mMaxLocatorsExceeded = false;
     mGrowingDuration = -1;
+    mParallelTrackWrite = false;
     mxf_get_timestamp_now(&mCreationDate);
     mxf_generate_uuid(&mGenerationUID);
     mxf_generate_aafsdk_umid(&mMaterialPackageUID);
@@ -178,6 +181,11 @@ void AvidClip::SetGrowingDuration(int64_t duration)
         mGrowingDuration = duration;
 }
 
+void AvidClip::SetParallelTrackWrite(bool enable)
+{
+    mParallelTrackWrite = enable;
+}
+
 void AvidClip::SetMaterialPackageCreationDate(mxfTimestamp creation_date)
 {
     mMaterialPackageCreationDate = creation_date;
@@ -538,8 +546,12 @@ AvidTrack* AvidClip::CreateTrack(EssenceType essence_type)
 
 AvidTrack* AvidClip::CreateTrack(EssenceType essence_type, string filename)
 {
-    mTracks.push_back(AvidTrack::OpenNew(this, mFileFactory->OpenNew(filename), (uint32_t)mTracks.size(),
-                                         essence_type));
+    auto_ptr<File> file(mFileFactory->OpenNew(filename));
+    if (mParallelTrackWrite) {
+        file->swapCFile(mxf_async_write_file_open(file->getCFile()));
+    }
+
+    mTracks.push_back(AvidTrack::OpenNew(this, file.release(), (uint32_t)mTracks.size(), essence_type));
     return mTracks.back();
 }
 
@@ -576,6 +588,13 @@ void AvidClip::WriteSamples(uint32_t track_index, const unsigned char *data, uin
     mTracks[track_index]->WriteSamples(data, size, num_samples);
 }
 
+void AvidClip::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_CHECK(track_index < mTracks.size());
+
+    mTracks[track_index]->WriteSample(data_array, array_size);
+}
+
 void AvidClip::CompleteWrite()
 {
     UpdateHeaderMetadata();
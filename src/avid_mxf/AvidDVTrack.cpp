@@ -68,3 +68,15 @@ void AvidDVTrack::SetComponentDepth(uint32_t depth)
     mDVDescriptorHelper->SetComponentDepth(depth);
 }
 
+void AvidDVTrack::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(mMXFFile);
+    BMX_CHECK(mSampleSize > 0);
+    BMX_CHECK(data_array && array_size > 0);
+
+    if (dba_get_total_size(data_array, array_size) == mSampleSize)
+        WriteSampleInt(data_array, array_size);
+    else
+        AvidPictureTrack::WriteSample(data_array, array_size);
+}
+
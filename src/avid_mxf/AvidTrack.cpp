@@ -50,6 +50,7 @@
 #include <bmx/avid_mxf/AvidAlphaTrack.h>
 #include <bmx/avid_mxf/AvidClip.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/MXFAsyncWriteFile.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -341,6 +342,16 @@ void AvidTrack::WriteSamples(const unsigned char *data, uint32_t size, uint32_t
     mContainerDuration += num_samples;
 }
 
+void AvidTrack::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_CHECK(data_array && array_size > 0);
+
+    // tracks that pass the sample data through unchanged override this method to avoid the copy
+    uint32_t size;
+    const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+    WriteSamples(data, size, 1);
+}
+
 void AvidTrack::CompleteWrite()
 {
     BMX_ASSERT(mMXFFile);
@@ -444,6 +455,12 @@ void AvidTrack::CompleteWrite()
     mMXFFile->updateBodyPartitions(&MXF_PP_K(ClosedComplete, Body));
 
 
+    // wait for the asynchronous writes. A failure is thrown here, whereas the close only logs it
+
+    if (mClip->mParallelTrackWrite)
+        mxf_async_write_file_flush(mMXFFile->getCFile());
+
+
     // done with the file
     delete mMXFFile;
     mMXFFile = 0;
@@ -521,6 +538,18 @@ void AvidTrack::WriteCBEIndexTable(Partition *partition)
     mCBEIndexSegment->write(mMXFFile, partition, 0);
 }
 
+void AvidTrack::WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(mMXFFile);
+
+    uint32_t i;
+    for (i = 0; i < array_size; i++) {
+        BMX_CHECK(mMXFFile->write(data_array[i].data, data_array[i].size) == data_array[i].size);
+        mContainerSize += data_array[i].size;
+    }
+    mContainerDuration++;
+}
+
 void AvidTrack::CreateHeaderMetadata()
 {
     BMX_ASSERT(!mHeaderMetadata);
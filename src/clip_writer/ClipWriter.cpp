@@ -428,6 +428,12 @@ void ClipWriter::WriteSamples(uint32_t track_index, const unsigned char *data, u
     track->WriteSamples(data, size, num_samples);
 }
 
+void ClipWriter::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    ClipWriterTrack *track = GetTrack(track_index);
+    track->WriteSample(data_array, array_size);
+}
+
 void ClipWriter::CompleteWrite()
 {
     switch (mType)
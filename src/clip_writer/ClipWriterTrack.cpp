@@ -67,6 +67,7 @@
 #include <bmx/rdd9_mxf/RDD9DataTrack.h>
 #include <bmx/rdd9_mxf/RDD9XMLTrack.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -1311,6 +1312,9 @@ void ClipWriterTrack::SetXMLLanguageCode(const string &code)
 
 void ClipWriterTrack::WriteSamples(const unsigned char *data, uint32_t size, uint32_t num_samples)
 {
+    StatsTimer stats_timer(STATS_CLIP_WRITE);
+    stats_timer.AddBytes(size);
+
     switch (mClipType)
     {
         case CW_AS02_CLIP_TYPE:
@@ -1337,6 +1341,39 @@ void ClipWriterTrack::WriteSamples(const unsigned char *data, uint32_t size, uin
     }
 }
 
+void ClipWriterTrack::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    StatsTimer stats_timer(STATS_CLIP_WRITE);
+    uint32_t i;
+    for (i = 0; i < array_size; i++)
+        stats_timer.AddBytes(data_array[i].size);
+
+    switch (mClipType)
+    {
+        case CW_AS02_CLIP_TYPE:
+            mAS02Track->WriteSample(data_array, array_size);
+            break;
+        case CW_OP1A_CLIP_TYPE:
+            mOP1ATrack->WriteSample(data_array, array_size);
+            break;
+        case CW_AVID_CLIP_TYPE:
+            mAvidTrack->WriteSample(data_array, array_size);
+            break;
+        case CW_D10_CLIP_TYPE:
+            mD10Track->WriteSample(data_array, array_size);
+            break;
+        case CW_RDD9_CLIP_TYPE:
+            mRDD9Track->WriteSample(data_array, array_size);
+            break;
+        case CW_WAVE_CLIP_TYPE:
+            mWaveTrack->WriteSample(data_array, array_size);
+            break;
+        case CW_UNKNOWN_CLIP_TYPE:
+            BMX_ASSERT(false);
+            break;
+    }
+}
+
 bool ClipWriterTrack::IsPicture() const
 {
     switch (mClipType)
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define HAVE_X86_CPUID  1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define HAVE_X86_CPUID  1
+#endif
+
+#include <bmx/CPUFeatures.h>
+
+using namespace bmx;
+
+
+#if defined(HAVE_X86_CPUID)
+
+// cpuid register indexes
+#define CPUID_EBX   1
+#define CPUID_ECX   2
+
+static bool get_cpuid(unsigned int leaf, unsigned int *regs)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if ((unsigned int)info[0] < leaf)
+        return false;
+    __cpuidex(info, (int)leaf, 0);
+    regs[0] = info[0];
+    regs[1] = info[1];
+    regs[2] = info[2];
+    regs[3] = info[3];
+    return true;
+#else
+    if (__get_cpuid_max(0, 0) < leaf)
+        return false;
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+    return true;
+#endif
+}
+
+static bool os_saves_ymm_registers()
+{
+    unsigned int regs[4];
+    if (!get_cpuid(1, regs) || !(regs[CPUID_ECX] & (1 << 27)))  // OSXSAVE
+        return false;
+
+#if defined(_MSC_VER)
+    return (_xgetbv(0) & 0x6) == 0x6;
+#else
+    unsigned int xcr0_low, xcr0_high;
+    __asm__ ("xgetbv" : "=a" (xcr0_low), "=d" (xcr0_high) : "c" (0));
+    return (xcr0_low & 0x6) == 0x6;
+#endif
+}
+
+#endif
+
+
+
+bool bmx::cpu_supports_avx2()
+{
+#if defined(HAVE_X86_CPUID)
+    unsigned int regs[4];
+    return os_saves_ymm_registers() &&
+           get_cpuid(7, regs) && (regs[CPUID_EBX] & (1 << 5));
+#else
+    return false;
+#endif
+}
+
+bool bmx::cpu_supports_pclmul()
+{
+#if defined(HAVE_X86_CPUID)
+    unsigned int regs[4];
+    return get_cpuid(1, regs) &&
+           (regs[CPUID_ECX] & (1 << 1)) &&    // PCLMULQDQ
+           (regs[CPUID_ECX] & (1 << 19));     // SSE4.1
+#else
+    return false;
+#endif
+}
+
+bool bmx::cpu_supports_sha()
+{
+#if defined(HAVE_X86_CPUID)
+    unsigned int regs[4];
+    return get_cpuid(1, regs) &&
+           (regs[CPUID_ECX] & (1 << 9)) &&    // SSSE3
+           (regs[CPUID_ECX] & (1 << 19)) &&   // SSE4.1
+           get_cpuid(7, regs) && (regs[CPUID_EBX] & (1 << 29));
+#else
+    return false;
+#endif
+}
@@ -37,12 +37,24 @@
 #include <cstring>
 #include <cerrno>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_CRC32_PCLMUL_KERNEL    1
+#define CRC32_PCLMUL_TARGET         __attribute__((target("pclmul,sse4.1")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define HAVE_CRC32_PCLMUL_KERNEL    1
+#define CRC32_PCLMUL_TARGET
+#endif
+
 #include <bmx/CRC32.h>
+#include <bmx/CPUFeatures.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
 
 using namespace std;
+using namespace bmx;
 
 
 
@@ -113,6 +125,150 @@ static const uint32_t CRC32_TABLE[256] =
 };
 
 
+
+// Slicing-by-8 tables. Table k gives the CRC of a byte followed by k zero bytes,
+// which allows 8 bytes to be processed with 8 independent lookups
+
+class CRC32SliceTables
+{
+public:
+    CRC32SliceTables()
+    {
+        int k, n;
+        for (n = 0; n < 256; n++)
+            table[0][n] = CRC32_TABLE[n];
+        for (k = 1; k < 8; k++) {
+            for (n = 0; n < 256; n++)
+                table[k][n] = (table[k - 1][n] >> 8) ^ CRC32_TABLE[table[k - 1][n] & 0xff];
+        }
+    }
+
+    uint32_t table[8][256];
+};
+
+static const CRC32SliceTables CRC32_SLICE_TABLES;
+
+
+static uint32_t crc32_update_slice8(uint32_t crc, const unsigned char *data, size_t size)
+{
+    const uint32_t (*table)[256] = CRC32_SLICE_TABLES.table;
+
+    // the words are assembled from bytes, which works independent of endianness and alignment
+    while (size >= 8) {
+        uint32_t low  = crc ^ ((uint32_t)data[0]        | ((uint32_t)data[1] << 8) |
+                               ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+        uint32_t high =        (uint32_t)data[4]        | ((uint32_t)data[5] << 8) |
+                               ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+        crc = table[7][ low         & 0xff] ^ table[6][(low  >> 8)  & 0xff] ^
+              table[5][(low  >> 16) & 0xff] ^ table[4][ low  >> 24        ] ^
+              table[3][ high        & 0xff] ^ table[2][(high >> 8)  & 0xff] ^
+              table[1][(high >> 16) & 0xff] ^ table[0][ high >> 24        ];
+        data += 8;
+        size -= 8;
+    }
+
+    while (size > 0) {
+        crc = CRC32_TABLE[(crc ^ *data) & 0xff] ^ (crc >> 8);
+        data++;
+        size--;
+    }
+
+    return crc;
+}
+
+
+#if defined(HAVE_CRC32_PCLMUL_KERNEL)
+
+static const bool HAVE_PCLMUL_SUPPORT = cpu_supports_pclmul();
+
+// Folds 64 bytes at a time using carry-less multiplication and reduces the result
+// to 32-bits using Barrett reduction. See Intel's "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction" white paper. The fold constants are
+// for the bit-reflected polynomial 0xedb88320
+// size must be >= 64 and a multiple of 16
+
+CRC32_PCLMUL_TARGET
+static uint32_t crc32_update_pclmul(uint32_t crc, const unsigned char *data, size_t size)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    const __m128i k5k0 = _mm_set_epi64x(0,              0x0163cd6124LL);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+    data += 64;
+    size -= 64;
+
+    // fold 4 x 128-bits in parallel
+    x0 = k1k2;
+    while (size >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+        data += 64;
+        size -= 64;
+    }
+
+    // fold into 128-bits
+    x0 = k3k4;
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // fold the remaining 16 byte blocks
+    while (size >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*)data)), x5);
+        data += 16;
+        size -= 16;
+    }
+
+    // fold 128-bits to 64-bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = k5k0;
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32-bits
+    x0 = poly;
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+#endif
+
+
+
 void bmx::crc32_init(uint32_t *crc32)
 {
     *crc32 = 0xffffffffL;
@@ -120,9 +276,16 @@ void bmx::crc32_init(uint32_t *crc32)
 
 void bmx::crc32_update(uint32_t *crc32, const unsigned char *data, size_t size)
 {
-    size_t i;
-    for (i = 0; i < size; i++)
-        *crc32 = CRC32_TABLE[((*crc32) ^ data[i]) & 0xff] ^ ((*crc32) >> 8);
+#if defined(HAVE_CRC32_PCLMUL_KERNEL)
+    if (HAVE_PCLMUL_SUPPORT && size >= 64) {
+        size_t fold_size = size & ~(size_t)15;
+        *crc32 = crc32_update_pclmul(*crc32, data, fold_size);
+        data += fold_size;
+        size -= fold_size;
+    }
+#endif
+
+    *crc32 = crc32_update_slice8(*crc32, data, size);
 }
 
 void bmx::crc32_final(uint32_t *crc32)
@@ -37,6 +37,8 @@
 #include <cerrno>
 
 #include <bmx/Checksum.h>
+#include <bmx/ThreadedChecksum.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -89,35 +91,42 @@ vector<string> Checksum::CalcFileChecksums(const string &filename, const vector<
 
 vector<string> Checksum::CalcFileChecksums(FILE *file, const vector<ChecksumType> &types)
 {
-    vector<Checksum> checksums;
+    // each checksum is calculated in a separate thread, in parallel with the file reads
+    vector<ThreadedChecksum*> checksums;
     size_t i;
     for (i = 0; i < types.size(); i++)
-        checksums.push_back(Checksum(types[i]));
+        checksums.push_back(new ThreadedChecksum(types[i]));
 
-    const size_t buffer_size = 8192;
+    vector<string> result;
+    bool read_error = false;
+    const size_t buffer_size = 65536;
     unsigned char *buffer = new unsigned char[buffer_size];
     size_t num_read = buffer_size;
     while (num_read == buffer_size) {
         num_read = fread(buffer, 1, buffer_size, file);
         if (num_read != buffer_size && ferror(file)) {
             log_warn("Read failure when calculating checksum: %s\n", bmx_strerror(errno).c_str());
-            delete [] buffer;
-            return vector<string>();
+            read_error = true;
+            break;
         }
 
         if (num_read > 0) {
             for (i = 0; i < checksums.size(); i++)
-                checksums[i].Update(buffer, (uint32_t)num_read);
+                checksums[i]->Update(buffer, (uint32_t)num_read);
         }
     }
     delete [] buffer;
 
-    vector<string> result;
-    for (i = 0; i < checksums.size(); i++) {
-        checksums[i].Final();
-        result.push_back(checksums[i].GetDigestString());
+    if (!read_error) {
+        for (i = 0; i < checksums.size(); i++) {
+            checksums[i]->Final();
+            result.push_back(checksums[i]->GetDigestString());
+        }
     }
 
+    for (i = 0; i < checksums.size(); i++)
+        delete checksums[i];
+
     return result;
 }
 
@@ -154,6 +163,9 @@ void Checksum::Init(ChecksumType type)
 
 void Checksum::Update(const unsigned char *data, uint32_t size)
 {
+    StatsTimer stats_timer(STATS_CHECKSUM);
+    stats_timer.AddBytes(size);
+
     switch (mType)
     {
         case CRC32_CHECKSUM: crc32_update(&mCRC32Context, data, size); break;
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <bmx/ChunkQueueWorker.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+
+class ChunkQueueWorker::Worker : public Thread
+{
+public:
+    Worker(ChunkQueueWorker *owner)
+    : Thread()
+    {
+        mOwner = owner;
+    }
+
+protected:
+    virtual void Run()
+    {
+        mOwner->RunWorker();
+    }
+
+private:
+    ChunkQueueWorker *mOwner;
+};
+
+
+
+ChunkQueueWorker::ChunkQueueWorker(uint32_t chunk_size, size_t max_chunks)
+{
+    BMX_ASSERT(chunk_size > 0 && max_chunks > 0);
+
+    mChunkSize = chunk_size;
+    mMaxChunks = max_chunks;
+    mWorker = 0;
+    mCurrentChunk = 0;
+    mWorkerBusy = false;
+    mStopWorker = false;
+    mFailed = false;
+}
+
+ChunkQueueWorker::~ChunkQueueWorker()
+{
+    // the sub-class is expected to have stopped the worker already
+    StopWorker();
+    delete mWorker;
+
+    size_t i;
+    for (i = 0; i < mChunks.size(); i++)
+        delete mChunks[i];
+}
+
+bool ChunkQueueWorker::Write(const unsigned char *data, uint32_t size)
+{
+    if (HaveFailed())
+        return false;
+
+    while (size > 0) {
+        if (!mCurrentChunk) {
+            mCurrentChunk = GetFreeChunk();
+            if (!mCurrentChunk)
+                return false;
+        }
+
+        uint32_t copy_size = mCurrentChunk->GetSizeAvailable();
+        if (copy_size > size)
+            copy_size = size;
+        mCurrentChunk->Append(data, copy_size);
+        data += copy_size;
+        size -= copy_size;
+
+        if (mCurrentChunk->GetSizeAvailable() == 0) {
+            SubmitChunk(mCurrentChunk);
+            mCurrentChunk = 0;
+        }
+    }
+
+    return true;
+}
+
+bool ChunkQueueWorker::Flush()
+{
+    if (mCurrentChunk) {
+        ByteArray *chunk = mCurrentChunk;
+        mCurrentChunk = 0;
+        if (chunk->GetSize() > 0 && mWorker) {
+            SubmitChunk(chunk);
+        } else {
+            // avoid starting a worker for a small amount of data
+            bool failed = false;
+            if (chunk->GetSize() > 0 && !HaveFailed())
+                failed = !ProcessChunk(chunk->GetBytes(), chunk->GetSize());
+
+            MutexLocker locker(&mMutex);
+            if (failed)
+                mFailed = true;
+            mFreeChunks.push_back(chunk);
+        }
+    }
+
+    // the queued chunks are not processed after a failure
+    MutexLocker locker(&mMutex);
+    while ((!mQueuedChunks.empty() && !mFailed) || mWorkerBusy)
+        mCondition.Wait(&mMutex);
+
+    return !mFailed;
+}
+
+void ChunkQueueWorker::StopWorker()
+{
+    if (!mWorker)
+        return;
+
+    {
+        MutexLocker locker(&mMutex);
+        mStopWorker = true;
+        mCondition.Broadcast();
+    }
+    mWorker->Join();
+}
+
+bool ChunkQueueWorker::HaveFailed()
+{
+    MutexLocker locker(&mMutex);
+    return mFailed;
+}
+
+string ChunkQueueWorker::GetWorkerErrorMessage() const
+{
+    if (mWorker && mWorker->HaveError())
+        return mWorker->GetErrorMessage();
+    else
+        return "";
+}
+
+ByteArray* ChunkQueueWorker::GetFreeChunk()
+{
+    MutexLocker locker(&mMutex);
+
+    while (mFreeChunks.empty() && mChunks.size() >= mMaxChunks && !mFailed)
+        mCondition.Wait(&mMutex);
+    if (mFailed)
+        return 0;
+
+    ByteArray *chunk;
+    if (!mFreeChunks.empty()) {
+        chunk = mFreeChunks.back();
+        mFreeChunks.pop_back();
+    } else {
+        chunk = new ByteArray(mChunkSize);
+        mChunks.push_back(chunk);
+    }
+    chunk->SetSize(0);
+
+    return chunk;
+}
+
+void ChunkQueueWorker::SubmitChunk(ByteArray *chunk)
+{
+    if (!mWorker) {
+        mWorker = new Worker(this);
+        mWorker->Start();
+    }
+
+    MutexLocker locker(&mMutex);
+    mQueuedChunks.push_back(chunk);
+    mCondition.Broadcast();
+}
+
+void ChunkQueueWorker::RunWorker()
+{
+    while (true) {
+        ByteArray *chunk;
+        bool failed;
+        {
+            MutexLocker locker(&mMutex);
+            while (mQueuedChunks.empty() && !mStopWorker)
+                mCondition.Wait(&mMutex);
+            if (mQueuedChunks.empty())
+                break;
+            chunk = mQueuedChunks.front();
+            mQueuedChunks.pop_front();
+            mWorkerBusy = true;
+            failed = mFailed;
+        }
+
+        // the chunks queued after a failure are discarded. An exception stops the worker and is
+        // recorded by the thread
+        if (!failed) {
+            try
+            {
+                failed = !ProcessChunk(chunk->GetBytes(), chunk->GetSize());
+            }
+            catch (...)
+            {
+                CompleteChunk(chunk, true);
+                throw;
+            }
+        }
+        CompleteChunk(chunk, failed);
+    }
+}
+
+void ChunkQueueWorker::CompleteChunk(ByteArray *chunk, bool failed)
+{
+    MutexLocker locker(&mMutex);
+    if (failed)
+        mFailed = true;
+    mFreeChunks.push_back(chunk);
+    mWorkerBusy = false;
+    mCondition.Broadcast();
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include <mxf/mxf.h>
+
+#include <bmx/MXFAsyncWriteFile.h>
+#include <bmx/ChunkQueueWorker.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#define CHUNK_SIZE      (512 * 1024)
+#define MAX_CHUNKS      8
+
+
+
+class AsyncWriter : public ChunkQueueWorker
+{
+public:
+    AsyncWriter(MXFFile *target);
+    virtual ~AsyncWriter();
+
+    MXFFile* GetTarget() const { return mTarget; }
+    MXFFile* ReleaseTarget();
+
+protected:
+    virtual bool ProcessChunk(const unsigned char *data, uint32_t size);
+
+private:
+    MXFFile *mTarget;
+};
+
+
+
+AsyncWriter::AsyncWriter(MXFFile *target)
+: ChunkQueueWorker(CHUNK_SIZE, MAX_CHUNKS)
+{
+    mTarget = target;
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    StopWorker();
+
+    if (mTarget)
+        mxf_file_close(&mTarget);
+}
+
+MXFFile* AsyncWriter::ReleaseTarget()
+{
+    MXFFile *target = mTarget;
+    mTarget = 0;
+    return target;
+}
+
+bool AsyncWriter::ProcessChunk(const unsigned char *data, uint32_t size)
+{
+    if (mxf_file_write(mTarget, data, size) != size) {
+        log_error("Failed to write %u bytes to file\n", size);
+        return false;
+    }
+
+    return true;
+}
+
+
+
+struct MXFFileSysData
+{
+    AsyncWriter *writer;
+    int64_t position;
+};
+
+
+static void async_write_file_close(MXFFileSysData *sys_data)
+{
+    if (!sys_data->writer)
+        return;
+
+    if (!sys_data->writer->Flush())
+        log_error("Failed to complete writes before closing file\n");
+    delete sys_data->writer;
+    sys_data->writer = 0;
+}
+
+static uint32_t async_write_file_read(MXFFileSysData *sys_data, uint8_t *data, uint32_t count)
+{
+    if (!sys_data->writer->Flush())
+        return 0;
+
+    uint32_t result = mxf_file_read(sys_data->writer->GetTarget(), data, count);
+    sys_data->position += result;
+    return result;
+}
+
+static uint32_t async_write_file_write(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
+{
+    if (!sys_data->writer->Write(data, count))
+        return 0;
+
+    sys_data->position += count;
+    return count;
+}
+
+static int async_write_file_getc(MXFFileSysData *sys_data)
+{
+    if (!sys_data->writer->Flush())
+        return EOF;
+
+    int c = mxf_file_getc(sys_data->writer->GetTarget());
+    if (c != EOF)
+        sys_data->position++;
+    return c;
+}
+
+static int async_write_file_putc(MXFFileSysData *sys_data, int c)
+{
+    uint8_t b = (uint8_t)c;
+    if (async_write_file_write(sys_data, &b, 1) != 1)
+        return EOF;
+    return c;
+}
+
+static int async_write_file_eof(MXFFileSysData *sys_data)
+{
+    if (!sys_data->writer->Flush())
+        return 1;
+
+    return mxf_file_eof(sys_data->writer->GetTarget());
+}
+
+static int async_write_file_seek(MXFFileSysData *sys_data, int64_t offset, int whence)
+{
+    if (!sys_data->writer->Flush())
+        return 0;
+
+    MXFFile *target = sys_data->writer->GetTarget();
+    int result = mxf_file_seek(target, offset, whence);
+    sys_data->position = mxf_file_tell(target);
+    return result;
+}
+
+static int64_t async_write_file_tell(MXFFileSysData *sys_data)
+{
+    // the position is tracked to avoid waiting for the queued writes
+    return sys_data->position;
+}
+
+static int async_write_file_is_seekable(MXFFileSysData *sys_data)
+{
+    return mxf_file_is_seekable(sys_data->writer->GetTarget());
+}
+
+static int64_t async_write_file_size(MXFFileSysData *sys_data)
+{
+    if (!sys_data->writer->Flush())
+        return -1;
+
+    return mxf_file_size(sys_data->writer->GetTarget());
+}
+
+static void free_async_write_file(MXFFileSysData *sys_data)
+{
+    delete sys_data->writer;
+    free(sys_data);
+}
+
+
+MXFFile* bmx::mxf_async_write_file_open(MXFFile *target)
+{
+    MXFFile *async_file = 0;
+    try
+    {
+        // using malloc() because mxf_file_close will call free()
+        BMX_CHECK((async_file = (MXFFile*)malloc(sizeof(MXFFile))) != 0);
+        memset(async_file, 0, sizeof(MXFFile));
+        BMX_CHECK((async_file->sysData = (MXFFileSysData*)malloc(sizeof(MXFFileSysData))) != 0);
+        memset(async_file->sysData, 0, sizeof(MXFFileSysData));
+
+        async_file->sysData->writer   = new AsyncWriter(target);
+        async_file->sysData->position = mxf_file_tell(target);
+
+        async_file->close         = async_write_file_close;
+        async_file->read          = async_write_file_read;
+        async_file->write         = async_write_file_write;
+        async_file->get_char      = async_write_file_getc;
+        async_file->put_char      = async_write_file_putc;
+        async_file->eof           = async_write_file_eof;
+        async_file->seek          = async_write_file_seek;
+        async_file->tell          = async_write_file_tell;
+        async_file->is_seekable   = async_write_file_is_seekable;
+        async_file->size          = async_write_file_size;
+        async_file->free_sys_data = free_async_write_file;
+
+        async_file->minLLen       = target->minLLen;
+        async_file->runinLen      = target->runinLen;
+
+        return async_file;
+    }
+    catch (...)
+    {
+        if (async_file) {
+            if (async_file->sysData && async_file->sysData->writer)
+                async_file->sysData->writer->ReleaseTarget(); // ownership returns to the caller
+            mxf_file_close(&async_file);
+        }
+        throw;
+    }
+}
+
+void bmx::mxf_async_write_file_flush(MXFFile *mxf_file)
+{
+    if (!mxf_file->sysData->writer->Flush())
+        BMX_EXCEPTION(("Failed to complete asynchronous writes to file"));
+}
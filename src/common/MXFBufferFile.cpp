@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include <mxf/mxf.h>
+
+#include <bmx/MXFBufferFile.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+struct MXFFileSysData
+{
+    const unsigned char *data;
+    uint32_t size;
+    int64_t file_position;
+    int64_t position;
+    int eof;
+};
+
+
+static void buffer_file_close(MXFFileSysData *sys_data)
+{
+    sys_data->data = 0;
+    sys_data->size = 0;
+}
+
+static uint32_t buffer_file_read(MXFFileSysData *sys_data, uint8_t *data, uint32_t count)
+{
+    int64_t offset = sys_data->position - sys_data->file_position;
+    if (offset < 0 || offset >= sys_data->size) {
+        sys_data->eof = 1;
+        return 0;
+    }
+
+    uint32_t num_read = count;
+    if (num_read > sys_data->size - offset)
+        num_read = (uint32_t)(sys_data->size - offset);
+    memcpy(data, &sys_data->data[offset], num_read);
+    sys_data->position += num_read;
+
+    return num_read;
+}
+
+static uint32_t buffer_file_write(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
+{
+    (void)sys_data;
+    (void)data;
+    (void)count;
+    return 0;
+}
+
+static int buffer_file_getc(MXFFileSysData *sys_data)
+{
+    uint8_t data;
+    if (buffer_file_read(sys_data, &data, 1) != 1)
+        return EOF;
+
+    return data;
+}
+
+static int buffer_file_putc(MXFFileSysData *sys_data, int c)
+{
+    (void)sys_data;
+    (void)c;
+    return EOF;
+}
+
+static int buffer_file_eof(MXFFileSysData *sys_data)
+{
+    return sys_data->eof;
+}
+
+static int buffer_file_seek(MXFFileSysData *sys_data, int64_t offset, int whence)
+{
+    int64_t new_position;
+    if (whence == SEEK_CUR)
+        new_position = sys_data->position + offset;
+    else if (whence == SEEK_SET)
+        new_position = offset;
+    else if (whence == SEEK_END)
+        new_position = sys_data->file_position + sys_data->size + offset;
+    else
+        return 0;
+
+    if (new_position < sys_data->file_position || new_position > sys_data->file_position + sys_data->size)
+        return 0;
+
+    sys_data->position = new_position;
+    sys_data->eof      = 0;
+
+    return 1;
+}
+
+static int64_t buffer_file_tell(MXFFileSysData *sys_data)
+{
+    return sys_data->position;
+}
+
+static int buffer_file_is_seekable(MXFFileSysData *sys_data)
+{
+    (void)sys_data;
+    return 1;
+}
+
+static int64_t buffer_file_size(MXFFileSysData *sys_data)
+{
+    return sys_data->file_position + sys_data->size;
+}
+
+static void free_buffer_file(MXFFileSysData *sys_data)
+{
+    delete sys_data;
+}
+
+
+MXFFile* bmx::mxf_buffer_file_open_read(const unsigned char *data, uint32_t size, int64_t file_position)
+{
+    MXFFile *buffer_file = 0;
+    try
+    {
+        // using malloc() because mxf_file_close will call free()
+        BMX_CHECK((buffer_file = (MXFFile*)malloc(sizeof(MXFFile))) != 0);
+        memset(buffer_file, 0, sizeof(MXFFile));
+
+        buffer_file->sysData = new MXFFileSysData;
+        memset(buffer_file->sysData, 0, sizeof(MXFFileSysData));
+
+        buffer_file->close         = buffer_file_close;
+        buffer_file->read          = buffer_file_read;
+        buffer_file->write         = buffer_file_write;
+        buffer_file->get_char      = buffer_file_getc;
+        buffer_file->put_char      = buffer_file_putc;
+        buffer_file->eof           = buffer_file_eof;
+        buffer_file->seek          = buffer_file_seek;
+        buffer_file->tell          = buffer_file_tell;
+        buffer_file->is_seekable   = buffer_file_is_seekable;
+        buffer_file->size          = buffer_file_size;
+        buffer_file->free_sys_data = free_buffer_file;
+
+        mxf_buffer_file_set_data(buffer_file, data, size, file_position);
+
+        return buffer_file;
+    }
+    catch (...)
+    {
+        if (buffer_file)
+            mxf_file_close(&buffer_file);
+        throw;
+    }
+}
+
+void bmx::mxf_buffer_file_set_data(MXFFile *buffer_file, const unsigned char *data, uint32_t size,
+                                   int64_t file_position)
+{
+    BMX_ASSERT(buffer_file->read == buffer_file_read);
+
+    buffer_file->sysData->data          = data;
+    buffer_file->sysData->size          = size;
+    buffer_file->sysData->file_position = file_position;
+    buffer_file->sysData->position      = file_position;
+    buffer_file->sysData->eof           = 0;
+}
@@ -40,6 +40,7 @@
 #include <mxf/mxf.h>
 
 #include <bmx/MXFChecksumFile.h>
+#include <bmx/ThreadedChecksum.h>
 #include <bmx/Logging.h>
 #include <bmx/BMXException.h>
 
@@ -57,7 +58,7 @@ struct MXFFileSysData
 {
     MXFChecksumFile checksum_file;
     MXFFile *target;
-    Checksum *checksum;
+    ThreadedChecksum *checksum;
     int64_t position;
     int64_t checksum_position;
     bool force_update;
@@ -312,7 +313,7 @@ MXFChecksumFile* bmx::mxf_checksum_file_open(MXFFile *target, ChecksumType type)
         memset(checksum_file->sysData, 0, sizeof(MXFFileSysData));
 
         checksum_file->sysData->target            = target;
-        checksum_file->sysData->checksum          = new Checksum(type);
+        checksum_file->sysData->checksum          = new ThreadedChecksum(type);
         checksum_file->sysData->position          = mxf_file_tell(target);
         checksum_file->sysData->checksum_position = 0;
         checksum_file->sysData->force_update      = false;
@@ -41,6 +41,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <vector>
+
 #include <curl/curl.h>
 
 #include <mxf/mxf.h>
@@ -54,37 +56,76 @@ using namespace std;
 using namespace bmx;
 
 
+#define HTTP_DEFAULT_BLOCK_SIZE     (64 * 1024)
+#define HTTP_MAX_TRANSFERS          4
+#define HTTP_MAX_TRANSFER_BLOCKS    8
+#define HTTP_MAX_READ_AHEAD         8
+#define HTTP_NUM_CACHE_BLOCKS       24
+
+
 typedef struct
 {
     MXFFile *mxf_file;
 } MXFHTTPFile;
 
+typedef enum
+{
+    HTTP_BLOCK_EMPTY,
+    HTTP_BLOCK_PENDING,
+    HTTP_BLOCK_READY,
+    HTTP_BLOCK_FAILED,
+} HTTPBlockState;
+
+// a block of the file in the cache
+typedef struct
+{
+    HTTPBlockState state;
+    int64_t index;
+    unsigned char *data;
+    uint32_t size;
+    int64_t last_access;
+    bool checked;
+    bool speculative;
+    CURLcode result;
+    long response_code;
+    bool accept_range_recv;
+    bool accept_bytes_range;
+    char error_buf[CURL_ERROR_SIZE];
+} HTTPBlock;
+
+// a byte range request that fills a run of consecutive blocks
+typedef struct
+{
+    MXFFileSysData *sys_data;
+    CURL *curl;
+    HTTPBlock *blocks[HTTP_MAX_TRANSFER_BLOCKS];
+    uint32_t num_blocks;
+    uint32_t block_num;
+    int64_t range_first;
+    bool accept_range_recv;
+    bool accept_bytes_range;
+    char error_buf[CURL_ERROR_SIZE];
+} HTTPTransfer;
+
 struct MXFFileSysData
 {
     MXFHTTPFile http_file;
     string url_str;
     CURL *curl;
+    CURLM *multi;
+    HTTPTransfer transfers[HTTP_MAX_TRANSFERS];
+    vector<HTTPTransfer*> free_transfers;
+    HTTPBlock blocks[HTTP_NUM_CACHE_BLOCKS];
+    uint32_t block_size;
+    int64_t access_count;
+    int64_t last_read_index;
+    uint32_t sequential_count;
+    int64_t known_file_size;
     int64_t position;
     int eof;
-    unsigned char *buffer;
-    uint32_t buffer_pos;
-    uint32_t buffer_size;
-    uint32_t buffer_alloc_size;
     bool disable_response_code_warn;
 };
 
-typedef struct
-{
-    MXFFileSysData *sys_data;
-    int64_t range_first;
-    int64_t range_last;
-    uint8_t *client_data;
-    uint32_t client_rem_count;
-    uint32_t read_count;
-    bool accept_range_recv;
-    bool accept_bytes_range;
-} CURLReceiveInfo;
-
 
 static size_t get_http_field_value_pos(const string &header_str, const string &field_name)
 {
@@ -115,26 +156,29 @@ static size_t curl_file_size_header_cb(char *buffer, size_t size, size_t nmemb,
 
 static size_t curl_header_cb(char *buffer, size_t size, size_t nmemb, void *priv)
 {
-  CURLReceiveInfo *info = (CURLReceiveInfo*)priv;
+  HTTPTransfer *transfer = (HTTPTransfer*)priv;
 
   const string header_str(buffer, size * nmemb);
 
   size_t fidx = get_http_field_value_pos(header_str, "Accept-Ranges");
   if (fidx != string::npos) {
-      info->accept_range_recv = true;
-      if (header_str.compare(fidx, 5, "bytes"))
-          info->accept_bytes_range = true;
+      transfer->accept_range_recv = true;
+      if (header_str.compare(fidx, 5, "bytes") == 0)
+          transfer->accept_bytes_range = true;
   }
 
   fidx = get_http_field_value_pos(header_str, "Content-Range");
   if (fidx != string::npos) {
-      int64_t first;
-      if (sscanf(&header_str.c_str()[fidx], "%" PRId64, &first) == 1) {
-          if (first != info->range_first) {
-              log_warn("HTTP content range start byte at %" PRId64 " does not match requested start byte at %" PRId64 "\n",
-                       first, info->range_first);
-          }
+      // the value has the form "bytes <first>-<last>/<complete length or *>"
+      int64_t first, last, complete_length;
+      int num_values = sscanf(&header_str.c_str()[fidx], "bytes %" PRId64 "-%" PRId64 "/%" PRId64,
+                              &first, &last, &complete_length);
+      if (num_values >= 1 && first != transfer->range_first) {
+          log_warn("HTTP content range start byte at %" PRId64 " does not match requested start byte at %" PRId64 "\n",
+                   first, transfer->range_first);
       }
+      if (num_values == 3)
+          transfer->sys_data->known_file_size = complete_length;
   }
 
   return size * nmemb;
@@ -142,134 +186,369 @@ static size_t curl_header_cb(char *buffer, size_t size, size_t nmemb, void *priv
 
 static size_t curl_data_cb(void* ptr, size_t size, size_t nmemb, void *priv)
 {
-  CURLReceiveInfo *info = (CURLReceiveInfo*)priv;
+  HTTPTransfer *transfer = (HTTPTransfer*)priv;
+  uint32_t block_size = transfer->sys_data->block_size;
 
   size_t rec_count = size * nmemb;
 
-  uint32_t client_copy_count = 0;
-  if (info->client_rem_count > 0) {
-      client_copy_count = info->client_rem_count;
-      if (client_copy_count > rec_count)
-          client_copy_count = (uint32_t)(rec_count);
-      memcpy(&info->client_data[info->read_count], ptr, client_copy_count);
-      info->client_rem_count   -= client_copy_count;
-      info->sys_data->position += client_copy_count;
-      info->read_count         += client_copy_count;
+  // returning a count less than rec_count results in CURLE_WRITE_ERROR, e.g. if the server
+  // ignored the range request and is returning the complete file
+  size_t copy_count = 0;
+  while (copy_count < rec_count && transfer->block_num < transfer->num_blocks) {
+      HTTPBlock *block = transfer->blocks[transfer->block_num];
+      uint32_t block_copy_count = block_size - block->size;
+      if (block_copy_count > rec_count - copy_count)
+          block_copy_count = (uint32_t)(rec_count - copy_count);
+      memcpy(&block->data[block->size], &((unsigned char*)ptr)[copy_count], block_copy_count);
+      block->size += block_copy_count;
+      copy_count  += block_copy_count;
+      if (block->size == block_size)
+          transfer->block_num++;
   }
 
-  uint32_t buf_copy_count = 0;
-  if (client_copy_count < rec_count) {
-      buf_copy_count = info->sys_data->buffer_alloc_size - info->sys_data->buffer_size;
-      if (buf_copy_count > rec_count - client_copy_count)
-          buf_copy_count = (uint32_t)(rec_count - client_copy_count);
-      memcpy(&info->sys_data->buffer[info->sys_data->buffer_size], &((unsigned char*)ptr)[client_copy_count], buf_copy_count);
-      info->sys_data->buffer_size += buf_copy_count;
-      info->read_count            += buf_copy_count;
-  }
+  return copy_count;
+}
+
+
+static void release_block(HTTPBlock *block)
+{
+    BMX_ASSERT(block->state != HTTP_BLOCK_PENDING);
+    block->state = HTTP_BLOCK_EMPTY;
+    block->index = -1;
+    block->size  = 0;
+}
+
+static void complete_transfer(MXFFileSysData *sys_data, HTTPTransfer *transfer, CURLcode result)
+{
+    long response_code = 0;
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &response_code);
+    curl_multi_remove_handle(sys_data->multi, transfer->curl);
+    sys_data->free_transfers.push_back(transfer);
+
+    // the data is valid if the server returned the complete file rather than a range starting at 0
+    bool complete_file_returned = (result == CURLE_WRITE_ERROR && transfer->range_first == 0 &&
+                                   (!transfer->accept_range_recv || !transfer->accept_bytes_range));
+
+    uint32_t i;
+    for (i = 0; i < transfer->num_blocks; i++) {
+        HTTPBlock *block = transfer->blocks[i];
+        if (result == CURLE_OK || result == CURLE_PARTIAL_FILE || complete_file_returned)
+            block->state = HTTP_BLOCK_READY;
+        else
+            block->state = HTTP_BLOCK_FAILED;
+        block->result             = result;
+        block->response_code      = response_code;
+        block->accept_range_recv  = transfer->accept_range_recv;
+        block->accept_bytes_range = transfer->accept_bytes_range;
+        memcpy(block->error_buf, transfer->error_buf, sizeof(block->error_buf));
+    }
+}
+
+static void run_transfers(MXFFileSysData *sys_data, bool wait)
+{
+    int running_count;
+    curl_multi_perform(sys_data->multi, &running_count);
+    if (wait && running_count > 0) {
+        curl_multi_wait(sys_data->multi, 0, 0, 1000, 0);
+        curl_multi_perform(sys_data->multi, &running_count);
+    }
+
+    CURLMsg *msg;
+    int msgs_in_queue;
+    while ((msg = curl_multi_info_read(sys_data->multi, &msgs_in_queue))) {
+        if (msg->msg != CURLMSG_DONE)
+            continue;
+
+        HTTPTransfer *transfer = 0;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+        BMX_ASSERT(transfer && transfer->curl == msg->easy_handle);
+        complete_transfer(sys_data, transfer, msg->data.result);
+    }
+}
+
+static HTTPBlock* find_block(MXFFileSysData *sys_data, int64_t index)
+{
+    size_t i;
+    for (i = 0; i < HTTP_NUM_CACHE_BLOCKS; i++) {
+        if (sys_data->blocks[i].state != HTTP_BLOCK_EMPTY && sys_data->blocks[i].index == index)
+            return &sys_data->blocks[i];
+    }
+
+    return 0;
+}
+
+static HTTPBlock* get_free_block(MXFFileSysData *sys_data, int64_t min_last_access)
+{
+    // use an empty block or else the least recently used block that is not being transferred
+    // and was accessed before min_last_access. The block data is allocated when the block is
+    // first used, after the empty blocks that already have data
+    HTTPBlock *unallocated_block = 0;
+    HTTPBlock *lru_block = 0;
+    size_t i;
+    for (i = 0; i < HTTP_NUM_CACHE_BLOCKS; i++) {
+        HTTPBlock *block = &sys_data->blocks[i];
+        if (block->state == HTTP_BLOCK_EMPTY) {
+            if (block->data)
+                return block;
+            if (!unallocated_block)
+                unallocated_block = block;
+        } else if (block->state != HTTP_BLOCK_PENDING && block->last_access < min_last_access &&
+                   (!lru_block || block->last_access < lru_block->last_access))
+        {
+            lru_block = block;
+        }
+    }
+
+    if (unallocated_block) {
+        unallocated_block->data = new unsigned char[sys_data->block_size];
+        return unallocated_block;
+    }
+
+    if (lru_block)
+        release_block(lru_block);
+
+    return lru_block;
+}
+
+// requests up to max_blocks consecutive blocks starting at index in a single range request,
+// stopping at the first block that is already in the cache. Requests that don't wait are read-ahead
+// requests and their blocks are marked as speculative
+static bool request_blocks(MXFFileSysData *sys_data, int64_t index, uint32_t max_blocks, bool wait)
+{
+    while (sys_data->free_transfers.empty()) {
+        if (!wait)
+            return false;
+        run_transfers(sys_data, true);
+    }
+
+    HTTPTransfer *transfer = sys_data->free_transfers.back();
+    int64_t min_last_access = sys_data->access_count;
+    transfer->num_blocks = 0;
+    while (transfer->num_blocks < max_blocks && transfer->num_blocks < HTTP_MAX_TRANSFER_BLOCKS) {
+        if (transfer->num_blocks > 0 && find_block(sys_data, index + transfer->num_blocks))
+            break;
+
+        HTTPBlock *block = get_free_block(sys_data, min_last_access);
+        while (!block && transfer->num_blocks == 0) {
+            if (!wait)
+                return false;
+            run_transfers(sys_data, true);
+            block = get_free_block(sys_data, min_last_access);
+        }
+        if (!block)
+            break;
+
+        block->state       = HTTP_BLOCK_PENDING;
+        block->index       = index + transfer->num_blocks;
+        block->size        = 0;
+        block->last_access = sys_data->access_count++;
+        block->checked     = false;
+        block->speculative = !wait;
+        transfer->blocks[transfer->num_blocks] = block;
+        transfer->num_blocks++;
+    }
+    sys_data->free_transfers.pop_back();
+
+    transfer->block_num          = 0;
+    transfer->range_first        = index * sys_data->block_size;
+    transfer->accept_range_recv  = false;
+    transfer->accept_bytes_range = false;
+    transfer->error_buf[0]       = 0;
+
+    int64_t range_last = transfer->range_first + (int64_t)transfer->num_blocks * sys_data->block_size - 1;
+    char range_buf[64];
+    bmx_snprintf(range_buf, sizeof(range_buf), "%" PRId64 "-%" PRId64, transfer->range_first, range_last);
+
+    CURL *curl = transfer->curl;
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (char*)transfer);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, transfer->error_buf);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1);
+    curl_easy_setopt(curl, CURLOPT_URL, sys_data->url_str.c_str());
+    curl_easy_setopt(curl, CURLOPT_RANGE, range_buf);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_data_cb);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)transfer);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, curl_header_cb);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void*)transfer);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1);
+    curl_multi_add_handle(sys_data->multi, curl);
+
+    return true;
+}
+
+static void request_missing_blocks(MXFFileSysData *sys_data, int64_t first_index, int64_t last_index,
+                                   uint32_t max_transfer_blocks)
+{
+    if (sys_data->known_file_size >= 0) {
+        int64_t file_last_index = (sys_data->known_file_size - 1) / sys_data->block_size;
+        if (last_index > file_last_index)
+            last_index = file_last_index;
+    }
+
+    int64_t index = first_index;
+    while (index <= last_index) {
+        if (find_block(sys_data, index)) {
+            index++;
+            continue;
+        }
+
+        uint32_t num_blocks = max_transfer_blocks;
+        if (num_blocks > last_index - index + 1)
+            num_blocks = (uint32_t)(last_index - index + 1);
+        if (!request_blocks(sys_data, index, num_blocks, false))
+            break;
+        index += num_blocks;
+    }
+}
+
+static bool check_block(MXFFileSysData *sys_data, HTTPBlock *block)
+{
+    while (block->state == HTTP_BLOCK_PENDING)
+        run_transfers(sys_data, true);
+
+    if (block->state == HTTP_BLOCK_FAILED) {
+        if (block->result == CURLE_WRITE_ERROR) {
+            if (!block->accept_range_recv || !block->accept_bytes_range)
+                log_error("HTTP server does not support byte range requests\n");
+            else
+                log_error("HTTP server returned more data than requested\n");
+        } else if (!(block->response_code == 416 && block->index > 0)) {
+            // a 416 (range not satisfiable) response for a block after the first indicates that
+            // the block starts beyond the end of the file
+            log_error("HTTP request failed: %s (curl result %d)\n", block->error_buf, block->result);
+        }
+        return false;
+    }
+
+    if (!block->checked) {
+        if (block->response_code != 206) { // 206 = partial content
+            if (!sys_data->disable_response_code_warn) {
+                if (block->result == CURLE_WRITE_ERROR || (block->accept_range_recv && !block->accept_bytes_range))
+                    log_warn("HTTP server does not support byte range requests\n");
+                else if (!block->accept_range_recv)
+                    log_warn("HTTP server does not indicate support for byte range requests\n");
+                else
+                    log_warn("Unexpected HTTP response code %ld\n", block->response_code);
+                sys_data->disable_response_code_warn = true;
+            }
+        } else {
+            sys_data->disable_response_code_warn = false;
+        }
+        block->checked = true;
+    }
 
-  return (size_t)client_copy_count + (size_t)buf_copy_count;
+    return true;
 }
 
 
 static void http_file_close(MXFFileSysData *sys_data)
 {
-    if (sys_data->curl)
+    size_t i;
+    for (i = 0; i < HTTP_MAX_TRANSFERS; i++) {
+        if (sys_data->transfers[i].curl) {
+            if (sys_data->multi)
+                curl_multi_remove_handle(sys_data->multi, sys_data->transfers[i].curl);
+            curl_easy_cleanup(sys_data->transfers[i].curl);
+            sys_data->transfers[i].curl = 0;
+        }
+    }
+    sys_data->free_transfers.clear();
+    for (i = 0; i < HTTP_NUM_CACHE_BLOCKS; i++) {
+        delete [] sys_data->blocks[i].data;
+        sys_data->blocks[i].data = 0;
+        sys_data->blocks[i].state = HTTP_BLOCK_EMPTY;
+    }
+    if (sys_data->multi) {
+        curl_multi_cleanup(sys_data->multi);
+        sys_data->multi = 0;
+    }
+    if (sys_data->curl) {
         curl_easy_cleanup(sys_data->curl);
-    delete [] sys_data->buffer;
+        sys_data->curl = 0;
+    }
 }
 
 static uint32_t http_file_read(MXFFileSysData *sys_data, uint8_t *data, uint32_t count)
 {
-    uint8_t *data_ptr  = data;
-    uint32_t rem_count = count;
+    uint32_t total_count = 0;
 
     sys_data->eof = 0;
+    if (count == 0)
+        return 0;
 
-    uint32_t buffer_copy_size = 0;
-    if (sys_data->buffer_pos < sys_data->buffer_size) {
-        buffer_copy_size = sys_data->buffer_size - sys_data->buffer_pos;
-        if (buffer_copy_size > rem_count)
-            buffer_copy_size = rem_count;
-        if (buffer_copy_size > 0) {
-            memcpy(data_ptr, &sys_data->buffer[sys_data->buffer_pos], buffer_copy_size);
-            sys_data->buffer_pos += buffer_copy_size;
-            sys_data->position   += buffer_copy_size;
-            data_ptr             += buffer_copy_size;
-            rem_count            -= buffer_copy_size;
+    // a read is sequential if it starts in the block where the previous read ended or the next one
+    int64_t first_index = sys_data->position / sys_data->block_size;
+    int64_t last_index  = (sys_data->position + count - 1) / sys_data->block_size;
+    if (first_index == sys_data->last_read_index || first_index == sys_data->last_read_index + 1)
+        sys_data->sequential_count++;
+    else
+        sys_data->sequential_count = 0;
+    sys_data->last_read_index = last_index;
+
+    int64_t refetch_index = -1;
+    while (total_count < count) {
+        int64_t index = sys_data->position / sys_data->block_size;
+
+        // request the blocks required for the read in a single request and, if the access
+        // pattern is sequential, read ahead in parallel requests. The read-ahead ramps up
+        // to the maximum with each sequential read
+        HTTPBlock *block = find_block(sys_data, index);
+        if (!block) {
+            int64_t max_blocks = last_index - index + 1;
+            if (max_blocks > HTTP_MAX_TRANSFER_BLOCKS)
+                max_blocks = HTTP_MAX_TRANSFER_BLOCKS;
+            request_blocks(sys_data, index, (uint32_t)max_blocks, true);
+            block = find_block(sys_data, index);
+            BMX_ASSERT(block);
+        }
+        block->last_access = sys_data->access_count++;
+        if (sys_data->sequential_count > 0) {
+            uint32_t read_ahead = sys_data->sequential_count;
+            if (read_ahead > HTTP_MAX_READ_AHEAD)
+                read_ahead = HTTP_MAX_READ_AHEAD;
+            request_missing_blocks(sys_data, index + 1, last_index + read_ahead,
+                                   (HTTP_MAX_READ_AHEAD + HTTP_MAX_TRANSFERS - 1) / HTTP_MAX_TRANSFERS);
         }
-    }
 
-    if (rem_count > 0) {
-        char error_buf[CURL_ERROR_SIZE];
-
-        sys_data->buffer_pos  = 0;
-        sys_data->buffer_size = 0;
-
-        CURLReceiveInfo info;
-        memset(&info, 0, sizeof(info));
-        info.sys_data         = sys_data;
-        info.client_data      = data_ptr;
-        info.client_rem_count = rem_count;
-        info.range_first      = sys_data->position;
-        info.range_last       = sys_data->position;
-        if (rem_count > sys_data->buffer_alloc_size)
-            info.range_last += rem_count - 1;
-        else
-            info.range_last += sys_data->buffer_alloc_size - 1;
-
-        char range_buf[64];
-        bmx_snprintf(range_buf, sizeof(range_buf), "%" PRId64 "-%" PRId64,
-                     info.range_first, info.range_last);
-
-        curl_easy_reset(sys_data->curl);
-        curl_easy_setopt(sys_data->curl, CURLOPT_ERRORBUFFER, error_buf);
-        curl_easy_setopt(sys_data->curl, CURLOPT_NOPROGRESS, 1);
-        curl_easy_setopt(sys_data->curl, CURLOPT_URL, sys_data->url_str.c_str());
-        curl_easy_setopt(sys_data->curl, CURLOPT_RANGE, range_buf);
-        curl_easy_setopt(sys_data->curl, CURLOPT_WRITEFUNCTION, curl_data_cb);
-        curl_easy_setopt(sys_data->curl, CURLOPT_WRITEDATA, (void*)&info);
-        curl_easy_setopt(sys_data->curl, CURLOPT_HEADERFUNCTION, curl_header_cb);
-        curl_easy_setopt(sys_data->curl, CURLOPT_HEADERDATA, (void*)&info);
-        curl_easy_setopt(sys_data->curl, CURLOPT_FAILONERROR, 1);
-
-        CURLcode result = curl_easy_perform(sys_data->curl);
-        rem_count = info.client_rem_count;
-
-        if (result != 0) {
-            if (result != CURLE_PARTIAL_FILE) {
-                if (result == CURLE_WRITE_ERROR) {
-                    if (!info.accept_range_recv || !info.accept_bytes_range) {
-                        if (info.range_first != 0)
-                            rem_count = count;
-                        bmx::log((info.range_first == 0 ? WARN_LOG: ERROR_LOG),
-                                 "HTTP server does not support byte range requests\n");
-                    } else {
-                        log_error("HTTP server returned more data than requested\n");
-                    }
-                } else {
-                    log_error("HTTP request failed: %s (curl result %d)\n", error_buf, result);
-                }
-            }
-        } else {
-            long code;
-            curl_easy_getinfo(sys_data->curl, CURLINFO_RESPONSE_CODE, &code);
-            if (code != 206) { // 206 = partial content
-                if (!sys_data->disable_response_code_warn) {
-                    if (info.accept_range_recv && !info.accept_bytes_range)
-                        log_warn("HTTP server does not support byte range requests\n");
-                    else if (!info.accept_range_recv)
-                        log_warn("HTTP server does not indicate support for byte range requests\n");
-                    else
-                        log_warn("Unexpected HTTP response code %ld\n", code);
-                    sys_data->disable_response_code_warn = true;
-                }
-            } else {
-                sys_data->disable_response_code_warn = false;
+        // a failed read-ahead block, e.g. from a dropped connection, is requested once more on demand
+        // before the failure is reported
+        if (block->speculative) {
+            while (block->state == HTTP_BLOCK_PENDING)
+                run_transfers(sys_data, true);
+            if (block->state == HTTP_BLOCK_FAILED) {
+                release_block(block);
+                continue;
             }
         }
+
+        if (!check_block(sys_data, block)) {
+            release_block(block);
+            break;
+        }
+
+        uint32_t block_offset = (uint32_t)(sys_data->position - index * sys_data->block_size);
+        if (block_offset >= block->size) {
+            // the read is beyond the end of a short block at the end of the file. Fetch the
+            // block once more in case the file is growing
+            release_block(block);
+            if (refetch_index == index)
+                break;
+            refetch_index = index;
+            continue;
+        }
+
+        uint32_t copy_count = block->size - block_offset;
+        if (copy_count > count - total_count)
+            copy_count = count - total_count;
+        memcpy(&data[total_count], &block->data[block_offset], copy_count);
+        sys_data->position += copy_count;
+        total_count        += copy_count;
     }
 
-    return count - rem_count;
+    // progress the read-ahead transfers
+    run_transfers(sys_data, false);
+
+    return total_count;
 }
 
 static uint32_t http_file_write(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
@@ -354,21 +633,7 @@ static int http_file_seek(MXFFileSysData *sys_data, int64_t offset, int whence)
         return 0;
     }
 
-    if (sys_data->position != new_position) {
-        int64_t pos_diff = new_position - sys_data->position;
-        if (sys_data->buffer_size > 0 &&
-            pos_diff >= - (int64_t)sys_data->buffer_pos &&
-            pos_diff < (int64_t)(sys_data->buffer_size - sys_data->buffer_pos))
-        {
-            sys_data->buffer_pos = (uint32_t)(sys_data->buffer_pos + pos_diff);
-        }
-        else
-        {
-            sys_data->buffer_size = 0;
-            sys_data->buffer_pos  = 0;
-        }
-        sys_data->position = new_position;
-    }
+    sys_data->position = new_position;
 
     sys_data->eof = false;
 
@@ -402,20 +667,27 @@ MXFFile* bmx::mxf_http_file_open_read(const string &url_str, uint32_t min_read_s
         memset(http_file, 0, sizeof(MXFFile));
 
         http_file->sysData = new MXFFileSysData;
-        http_file->sysData->http_file.mxf_file = http_file;
-        http_file->sysData->url_str = url_str;
-        http_file->sysData->curl = 0;
-        http_file->sysData->position = 0;
-        http_file->sysData->eof = false;
-        http_file->sysData->buffer = 0;
-        http_file->sysData->buffer_pos = 0;
-        http_file->sysData->buffer_size = 0;
-        http_file->sysData->buffer_alloc_size = 0;
-
-        BMX_CHECK((http_file->sysData->curl = curl_easy_init()) != 0);
-        if (min_read_size > 0) {
-            http_file->sysData->buffer            = new unsigned char[min_read_size];
-            http_file->sysData->buffer_alloc_size = min_read_size;
+        MXFFileSysData *sys_data = http_file->sysData;
+        sys_data->http_file.mxf_file = http_file;
+        sys_data->url_str = url_str;
+        sys_data->curl = 0;
+        sys_data->multi = 0;
+        sys_data->block_size = (min_read_size > 0 ? min_read_size : HTTP_DEFAULT_BLOCK_SIZE);
+        sys_data->access_count = 0;
+        sys_data->last_read_index = -1;
+        sys_data->sequential_count = 0;
+        sys_data->known_file_size = -1;
+        sys_data->position = 0;
+        sys_data->eof = false;
+        sys_data->disable_response_code_warn = false;
+        size_t i;
+        memset(sys_data->transfers, 0, sizeof(sys_data->transfers));
+        for (i = 0; i < HTTP_MAX_TRANSFERS; i++)
+            sys_data->transfers[i].sys_data = sys_data;
+        memset(sys_data->blocks, 0, sizeof(sys_data->blocks));
+        for (i = 0; i < HTTP_NUM_CACHE_BLOCKS; i++) {
+            sys_data->blocks[i].state = HTTP_BLOCK_EMPTY;
+            sys_data->blocks[i].index = -1;
         }
 
         http_file->close         = http_file_close;
@@ -430,6 +702,13 @@ MXFFile* bmx::mxf_http_file_open_read(const string &url_str, uint32_t min_read_s
         http_file->size          = http_file_size;
         http_file->free_sys_data = free_http_file;
 
+        BMX_CHECK((sys_data->curl = curl_easy_init()) != 0);
+        BMX_CHECK((sys_data->multi = curl_multi_init()) != 0);
+        for (i = 0; i < HTTP_MAX_TRANSFERS; i++) {
+            BMX_CHECK((sys_data->transfers[i].curl = curl_easy_init()) != 0);
+            sys_data->free_transfers.push_back(&sys_data->transfers[i]);
+        }
+
         return http_file;
     }
     catch (...)
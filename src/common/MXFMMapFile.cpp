@@ -0,0 +1,473 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && !defined(_WIN32)
+
+#define __STDC_FORMAT_MACROS
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <mxf/mxf.h>
+
+#include <bmx/MXFMMapFile.h>
+#include <bmx/Utils.h>
+#include <bmx/Logging.h>
+#include <bmx/BMXException.h>
+
+using namespace std;
+using namespace bmx;
+
+
+struct MXFFileSysData
+{
+    int fd;
+    bool writable;
+    int64_t position;
+    int64_t file_size;      // size of the file's data, i.e. excluding extension beyond the written data
+    int64_t extent_size;    // size the output file has been extended to
+    bool use_pwrite;        // output is written using pwrite() because the file blocks can't be reserved
+    int eof;
+    unsigned char *window;
+    int64_t window_offset;
+    size_t window_size;
+    size_t max_window_size;
+    size_t page_size;
+};
+
+
+static int64_t get_fd_size(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return -1;
+
+    return st.st_size;
+}
+
+static bool position_in_window(MXFFileSysData *sys_data)
+{
+    return sys_data->window &&
+           sys_data->position >= sys_data->window_offset &&
+           sys_data->position < sys_data->window_offset + (int64_t)sys_data->window_size;
+}
+
+static void unmap_window(MXFFileSysData *sys_data)
+{
+    if (sys_data->window) {
+        munmap(sys_data->window, sys_data->window_size);
+        sys_data->window        = 0;
+        sys_data->window_offset = 0;
+        sys_data->window_size   = 0;
+    }
+}
+
+static bool map_window(MXFFileSysData *sys_data, int64_t limit)
+{
+    unmap_window(sys_data);
+
+    int64_t offset = sys_data->position - (sys_data->position % sys_data->page_size);
+    if (offset >= limit)
+        return false;
+
+    size_t size = sys_data->max_window_size;
+    if ((int64_t)size > limit - offset)
+        size = (size_t)(limit - offset);
+
+    void *window = mmap(0, size, (sys_data->writable ? PROT_READ | PROT_WRITE : PROT_READ), MAP_SHARED,
+                        sys_data->fd, (off_t)offset);
+    if (window == MAP_FAILED) {
+        log_error("Failed to memory map %" PRIszt " bytes at file offset %" PRId64 ": %s\n",
+                  size, offset, bmx_strerror(errno).c_str());
+        return false;
+    }
+
+    if (!sys_data->writable) {
+#ifdef HAVE_MADVISE
+        // hint that the window will be read sequentially and start reading it in now
+        madvise(window, size, MADV_SEQUENTIAL);
+        madvise(window, size, MADV_WILLNEED);
+#endif
+#ifdef HAVE_POSIX_FADVISE
+        // start reading the next window into the page cache
+        posix_fadvise(sys_data->fd, (off_t)(offset + size), (off_t)sys_data->max_window_size, POSIX_FADV_WILLNEED);
+#endif
+    }
+
+    sys_data->window        = (unsigned char*)window;
+    sys_data->window_offset = offset;
+    sys_data->window_size   = size;
+
+    return true;
+}
+
+static bool extend_file(MXFFileSysData *sys_data, int64_t min_size)
+{
+    int64_t new_extent_size = min_size + sys_data->max_window_size - 1;
+    new_extent_size -= new_extent_size % sys_data->max_window_size;
+
+#ifdef HAVE_POSIX_FALLOCATE
+    // the blocks are reserved rather than leaving a sparse extension so that a full disk results in a write
+    // error rather than a SIGBUS when a mapped page is written
+    int result = posix_fallocate(sys_data->fd, (off_t)sys_data->extent_size,
+                                 (off_t)(new_extent_size - sys_data->extent_size));
+    if (result == 0) {
+        sys_data->extent_size = new_extent_size;
+        return true;
+    } else if (result != EINVAL && result != EOPNOTSUPP) {
+        log_error("Failed to extend memory mapped file to %" PRId64 " bytes: %s\n",
+                  new_extent_size, bmx_strerror(result).c_str());
+        return false;
+    }
+#endif
+
+    // the blocks can't be reserved and so the output is written using pwrite()
+    unmap_window(sys_data);
+    sys_data->use_pwrite = true;
+
+    return true;
+}
+
+static uint32_t pwrite_file(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
+{
+    uint32_t total_write = 0;
+    while (total_write < count) {
+        ssize_t result = pwrite(sys_data->fd, &data[total_write], count - total_write, (off_t)sys_data->position);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0) {
+            if (result < 0)
+                log_error("Failed to write to file: %s\n", bmx_strerror(errno).c_str());
+            break;
+        }
+
+        sys_data->position += result;
+        total_write        += (uint32_t)result;
+        if (sys_data->position > sys_data->file_size)
+            sys_data->file_size = sys_data->position;
+    }
+
+    // windows used for reading are limited to the written data
+    sys_data->extent_size = sys_data->file_size;
+
+    return total_write;
+}
+
+
+static void mmap_file_close(MXFFileSysData *sys_data)
+{
+    unmap_window(sys_data);
+
+    if (sys_data->fd >= 0) {
+        // a failed reservation could have extended the file
+        if (sys_data->writable && get_fd_size(sys_data->fd) != sys_data->file_size) {
+            if (ftruncate(sys_data->fd, (off_t)sys_data->file_size) != 0) {
+                log_error("Failed to truncate memory mapped file to %" PRId64 " bytes: %s\n",
+                          sys_data->file_size, bmx_strerror(errno).c_str());
+            }
+        }
+        close(sys_data->fd);
+        sys_data->fd = -1;
+    }
+}
+
+static uint32_t mmap_file_read(MXFFileSysData *sys_data, uint8_t *data, uint32_t count)
+{
+    uint32_t total_read = 0;
+    while (total_read < count) {
+        if (sys_data->position >= sys_data->file_size && !sys_data->writable) {
+            // the file could be growing
+            int64_t file_size = get_fd_size(sys_data->fd);
+            if (file_size > sys_data->file_size)
+                sys_data->file_size = file_size;
+        }
+        if (sys_data->position >= sys_data->file_size) {
+            sys_data->eof = 1;
+            break;
+        }
+
+        if (!position_in_window(sys_data) &&
+            !map_window(sys_data, (sys_data->writable ? sys_data->extent_size : sys_data->file_size)))
+        {
+            break;
+        }
+
+        int64_t avail_end = sys_data->window_offset + (int64_t)sys_data->window_size;
+        if (avail_end > sys_data->file_size)
+            avail_end = sys_data->file_size;
+
+        uint32_t copy_count = count - total_read;
+        if ((int64_t)copy_count > avail_end - sys_data->position)
+            copy_count = (uint32_t)(avail_end - sys_data->position);
+
+        memcpy(&data[total_read], &sys_data->window[sys_data->position - sys_data->window_offset], copy_count);
+        sys_data->position += copy_count;
+        total_read         += copy_count;
+    }
+
+    return total_read;
+}
+
+static uint32_t mmap_file_write(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
+{
+    if (!sys_data->writable)
+        return 0;
+
+    uint32_t total_write = 0;
+    while (total_write < count) {
+        if (sys_data->use_pwrite)
+            return total_write + pwrite_file(sys_data, &data[total_write], count - total_write);
+
+        if (sys_data->position >= sys_data->extent_size) {
+            if (!extend_file(sys_data, sys_data->position + (count - total_write)))
+                break;
+            continue; // the output could have switched to pwrite()
+        }
+
+        if (!position_in_window(sys_data) && !map_window(sys_data, sys_data->extent_size))
+            break;
+
+        uint32_t copy_count = count - total_write;
+        int64_t avail = sys_data->window_offset + (int64_t)sys_data->window_size - sys_data->position;
+        if ((int64_t)copy_count > avail)
+            copy_count = (uint32_t)avail;
+
+        memcpy(&sys_data->window[sys_data->position - sys_data->window_offset], &data[total_write], copy_count);
+        sys_data->position += copy_count;
+        total_write        += copy_count;
+        if (sys_data->position > sys_data->file_size)
+            sys_data->file_size = sys_data->position;
+    }
+
+    return total_write;
+}
+
+static int mmap_file_getc(MXFFileSysData *sys_data)
+{
+    uint8_t data;
+    if (mmap_file_read(sys_data, &data, 1) != 1)
+        return EOF;
+
+    return data;
+}
+
+static int mmap_file_putc(MXFFileSysData *sys_data, int c)
+{
+    uint8_t data = (uint8_t)c;
+    if (mmap_file_write(sys_data, &data, 1) != 1)
+        return EOF;
+
+    return c;
+}
+
+static int mmap_file_eof(MXFFileSysData *sys_data)
+{
+    return sys_data->eof;
+}
+
+static int64_t mmap_file_size(MXFFileSysData *sys_data)
+{
+    if (!sys_data->writable) {
+        int64_t file_size = get_fd_size(sys_data->fd);
+        if (file_size > sys_data->file_size)
+            sys_data->file_size = file_size;
+    }
+
+    return sys_data->file_size;
+}
+
+static int mmap_file_seek(MXFFileSysData *sys_data, int64_t offset, int whence)
+{
+    int64_t new_position;
+    if (whence == SEEK_CUR)
+        new_position = sys_data->position + offset;
+    else if (whence == SEEK_SET)
+        new_position = offset;
+    else if (whence == SEEK_END)
+        new_position = mmap_file_size(sys_data) + offset;
+    else
+        return 0;
+
+    if (new_position < 0)
+        return 0;
+
+    sys_data->position = new_position;
+    sys_data->eof      = 0;
+
+    return 1;
+}
+
+static int64_t mmap_file_tell(MXFFileSysData *sys_data)
+{
+    return sys_data->position;
+}
+
+static int mmap_file_is_seekable(MXFFileSysData *sys_data)
+{
+    (void)sys_data;
+    return 1;
+}
+
+static void free_mmap_file(MXFFileSysData *sys_data)
+{
+    delete sys_data;
+}
+
+
+static MXFFile* open_mmap_file(const string &filename, int flags, uint32_t window_size)
+{
+    MXFFile *mmap_file = 0;
+    try
+    {
+        // using malloc() because mxf_file_close will call free()
+        BMX_CHECK((mmap_file = (MXFFile*)malloc(sizeof(MXFFile))) != 0);
+        memset(mmap_file, 0, sizeof(MXFFile));
+
+        mmap_file->sysData = new MXFFileSysData;
+        memset(mmap_file->sysData, 0, sizeof(MXFFileSysData));
+        mmap_file->sysData->fd       = -1;
+        mmap_file->sysData->writable = ((flags & O_ACCMODE) != O_RDONLY);
+
+        long sys_page_size = sysconf(_SC_PAGESIZE);
+        BMX_CHECK(sys_page_size > 0);
+        size_t page_size = (size_t)sys_page_size;
+        mmap_file->sysData->page_size = page_size;
+        if (window_size < page_size)
+            mmap_file->sysData->max_window_size = page_size;
+        else
+            mmap_file->sysData->max_window_size = (window_size + page_size - 1) / page_size * page_size;
+
+        mmap_file->close         = mmap_file_close;
+        mmap_file->read          = mmap_file_read;
+        mmap_file->write         = mmap_file_write;
+        mmap_file->get_char      = mmap_file_getc;
+        mmap_file->put_char      = mmap_file_putc;
+        mmap_file->eof           = mmap_file_eof;
+        mmap_file->seek          = mmap_file_seek;
+        mmap_file->tell          = mmap_file_tell;
+        mmap_file->is_seekable   = mmap_file_is_seekable;
+        mmap_file->size          = mmap_file_size;
+        mmap_file->free_sys_data = free_mmap_file;
+
+        mmap_file->sysData->fd = open(filename.c_str(), flags, 0666);
+        if (mmap_file->sysData->fd < 0) {
+            BMX_EXCEPTION(("Failed to open file '%s' for memory mapped access: %s",
+                           filename.c_str(), bmx_strerror(errno).c_str()));
+        }
+
+        int64_t file_size = get_fd_size(mmap_file->sysData->fd);
+        BMX_CHECK(file_size >= 0);
+        mmap_file->sysData->file_size   = file_size;
+        mmap_file->sysData->extent_size = file_size;
+
+        return mmap_file;
+    }
+    catch (...)
+    {
+        if (mmap_file)
+            mxf_file_close(&mmap_file);
+        throw;
+    }
+}
+
+
+bool bmx::mxf_mmap_is_supported()
+{
+    return true;
+}
+
+MXFFile* bmx::mxf_mmap_file_open_read(const string &filename, uint32_t window_size)
+{
+    return open_mmap_file(filename, O_RDONLY, window_size);
+}
+
+MXFFile* bmx::mxf_mmap_file_open_new(const string &filename, uint32_t window_size)
+{
+    return open_mmap_file(filename, O_RDWR | O_CREAT | O_TRUNC, window_size);
+}
+
+MXFFile* bmx::mxf_mmap_file_open_modify(const string &filename, uint32_t window_size)
+{
+    return open_mmap_file(filename, O_RDWR, window_size);
+}
+
+
+#else // if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && !defined(_WIN32)
+
+
+#include <mxf/mxf.h>
+
+#include <bmx/MXFMMapFile.h>
+#include <bmx/Logging.h>
+#include <bmx/BMXException.h>
+
+using namespace std;
+using namespace bmx;
+
+
+bool bmx::mxf_mmap_is_supported()
+{
+    return false;
+}
+
+MXFFile* bmx::mxf_mmap_file_open_read(const string &filename, uint32_t window_size)
+{
+    (void)filename;
+    (void)window_size;
+    BMX_EXCEPTION(("Memory mapped file access is not supported in this build"));
+}
+
+MXFFile* bmx::mxf_mmap_file_open_new(const string &filename, uint32_t window_size)
+{
+    (void)filename;
+    (void)window_size;
+    BMX_EXCEPTION(("Memory mapped file access is not supported in this build"));
+}
+
+MXFFile* bmx::mxf_mmap_file_open_modify(const string &filename, uint32_t window_size)
+{
+    (void)filename;
+    (void)window_size;
+    BMX_EXCEPTION(("Memory mapped file access is not supported in this build"));
+}
+
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+#include <mxf/mxf.h>
+
+#include <bmx/MXFStatsFile.h>
+#include <bmx/Stats.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+struct MXFFileSysData
+{
+    MXFFile *target;
+};
+
+
+static void stats_file_close(MXFFileSysData *sys_data)
+{
+    if (sys_data->target)
+        mxf_file_close(&sys_data->target);
+}
+
+static uint32_t stats_file_read(MXFFileSysData *sys_data, uint8_t *data, uint32_t count)
+{
+    StatsTimer timer(STATS_FILE_READ);
+    uint32_t result = mxf_file_read(sys_data->target, data, count);
+    timer.AddBytes(result);
+    return result;
+}
+
+static uint32_t stats_file_write(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
+{
+    StatsTimer timer(STATS_FILE_WRITE);
+    uint32_t result = mxf_file_write(sys_data->target, data, count);
+    timer.AddBytes(result);
+    return result;
+}
+
+static int stats_file_getc(MXFFileSysData *sys_data)
+{
+    // single bytes are not timed because the timer overhead would dominate
+    return mxf_file_getc(sys_data->target);
+}
+
+static int stats_file_putc(MXFFileSysData *sys_data, int c)
+{
+    return mxf_file_putc(sys_data->target, c);
+}
+
+static int stats_file_eof(MXFFileSysData *sys_data)
+{
+    return mxf_file_eof(sys_data->target);
+}
+
+static int stats_file_seek(MXFFileSysData *sys_data, int64_t offset, int whence)
+{
+    StatsTimer timer(STATS_FILE_SEEK);
+    return mxf_file_seek(sys_data->target, offset, whence);
+}
+
+static int64_t stats_file_tell(MXFFileSysData *sys_data)
+{
+    return mxf_file_tell(sys_data->target);
+}
+
+static int stats_file_is_seekable(MXFFileSysData *sys_data)
+{
+    return mxf_file_is_seekable(sys_data->target);
+}
+
+static int64_t stats_file_size(MXFFileSysData *sys_data)
+{
+    return mxf_file_size(sys_data->target);
+}
+
+static void free_stats_file(MXFFileSysData *sys_data)
+{
+    free(sys_data);
+}
+
+
+MXFFile* bmx::mxf_stats_file_open(MXFFile *target)
+{
+    MXFFile *stats_file = 0;
+    try
+    {
+        // using malloc() because mxf_file_close will call free()
+        BMX_CHECK((stats_file = (MXFFile*)malloc(sizeof(MXFFile))) != 0);
+        memset(stats_file, 0, sizeof(MXFFile));
+        BMX_CHECK((stats_file->sysData = (MXFFileSysData*)malloc(sizeof(MXFFileSysData))) != 0);
+        memset(stats_file->sysData, 0, sizeof(MXFFileSysData));
+
+        stats_file->sysData->target = target;
+
+        stats_file->close         = stats_file_close;
+        stats_file->read          = stats_file_read;
+        stats_file->write         = stats_file_write;
+        stats_file->get_char      = stats_file_getc;
+        stats_file->put_char      = stats_file_putc;
+        stats_file->eof           = stats_file_eof;
+        stats_file->seek          = stats_file_seek;
+        stats_file->tell          = stats_file_tell;
+        stats_file->is_seekable   = stats_file_is_seekable;
+        stats_file->size          = stats_file_size;
+        stats_file->free_sys_data = free_stats_file;
+
+        stats_file->minLLen       = target->minLLen;
+        stats_file->runinLen      = target->runinLen;
+
+        return stats_file;
+    }
+    catch (...)
+    {
+        if (stats_file) {
+            if (stats_file->sysData)
+                stats_file->sysData->target = 0; // ownership returns to the caller
+            mxf_file_close(&stats_file);
+        }
+        throw;
+    }
+}
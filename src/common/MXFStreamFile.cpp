@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#define __STDC_FORMAT_MACROS
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include <mxf/mxf.h>
+
+#include <bmx/MXFStreamFile.h>
+#include <bmx/Utils.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#define STREAM_BUFFER_SIZE  (256 * 1024)
+
+
+struct MXFFileSysData
+{
+    FILE *file;
+    bool is_stdout;
+    int64_t position;
+};
+
+
+static void stream_file_close(MXFFileSysData *sys_data)
+{
+    if (!sys_data->file)
+        return;
+
+    if (fflush(sys_data->file) != 0)
+        log_error("Failed to flush stream output: %s\n", bmx_strerror(errno).c_str());
+    if (!sys_data->is_stdout)
+        fclose(sys_data->file);
+    sys_data->file = 0;
+}
+
+static uint32_t stream_file_read(MXFFileSysData *sys_data, uint8_t *data, uint32_t count)
+{
+    (void)sys_data;
+    (void)data;
+    (void)count;
+
+    return 0;
+}
+
+static uint32_t stream_file_write(MXFFileSysData *sys_data, const uint8_t *data, uint32_t count)
+{
+    uint32_t result = (uint32_t)fwrite(data, 1, count, sys_data->file);
+    sys_data->position += result;
+
+    return result;
+}
+
+static int stream_file_getc(MXFFileSysData *sys_data)
+{
+    (void)sys_data;
+
+    return EOF;
+}
+
+static int stream_file_putc(MXFFileSysData *sys_data, int c)
+{
+    int result = fputc(c, sys_data->file);
+    if (result != EOF)
+        sys_data->position++;
+
+    return result;
+}
+
+static int stream_file_eof(MXFFileSysData *sys_data)
+{
+    (void)sys_data;
+
+    return 1;
+}
+
+static int stream_file_seek(MXFFileSysData *sys_data, int64_t offset, int whence)
+{
+    int64_t new_position;
+    if (whence == SEEK_SET)
+        new_position = offset;
+    else if (whence == SEEK_CUR)
+        new_position = sys_data->position + offset;
+    else
+        new_position = -1;
+
+    if (new_position != sys_data->position) {
+        log_error("Seek to offset %" PRId64 " from output position %" PRId64 " is not possible in a stream\n",
+                  offset, sys_data->position);
+        return 0;
+    }
+
+    // as with fseek(), write the buffered output
+    if (fflush(sys_data->file) != 0) {
+        log_error("Failed to flush stream output: %s\n", bmx_strerror(errno).c_str());
+        return 0;
+    }
+
+    return 1;
+}
+
+static int64_t stream_file_tell(MXFFileSysData *sys_data)
+{
+    return sys_data->position;
+}
+
+static int stream_file_is_seekable(MXFFileSysData *sys_data)
+{
+    (void)sys_data;
+
+    return 0;
+}
+
+static int64_t stream_file_size(MXFFileSysData *sys_data)
+{
+    return sys_data->position;
+}
+
+static void free_stream_file(MXFFileSysData *sys_data)
+{
+    free(sys_data);
+}
+
+static MXFFile* open_stream_file(FILE *file, bool is_stdout)
+{
+    MXFFile *stream_file = 0;
+    try
+    {
+        // using malloc() because mxf_file_close will call free()
+        BMX_CHECK((stream_file = (MXFFile*)malloc(sizeof(MXFFile))) != 0);
+        memset(stream_file, 0, sizeof(MXFFile));
+        BMX_CHECK((stream_file->sysData = (MXFFileSysData*)malloc(sizeof(MXFFileSysData))) != 0);
+        memset(stream_file->sysData, 0, sizeof(MXFFileSysData));
+
+        stream_file->sysData->file      = file;
+        stream_file->sysData->is_stdout = is_stdout;
+        stream_file->sysData->position  = 0;
+
+        stream_file->close         = stream_file_close;
+        stream_file->read          = stream_file_read;
+        stream_file->write         = stream_file_write;
+        stream_file->get_char      = stream_file_getc;
+        stream_file->put_char      = stream_file_putc;
+        stream_file->eof           = stream_file_eof;
+        stream_file->seek          = stream_file_seek;
+        stream_file->tell          = stream_file_tell;
+        stream_file->is_seekable   = stream_file_is_seekable;
+        stream_file->size          = stream_file_size;
+        stream_file->free_sys_data = free_stream_file;
+
+        return stream_file;
+    }
+    catch (...)
+    {
+        if (stream_file) {
+            if (stream_file->sysData)
+                stream_file->sysData->file = 0; // ownership returns to the caller
+            mxf_file_close(&stream_file);
+        }
+        throw;
+    }
+}
+
+
+
+bool bmx::mxf_stream_file_is_stream(const string &filename)
+{
+    if (filename == "-")
+        return true;
+
+#if defined(_WIN32)
+    return false;
+#else
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+
+    // character devices such as /dev/null are seekable and keep using the disk file
+    return S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode);
+#endif
+}
+
+MXFFile* bmx::mxf_stream_file_open_stdout()
+{
+#if defined(_WIN32)
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    setvbuf(stdout, 0, _IOFBF, STREAM_BUFFER_SIZE);
+
+    return open_stream_file(stdout, true);
+}
+
+MXFFile* bmx::mxf_stream_file_open_new(const string &filename)
+{
+    if (filename == "-")
+        return mxf_stream_file_open_stdout();
+
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (!file)
+        BMX_EXCEPTION(("Failed to open stream '%s' for writing: %s", filename.c_str(), bmx_strerror(errno).c_str()));
+    setvbuf(file, 0, _IOFBF, STREAM_BUFFER_SIZE);
+
+    try
+    {
+        return open_stream_file(file, false);
+    }
+    catch (...)
+    {
+        fclose(file);
+        throw;
+    }
+}
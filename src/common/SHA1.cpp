@@ -40,6 +40,9 @@
 // * Changed 'unsigned long' to 'uint32_t' (otherwise calculation is
 //   wrong)
 // * Changed sha1_update 'len' parameter type to 'uint32_t'
+// * Made the sha1_transform workspace a local variable so that contexts can be
+//   used in separate threads
+// * Added a SHA extensions (SHA-NI) transform that is selected at runtime
 
 
 #ifdef HAVE_CONFIG_H
@@ -50,12 +53,24 @@
 #include <cstring>
 #include <cerrno>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_SHA1_SHANI_KERNEL  1
+#define SHA1_SHANI_TARGET       __attribute__((target("sha,ssse3,sse4.1")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define HAVE_SHA1_SHANI_KERNEL  1
+#define SHA1_SHANI_TARGET
+#endif
+
 #include <bmx/SHA1.h>
+#include <bmx/CPUFeatures.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
 
 using namespace std;
+using namespace bmx;
 
 
 #define SHA1HANDSOFF /* Copies data before messing with it. */
@@ -93,7 +108,7 @@ typedef union {
 } CHAR64LONG16;
 CHAR64LONG16* block;
 #ifdef SHA1HANDSOFF
-static unsigned char workspace[64];
+unsigned char workspace[64];
     block = (CHAR64LONG16*)workspace;
     memcpy(block, buffer, 64);
 #else
@@ -137,6 +152,96 @@ static unsigned char workspace[64];
 }
 
 
+#if defined(HAVE_SHA1_SHANI_KERNEL)
+
+static const bool HAVE_SHANI_SUPPORT = cpu_supports_sha();
+
+/* 4 rounds using the SHA extensions. The message words for rounds 16 to 79 are
+   derived from the previous 16 in msg[], which is updated in place */
+
+template <int FUNC, bool LOAD, bool SCHEDULE>
+SHA1_SHANI_TARGET
+static inline void sha1_shani_rounds4(__m128i *abcd, __m128i *e_in, __m128i *e_out, __m128i msg[4], int i,
+                                      const unsigned char *data, const __m128i &byte_swap)
+{
+    if (LOAD) {
+        msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), byte_swap);
+    } else if (SCHEDULE) {
+        msg[i] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(msg[i], msg[(i + 1) & 3]),
+                                                  msg[(i + 2) & 3]),
+                                    msg[(i + 3) & 3]);
+    }
+
+    if (i == 0 && LOAD)
+        *e_in = _mm_add_epi32(*e_in, msg[0]);
+    else
+        *e_in = _mm_sha1nexte_epu32(*e_in, msg[i]);
+    *e_out = *abcd;
+    *abcd = _mm_sha1rnds4_epu32(*abcd, *e_in, FUNC);
+}
+
+SHA1_SHANI_TARGET
+static void sha1_transform_shani(uint32_t state[5], const unsigned char *data, size_t num_blocks)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+    __m128i abcd, abcd_save, e0, e0_save, e1;
+    __m128i msg[4];
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state), 0x1b);
+    e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+    e1 = _mm_setzero_si128();
+
+    for (; num_blocks > 0; num_blocks--, data += 64) {
+        abcd_save = abcd;
+        e0_save = e0;
+
+        sha1_shani_rounds4<0, true,  false>(&abcd, &e0, &e1, msg, 0, data, byte_swap);
+        sha1_shani_rounds4<0, true,  false>(&abcd, &e1, &e0, msg, 1, data, byte_swap);
+        sha1_shani_rounds4<0, true,  false>(&abcd, &e0, &e1, msg, 2, data, byte_swap);
+        sha1_shani_rounds4<0, true,  false>(&abcd, &e1, &e0, msg, 3, data, byte_swap);
+        sha1_shani_rounds4<0, false, true >(&abcd, &e0, &e1, msg, 0, data, byte_swap);
+        sha1_shani_rounds4<1, false, true >(&abcd, &e1, &e0, msg, 1, data, byte_swap);
+        sha1_shani_rounds4<1, false, true >(&abcd, &e0, &e1, msg, 2, data, byte_swap);
+        sha1_shani_rounds4<1, false, true >(&abcd, &e1, &e0, msg, 3, data, byte_swap);
+        sha1_shani_rounds4<1, false, true >(&abcd, &e0, &e1, msg, 0, data, byte_swap);
+        sha1_shani_rounds4<1, false, true >(&abcd, &e1, &e0, msg, 1, data, byte_swap);
+        sha1_shani_rounds4<2, false, true >(&abcd, &e0, &e1, msg, 2, data, byte_swap);
+        sha1_shani_rounds4<2, false, true >(&abcd, &e1, &e0, msg, 3, data, byte_swap);
+        sha1_shani_rounds4<2, false, true >(&abcd, &e0, &e1, msg, 0, data, byte_swap);
+        sha1_shani_rounds4<2, false, true >(&abcd, &e1, &e0, msg, 1, data, byte_swap);
+        sha1_shani_rounds4<2, false, true >(&abcd, &e0, &e1, msg, 2, data, byte_swap);
+        sha1_shani_rounds4<3, false, true >(&abcd, &e1, &e0, msg, 3, data, byte_swap);
+        sha1_shani_rounds4<3, false, true >(&abcd, &e0, &e1, msg, 0, data, byte_swap);
+        sha1_shani_rounds4<3, false, true >(&abcd, &e1, &e0, msg, 1, data, byte_swap);
+        sha1_shani_rounds4<3, false, true >(&abcd, &e0, &e1, msg, 2, data, byte_swap);
+        sha1_shani_rounds4<3, false, true >(&abcd, &e1, &e0, msg, 3, data, byte_swap);
+
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+#endif
+
+
+static void sha1_transform_blocks(uint32_t state[5], const unsigned char *data, size_t num_blocks)
+{
+#if defined(HAVE_SHA1_SHANI_KERNEL)
+    if (HAVE_SHANI_SUPPORT) {
+        sha1_transform_shani(state, data, num_blocks);
+        return;
+    }
+#endif
+
+    size_t i;
+    for (i = 0; i < num_blocks; i++)
+        sha1_transform(state, &data[i * 64]);
+}
+
+
 /* sha1_init - Initialize new context */
 
 void bmx::sha1_init(SHA1Context *context)
@@ -162,9 +267,10 @@ size_t i, j;
     context->count[1] += (len >> 29);
     if ((j + len) > 63) {
         memcpy(&context->buffer[j], data, (i = 64-j));
-        sha1_transform(context->state, context->buffer);
-        for ( ; i + 63 < len; i += 64) {
-            sha1_transform(context->state, &data[i]);
+        sha1_transform_blocks(context->state, context->buffer, 1);
+        if (i + 63 < len) {
+            sha1_transform_blocks(context->state, &data[i], (len - i) / 64);
+            i += ((len - i) / 64) * 64;
         }
         j = 0;
     }
@@ -199,9 +305,6 @@ unsigned char finalcount[8];
     memset(context->state, 0, 20);
     memset(context->count, 0, 8);
     memset(&finalcount, 0, 8);
-#ifdef SHA1HANDSOFF  /* make sha1_transform overwrite it's own static vars */
-    sha1_transform(context->state, context->buffer);
-#endif
 }
 
 string bmx::sha1_digest_str(const unsigned char digest[20])
@@ -254,7 +357,7 @@ string bmx::sha1_calc_file(FILE *file)
             sha1_update(&context, buffer, (uint32_t)num_read);
     }
 
-    unsigned char digest[16];
+    unsigned char digest[20];
     sha1_final(digest, &context);
 
     return sha1_digest_str(digest);
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <ctime>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include <bmx/Stats.h>
+#include <bmx/Utils.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#if defined(_MSC_VER)
+#define ATOMIC_ADD(var, value)  InterlockedExchangeAdd64((volatile LONG64*)&(var), (LONG64)(value))
+#else
+#define ATOMIC_ADD(var, value)  __sync_fetch_and_add(&(var), (value))
+#endif
+
+
+static const char *COUNTER_NAMES[] =
+{
+    "file_read",
+    "file_write",
+    "file_seek",
+    "mxf_read",
+    "essence_read",
+    "essence_parse",
+    "sound_conversion",
+    "checksum",
+    "clip_write",
+};
+
+static StatsCounterValue COUNTERS[STATS_NUM_COUNTERS];
+
+
+bool bmx::STATS_ENABLED = false;
+
+
+void bmx::stats_enable(bool enable)
+{
+    STATS_ENABLED = enable;
+}
+
+void bmx::stats_reset()
+{
+    memset(COUNTERS, 0, sizeof(COUNTERS));
+}
+
+const char* bmx::stats_counter_name(StatsCounter counter)
+{
+    BMX_ASSERT((size_t)counter < BMX_ARRAY_SIZE(COUNTER_NAMES));
+    return COUNTER_NAMES[counter];
+}
+
+void bmx::stats_get_counter(StatsCounter counter, StatsCounterValue *value)
+{
+    BMX_ASSERT((size_t)counter < STATS_NUM_COUNTERS);
+    *value = COUNTERS[counter];
+}
+
+int64_t bmx::stats_get_time_nsec()
+{
+#if HAVE_CLOCK_GETTIME
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+        return 0;
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+
+#elif defined(_WIN32)
+    static LARGE_INTEGER frequency = {{0, 0}};
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0 && !QueryPerformanceFrequency(&frequency))
+        return 0;
+    if (!QueryPerformanceCounter(&now))
+        return 0;
+    return (int64_t)(now.QuadPart / frequency.QuadPart) * 1000000000LL +
+           (int64_t)(now.QuadPart % frequency.QuadPart) * 1000000000LL / frequency.QuadPart;
+
+#else
+    struct timeval now;
+    if (gettimeofday(&now, 0) != 0)
+        return 0;
+    return now.tv_sec * 1000000000LL + now.tv_usec * 1000LL;
+#endif
+}
+
+void bmx::stats_add(StatsCounter counter, int64_t nsec, int64_t bytes)
+{
+    BMX_ASSERT((size_t)counter < STATS_NUM_COUNTERS);
+    StatsCounterValue *value = &COUNTERS[counter];
+
+    if (nsec < 0)
+        nsec = 0;
+    uint64_t usec = (uint64_t)nsec / 1000;
+    size_t bucket = 0;
+    while (bucket < STATS_NUM_LATENCY_BUCKETS - 1 && usec >= ((uint64_t)1 << bucket))
+        bucket++;
+
+    ATOMIC_ADD(value->calls, 1);
+    ATOMIC_ADD(value->nsec, (uint64_t)nsec);
+    if (bytes > 0)
+        ATOMIC_ADD(value->bytes, (uint64_t)bytes);
+    ATOMIC_ADD(value->latency[bucket], 1);
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <libMXF++/MXFException.h>
+
+#include <bmx/Thread.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+
+#if defined(_WIN32)
+
+struct Mutex::Data
+{
+    CRITICAL_SECTION cs;
+};
+
+struct Condition::Data
+{
+    CONDITION_VARIABLE cv;
+};
+
+struct Thread::Data
+{
+    HANDLE handle;
+
+    static unsigned __stdcall Start(void *arg)
+    {
+        ((Thread*)arg)->RunThread();
+        return 0;
+    }
+};
+
+#else
+
+struct Mutex::Data
+{
+    pthread_mutex_t mutex;
+};
+
+struct Condition::Data
+{
+    pthread_cond_t cond;
+};
+
+struct Thread::Data
+{
+    pthread_t thread;
+
+    static void* Start(void *arg)
+    {
+        ((Thread*)arg)->RunThread();
+        return 0;
+    }
+};
+
+#endif
+
+
+
+Mutex::Mutex()
+{
+    mData = new Data;
+#if defined(_WIN32)
+    InitializeCriticalSection(&mData->cs);
+#else
+    if (pthread_mutex_init(&mData->mutex, 0) != 0) {
+        delete mData;
+        BMX_EXCEPTION(("Failed to initialise mutex"));
+    }
+#endif
+}
+
+Mutex::~Mutex()
+{
+#if defined(_WIN32)
+    DeleteCriticalSection(&mData->cs);
+#else
+    pthread_mutex_destroy(&mData->mutex);
+#endif
+    delete mData;
+}
+
+void Mutex::Lock()
+{
+#if defined(_WIN32)
+    EnterCriticalSection(&mData->cs);
+#else
+    BMX_CHECK(pthread_mutex_lock(&mData->mutex) == 0);
+#endif
+}
+
+void Mutex::Unlock()
+{
+#if defined(_WIN32)
+    LeaveCriticalSection(&mData->cs);
+#else
+    BMX_CHECK(pthread_mutex_unlock(&mData->mutex) == 0);
+#endif
+}
+
+
+
+MutexLocker::MutexLocker(Mutex *mutex)
+{
+    mMutex = mutex;
+    if (mMutex)
+        mMutex->Lock();
+}
+
+MutexLocker::~MutexLocker()
+{
+    if (mMutex)
+        mMutex->Unlock();
+}
+
+
+
+Condition::Condition()
+{
+    mData = new Data;
+#if defined(_WIN32)
+    InitializeConditionVariable(&mData->cv);
+#else
+    if (pthread_cond_init(&mData->cond, 0) != 0) {
+        delete mData;
+        BMX_EXCEPTION(("Failed to initialise condition variable"));
+    }
+#endif
+}
+
+Condition::~Condition()
+{
+#if !defined(_WIN32)
+    pthread_cond_destroy(&mData->cond);
+#endif
+    delete mData;
+}
+
+void Condition::Wait(Mutex *mutex)
+{
+#if defined(_WIN32)
+    BMX_CHECK(SleepConditionVariableCS(&mData->cv, &mutex->mData->cs, INFINITE));
+#else
+    BMX_CHECK(pthread_cond_wait(&mData->cond, &mutex->mData->mutex) == 0);
+#endif
+}
+
+void Condition::Signal()
+{
+#if defined(_WIN32)
+    WakeConditionVariable(&mData->cv);
+#else
+    pthread_cond_signal(&mData->cond);
+#endif
+}
+
+void Condition::Broadcast()
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(&mData->cv);
+#else
+    pthread_cond_broadcast(&mData->cond);
+#endif
+}
+
+
+
+Thread::Thread()
+{
+    mData = new Data;
+    mRunning = false;
+    mHaveError = false;
+}
+
+Thread::~Thread()
+{
+    if (mRunning)
+        log_error("Thread object deleted whilst the thread is still running\n");
+    delete mData;
+}
+
+void Thread::Start()
+{
+    BMX_CHECK(!mRunning);
+
+    mHaveError = false;
+    mErrorMessage.clear();
+
+#if defined(_WIN32)
+    uintptr_t handle = _beginthreadex(0, 0, Data::Start, this, 0, 0);
+    if (handle == 0)
+        BMX_EXCEPTION(("Failed to start thread"));
+    mData->handle = (HANDLE)handle;
+#else
+    if (pthread_create(&mData->thread, 0, Data::Start, this) != 0)
+        BMX_EXCEPTION(("Failed to start thread"));
+#endif
+
+    mRunning = true;
+}
+
+void Thread::Join()
+{
+    if (!mRunning)
+        return;
+
+#if defined(_WIN32)
+    WaitForSingleObject(mData->handle, INFINITE);
+    CloseHandle(mData->handle);
+#else
+    pthread_join(mData->thread, 0);
+#endif
+
+    mRunning = false;
+}
+
+void Thread::RunThread()
+{
+    try
+    {
+        Run();
+    }
+    catch (const mxfpp::MXFException &ex)
+    {
+        log_error("Thread failed: %s\n", ex.getMessage().c_str());
+        mErrorMessage = ex.getMessage();
+        mHaveError = true;
+    }
+    catch (const BMXException &ex)
+    {
+        log_error("Thread failed: %s\n", ex.what());
+        mErrorMessage = ex.what();
+        mHaveError = true;
+    }
+    catch (...)
+    {
+        log_error("Thread failed with an unknown exception\n");
+        mErrorMessage = "unknown exception";
+        mHaveError = true;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <bmx/ThreadedChecksum.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#define CHUNK_SIZE      (256 * 1024)
+#define MAX_CHUNKS      4
+
+
+
+ThreadedChecksum::ThreadedChecksum(ChecksumType type)
+: ChunkQueueWorker(CHUNK_SIZE, MAX_CHUNKS), mChecksum(type)
+{
+    mFinal = false;
+}
+
+ThreadedChecksum::~ThreadedChecksum()
+{
+    StopWorker();
+}
+
+void ThreadedChecksum::Update(const unsigned char *data, uint32_t size)
+{
+    BMX_CHECK(!mFinal);
+
+    if (!Write(data, size)) {
+        StopWorker();
+        BMX_EXCEPTION(("Checksum worker thread failed: %s", GetWorkerErrorMessage().c_str()));
+    }
+}
+
+void ThreadedChecksum::Final()
+{
+    if (mFinal)
+        return;
+
+    bool result = Flush();
+    StopWorker();
+    if (!result)
+        BMX_EXCEPTION(("Checksum worker thread failed: %s", GetWorkerErrorMessage().c_str()));
+
+    mChecksum.Final();
+    mFinal = true;
+}
+
+size_t ThreadedChecksum::GetDigestSize() const
+{
+    return mChecksum.GetDigestSize();
+}
+
+void ThreadedChecksum::GetDigest(unsigned char *digest, size_t size) const
+{
+    BMX_ASSERT(mFinal);
+    mChecksum.GetDigest(digest, size);
+}
+
+string ThreadedChecksum::GetDigestString() const
+{
+    BMX_ASSERT(mFinal);
+    return mChecksum.GetDigestString();
+}
+
+bool ThreadedChecksum::ProcessChunk(const unsigned char *data, uint32_t size)
+{
+    mChecksum.Update(data, size);
+    return true;
+}
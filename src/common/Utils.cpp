@@ -666,6 +666,30 @@ bool bmx::check_is_dir(string name)
 #endif
 }
 
+bool bmx::get_file_status(string filename, int64_t *size, int64_t *modified_time)
+{
+#if defined(_WIN32)
+    struct _stati64 buf;
+    if (_stati64(filename.c_str(), &buf) != 0 || (buf.st_mode & _S_IFMT) != _S_IFREG)
+        return false;
+#else
+    struct stat buf;
+    if (stat(filename.c_str(), &buf) != 0 || !S_ISREG(buf.st_mode))
+        return false;
+#endif
+
+    // the modification time has a 1 second resolution where nanoseconds are not available
+    *size = buf.st_size;
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+    *modified_time = (int64_t)buf.st_mtim.tv_sec * 1000000000 + buf.st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    *modified_time = (int64_t)buf.st_mtimespec.tv_sec * 1000000000 + buf.st_mtimespec.tv_nsec;
+#else
+    *modified_time = (int64_t)buf.st_mtime * 1000000000;
+#endif
+    return true;
+}
+
 bool bmx::check_is_abs_path(string name)
 {
 #if defined(_WIN32)
@@ -312,21 +312,17 @@ void D10File::WriteSamples(uint32_t track_index, const unsigned char *data, uint
 
     GetTrack(track_index)->WriteSamplesInt(data, size, num_samples);
 
-    while (mCPManager->HaveContentPackage()) {
-        if (mFirstWrite && mRequireBodyPartition) {
-            if (mInputDuration >= 0)
-                BMX_EXCEPTION(("XML track's Generic Stream partition is currently incompatible with single pass flavours"));
+    WriteContentPackages();
+}
 
-            Partition &ess_partition = mMXFFile->createPartition();
-            ess_partition.setKey(&MXF_PP_K(OpenComplete, Body));
-            ess_partition.setBodySID(mStreamIdHelper.GetId("BodyStream"));
-            ess_partition.write(mMXFFile);
+void D10File::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    if (!data_array || dba_get_total_size(data_array, array_size) == 0)
+        return;
 
-            mFirstWrite = false;
-        }
+    GetTrack(track_index)->WriteSampleArrayInt(data_array, array_size);
 
-        mCPManager->WriteNextContentPackage(mMXFFile);
-    }
+    WriteContentPackages();
 }
 
 void D10File::CompleteWrite()
@@ -789,3 +785,22 @@ void D10File::UpdateTrackMetadata(GenericPackage *package, int64_t duration)
     }
 }
 
+void D10File::WriteContentPackages()
+{
+    while (mCPManager->HaveContentPackage()) {
+        if (mFirstWrite && mRequireBodyPartition) {
+            if (mInputDuration >= 0)
+                BMX_EXCEPTION(("XML track's Generic Stream partition is currently incompatible with single pass flavours"));
+
+            Partition &ess_partition = mMXFFile->createPartition();
+            ess_partition.setKey(&MXF_PP_K(OpenComplete, Body));
+            ess_partition.setBodySID(mStreamIdHelper.GetId("BodyStream"));
+            ess_partition.write(mMXFFile);
+
+            mFirstWrite = false;
+        }
+
+        mCPManager->WriteNextContentPackage(mMXFFile);
+    }
+}
+
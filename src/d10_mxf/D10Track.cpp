@@ -135,6 +135,11 @@ void D10Track::WriteSamples(const unsigned char *data, uint32_t size, uint32_t n
     mD10File->WriteSamples(mTrackIndex, data, size, num_samples);
 }
 
+void D10Track::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    mD10File->WriteSample(mTrackIndex, data_array, array_size);
+}
+
 uint32_t D10Track::GetSampleSize()
 {
     return mDescriptorHelper->GetSampleSize();
@@ -159,3 +164,13 @@ void D10Track::WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size
     mCPManager->WriteSample(mTrackIndex, data_array, array_size);
 }
 
+void D10Track::WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(data_array && array_size);
+
+    // the MPEG and AES-3 tracks process the sample data and require it in a single buffer
+    uint32_t size;
+    const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+    WriteSamplesInt(data, size, 1);
+}
+
@@ -35,13 +35,146 @@
 
 #define __STDC_LIMIT_MACROS
 
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_PREFIX_AVX2_KERNEL     1
+#define PREFIX_AVX2_TARGET          __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define HAVE_PREFIX_AVX2_KERNEL     1
+#define PREFIX_AVX2_TARGET
+#endif
+
+// SSE2 is part of the x86-64 baseline and so the SSE2 kernel is selected at compile time
+#if defined(HAVE_PREFIX_AVX2_KERNEL) && \
+        (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HAVE_PREFIX_SSE2_KERNEL     1
+#endif
+
 #include "EssenceParserUtils.h"
+#include <bmx/essence_parser/EssenceParser.h>
+#include <bmx/CPUFeatures.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
 
 using namespace bmx;
 
 
+static const unsigned char START_CODE_PREFIX[3] = {0x00, 0x00, 0x01};
+static const unsigned char PARSE_INFO_PREFIX[4] = {0x42, 0x42, 0x43, 0x44};
+
+
+
+#if defined(HAVE_PREFIX_AVX2_KERNEL)
+
+static const bool HAVE_AVX2_SUPPORT = cpu_supports_avx2();
+
+static inline uint32_t first_set_bit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+// The prefix finders compare 16 or 32 candidate positions at a time by loading the data at
+// offsets 0 to prefix_size - 1 and AND-ing the byte equality masks. They return the prefix offset
+// or set *end to the offset where the remaining (< block size + prefix size) bytes start
+
+#if defined(HAVE_PREFIX_SSE2_KERNEL)
+static uint32_t find_prefix_sse2(const unsigned char *data, uint32_t data_size, const unsigned char *prefix,
+                                 uint32_t prefix_size, uint32_t *end)
+{
+    __m128i p0 = _mm_set1_epi8((char)prefix[0]);
+    __m128i p1 = _mm_set1_epi8((char)prefix[1]);
+    __m128i p2 = _mm_set1_epi8((char)prefix[2]);
+    __m128i p3 = _mm_set1_epi8((char)prefix[prefix_size - 1]);
+    uint32_t offset = 0;
+    while (data_size - offset >= 16 + prefix_size) {
+        __m128i m = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&data[offset]), p0),
+                                  _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&data[offset + 1]), p1));
+        m = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&data[offset + 2]), p2));
+        if (prefix_size > 3)
+            m = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&data[offset + 3]), p3));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(m);
+        if (mask)
+            return offset + first_set_bit(mask);
+        offset += 16;
+    }
+
+    *end = offset;
+    return ESSENCE_PARSER_NULL_OFFSET;
+}
+#endif
+
+PREFIX_AVX2_TARGET
+static uint32_t find_prefix_avx2(const unsigned char *data, uint32_t data_size, const unsigned char *prefix,
+                                 uint32_t prefix_size, uint32_t *end)
+{
+    __m256i p0 = _mm256_set1_epi8((char)prefix[0]);
+    __m256i p1 = _mm256_set1_epi8((char)prefix[1]);
+    __m256i p2 = _mm256_set1_epi8((char)prefix[2]);
+    __m256i p3 = _mm256_set1_epi8((char)prefix[prefix_size - 1]);
+    uint32_t offset = 0;
+    while (data_size - offset >= 32 + prefix_size) {
+        __m256i m = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&data[offset]), p0),
+                                     _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&data[offset + 1]), p1));
+        m = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&data[offset + 2]), p2));
+        if (prefix_size > 3)
+            m = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&data[offset + 3]), p3));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(m);
+        if (mask)
+            return offset + first_set_bit(mask);
+        offset += 32;
+    }
+
+    *end = offset;
+    return ESSENCE_PARSER_NULL_OFFSET;
+}
+
+#endif
+
+static uint32_t find_prefix(const unsigned char *data, uint32_t data_size, const unsigned char *prefix,
+                            uint32_t prefix_size)
+{
+    if (data_size == ESSENCE_PARSER_NULL_OFFSET || data_size < prefix_size)
+        return ESSENCE_PARSER_NULL_OFFSET;
+
+    uint32_t offset = 0;
+#if defined(HAVE_PREFIX_AVX2_KERNEL)
+    uint32_t result = ESSENCE_PARSER_NULL_OFFSET;
+    if (HAVE_AVX2_SUPPORT)
+        result = find_prefix_avx2(data, data_size, prefix, prefix_size, &offset);
+#if defined(HAVE_PREFIX_SSE2_KERNEL)
+    else
+        result = find_prefix_sse2(data, data_size, prefix, prefix_size, &offset);
+#endif
+    if (result != ESSENCE_PARSER_NULL_OFFSET)
+        return result;
+#endif
+
+    // memchr is typically vectorised by the C library
+    const unsigned char *datap = data + offset;
+    const unsigned char *end = data + data_size - prefix_size + 1;
+    while (datap < end) {
+        datap = (const unsigned char*)memchr(datap, prefix[0], end - datap);
+        if (!datap)
+            break;
+        if (memcmp(datap + 1, prefix + 1, prefix_size - 1) == 0)
+            return (uint32_t)(datap - data);
+        datap++;
+    }
+
+    return ESSENCE_PARSER_NULL_OFFSET;
+}
+
+
 
 uint32_t bmx::get_bits(const unsigned char *data, uint32_t data_size, uint32_t bit_offset, uint8_t num_bits)
 {
@@ -63,3 +196,13 @@ uint32_t bmx::get_bits(const unsigned char *data, uint32_t data_size, uint32_t b
     return (uint32_t)buffer;
 }
 
+uint32_t bmx::find_start_code_prefix(const unsigned char *data, uint32_t data_size)
+{
+    return find_prefix(data, data_size, START_CODE_PREFIX, sizeof(START_CODE_PREFIX));
+}
+
+uint32_t bmx::find_parse_info_prefix(const unsigned char *data, uint32_t data_size)
+{
+    return find_prefix(data, data_size, PARSE_INFO_PREFIX, sizeof(PARSE_INFO_PREFIX));
+}
+
@@ -43,6 +43,11 @@ namespace bmx
 
 uint32_t get_bits(const unsigned char *data, uint32_t data_size, uint32_t bit_offset, uint8_t num_bits);
 
+// return the offset of the first 0x000001 start code prefix (AVC, MPEG-2) or VC-2 parse info prefix
+// or ESSENCE_PARSER_NULL_OFFSET if not found
+uint32_t find_start_code_prefix(const unsigned char *data, uint32_t data_size);
+uint32_t find_parse_info_prefix(const unsigned char *data, uint32_t data_size);
+
 
 
 };
@@ -36,6 +36,7 @@
 #include <cerrno>
 
 #include <bmx/essence_parser/FileEssenceSource.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -86,11 +87,13 @@ bool FileEssenceSource::Open(const string &filename, int64_t start_offset)
 uint32_t FileEssenceSource::Read(unsigned char *data, uint32_t size)
 {
     BMX_ASSERT(mFile);
+    StatsTimer stats_timer(STATS_FILE_READ);
     mErrno = 0;
 
     size_t num_read = fread(data, 1, size, mFile);
     if (num_read < size && ferror(mFile))
         mErrno = errno;
+    stats_timer.AddBytes(num_read);
 
     return (uint32_t)num_read;
 }
@@ -120,18 +120,22 @@ uint32_t MPEG2EssenceParser::ParseFrameStart(const unsigned char *data, uint32_t
 {
     BMX_CHECK(data_size != ESSENCE_PARSER_NULL_OFFSET);
 
-    uint32_t state = 0xffffffff;
     uint32_t offset = 0;
-    while (offset < data_size) {
-        state = (state << 8) | data[offset];
-        if (state == SEQUENCE_HEADER_CODE ||
-            state == GROUP_HEADER_CODE ||
-            state == PICTURE_START_CODE)
+    uint32_t prefix_offset;
+    while ((prefix_offset = find_start_code_prefix(&data[offset], data_size - offset)) != ESSENCE_PARSER_NULL_OFFSET) {
+        offset += prefix_offset;
+        if (offset + 3 >= data_size)
+            break;
+
+        uint32_t start_code = 0x00000100 | data[offset + 3];
+        if (start_code == SEQUENCE_HEADER_CODE ||
+            start_code == GROUP_HEADER_CODE ||
+            start_code == PICTURE_START_CODE)
         {
-            return offset - 3;
+            return offset;
         }
 
-        offset++;
+        offset += 3;
     }
 
     return ESSENCE_PARSER_NULL_OFFSET;
@@ -146,7 +150,19 @@ uint32_t MPEG2EssenceParser::ParseFrameSize(const unsigned char *data, uint32_t
         return ESSENCE_PARSER_NULL_OFFSET;
 
     while (mOffset < data_size) {
-        mState = (mState << 8) | data[mOffset];
+        if (mOffset > 3) {
+            // skip to the next start code, which is where the state could change
+            uint32_t prefix_offset = find_start_code_prefix(&data[mOffset - 3], data_size - (mOffset - 3));
+            if (prefix_offset == ESSENCE_PARSER_NULL_OFFSET || mOffset + prefix_offset >= data_size) {
+                // continue the search in the next call, which could complete a prefix at the end of the data
+                mOffset = data_size;
+                break;
+            }
+            mOffset += prefix_offset;
+            mState = 0x00000100 | data[mOffset];
+        } else {
+            mState = (mState << 8) | data[mOffset];
+        }
         if (mState == SEQUENCE_HEADER_CODE ||
             mState == GROUP_HEADER_CODE ||
             mState == PICTURE_START_CODE)
@@ -177,6 +193,14 @@ uint32_t MPEG2EssenceParser::ParseFrameSize(const unsigned char *data, uint32_t
     return ESSENCE_PARSER_NULL_OFFSET;
 }
 
+EssenceParser* MPEG2EssenceParser::Clone() const
+{
+    // frame boundaries only depend on the start codes, which allows a clone to start at any frame start
+    MPEG2EssenceParser *parser = new MPEG2EssenceParser(*this);
+    parser->ResetFrameSize();
+    return parser;
+}
+
 void MPEG2EssenceParser::ParseFrameInfo(const unsigned char *data, uint32_t data_size)
 {
     BMX_CHECK(data_size != ESSENCE_PARSER_NULL_OFFSET);
@@ -38,6 +38,9 @@
 #include <cstdio>
 #include <cstring>
 #include <cerrno>
+
+#include <vector>
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 #ifdef HAVE_UNISTD_H
@@ -45,6 +48,8 @@
 #endif
 
 #include <bmx/essence_parser/RawEssenceReader.h>
+#include <bmx/Stats.h>
+#include <bmx/Thread.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -55,6 +60,71 @@ using namespace bmx;
 
 #define READ_BLOCK_SIZE         8192
 #define PARSE_FRAME_START_SIZE  8192
+#define PARSE_SEGMENT_SIZE      (1024 * 1024)
+#define MAX_PARSE_THREADS       64
+
+
+
+// locates the sample boundaries in a segment of a block of data. The parser continues into the
+// next segment until it passes the segment end so that the boundaries can be stitched together
+
+class SegmentParser : public Thread
+{
+public:
+    SegmentParser(EssenceParser *parser, const unsigned char *data, uint32_t data_size,
+                  uint32_t start, uint32_t end, bool find_start)
+    : Thread()
+    {
+        mParser = parser;
+        mData = data;
+        mDataSize = data_size;
+        mStart = start;
+        mEnd = end;
+        mFindStart = find_start;
+    }
+    virtual ~SegmentParser()
+    {
+        Join();
+        delete mParser;
+    }
+
+    void Parse()
+    {
+        uint32_t offset = mStart;
+        if (mFindStart) {
+            uint32_t start_offset = mParser->ParseFrameStart(mData + mStart, mDataSize - mStart);
+            if (start_offset == ESSENCE_PARSER_NULL_OFFSET)
+                return;
+            offset += start_offset;
+        }
+        mBoundaries.push_back(offset);
+
+        while (offset < mEnd) {
+            uint32_t sample_size = mParser->ParseFrameSize(mData + offset, mDataSize - offset);
+            if (sample_size == ESSENCE_PARSER_NULL_OFFSET || sample_size == ESSENCE_PARSER_NULL_FRAME_SIZE)
+                break;
+            offset += sample_size;
+            mBoundaries.push_back(offset);
+        }
+    }
+
+    const vector<uint32_t>& GetBoundaries() const { return mBoundaries; }
+
+protected:
+    virtual void Run()
+    {
+        Parse();
+    }
+
+private:
+    EssenceParser *mParser;
+    const unsigned char *mData;
+    uint32_t mDataSize;
+    uint32_t mStart;
+    uint32_t mEnd;
+    bool mFindStart;
+    vector<uint32_t> mBoundaries;
+};
 
 
 
@@ -66,10 +136,12 @@ RawEssenceReader::RawEssenceReader(EssenceSource *essence_source)
     mMaxSampleSize = 0;
     mFixedSampleSize = 0;
     mEssenceParser = 0;
+    mSampleDataOffset = 0;
     mSampleDataSize = 0;
     mNumSamples = 0;
     mReadFirstSample = false;
     mLastSampleRead = false;
+    mParseThreads = 0;
 
     mSampleBuffer.SetAllocBlockSize(READ_BLOCK_SIZE);
 }
@@ -100,15 +172,34 @@ void RawEssenceReader::SetCheckMaxSampleSize(uint32_t size)
     mMaxSampleSize = size;
 }
 
+void RawEssenceReader::SetParseThreads(uint32_t num_threads)
+{
+    if (num_threads > MAX_PARSE_THREADS)
+        mParseThreads = MAX_PARSE_THREADS;
+    else
+        mParseThreads = num_threads;
+}
+
 uint32_t RawEssenceReader::ReadSamples(uint32_t num_samples)
 {
     if (mLastSampleRead)
         return 0;
 
-    // shift data from previous read to start of sample data
-    // note that this is needed even if mFixedSampleSize > 0 because the previous read could have occurred
-    // when mFixedSampleSize == 0
-    ShiftSampleData(0, mSampleDataSize);
+    StatsTimer stats_timer(STATS_ESSENCE_PARSE);
+
+    if (mFixedSampleSize > 0)
+        mParsedSampleSizes.clear();
+
+    if (mParsedSampleSizes.empty()) {
+        // shift data from previous read to start of sample data
+        // note that this is needed even if mFixedSampleSize > 0 because the previous read could have occurred
+        // when mFixedSampleSize == 0
+        ShiftSampleData(0, mSampleDataOffset + mSampleDataSize);
+        mSampleDataOffset = 0;
+    } else {
+        // the remaining data is shifted once all the samples parsed in the block have been read
+        mSampleDataOffset += mSampleDataSize;
+    }
     mSampleDataSize = 0;
     mNumSamples = 0;
 
@@ -116,8 +207,12 @@ uint32_t RawEssenceReader::ReadSamples(uint32_t num_samples)
     if (mFixedSampleSize == 0) {
         uint32_t i;
         for (i = 0; i < num_samples; i++) {
-            if (!ReadAndParseSample())
+            if (mParseThreads > 1 && mReadFirstSample) {
+                if (!ReadParsedSample())
+                    break;
+            } else if (!ReadAndParseSample()) {
                 break;
+            }
         }
     } else {
         ReadBytes(mFixedSampleSize * num_samples - mSampleBuffer.GetSize());
@@ -129,6 +224,7 @@ uint32_t RawEssenceReader::ReadSamples(uint32_t num_samples)
         mSampleDataSize = mNumSamples * mFixedSampleSize;
     }
 
+    stats_timer.AddBytes(mSampleDataSize);
     return mNumSamples;
 }
 
@@ -145,17 +241,19 @@ void RawEssenceReader::Reset()
 
     mTotalReadLength = 0;
     mSampleBuffer.SetSize(0);
+    mSampleDataOffset = 0;
     mSampleDataSize = 0;
     mNumSamples = 0;
     mReadFirstSample = false;
     mLastSampleRead = false;
+    mParsedSampleSizes.clear();
 }
 
 bool RawEssenceReader::ReadAndParseSample()
 {
     BMX_CHECK(mEssenceParser);
 
-    uint32_t sample_start_offset = mSampleDataSize;
+    uint32_t sample_start_offset = mSampleDataOffset + mSampleDataSize;
     uint32_t sample_num_read = mSampleBuffer.GetSize() - sample_start_offset;
     uint32_t num_read;
 
@@ -205,7 +303,7 @@ bool RawEssenceReader::ReadAndParseSample()
         // assume remaining data is valid sample data
         mLastSampleRead = true;
         if (sample_num_read > 0) {
-            mSampleDataSize = mSampleBuffer.GetSize();
+            mSampleDataSize = mSampleBuffer.GetSize() - mSampleDataOffset;
             mNumSamples++;
         }
         return false;
@@ -216,6 +314,119 @@ bool RawEssenceReader::ReadAndParseSample()
     return true;
 }
 
+bool RawEssenceReader::ReadParsedSample()
+{
+    if (mParsedSampleSizes.empty() && !ParseSampleBlock())
+        return ReadAndParseSample();
+
+    uint32_t sample_size = mParsedSampleSizes.front();
+    mParsedSampleSizes.pop_front();
+    BMX_CHECK_M(mMaxSampleSize == 0 || sample_size <= mMaxSampleSize,
+               ("Max raw sample size (%u) exceeded", mMaxSampleSize));
+
+    mSampleDataSize += sample_size;
+    mNumSamples++;
+    return true;
+}
+
+bool RawEssenceReader::ParseSampleBlock()
+{
+    BMX_CHECK(mEssenceParser);
+    BMX_ASSERT(mParsedSampleSizes.empty());
+
+    EssenceParser *first_parser = mEssenceParser->Clone();
+    if (!first_parser)
+        return false;
+
+    // keep the samples already read in this call and move the remaining data to follow them
+    ShiftSampleData(0, mSampleDataOffset);
+    mSampleDataOffset = 0;
+
+    // the allocation includes space for the data remaining from the previous block so that the buffer
+    // is not reallocated for each block
+    uint32_t max_block_size = mParseThreads * PARSE_SEGMENT_SIZE;
+    mSampleBuffer.Reallocate(mSampleDataSize + 2 * max_block_size);
+
+    uint32_t block_start = mSampleDataSize;
+    uint32_t block_size = mSampleBuffer.GetSize() - block_start;
+    if (block_size < max_block_size)
+        block_size += ReadBytes(max_block_size - block_size);
+    if (block_size == 0) {
+        delete first_parser;
+        return false;
+    }
+
+    const unsigned char *block = mSampleBuffer.GetBytes() + block_start;
+    uint32_t num_segments = (block_size + PARSE_SEGMENT_SIZE - 1) / PARSE_SEGMENT_SIZE;
+    uint32_t segment_size = block_size / num_segments;
+
+    // the first segment starts at a known sample start and is parsed in this thread. The other segments
+    // start at a candidate sample start found by the parser
+    vector<SegmentParser*> segment_parsers;
+    EssenceParser *resync_parser = 0;
+    try
+    {
+        uint32_t i;
+        segment_parsers.push_back(new SegmentParser(first_parser, block, block_size, 0, segment_size, false));
+        for (i = 1; i < num_segments; i++) {
+            uint32_t end = (i + 1 == num_segments ? block_size : (i + 1) * segment_size);
+            segment_parsers.push_back(new SegmentParser(mEssenceParser->Clone(), block, block_size,
+                                                        i * segment_size, end, true));
+            segment_parsers.back()->Start();
+        }
+        segment_parsers[0]->Parse();
+        for (i = 1; i < num_segments; i++)
+            segment_parsers[i]->Join();
+
+        // stitch the segment boundaries together, starting from the last known sample boundary and
+        // parsing serially where a segment parser is not in sync
+        uint32_t pos = 0;
+        bool parse_end = false;
+        for (i = 0; i < num_segments && !parse_end; i++) {
+            const vector<uint32_t> &boundaries = segment_parsers[i]->GetBoundaries();
+            uint32_t segment_end = (i + 1 == num_segments ? block_size : (i + 1) * segment_size);
+            while (pos < segment_end) {
+                vector<uint32_t>::const_iterator iter = lower_bound(boundaries.begin(), boundaries.end(), pos);
+                if (iter != boundaries.end() && *iter == pos) {
+                    for (iter++; iter != boundaries.end(); iter++) {
+                        mParsedSampleSizes.push_back(*iter - pos);
+                        pos = *iter;
+                    }
+                    if (pos >= segment_end)
+                        break;
+                }
+
+                if (!resync_parser)
+                    resync_parser = mEssenceParser->Clone();
+                uint32_t sample_size = resync_parser->ParseFrameSize(block + pos, block_size - pos);
+                if (sample_size == ESSENCE_PARSER_NULL_OFFSET || sample_size == ESSENCE_PARSER_NULL_FRAME_SIZE) {
+                    // the remaining data is parsed serially
+                    parse_end = true;
+                    break;
+                }
+                mParsedSampleSizes.push_back(sample_size);
+                pos += sample_size;
+            }
+        }
+    }
+    catch (...)
+    {
+        size_t i;
+        for (i = 0; i < segment_parsers.size(); i++)
+            delete segment_parsers[i];
+        delete resync_parser;
+        mParsedSampleSizes.clear();
+        throw;
+    }
+
+    size_t i;
+    for (i = 0; i < segment_parsers.size(); i++)
+        delete segment_parsers[i];
+    delete resync_parser;
+
+    return !mParsedSampleSizes.empty();
+}
+
 uint32_t RawEssenceReader::ReadBytes(uint32_t size)
 {
     BMX_ASSERT(mMaxReadLength == 0 || mTotalReadLength <= mMaxReadLength);
@@ -35,10 +35,582 @@
 
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_KERNELS   1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS   1
+#define AVX2_TARGET         __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS   1
+#define AVX2_TARGET
+#endif
+
 #include <bmx/essence_parser/SoundConversion.h>
+#include <bmx/CPUFeatures.h>
+#include <bmx/Stats.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
 
+using namespace bmx;
+
+
+// The conversion kernels are specialised at compile time for the sample size and the common channel
+// counts. A CHANNEL_COUNT of 0 means the channel count is only known at runtime.
+// The SSE2 kernels handle 16-bit stereo, 8 samples at a time, and 16-bit 8 channel AES-3. The AVX2
+// kernels are selected at runtime and gather 8 samples of a channel at a time for the other 16-bit and
+// 24-bit layouts, including AES-3, and convert 24-bit 8 channel AES-3. The remaining samples are handled
+// by the scalar kernels. Interleaving has no AVX2 kernel because AVX2 has no scatter store.
+
+#if defined(HAVE_AVX2_KERNELS)
+
+static const bool HAVE_AVX2_SUPPORT = cpu_supports_avx2();
+
+// Gathers the 32-bit words at input_stride intervals, shifts them right by shift bits and stores the low
+// sample_size (2 or 3) bytes, 8 samples at a time. Returns the number of samples converted.
+// The whole word is read and so the input must extend 4 - sample_size bytes beyond the last sample
+AVX2_TARGET
+static uint32_t gather_samples_avx2(const unsigned char *input_data, uint32_t input_stride, int shift,
+                                    uint32_t sample_size, uint32_t sample_count, unsigned char *output_data)
+{
+    // pack the low bytes of each 32-bit lane in each 128-bit half and then join the halves
+    const __m256i pack_16bit = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i pack_24bit = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i join_16bit = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    const __m256i join_24bit = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                               _mm256_set1_epi32((int)input_stride));
+    const __m128i shift_count = _mm_cvtsi32_si128(shift);
+    uint32_t i;
+
+    for (i = 0; i + 8 <= sample_count; i += 8) {
+        __m256i samples = _mm256_srl_epi32(_mm256_i32gather_epi32((const int*)input_data, offsets, 1), shift_count);
+        if (sample_size == 2) {
+            samples = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(samples, pack_16bit), join_16bit);
+            _mm_storeu_si128((__m128i*)output_data, _mm256_castsi256_si128(samples));
+        } else {
+            samples = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(samples, pack_24bit), join_24bit);
+            _mm_storeu_si128((__m128i*)output_data, _mm256_castsi256_si128(samples));
+            _mm_storel_epi64((__m128i*)(output_data + 16), _mm256_extracti128_si256(samples, 1));
+        }
+
+        input_data  += 8 * input_stride;
+        output_data += 8 * sample_size;
+    }
+
+    return i;
+}
+
+// Converts 8 channels of 24-bit AES-3 words to interleaved PCM, 1 sample (24 bytes) at a time
+AVX2_TARGET
+static uint16_t convert_aes3_mc_24bit_avx2(const unsigned char *aes_data_ptr, uint16_t sample_count,
+                                           uint8_t valid_flags, unsigned char *pcm_data_ptr)
+{
+    const __m256i pack_24bit = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i join_24bit = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    int valid_mask_values[8];
+    uint8_t channel_num;
+    for (channel_num = 0; channel_num < 8; channel_num++)
+        valid_mask_values[channel_num] = ((valid_flags & (1 << channel_num)) ? -1 : 0);
+    const __m256i valid_mask = _mm256_loadu_si256((const __m256i*)valid_mask_values);
+    uint16_t sample_num;
+
+    for (sample_num = 0; sample_num < sample_count; sample_num++) {
+        __m256i samples = _mm256_and_si256(_mm256_srli_epi32(_mm256_loadu_si256((const __m256i*)aes_data_ptr), 4),
+                                           valid_mask);
+        samples = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(samples, pack_24bit), join_24bit);
+        _mm_storeu_si128((__m128i*)pcm_data_ptr, _mm256_castsi256_si128(samples));
+        _mm_storel_epi64((__m128i*)(pcm_data_ptr + 16), _mm256_extracti128_si256(samples, 1));
+
+        pcm_data_ptr += 24;
+        aes_data_ptr += 8 * 4;
+    }
+
+    return sample_num;
+}
+
+#endif
+
+static inline uint32_t get_aes3_word(const unsigned char *aes3_data)
+{
+    return  (uint32_t)aes3_data[0]        |
+           ((uint32_t)aes3_data[1] << 8)  |
+           ((uint32_t)aes3_data[2] << 16) |
+           ((uint32_t)aes3_data[3] << 24);
+}
+
+template <uint32_t BLOCK_ALIGN>
+static inline void set_aes3_pcm_sample(uint32_t aes3_word, unsigned char *pcm_data)
+{
+    // 16-bit samples are in bits 12 to 27 and 24-bit samples are in bits 4 to 27
+    if (BLOCK_ALIGN == 2) {
+        pcm_data[0] = (unsigned char)(aes3_word >> 12);
+        pcm_data[1] = (unsigned char)(aes3_word >> 20);
+    } else {
+        pcm_data[0] = (unsigned char)(aes3_word >> 4);
+        pcm_data[1] = (unsigned char)(aes3_word >> 12);
+        pcm_data[2] = (unsigned char)(aes3_word >> 20);
+    }
+}
+
+template <uint32_t BLOCK_ALIGN>
+static void convert_aes3_samples(const unsigned char *aes_data_ptr, uint16_t sample_count,
+                                 unsigned char *pcm_data_ptr)
+{
+    uint16_t sample_num = 0;
+
+#if defined(HAVE_AVX2_KERNELS)
+    if (HAVE_AVX2_SUPPORT) {
+        sample_num = (uint16_t)gather_samples_avx2(aes_data_ptr, 8 * 4, (BLOCK_ALIGN == 2 ? 12 : 4), BLOCK_ALIGN,
+                                                   sample_count, pcm_data_ptr);
+        pcm_data_ptr += sample_num * BLOCK_ALIGN;
+        aes_data_ptr += sample_num * 8 * 4;
+    }
+#endif
+
+    for (; sample_num < sample_count; sample_num++) {
+        set_aes3_pcm_sample<BLOCK_ALIGN>(get_aes3_word(aes_data_ptr), pcm_data_ptr);
+        pcm_data_ptr += BLOCK_ALIGN;
+        aes_data_ptr += 8 * 4;
+    }
+}
+
+template <uint32_t BLOCK_ALIGN>
+static void convert_aes3_mc_samples(const unsigned char *aes_data_ptr, uint16_t sample_count, uint8_t valid_flags,
+                                    uint8_t channel_count, unsigned char *pcm_data_ptr)
+{
+    uint16_t sample_num = 0;
+    uint8_t channel_num;
+
+#if defined(HAVE_SSE2_KERNELS)
+    if (BLOCK_ALIGN == 2 && channel_count == 8) {
+        // sign extend bits 12 to 27 to 32-bits and pack all 8 channels into a single register
+        uint16_t valid_mask_values[8];
+        for (channel_num = 0; channel_num < 8; channel_num++)
+            valid_mask_values[channel_num] = ((valid_flags & (1 << channel_num)) ? 0xffff : 0x0000);
+        __m128i valid_mask = _mm_loadu_si128((const __m128i*)valid_mask_values);
+
+        for (; sample_num < sample_count; sample_num++) {
+            __m128i low  = _mm_loadu_si128((const __m128i*)aes_data_ptr);
+            __m128i high = _mm_loadu_si128((const __m128i*)(aes_data_ptr + 16));
+            low  = _mm_srai_epi32(_mm_slli_epi32(low, 4), 16);
+            high = _mm_srai_epi32(_mm_slli_epi32(high, 4), 16);
+            _mm_storeu_si128((__m128i*)pcm_data_ptr, _mm_and_si128(_mm_packs_epi32(low, high), valid_mask));
+            pcm_data_ptr += 16;
+            aes_data_ptr += 8 * 4;
+        }
+        return;
+    }
+#endif
+
+#if defined(HAVE_AVX2_KERNELS)
+    if (BLOCK_ALIGN == 3 && channel_count == 8 && HAVE_AVX2_SUPPORT) {
+        convert_aes3_mc_24bit_avx2(aes_data_ptr, sample_count, valid_flags, pcm_data_ptr);
+        return;
+    }
+#endif
+
+    for (; sample_num < sample_count; sample_num++) {
+        for (channel_num = 0; channel_num < channel_count; channel_num++) {
+            if (valid_flags & (1 << channel_num))
+                set_aes3_pcm_sample<BLOCK_ALIGN>(get_aes3_word(aes_data_ptr), pcm_data_ptr);
+            else
+                memset(pcm_data_ptr, 0, BLOCK_ALIGN);
+            pcm_data_ptr += BLOCK_ALIGN;
+            aes_data_ptr += 4;
+        }
+        aes_data_ptr += (8 - channel_count) * 4;
+    }
+}
+
+template <uint32_t BLOCK_ALIGN, uint16_t CHANNEL_COUNT>
+static void deinterleave_samples(const unsigned char *input_data, uint16_t channel_count, uint32_t sample_count,
+                                 unsigned char *output_data)
+{
+    uint32_t input_block_align = BLOCK_ALIGN * (CHANNEL_COUNT ? CHANNEL_COUNT : channel_count);
+    uint32_t i;
+    for (i = 0; i < sample_count; i++) {
+        memcpy(output_data, input_data, BLOCK_ALIGN);
+        input_data  += input_block_align;
+        output_data += BLOCK_ALIGN;
+    }
+}
+
+template <uint32_t BLOCK_ALIGN, uint16_t CHANNEL_COUNT>
+static void interleave_samples(const unsigned char *input_data, uint16_t channel_count, uint32_t sample_count,
+                               unsigned char *output_data)
+{
+    uint32_t output_block_align = BLOCK_ALIGN * (CHANNEL_COUNT ? CHANNEL_COUNT : channel_count);
+    uint32_t i;
+    for (i = 0; i < sample_count; i++) {
+        memcpy(output_data, input_data, BLOCK_ALIGN);
+        input_data  += BLOCK_ALIGN;
+        output_data += output_block_align;
+    }
+}
+
+#if defined(HAVE_SSE2_KERNELS)
+
+// Returns the low 16 bits of each 32-bit lane in a followed by b
+static inline __m128i pack_low_16bit(__m128i a, __m128i b)
+{
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+static uint32_t deinterleave_16bit_stereo_sse2(const unsigned char *input_data, uint16_t channel_num,
+                                               uint32_t sample_count, unsigned char *output_data)
+{
+    __m128i shift = _mm_cvtsi32_si128(16 * channel_num);
+    uint32_t i;
+
+    for (i = 0; i + 8 <= sample_count; i += 8) {
+        __m128i low  = _mm_srl_epi32(_mm_loadu_si128((const __m128i*)input_data), shift);
+        __m128i high = _mm_srl_epi32(_mm_loadu_si128((const __m128i*)(input_data + 16)), shift);
+        _mm_storeu_si128((__m128i*)output_data, pack_low_16bit(low, high));
+
+        input_data  += 32;
+        output_data += 16;
+    }
+
+    return i;
+}
+
+static uint32_t interleave_16bit_stereo_sse2(const unsigned char *input_data, uint16_t channel_num,
+                                             uint32_t sample_count, unsigned char *output_data)
+{
+    __m128i shift = _mm_cvtsi32_si128(16 * channel_num);
+    __m128i zero = _mm_setzero_si128();
+    __m128i other_channel_mask = _mm_srl_epi32(_mm_set1_epi32((int)0xffff0000), shift);
+    uint32_t i;
+
+    for (i = 0; i + 8 <= sample_count; i += 8) {
+        __m128i samples = _mm_loadu_si128((const __m128i*)input_data);
+        __m128i *output_low  = (__m128i*)output_data;
+        __m128i *output_high = (__m128i*)(output_data + 16);
+        _mm_storeu_si128(output_low,
+                         _mm_or_si128(_mm_and_si128(_mm_loadu_si128(output_low), other_channel_mask),
+                                      _mm_sll_epi32(_mm_unpacklo_epi16(samples, zero), shift)));
+        _mm_storeu_si128(output_high,
+                         _mm_or_si128(_mm_and_si128(_mm_loadu_si128(output_high), other_channel_mask),
+                                      _mm_sll_epi32(_mm_unpackhi_epi16(samples, zero), shift)));
+
+        input_data  += 16;
+        output_data += 32;
+    }
+
+    return i;
+}
+
+#endif
+
+template <uint32_t BLOCK_ALIGN, uint16_t CHANNEL_COUNT>
+static void deinterleave_channel(const unsigned char *input_data, uint16_t channel_count, uint16_t channel_num,
+                                 uint32_t sample_count, unsigned char *output_data)
+{
+    uint32_t input_block_align = BLOCK_ALIGN * (CHANNEL_COUNT ? CHANNEL_COUNT : channel_count);
+    uint32_t done_count = 0;
+
+#if defined(HAVE_SSE2_KERNELS)
+    if (BLOCK_ALIGN == 2 && CHANNEL_COUNT == 2)
+        done_count = deinterleave_16bit_stereo_sse2(input_data, channel_num, sample_count, output_data);
+#endif
+#if defined(HAVE_AVX2_KERNELS)
+    // the last sample is left for the scalar kernel because the gather reads beyond the sample
+    if ((BLOCK_ALIGN == 2 || BLOCK_ALIGN == 3) && done_count == 0 && sample_count > 0 && HAVE_AVX2_SUPPORT) {
+        done_count = gather_samples_avx2(input_data + channel_num * BLOCK_ALIGN, input_block_align, 0, BLOCK_ALIGN,
+                                         sample_count - 1, output_data);
+    }
+#endif
+
+    deinterleave_samples<BLOCK_ALIGN, CHANNEL_COUNT>(input_data + done_count * input_block_align + channel_num * BLOCK_ALIGN,
+                                                     channel_count, sample_count - done_count,
+                                                     output_data + done_count * BLOCK_ALIGN);
+}
+
+template <uint32_t BLOCK_ALIGN, uint16_t CHANNEL_COUNT>
+static void interleave_channel(const unsigned char *input_data, uint16_t channel_count, uint16_t channel_num,
+                               uint32_t sample_count, unsigned char *output_data)
+{
+    uint32_t output_block_align = BLOCK_ALIGN * (CHANNEL_COUNT ? CHANNEL_COUNT : channel_count);
+    uint32_t done_count = 0;
+
+#if defined(HAVE_SSE2_KERNELS)
+    if (BLOCK_ALIGN == 2 && CHANNEL_COUNT == 2)
+        done_count = interleave_16bit_stereo_sse2(input_data, channel_num, sample_count, output_data);
+#endif
+
+    interleave_samples<BLOCK_ALIGN, CHANNEL_COUNT>(input_data + done_count * BLOCK_ALIGN,
+                                                   channel_count, sample_count - done_count,
+                                                   output_data + done_count * output_block_align + channel_num * BLOCK_ALIGN);
+}
+
+static void deinterleave_any_channel(const unsigned char *input_data, uint32_t input_block_align,
+                                     uint32_t output_block_align, uint16_t channel_num, uint32_t sample_count,
+                                     unsigned char *output_data)
+{
+    uint32_t channel_offset = channel_num * output_block_align;
+    uint32_t i, j;
+    for (i = 0; i < sample_count; i++) {
+        for (j = 0; j < output_block_align; j++)
+            output_data[i * output_block_align + j] = input_data[i * input_block_align + channel_offset + j];
+    }
+}
+
+static void interleave_any_channel(const unsigned char *input_data, uint32_t input_block_align,
+                                   uint32_t output_block_align, uint16_t channel_num, uint32_t sample_count,
+                                   unsigned char *output_data)
+{
+    uint32_t channel_offset = channel_num * input_block_align;
+    uint32_t i, j;
+    for (i = 0; i < sample_count; i++) {
+        for (j = 0; j < input_block_align; j++)
+            output_data[i * output_block_align + channel_offset + j] = input_data[i * input_block_align + j];
+    }
+}
+
+template <uint32_t BLOCK_ALIGN>
+static void deinterleave_channel(const unsigned char *input_data, uint16_t channel_count, uint16_t channel_num,
+                                 uint32_t sample_count, unsigned char *output_data)
+{
+    switch (channel_count)
+    {
+        case 2:
+            deinterleave_channel<BLOCK_ALIGN, 2>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 4:
+            deinterleave_channel<BLOCK_ALIGN, 4>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 8:
+            deinterleave_channel<BLOCK_ALIGN, 8>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 16:
+            deinterleave_channel<BLOCK_ALIGN, 16>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        default:
+            deinterleave_channel<BLOCK_ALIGN, 0>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+    }
+}
+
+template <uint32_t BLOCK_ALIGN>
+static void interleave_channel(const unsigned char *input_data, uint16_t channel_count, uint16_t channel_num,
+                               uint32_t sample_count, unsigned char *output_data)
+{
+    switch (channel_count)
+    {
+        case 2:
+            interleave_channel<BLOCK_ALIGN, 2>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 4:
+            interleave_channel<BLOCK_ALIGN, 4>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 8:
+            interleave_channel<BLOCK_ALIGN, 8>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 16:
+            interleave_channel<BLOCK_ALIGN, 16>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        default:
+            interleave_channel<BLOCK_ALIGN, 0>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+    }
+}
+
+
+
+// The all channel kernels copy blocks of samples that fit in the L1 cache, one channel at a time, so
+// that the input data is only read once from memory. The SSE2 kernels transpose 8 samples of 8 channels
+// at a time for 16-bit samples
+
+#define ALL_CHANNELS_BLOCK_SIZE     64
+
+#if defined(HAVE_SSE2_KERNELS)
+
+static inline void transpose_8x8_16bit(__m128i *rows)
+{
+    __m128i a0 = _mm_unpacklo_epi16(rows[0], rows[1]);
+    __m128i a1 = _mm_unpackhi_epi16(rows[0], rows[1]);
+    __m128i a2 = _mm_unpacklo_epi16(rows[2], rows[3]);
+    __m128i a3 = _mm_unpackhi_epi16(rows[2], rows[3]);
+    __m128i a4 = _mm_unpacklo_epi16(rows[4], rows[5]);
+    __m128i a5 = _mm_unpackhi_epi16(rows[4], rows[5]);
+    __m128i a6 = _mm_unpacklo_epi16(rows[6], rows[7]);
+    __m128i a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    rows[0] = _mm_unpacklo_epi64(b0, b4);
+    rows[1] = _mm_unpackhi_epi64(b0, b4);
+    rows[2] = _mm_unpacklo_epi64(b1, b5);
+    rows[3] = _mm_unpackhi_epi64(b1, b5);
+    rows[4] = _mm_unpacklo_epi64(b2, b6);
+    rows[5] = _mm_unpackhi_epi64(b2, b6);
+    rows[6] = _mm_unpacklo_epi64(b3, b7);
+    rows[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+static uint32_t deinterleave_all_16bit_sse2(const unsigned char *input_data, uint16_t channel_count,
+                                            uint32_t sample_count, unsigned char * const *output_data)
+{
+    uint32_t input_block_align = 2 * channel_count;
+    uint32_t i;
+
+    if (channel_count == 2) {
+        for (i = 0; i + 8 <= sample_count; i += 8) {
+            __m128i low  = _mm_loadu_si128((const __m128i*)input_data);
+            __m128i high = _mm_loadu_si128((const __m128i*)(input_data + 16));
+            if (output_data[0])
+                _mm_storeu_si128((__m128i*)(output_data[0] + 2 * i), pack_low_16bit(low, high));
+            if (output_data[1]) {
+                _mm_storeu_si128((__m128i*)(output_data[1] + 2 * i),
+                                 pack_low_16bit(_mm_srli_epi32(low, 16), _mm_srli_epi32(high, 16)));
+            }
+            input_data += 32;
+        }
+        return i;
+    }
+
+    if (channel_count % 8 != 0)
+        return 0;
+
+    __m128i rows[8];
+    uint16_t c, k;
+    for (i = 0; i + 8 <= sample_count; i += 8) {
+        for (c = 0; c < channel_count; c += 8) {
+            for (k = 0; k < 8; k++)
+                rows[k] = _mm_loadu_si128((const __m128i*)(input_data + k * input_block_align + 2 * c));
+            transpose_8x8_16bit(rows);
+            for (k = 0; k < 8; k++) {
+                if (output_data[c + k])
+                    _mm_storeu_si128((__m128i*)(output_data[c + k] + 2 * i), rows[k]);
+            }
+        }
+        input_data += 8 * input_block_align;
+    }
+
+    return i;
+}
+
+static uint16_t convert_aes3_all_16bit_sse2(const unsigned char *aes_data_ptr, uint16_t sample_count,
+                                            uint8_t valid_flags, uint8_t channel_count,
+                                            unsigned char * const *pcm_data)
+{
+    __m128i rows[8];
+    uint16_t sample_num;
+    uint8_t channel_num;
+    uint16_t k;
+
+    for (sample_num = 0; sample_num + 8 <= sample_count; sample_num += 8) {
+        for (k = 0; k < 8; k++) {
+            __m128i low  = _mm_loadu_si128((const __m128i*)aes_data_ptr);
+            __m128i high = _mm_loadu_si128((const __m128i*)(aes_data_ptr + 16));
+            low  = _mm_srai_epi32(_mm_slli_epi32(low, 4), 16);
+            high = _mm_srai_epi32(_mm_slli_epi32(high, 4), 16);
+            rows[k] = _mm_packs_epi32(low, high);
+            aes_data_ptr += 8 * 4;
+        }
+        transpose_8x8_16bit(rows);
+        for (channel_num = 0; channel_num < channel_count; channel_num++) {
+            if (pcm_data[channel_num]) {
+                _mm_storeu_si128((__m128i*)(pcm_data[channel_num] + 2 * sample_num),
+                                 (valid_flags & (1 << channel_num)) ? rows[channel_num] : _mm_setzero_si128());
+            }
+        }
+    }
+
+    return sample_num;
+}
+
+#endif
+
+template <uint32_t BLOCK_ALIGN>
+static void deinterleave_all_channels(const unsigned char *input_data, uint32_t block_align, uint16_t channel_count,
+                                      uint32_t sample_count, unsigned char * const *output_data)
+{
+    uint32_t sample_size = (BLOCK_ALIGN ? BLOCK_ALIGN : block_align);
+    uint32_t input_block_align = channel_count * sample_size;
+    uint32_t start = 0;
+    uint32_t end, i;
+    uint16_t c;
+
+#if defined(HAVE_SSE2_KERNELS)
+    if (BLOCK_ALIGN == 2)
+        start = deinterleave_all_16bit_sse2(input_data, channel_count, sample_count, output_data);
+#endif
+#if defined(HAVE_AVX2_KERNELS)
+    bool use_avx2 = ((BLOCK_ALIGN == 2 || BLOCK_ALIGN == 3) && start == 0 && HAVE_AVX2_SUPPORT);
+#endif
+
+    for (; start < sample_count; start = end) {
+        end = start + ALL_CHANNELS_BLOCK_SIZE;
+        if (end > sample_count)
+            end = sample_count;
+        for (c = 0; c < channel_count; c++) {
+            if (!output_data[c])
+                continue;
+            const unsigned char *input_ptr = input_data + start * input_block_align + c * sample_size;
+            unsigned char *output_ptr = output_data[c] + start * sample_size;
+            i = start;
+#if defined(HAVE_AVX2_KERNELS)
+            if (use_avx2) {
+                // the last sample is left for the scalar loop because the gather reads beyond the sample
+                uint32_t count = gather_samples_avx2(input_ptr, input_block_align, 0, sample_size,
+                                                     (end < sample_count ? end : end - 1) - start, output_ptr);
+                i           += count;
+                input_ptr   += count * input_block_align;
+                output_ptr  += count * sample_size;
+            }
+#endif
+            for (; i < end; i++) {
+                memcpy(output_ptr, input_ptr, sample_size);
+                input_ptr  += input_block_align;
+                output_ptr += sample_size;
+            }
+        }
+    }
+}
+
+template <uint32_t BLOCK_ALIGN>
+static void convert_aes3_all_channels(const unsigned char *aes_data_ptr, uint16_t sample_count, uint8_t valid_flags,
+                                      uint8_t channel_count, unsigned char * const *pcm_data)
+{
+    uint16_t start = 0;
+    uint8_t channel_num;
+
+#if defined(HAVE_SSE2_KERNELS)
+    if (BLOCK_ALIGN == 2)
+        start = convert_aes3_all_16bit_sse2(aes_data_ptr, sample_count, valid_flags, channel_count, pcm_data);
+#endif
+
+    for (channel_num = 0; channel_num < channel_count; channel_num++) {
+        unsigned char *pcm_data_ptr = pcm_data[channel_num];
+        if (!pcm_data_ptr)
+            continue;
+        if (valid_flags & (1 << channel_num)) {
+            convert_aes3_samples<BLOCK_ALIGN>(aes_data_ptr + start * 8 * 4 + channel_num * 4, sample_count - start,
+                                              pcm_data_ptr + start * BLOCK_ALIGN);
+        } else {
+            memset(pcm_data_ptr + start * BLOCK_ALIGN, 0, (sample_count - start) * BLOCK_ALIGN);
+        }
+    }
+}
+
 
 
 uint8_t bmx::get_aes3_channel_valid_flags(const unsigned char *aes3_data, uint32_t aes3_data_size)
@@ -57,6 +629,9 @@ uint32_t bmx::convert_aes3_to_pcm(const unsigned char *aes3_data, uint32_t aes3_
                                  uint32_t bits_per_sample, uint8_t channel_num,
                                  unsigned char *pcm_data, uint32_t pcm_data_size)
 {
+    StatsTimer stats_timer(STATS_SOUND_CONVERSION);
+    stats_timer.AddBytes(aes3_data_size);
+
     uint16_t sample_count   = get_aes3_sample_count(aes3_data, aes3_data_size);
     uint8_t valid_flags     = (ignore_valid_flags ? 0xff : get_aes3_channel_valid_flags(aes3_data, aes3_data_size));
     uint32_t block_align    = (bits_per_sample + 7) / 8;
@@ -71,33 +646,10 @@ uint32_t bmx::convert_aes3_to_pcm(const unsigned char *aes3_data, uint32_t aes3_
         return 4 + sample_count * 4 * 8;
     }
 
-    const unsigned char *aes_data_ptr = &aes3_data[4];
-    unsigned char *pcm_data_ptr = &pcm_data[0];
-    uint16_t sample_num;
-
-    if (block_align == 2) {
-        for (sample_num = 0; sample_num < sample_count; sample_num++) {
-            aes_data_ptr += channel_num * 4;
-            pcm_data_ptr[0] = (aes_data_ptr[1] >> 4) |
-                              (aes_data_ptr[2] << 4);
-            pcm_data_ptr[1] = (aes_data_ptr[2] >> 4) |
-                              (aes_data_ptr[3] << 4);
-            pcm_data_ptr += 2;
-            aes_data_ptr += (8 - channel_num) * 4;
-        }
-    } else {
-        for (sample_num = 0; sample_num < sample_count; sample_num++) {
-            aes_data_ptr += channel_num * 4;
-            pcm_data_ptr[0] = (aes_data_ptr[0] >> 4) |
-                              (aes_data_ptr[1] << 4);
-            pcm_data_ptr[1] = (aes_data_ptr[1] >> 4) |
-                              (aes_data_ptr[2] << 4);
-            pcm_data_ptr[2] = (aes_data_ptr[2] >> 4) |
-                              (aes_data_ptr[3] << 4);
-            pcm_data_ptr += 3;
-            aes_data_ptr += (8 - channel_num) * 4;
-        }
-    }
+    if (block_align == 2)
+        convert_aes3_samples<2>(&aes3_data[4 + channel_num * 4], sample_count, pcm_data);
+    else
+        convert_aes3_samples<3>(&aes3_data[4 + channel_num * 4], sample_count, pcm_data);
 
     return 4 + sample_count * 4 * 8;
 }
@@ -106,6 +658,9 @@ uint32_t bmx::convert_aes3_to_mc_pcm(const unsigned char *aes3_data, uint32_t ae
                                     uint32_t bits_per_sample, uint8_t channel_count,
                                     unsigned char *pcm_data, uint32_t pcm_data_size)
 {
+    StatsTimer stats_timer(STATS_SOUND_CONVERSION);
+    stats_timer.AddBytes(aes3_data_size);
+
     uint16_t sample_count       = get_aes3_sample_count(aes3_data, aes3_data_size);
     uint8_t valid_flags         = (ignore_valid_flags ? 0xff : get_aes3_channel_valid_flags(aes3_data, aes3_data_size));
     uint32_t bytes_per_sample   = (bits_per_sample + 7) / 8;
@@ -115,48 +670,34 @@ uint32_t bmx::convert_aes3_to_mc_pcm(const unsigned char *aes3_data, uint32_t ae
     BMX_CHECK(channel_count <= 8);
     BMX_CHECK(pcm_data_size >= channel_count * bytes_per_sample * sample_count);
 
-    const unsigned char *aes_data_ptr = &aes3_data[4];
-    unsigned char *pcm_data_ptr = &pcm_data[0];
-    uint16_t sample_num, channel_num;
-
-    if (bytes_per_sample == 2) {
-        for (sample_num = 0; sample_num < sample_count; sample_num++) {
-            for (channel_num = 0; channel_num < channel_count; channel_num++) {
-                if (valid_flags & (1 << channel_num)) {
-                    pcm_data_ptr[0] = (aes_data_ptr[1] >> 4) |
-                                      (aes_data_ptr[2] << 4);
-                    pcm_data_ptr[1] = (aes_data_ptr[2] >> 4) |
-                                      (aes_data_ptr[3] << 4);
-                } else {
-                    pcm_data_ptr[0] = 0x00;
-                    pcm_data_ptr[1] = 0x00;
-                }
-                pcm_data_ptr += 2;
-                aes_data_ptr += 4;
-            }
-            aes_data_ptr += (8 - channel_count) * 4;
-        }
-    } else {
-        for (sample_num = 0; sample_num < sample_count; sample_num++) {
-            for (channel_num = 0; channel_num < channel_count; channel_num++) {
-                if (valid_flags & (1 << channel_num)) {
-                    pcm_data_ptr[0] = (aes_data_ptr[0] >> 4) |
-                                      (aes_data_ptr[1] << 4);
-                    pcm_data_ptr[1] = (aes_data_ptr[1] >> 4) |
-                                      (aes_data_ptr[2] << 4);
-                    pcm_data_ptr[2] = (aes_data_ptr[2] >> 4) |
-                                      (aes_data_ptr[3] << 4);
-                } else {
-                    pcm_data_ptr[0] = 0x00;
-                    pcm_data_ptr[1] = 0x00;
-                    pcm_data_ptr[2] = 0x00;
-                }
-                pcm_data_ptr += 3;
-                aes_data_ptr += 4;
-            }
-            aes_data_ptr += (8 - channel_count) * 4;
-        }
-    }
+    if (bytes_per_sample == 2)
+        convert_aes3_mc_samples<2>(&aes3_data[4], sample_count, valid_flags, channel_count, pcm_data);
+    else
+        convert_aes3_mc_samples<3>(&aes3_data[4], sample_count, valid_flags, channel_count, pcm_data);
+
+    return 4 + sample_count * 4 * 8;
+}
+
+uint32_t bmx::convert_aes3_to_pcm_channels(const unsigned char *aes3_data, uint32_t aes3_data_size,
+                                          bool ignore_valid_flags, uint32_t bits_per_sample, uint8_t channel_count,
+                                          unsigned char * const *pcm_data, uint32_t pcm_data_size)
+{
+    StatsTimer stats_timer(STATS_SOUND_CONVERSION);
+    stats_timer.AddBytes(aes3_data_size);
+
+    uint16_t sample_count   = get_aes3_sample_count(aes3_data, aes3_data_size);
+    uint8_t valid_flags     = (ignore_valid_flags ? 0xff : get_aes3_channel_valid_flags(aes3_data, aes3_data_size));
+    uint32_t block_align    = (bits_per_sample + 7) / 8;
+
+    BMX_CHECK(sample_count <= (aes3_data_size - 4) / (8 * 4)); // 4 bytes per sample, 8 channels
+    BMX_CHECK(block_align == 2 || block_align == 3); // only 16-bit to 24-bit sample size allowed
+    BMX_CHECK(channel_count <= 8);
+    BMX_CHECK(pcm_data_size >= block_align * sample_count);
+
+    if (block_align == 2)
+        convert_aes3_all_channels<2>(&aes3_data[4], sample_count, valid_flags, channel_count, pcm_data);
+    else
+        convert_aes3_all_channels<3>(&aes3_data[4], sample_count, valid_flags, channel_count, pcm_data);
 
     return 4 + sample_count * 4 * 8;
 }
@@ -165,17 +706,60 @@ void bmx::deinterleave_audio(const unsigned char *input_data, uint32_t input_dat
                             uint32_t bits_per_sample, uint16_t channel_count, uint16_t channel_num,
                             unsigned char *output_data, uint32_t output_data_size)
 {
+    StatsTimer stats_timer(STATS_SOUND_CONVERSION);
+    stats_timer.AddBytes(input_data_size);
+
     uint32_t input_block_align = channel_count * ((bits_per_sample + 7) / 8);
     uint32_t output_block_align = (bits_per_sample + 7) / 8;
-    uint32_t channel_offset = channel_num * output_block_align;
     uint32_t sample_count = input_data_size / input_block_align;
-    uint32_t i, j;
 
     BMX_CHECK(output_data_size >= sample_count * output_block_align);
+    BMX_CHECK(channel_num < channel_count);
 
-    for (i = 0; i < sample_count; i++) {
-        for (j = 0; j < output_block_align; j++)
-            output_data[i * output_block_align + j] = input_data[i * input_block_align + channel_offset + j];
+    switch (output_block_align)
+    {
+        case 2:
+            deinterleave_channel<2>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 3:
+            deinterleave_channel<3>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 4:
+            deinterleave_channel<4>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        default:
+            deinterleave_any_channel(input_data, input_block_align, output_block_align, channel_num, sample_count,
+                                     output_data);
+            break;
+    }
+}
+
+void bmx::deinterleave_audio_channels(const unsigned char *input_data, uint32_t input_data_size,
+                                     uint32_t bits_per_sample, uint16_t channel_count,
+                                     unsigned char * const *output_data, uint32_t output_data_size)
+{
+    StatsTimer stats_timer(STATS_SOUND_CONVERSION);
+    stats_timer.AddBytes(input_data_size);
+
+    uint32_t output_block_align = (bits_per_sample + 7) / 8;
+    uint32_t sample_count = input_data_size / (channel_count * output_block_align);
+
+    BMX_CHECK(output_data_size >= sample_count * output_block_align);
+
+    switch (output_block_align)
+    {
+        case 2:
+            deinterleave_all_channels<2>(input_data, output_block_align, channel_count, sample_count, output_data);
+            break;
+        case 3:
+            deinterleave_all_channels<3>(input_data, output_block_align, channel_count, sample_count, output_data);
+            break;
+        case 4:
+            deinterleave_all_channels<4>(input_data, output_block_align, channel_count, sample_count, output_data);
+            break;
+        default:
+            deinterleave_all_channels<0>(input_data, output_block_align, channel_count, sample_count, output_data);
+            break;
     }
 }
 
@@ -183,16 +767,30 @@ void bmx::interleave_audio(const unsigned char *input_data, uint32_t input_data_
                            uint32_t bits_per_sample, uint16_t channel_count, uint16_t channel_num,
                            unsigned char *output_data, uint32_t output_data_size)
 {
+    StatsTimer stats_timer(STATS_SOUND_CONVERSION);
+    stats_timer.AddBytes(input_data_size);
+
     uint32_t input_block_align = (bits_per_sample + 7) / 8;
     uint32_t output_block_align = channel_count * input_block_align;
-    uint32_t channel_offset = channel_num * input_block_align;
     uint32_t sample_count = input_data_size / input_block_align;
-    uint32_t i, j;
 
     BMX_CHECK(output_data_size >= sample_count * output_block_align);
+    BMX_CHECK(channel_num < channel_count);
 
-    for (i = 0; i < sample_count; i++) {
-        for (j = 0; j < input_block_align; j++)
-            output_data[i * output_block_align + channel_offset + j] = input_data[i * input_block_align + j];
+    switch (input_block_align)
+    {
+        case 2:
+            interleave_channel<2>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 3:
+            interleave_channel<3>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        case 4:
+            interleave_channel<4>(input_data, channel_count, channel_num, sample_count, output_data);
+            break;
+        default:
+            interleave_any_channel(input_data, input_block_align, output_block_align, channel_num, sample_count,
+                                   output_data);
+            break;
     }
 }
@@ -41,6 +41,7 @@
 #include <limits.h>
 
 #include <bmx/essence_parser/VC2EssenceParser.h>
+#include "EssenceParserUtils.h"
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -314,59 +315,40 @@ uint32_t VC2EssenceParser::ParseFrameSize(const unsigned char *data, uint32_t da
                 mOffset = buffer.GetPos();
                 mParseState = PARSE_INFO_STATE;
             } else {
-                mSearchState = 0;
                 mSearchCount = (uint32_t)(buffer.GetPos() - mOffset);
                 mParseState = SEARCH_PARSE_INFO_STATE;
             }
         } else { // mParseState == SEARCH_PARSE_INFO_STATE
-            buffer.SetPos(mOffset + mSearchCount);
-            while (buffer.GetRemSize() > 0) {
-                uint32_t next_data;
-                uint32_t read_count;
-                while (mSearchState != PARSE_INFO_PREFIX && mSearchCount < MAX_SEARCH_COUNT) {
-                    if ((mSearchState & 0x00ffffff) == (PARSE_INFO_PREFIX >> 8))
-                        read_count = 1;
-                    else if ((mSearchState & 0x0000ffff) == (PARSE_INFO_PREFIX >> 16))
-                        read_count = 2;
-                    else if ((mSearchState & 0x000000ff) == (PARSE_INFO_PREFIX >> 24))
-                        read_count = 3;
-                    else
-                        read_count = 4;
-                    try {
-                        next_data = (uint32_t)buffer.GetUIntLit(read_count);
-                    } catch (...) {
-                        // end of buffer
-                        break;
-                    }
-                    if (read_count == 4)
-                        mSearchState = next_data;
-                    else
-                        mSearchState = (mSearchState << (read_count * 8)) | next_data;
-                    mSearchCount += read_count;
-                }
-                if (mSearchState != PARSE_INFO_PREFIX) {
+            // mSearchCount is the offset from mOffset where the next parse info prefix could start
+            while (true) {
+                uint32_t search_pos = mOffset + mSearchCount;
+                uint32_t prefix_offset = find_parse_info_prefix(&data[search_pos], data_size - search_pos);
+                if (prefix_offset == ESSENCE_PARSER_NULL_OFFSET) {
+                    // a prefix could start in the last 3 bytes and be completed by the next data
+                    if (data_size - search_pos > 3)
+                        mSearchCount = data_size - 3 - mOffset;
                     if (mSearchCount >= MAX_SEARCH_COUNT) {
                         log_warn("Failed to find next parse info within maximum %u bytes\n", MAX_SEARCH_COUNT);
                         return ESSENCE_PARSER_NULL_FRAME_SIZE;
                     }
                     break;
                 }
+                mSearchCount += prefix_offset;
 
                 ParseInfo parse_info;
-                buffer.SetPos(buffer.GetPos() - 4);
+                buffer.SetPos(mOffset + mSearchCount);
                 uint32_t res = ParseParseInfo(&buffer, &parse_info);
-                if (res == 0) {
-                    mSearchState = 0;
-                } else {
-                    if (res != ESSENCE_PARSER_NULL_OFFSET &&
-                        parse_info.prev_parse_offset == VC2_PARSE_INFO_SIZE + mSearchCount - 4)
-                    {
-                        buffer.SetPos(buffer.GetPos() - VC2_PARSE_INFO_SIZE);
-                        mOffset = buffer.GetPos();
-                        mParseState = PARSE_INFO_STATE;
-                    }
+                if (res == ESSENCE_PARSER_NULL_OFFSET)
+                    break; // parse info is incomplete
+                if (res != 0 && parse_info.prev_parse_offset == VC2_PARSE_INFO_SIZE + mSearchCount) {
+                    buffer.SetPos(buffer.GetPos() - VC2_PARSE_INFO_SIZE);
+                    mOffset = buffer.GetPos();
+                    mParseState = PARSE_INFO_STATE;
                     break;
                 }
+
+                // not the next parse info; continue searching from the next byte
+                mSearchCount++;
             }
             if (mParseState == SEARCH_PARSE_INFO_STATE)
                 break; // reached end of buffer
@@ -715,7 +697,6 @@ void VC2EssenceParser::ResetFrameSize()
     memset(&mCurrentParseInfo, 0, sizeof(mCurrentParseInfo));
     mParseInfos.clear();
     mPictureCount = 0;
-    mSearchState = 0;
     mSearchCount = 0;
 }
 
@@ -38,6 +38,7 @@
 #include <cstring>
 
 #include <bmx/frame/DataBufferArray.h>
+#include <bmx/ByteArray.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
 
@@ -69,3 +70,18 @@ void bmx::dba_copy_data(unsigned char *dest, uint32_t dest_size, const CDataBuff
     }
 }
 
+const unsigned char* bmx::dba_gather_data(ByteArray *gather_buffer, const CDataBuffer *data_array, uint32_t array_size,
+                                          uint32_t *size)
+{
+    if (array_size == 1) {
+        *size = data_array[0].size;
+        return data_array[0].data;
+    }
+
+    *size = dba_get_total_size(data_array, array_size);
+    gather_buffer->Allocate(*size);
+    dba_copy_data(gather_buffer->GetBytes(), gather_buffer->GetAllocatedSize(), data_array, array_size);
+    gather_buffer->SetSize(*size);
+
+    return gather_buffer->GetBytes();
+}
@@ -34,6 +34,7 @@
 #endif
 
 #include <bmx/frame/Frame.h>
+#include <bmx/Thread.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
 
@@ -42,6 +43,100 @@ using namespace bmx;
 
 
 
+namespace bmx
+{
+
+// The pool is shared between the factory and the frames it created so that frames can outlive the factory.
+// Frames may be created and released by the essence reader's prefetch thread and therefore access is
+// serialized by a mutex
+
+class FramePool
+{
+public:
+    FramePool(uint32_t max_free_frames)
+    {
+        mMaxFreeFrames = max_free_frames;
+        mRefCount = 1;
+        mClosed = false;
+    }
+
+    PooledFrame* Acquire()
+    {
+        {
+            MutexLocker locker(&mMutex);
+            if (!mFreeFrames.empty()) {
+                PooledFrame *frame = mFreeFrames.back();
+                mFreeFrames.pop_back();
+                return frame;
+            }
+        }
+
+        return new PooledFrame(this);
+    }
+
+    void Recycle(PooledFrame *frame)
+    {
+        frame->Reset();
+        frame->mData.SetSize(0);
+
+        {
+            MutexLocker locker(&mMutex);
+            if (!mClosed && mFreeFrames.size() < mMaxFreeFrames) {
+                mFreeFrames.push_back(frame);
+                return;
+            }
+        }
+
+        delete frame;
+    }
+
+    void AddRef()
+    {
+        MutexLocker locker(&mMutex);
+        mRefCount++;
+    }
+
+    void RemoveRef()
+    {
+        bool delete_pool;
+        {
+            MutexLocker locker(&mMutex);
+            mRefCount--;
+            delete_pool = (mRefCount == 0);
+        }
+
+        if (delete_pool)
+            delete this;
+    }
+
+    void Close()
+    {
+        vector<PooledFrame*> free_frames;
+        {
+            MutexLocker locker(&mMutex);
+            mClosed = true;
+            free_frames.swap(mFreeFrames);
+        }
+
+        size_t i;
+        for (i = 0; i < free_frames.size(); i++)
+            delete free_frames[i];
+
+        RemoveRef();
+    }
+
+private:
+    Mutex mMutex;
+    uint32_t mMaxFreeFrames;
+    uint32_t mRefCount;
+    bool mClosed;
+    vector<PooledFrame*> mFreeFrames;
+};
+
+};
+
+
+
 FrameMetadata::FrameMetadata(const char *id)
 {
     mId = id;
@@ -113,6 +208,11 @@ Frame::~Frame()
     }
 }
 
+void Frame::Release()
+{
+    delete this;
+}
+
 const vector<FrameMetadata*>* Frame::GetMetadata(std::string id) const
 {
     map<string, vector<FrameMetadata*> >::const_iterator result = mMetadata.find(id);
@@ -127,6 +227,35 @@ void Frame::InsertMetadata(FrameMetadata *metadata)
     mMetadata[metadata->GetId()].push_back(metadata);
 }
 
+void Frame::Reset()
+{
+    edit_rate = ZERO_RATIONAL;
+    position = NULL_FRAME_POSITION;
+    track_edit_rate = ZERO_RATIONAL;
+    track_position = NULL_FRAME_POSITION;
+    ec_position = NULL_FRAME_POSITION;
+    request_num_samples = 0;
+    first_sample_offset = 0;
+    num_samples = 0;
+    temporal_reordering = false;
+    temporal_offset = 0;
+    key_frame_offset = 0;
+    flags = 0;
+    cp_file_position = 0;
+    file_position = 0;
+    kl_size = 0;
+    file_id = (size_t)(-1);
+    element_key = g_Null_Key;
+
+    map<string, vector<FrameMetadata*> >::const_iterator iter;
+    for (iter = mMetadata.begin(); iter != mMetadata.end(); iter++) {
+        size_t i;
+        for (i = 0; i < iter->second.size(); i++)
+            delete iter->second[i];
+    }
+    mMetadata.clear();
+}
+
 
 
 DefaultFrame::DefaultFrame()
@@ -184,3 +313,86 @@ Frame* DefaultFrameFactory::CreateFrame()
     return new DefaultFrame();
 }
 
+
+
+PooledFrame::PooledFrame(FramePool *pool)
+: Frame()
+{
+    mPool = pool;
+    mPool->AddRef();
+}
+
+PooledFrame::PooledFrame(const PooledFrame &from)
+: Frame(from), mData(from.mData)
+{
+    mPool = from.mPool;
+    mPool->AddRef();
+}
+
+PooledFrame::~PooledFrame()
+{
+    mPool->RemoveRef();
+}
+
+uint32_t PooledFrame::GetSize() const
+{
+    return mData.GetSize();
+}
+
+const unsigned char* PooledFrame::GetBytes() const
+{
+    return mData.GetBytes();
+}
+
+void PooledFrame::Grow(uint32_t min_size)
+{
+    mData.Grow(min_size);
+}
+
+uint32_t PooledFrame::GetSizeAvailable() const
+{
+    return mData.GetSizeAvailable();
+}
+
+unsigned char* PooledFrame::GetBytesAvailable() const
+{
+    return mData.GetBytesAvailable();
+}
+
+void PooledFrame::SetSize(uint32_t size)
+{
+    mData.SetSize(size);
+}
+
+void PooledFrame::IncrementSize(uint32_t inc)
+{
+    mData.IncrementSize(inc);
+}
+
+Frame* PooledFrame::Clone()
+{
+    return new PooledFrame(*this);
+}
+
+void PooledFrame::Release()
+{
+    mPool->Recycle(this);
+}
+
+
+
+PooledFrameFactory::PooledFrameFactory(uint32_t max_free_frames)
+{
+    mPool = new FramePool(max_free_frames);
+}
+
+PooledFrameFactory::~PooledFrameFactory()
+{
+    mPool->Close();
+}
+
+Frame* PooledFrameFactory::CreateFrame()
+{
+    return mPool->Acquire();
+}
+
@@ -110,7 +110,7 @@ void DefaultFrameBuffer::PushFrame(Frame *frame)
 void DefaultFrameBuffer::PopFrame(bool del_frame)
 {
     if (del_frame && mFrames.front())
-        delete mFrames.front();
+        mFrames.front()->Release();
 
     mFrames.pop_front();
 }
@@ -136,8 +136,10 @@ void DefaultFrameBuffer::Clear(bool del_frames)
 {
     if (del_frames) {
         size_t i;
-        for (i = 0; i < mFrames.size(); i++)
-            delete mFrames[i];
+        for (i = 0; i < mFrames.size(); i++) {
+            if (mFrames[i])
+                mFrames[i]->Release();
+        }
     }
 
     mFrames.clear();
@@ -103,6 +103,8 @@ OP1AFile::OP1AFile(int flavour, mxfpp::File *mxf_file, mxfRational frame_rate)
     mWaitForIndexComplete = false;
     mPartitionInterval = 0;
     mPartitionFrameCount = 0;
+    mLiveUpdateInterval = 0;
+    mLiveUpdateHeader = false;
     mKAGSize = ((flavour & OP1A_512_KAG_FLAVOUR) ? 512 : 1);
     mEssencePartitionKAGSize = mKAGSize;
     mSupportCompleteSinglePass = false;
@@ -110,6 +112,12 @@ OP1AFile::OP1AFile(int flavour, mxfpp::File *mxf_file, mxfRational frame_rate)
     mMXFChecksumFile = 0;
     mCBEIndexPartitionIndex = 0;
 
+    // a stream output, e.g. stdout or a pipe, can only be written in a single pass
+    if (!mMXFFile->isSeekable() && !(mFlavour & OP1A_SINGLE_PASS_WRITE_FLAVOUR)) {
+        log_info("Writing in a single pass because the output file is not seekable\n");
+        mFlavour |= OP1A_SINGLE_PASS_WRITE_FLAVOUR;
+    }
+
     mTrackIdHelper.SetId("TimecodeTrack", 901);
     mTrackIdHelper.SetStartId(MXF_PICTURE_DDEF, 1001);
     mTrackIdHelper.SetStartId(MXF_SOUND_DDEF,   2001);
@@ -241,6 +249,12 @@ void OP1AFile::SetRepeatIndexTable(bool enable)
     mIndexTable->SetRepeatIndexTable(enable);
 }
 
+void OP1AFile::SetLiveUpdateInterval(int64_t frame_count)
+{
+    BMX_CHECK(frame_count >= 0);
+    mLiveUpdateInterval = frame_count;
+}
+
 void OP1AFile::SetOutputStartOffset(int64_t offset)
 {
     BMX_CHECK(offset >= 0);
@@ -305,6 +319,18 @@ void OP1AFile::PrepareHeaderMetadata()
 
     BMX_CHECK(!mTracks.empty());
 
+    // the clip wrapped essence element length is only known at the end and is updated in place
+    BMX_CHECK_M(mFrameWrapped || mMXFFile->isSeekable(),
+                ("Clip wrapping is not supported when the output file is not seekable"));
+
+    // live update requires body partitions to hold the index table segments written so far
+    if (mLiveUpdateInterval > 0) {
+        BMX_CHECK_M(!(mFlavour & OP1A_MIN_PARTITIONS_FLAVOUR),
+                    ("Live update is not supported with the minimal partitions flavour"));
+        if (mPartitionInterval == 0 || mPartitionInterval > mLiveUpdateInterval)
+            mPartitionInterval = mLiveUpdateInterval;
+    }
+
     // sort tracks, picture - sound - data
     stable_sort(mTracks.begin(), mTracks.end(), compare_track);
 
@@ -363,6 +389,11 @@ void OP1AFile::PrepareWrite()
     if (!mHavePreparedHeaderMetadata)
         PrepareHeaderMetadata();
 
+    // the header metadata can only be updated in place if the file allows seeking back
+    mLiveUpdateHeader = (mLiveUpdateInterval > 0 &&
+                         !(mFlavour & OP1A_SINGLE_PASS_WRITE_FLAVOUR) &&
+                         mMXFFile->isSeekable());
+
     CreateFile();
 }
 
@@ -384,6 +415,16 @@ void OP1AFile::WriteSamples(uint32_t track_index, const unsigned char *data, uin
     WriteContentPackages(false);
 }
 
+void OP1AFile::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    if (!data_array || dba_get_total_size(data_array, array_size) == 0)
+        return;
+
+    GetTrack(track_index)->WriteSampleArrayInt(data_array, array_size);
+
+    WriteContentPackages(false);
+}
+
 void OP1AFile::CompleteWrite()
 {
     BMX_ASSERT(mMXFFile);
@@ -566,6 +607,12 @@ void OP1AFile::CompleteWrite()
     }
 
 
+    // write the output buffered by a stream. The seek fails if that fails, whereas the close only logs it
+
+    if (!mMXFFile->isSeekable())
+        mMXFFile->seek(mMXFFile->tell(), SEEK_SET);
+
+
     // done with the file
     delete mMXFFile;
     mMXFFile = 0;
@@ -853,7 +900,13 @@ void OP1AFile::UpdateTrackMetadata(GenericPackage *package, int64_t origin, int6
         Sequence *sequence = dynamic_cast<Sequence*>(track->getSequence());
         BMX_ASSERT(sequence);
         vector<StructuralComponent*> components = sequence->getStructuralComponents();
-        if (sequence->getDuration() < 0) {
+        if (sequence->getDuration() < 0 ||
+            find(mLiveUpdateSequences.begin(), mLiveUpdateSequences.end(), sequence) != mLiveUpdateSequences.end())
+        {
+            // remember the sequences with an unknown duration so that later live updates set it again
+            if (mLiveUpdateHeader && sequence->getDuration() < 0)
+                mLiveUpdateSequences.push_back(sequence);
+
             sequence->setDuration(duration);
             BMX_ASSERT(components.size() == 1);
             components[0]->setDuration(duration);
@@ -871,6 +924,32 @@ void OP1AFile::UpdateTrackMetadata(GenericPackage *package, int64_t origin, int6
     }
 }
 
+void OP1AFile::UpdateLiveHeaderMetadata()
+{
+    int64_t file_pos = mMXFFile->tell();
+
+    UpdatePackageMetadata();
+
+
+    // re-write the header partition pack and the header metadata in place. The header partition stays
+    // open and incomplete because the duration will change
+
+    mMXFFile->seek(0, SEEK_SET);
+    mMXFFile->openMemoryFile(MEMORY_WRITE_CHUNK_SIZE);
+    mMXFFile->setMemoryPartitionIndexes(0, 0);
+
+    Partition &header_partition = mMXFFile->getPartition(0);
+    header_partition.write(mMXFFile);
+
+    PositionFillerWriter pos_filler_writer(mHeaderMetadataEndPos);
+    mHeaderMetadata->write(mMXFFile, &header_partition, &pos_filler_writer);
+
+    mMXFFile->updatePartitions();
+    mMXFFile->closeMemoryFile();
+
+    mMXFFile->seek(file_pos, SEEK_SET);
+}
+
 void OP1AFile::WriteContentPackages(bool end_of_samples)
 {
     // for dual segment index tables (eg. AVCI), wait for first 2 content packages before writing
@@ -946,6 +1025,8 @@ void OP1AFile::WriteContentPackages(bool end_of_samples)
             }
         }
 
+        bool live_update_header = (start_ess_partition && mLiveUpdateHeader && mIndexTable->GetDuration() > 0);
+
         if (start_ess_partition) {
             // write VBE index table segments and ensure new essence partition is started
 
@@ -990,6 +1071,9 @@ void OP1AFile::WriteContentPackages(bool end_of_samples)
             mMXFFile->closeMemoryFile();
         }
 
+        if (live_update_header)
+            UpdateLiveHeaderMetadata();
+
         mCPManager->WriteNextContentPackage();
 
         if (mPartitionInterval > 0)
@@ -50,11 +50,12 @@ using namespace mxfpp;
 //      (65535 [2-byte max len]
 //        - (80 [segment header] + 12 [delta entry array header] + 6 [delta entry] + 22 [index entry array header]))
 #define MAX_INDEX_SEGMENT_SIZE      65000
-#define INDEX_ENTRIES_INCREMENT     250
+#define INDEX_ENTRY_CHUNK_ENTRIES   256
 
 #define MAX_GOP_SIZE_GUESS          30
 
-#define MAX_CACHE_ENTRIES           250
+// index entry cache ring buffer size, which limits the distance between the oldest and newest cached entry
+#define MAX_CACHE_ENTRIES           256
 
 
 
@@ -116,46 +117,71 @@ OP1AIndexTableElement::OP1AIndexTableElement(uint32_t track_index_, ElementType
     slice_offset = 0;
     element_size = 0;
     last_add_index_entry_pos = -1;
+    mIndexEntryCacheCount = 0;
 }
 
 void OP1AIndexTableElement::CacheIndexEntry(int64_t position, int8_t temporal_offset, int8_t key_frame_offset,
                                             uint8_t flags, bool can_start_partition, bool require_update)
 {
-    BMX_CHECK(mIndexEntryCache.size() <= MAX_CACHE_ENTRIES);
+    BMX_ASSERT(position >= 0);
+
+    if (mIndexEntryCache.empty()) {
+        mIndexEntryCache.resize(MAX_CACHE_ENTRIES);
+        mIndexEntryCachePositions.resize(MAX_CACHE_ENTRIES, -1);
+    }
 
-    mIndexEntryCache[position] = OP1AIndexEntry(temporal_offset, key_frame_offset, flags, can_start_partition);
+    size_t slot = (size_t)(position % MAX_CACHE_ENTRIES);
+    BMX_CHECK(mIndexEntryCachePositions[slot] < 0 || mIndexEntryCachePositions[slot] == position);
 
-    if (require_update)
-        require_updates.insert(position);
+    if (mIndexEntryCachePositions[slot] < 0)
+        mIndexEntryCacheCount++;
+    mIndexEntryCache[slot] = OP1AIndexEntry(temporal_offset, key_frame_offset, flags, can_start_partition);
+    mIndexEntryCachePositions[slot] = position;
+
+    if (require_update) {
+        if (mRequireUpdates.empty() || position > mRequireUpdates.back()) {
+            mRequireUpdates.push_back(position);
+        } else {
+            vector<int64_t>::iterator iter = lower_bound(mRequireUpdates.begin(), mRequireUpdates.end(), position);
+            if (*iter != position)
+                mRequireUpdates.insert(iter, position);
+        }
+    }
     if (position > last_add_index_entry_pos)
         last_add_index_entry_pos = position;
 }
 
 void OP1AIndexTableElement::UpdateIndexEntry(int64_t position, int8_t temporal_offset)
 {
-    BMX_ASSERT(mIndexEntryCache.find(position) != mIndexEntryCache.end());
+    size_t slot = (size_t)(position % MAX_CACHE_ENTRIES);
+    BMX_ASSERT(!mIndexEntryCache.empty() && mIndexEntryCachePositions[slot] == position);
 
-    mIndexEntryCache[position].temporal_offset = temporal_offset;
+    mIndexEntryCache[slot].temporal_offset = temporal_offset;
 }
 
 void OP1AIndexTableElement::UpdateIndexEntry(int64_t position, int8_t temporal_offset, int8_t key_frame_offset,
                                              uint8_t flags)
 {
-    BMX_ASSERT(mIndexEntryCache.find(position) != mIndexEntryCache.end());
+    size_t slot = (size_t)(position % MAX_CACHE_ENTRIES);
+    BMX_ASSERT(!mIndexEntryCache.empty() && mIndexEntryCachePositions[slot] == position);
 
-    mIndexEntryCache[position].temporal_offset  = temporal_offset;
-    mIndexEntryCache[position].key_frame_offset = key_frame_offset;
-    mIndexEntryCache[position].flags            = flags;
+    mIndexEntryCache[slot].temporal_offset  = temporal_offset;
+    mIndexEntryCache[slot].key_frame_offset = key_frame_offset;
+    mIndexEntryCache[slot].flags            = flags;
 }
 
 bool OP1AIndexTableElement::TakeIndexEntry(int64_t position, OP1AIndexEntry *entry)
 {
-    map<int64_t, OP1AIndexEntry>::iterator result = mIndexEntryCache.find(position);
-    if (result == mIndexEntryCache.end())
+    if (mIndexEntryCacheCount == 0)
+        return false;
+
+    size_t slot = (size_t)(position % MAX_CACHE_ENTRIES);
+    if (mIndexEntryCachePositions[slot] != position)
         return false;
 
-    *entry = result->second;
-    mIndexEntryCache.erase(result);
+    *entry = mIndexEntryCache[slot];
+    mIndexEntryCachePositions[slot] = -1;
+    mIndexEntryCacheCount--;
 
     return true;
 }
@@ -165,24 +191,77 @@ bool OP1AIndexTableElement::CanStartPartition(int64_t position)
     if (is_cbe)
         return true;
 
-    BMX_ASSERT(mIndexEntryCache.find(position) != mIndexEntryCache.end());
+    size_t slot = (size_t)(position % MAX_CACHE_ENTRIES);
+    BMX_ASSERT(!mIndexEntryCache.empty() && mIndexEntryCachePositions[slot] == position);
 
-    return (mIndexEntryCache[position].can_start_partition);
+    return (mIndexEntryCache[slot].can_start_partition);
 }
 
 bool OP1AIndexTableElement::RequireUpdatesAtEnd(int64_t end_offset) const
 {
-    return !require_updates.empty() && (*require_updates.begin()) <= last_add_index_entry_pos + end_offset;
+    return !mRequireUpdates.empty() && mRequireUpdates.front() <= last_add_index_entry_pos + end_offset;
 }
 
 bool OP1AIndexTableElement::RequireUpdatesAtPos(int64_t position) const
 {
-    return !require_updates.empty() && (*require_updates.begin()) <= position;
+    return !mRequireUpdates.empty() && mRequireUpdates.front() <= position;
+}
+
+void OP1AIndexTableElement::ClearRequiredUpdate(int64_t position)
+{
+    // updates are mostly for the oldest positions and the vector is limited to the reordering window
+    vector<int64_t>::iterator iter = lower_bound(mRequireUpdates.begin(), mRequireUpdates.end(), position);
+    if (iter != mRequireUpdates.end() && *iter == position)
+        mRequireUpdates.erase(iter);
 }
 
 void OP1AIndexTableElement::IgnoreRequiredUpdates()
 {
-    require_updates.clear();
+    mRequireUpdates.clear();
+}
+
+
+
+OP1AIndexEntryArena::OP1AIndexEntryArena()
+{
+    mChunkSize = 0;
+}
+
+OP1AIndexEntryArena::~OP1AIndexEntryArena()
+{
+    size_t i;
+    for (i = 0; i < mFreeChunks.size(); i++)
+        delete [] mFreeChunks[i];
+}
+
+void OP1AIndexEntryArena::SetChunkSize(uint32_t size)
+{
+    BMX_ASSERT(size > 0);
+
+    if (size != mChunkSize) {
+        size_t i;
+        for (i = 0; i < mFreeChunks.size(); i++)
+            delete [] mFreeChunks[i];
+        mFreeChunks.clear();
+        mChunkSize = size;
+    }
+}
+
+unsigned char* OP1AIndexEntryArena::AllocateChunk()
+{
+    BMX_ASSERT(mChunkSize > 0);
+
+    if (mFreeChunks.empty())
+        return new unsigned char[mChunkSize];
+
+    unsigned char *chunk = mFreeChunks.back();
+    mFreeChunks.pop_back();
+    return chunk;
+}
+
+void OP1AIndexEntryArena::FreeChunk(unsigned char *chunk)
+{
+    mFreeChunks.push_back(chunk);
 }
 
 
@@ -191,11 +270,13 @@ OP1AIndexTableSegment::OP1AIndexTableSegment(uint32_t index_sid, uint32_t body_s
                                              int64_t start_position, uint32_t index_entry_size,
                                              uint32_t slice_count, bool force_write_slice_count,
                                              mxfOptBool single_index_location, mxfOptBool single_essence_location,
-                                             mxfOptBool forward_index_direction)
+                                             mxfOptBool forward_index_direction, OP1AIndexEntryArena *arena)
 {
+    mArena = arena;
+    mChunkNumEntries = arena->GetChunkSize() / index_entry_size;
+    mNumEntries = 0;
     mIndexEntrySize = index_entry_size;
-
-    mEntries.SetAllocBlockSize(INDEX_ENTRIES_INCREMENT * index_entry_size);
+    BMX_ASSERT(mChunkNumEntries > 0);
 
     mxfUUID uuid;
     mxf_generate_uuid(&uuid);
@@ -216,21 +297,29 @@ OP1AIndexTableSegment::OP1AIndexTableSegment(uint32_t index_sid, uint32_t body_s
 
 OP1AIndexTableSegment::~OP1AIndexTableSegment()
 {
+    size_t i;
+    for (i = 0; i < mEntryChunks.size(); i++)
+        mArena->FreeChunk(mEntryChunks[i]);
 }
 
 bool OP1AIndexTableSegment::RequireNewSegment(uint8_t can_start_partition)
 {
-    return mEntries.GetSize() >= MAX_INDEX_SEGMENT_SIZE ||
-          (mEntries.GetSize() >= (MAX_INDEX_SEGMENT_SIZE - MAX_GOP_SIZE_GUESS * mIndexEntrySize) && can_start_partition);
+    uint32_t entries_size = mNumEntries * mIndexEntrySize;
+    return entries_size >= MAX_INDEX_SEGMENT_SIZE ||
+          (entries_size >= (MAX_INDEX_SEGMENT_SIZE - MAX_GOP_SIZE_GUESS * mIndexEntrySize) && can_start_partition);
 }
 
 void OP1AIndexTableSegment::AddIndexEntry(const OP1AIndexEntry *entry, int64_t stream_offset,
-                                          vector<uint32_t> slice_cp_offsets)
+                                          const vector<uint32_t> &slice_cp_offsets)
 {
     BMX_ASSERT(mIndexEntrySize == 11 + slice_cp_offsets.size() * 4);
-    mEntries.Grow(mIndexEntrySize);
 
-    unsigned char *entry_bytes = mEntries.GetBytesAvailable();
+    // entries are appended to fixed size chunks and therefore never need to be reallocated and copied
+    if (mNumEntries == mEntryChunks.size() * mChunkNumEntries)
+        mEntryChunks.push_back(mArena->AllocateChunk());
+    mNumEntries++;
+
+    unsigned char *entry_bytes = GetEntryBytes(mNumEntries - 1);
     mxf_set_int8(entry->temporal_offset, &entry_bytes[0]);
     mxf_set_int8(entry->key_frame_offset, &entry_bytes[1]);
     mxf_set_uint8(entry->flags, &entry_bytes[2]);
@@ -239,26 +328,25 @@ void OP1AIndexTableSegment::AddIndexEntry(const OP1AIndexEntry *entry, int64_t s
     for (i = 0; i < slice_cp_offsets.size(); i++)
         mxf_set_uint32(slice_cp_offsets[i], &entry_bytes[11 + i * 4]);
 
-    mEntries.IncrementSize(mIndexEntrySize);
-
     mSegment.incrementIndexDuration();
 }
 
 void OP1AIndexTableSegment::UpdateIndexEntry(int64_t segment_position, int8_t temporal_offset)
 {
-    BMX_ASSERT(segment_position * mIndexEntrySize < mEntries.GetSize());
+    BMX_ASSERT(segment_position >= 0 && segment_position < mNumEntries);
 
-    mxf_set_int8(temporal_offset, &mEntries.GetBytes()[segment_position * mIndexEntrySize]);
+    mxf_set_int8(temporal_offset, GetEntryBytes(segment_position));
 }
 
 void OP1AIndexTableSegment::UpdateIndexEntry(int64_t segment_position, int8_t temporal_offset, int8_t key_frame_offset,
                                              uint8_t flags)
 {
-    BMX_ASSERT(segment_position * mIndexEntrySize < mEntries.GetSize());
+    BMX_ASSERT(segment_position >= 0 && segment_position < mNumEntries);
 
-    mxf_set_int8(temporal_offset,  &mEntries.GetBytes()[segment_position * mIndexEntrySize]);
-    mxf_set_int8(key_frame_offset, &mEntries.GetBytes()[segment_position * mIndexEntrySize + 1]);
-    mxf_set_int8(flags,            &mEntries.GetBytes()[segment_position * mIndexEntrySize + 2]);
+    unsigned char *entry_bytes = GetEntryBytes(segment_position);
+    mxf_set_int8(temporal_offset,  &entry_bytes[0]);
+    mxf_set_int8(key_frame_offset, &entry_bytes[1]);
+    mxf_set_int8(flags,            &entry_bytes[2]);
 }
 
 void OP1AIndexTableSegment::AddCBEIndexEntries(uint32_t edit_unit_byte_count, uint32_t num_entries)
@@ -278,6 +366,23 @@ uint32_t OP1AIndexTableSegment::GetDuration() const
     return (uint32_t)mSegment.getIndexDuration();
 }
 
+void OP1AIndexTableSegment::WriteEntries(File *mxf_file)
+{
+    uint32_t remaining_entries = mNumEntries;
+    size_t i;
+    for (i = 0; i < mEntryChunks.size(); i++) {
+        uint32_t num_entries = (remaining_entries < mChunkNumEntries ? remaining_entries : mChunkNumEntries);
+        mxf_file->write(mEntryChunks[i], num_entries * mIndexEntrySize);
+        remaining_entries -= num_entries;
+    }
+}
+
+unsigned char* OP1AIndexTableSegment::GetEntryBytes(int64_t segment_position)
+{
+    return &mEntryChunks[(size_t)(segment_position / mChunkNumEntries)]
+                        [(segment_position % mChunkNumEntries) * mIndexEntrySize];
+}
+
 
 
 OP1AIndexTable::OP1AIndexTable(uint32_t index_sid, uint32_t body_sid, mxfRational edit_rate, bool force_write_slice_count)
@@ -391,15 +496,17 @@ void OP1AIndexTable::PrepareWrite()
     }
     BMX_ASSERT(!mIsCBE || mSliceCount == 0);
 
+    mEntryArena.SetChunkSize(INDEX_ENTRY_CHUNK_ENTRIES * mIndexEntrySize);
+
     mIndexSegments.push_back(new OP1AIndexTableSegment(mIndexSID, mBodySID, mEditRate, 0, mIndexEntrySize,
                                                        mSliceCount, mForceWriteSliceCount,
                                                        mSingleIndexLocation, mSingleEssenceLocation,
-                                                       mForwardIndexDirection));
+                                                       mForwardIndexDirection, &mEntryArena));
     if (RequireIndexTableSegmentPair()) {
         mAVCIFirstIndexSegment = new OP1AIndexTableSegment(mIndexSID, mBodySID, mEditRate, 0, mIndexEntrySize,
                                                            mSliceCount, mForceWriteSliceCount,
                                                            mSingleIndexLocation, mSingleEssenceLocation,
-                                                           mForwardIndexDirection);
+                                                           mForwardIndexDirection, &mEntryArena);
     }
 }
 
@@ -449,7 +556,7 @@ void OP1AIndexTable::UpdateIndexEntry(uint32_t track_index, int64_t position, in
         mIndexSegments[i]->UpdateIndexEntry(mIndexSegments[i]->GetDuration() - end_offset, temporal_offset);
     }
 
-    mIndexElementsMap[track_index]->require_updates.erase(position);
+    mIndexElementsMap[track_index]->ClearRequiredUpdate(position);
 }
 
 void OP1AIndexTable::UpdateIndexEntry(uint32_t track_index, int64_t position, int8_t temporal_offset,
@@ -472,7 +579,7 @@ void OP1AIndexTable::UpdateIndexEntry(uint32_t track_index, int64_t position, in
                                             key_frame_offset, flags);
     }
 
-    mIndexElementsMap[track_index]->require_updates.erase(position);
+    mIndexElementsMap[track_index]->ClearRequiredUpdate(position);
 }
 
 bool OP1AIndexTable::CanStartPartition()
@@ -489,7 +596,7 @@ bool OP1AIndexTable::CanStartPartition()
     return true;
 }
 
-void OP1AIndexTable::UpdateIndex(uint32_t size, vector<uint32_t> element_sizes)
+void OP1AIndexTable::UpdateIndex(uint32_t size, const vector<uint32_t> &element_sizes)
 {
     BMX_ASSERT(element_sizes.size() == mIndexElements.size());
 
@@ -617,7 +724,7 @@ void OP1AIndexTable::IgnoreRequiredUpdates(uint32_t track_index)
     mIndexElementsMap[track_index]->IgnoreRequiredUpdates();
 }
 
-void OP1AIndexTable::CreateDeltaEntries(vector<uint32_t> &element_sizes)
+void OP1AIndexTable::CreateDeltaEntries(const vector<uint32_t> &element_sizes)
 {
     mDeltaEntries.clear();
 
@@ -665,7 +772,7 @@ void OP1AIndexTable::CreateDeltaEntries(vector<uint32_t> &element_sizes)
     }
 }
 
-void OP1AIndexTable::CheckDeltaEntries(vector<uint32_t> &element_sizes)
+void OP1AIndexTable::CheckDeltaEntries(const vector<uint32_t> &element_sizes)
 {
     size_t i;
     for (i = 0; i < mIndexElements.size(); i++) {
@@ -676,7 +783,7 @@ void OP1AIndexTable::CheckDeltaEntries(vector<uint32_t> &element_sizes)
     }
 }
 
-void OP1AIndexTable::UpdateCBEIndex(uint32_t size, vector<uint32_t> &element_sizes)
+void OP1AIndexTable::UpdateCBEIndex(uint32_t size, const vector<uint32_t> &element_sizes)
 {
     if (mDuration == 0 && mAVCIFirstIndexSegment) {
         mAVCIFirstIndexSegment->AddCBEIndexEntries(size, 1);
@@ -708,13 +815,13 @@ void OP1AIndexTable::UpdateCBEIndex(uint32_t size, vector<uint32_t> &element_siz
     }
 }
 
-void OP1AIndexTable::UpdateVBEIndex(vector<uint32_t> &element_sizes)
+void OP1AIndexTable::UpdateVBEIndex(const vector<uint32_t> &element_sizes)
 {
     bool can_start_partition = CanStartPartition(); // check before any TakeIndexEntry calls
 
     uint32_t slice_cp_offset = 0;
-    vector<uint32_t> slice_cp_offsets;
     uint8_t prev_slice_offset = 0;
+    mSliceCPOffsets.clear();
     OP1AIndexEntry entry;
     size_t i;
     for (i = 0; i < mIndexElements.size(); i++) {
@@ -726,7 +833,7 @@ void OP1AIndexTable::UpdateVBEIndex(vector<uint32_t> &element_sizes)
         }
 
         if (mIndexElements[i]->slice_offset != prev_slice_offset) {
-            slice_cp_offsets.push_back(slice_cp_offset);
+            mSliceCPOffsets.push_back(slice_cp_offset);
             prev_slice_offset = mIndexElements[i]->slice_offset;
         }
         slice_cp_offset += element_sizes[i];
@@ -736,10 +843,10 @@ void OP1AIndexTable::UpdateVBEIndex(vector<uint32_t> &element_sizes)
         mIndexSegments.push_back(new OP1AIndexTableSegment(mIndexSID, mBodySID, mEditRate, mDuration,
                                                            mIndexEntrySize, mSliceCount, mForceWriteSliceCount,
                                                            mSingleIndexLocation, mSingleEssenceLocation,
-                                                           mForwardIndexDirection));
+                                                           mForwardIndexDirection, &mEntryArena));
     }
 
-    mIndexSegments.back()->AddIndexEntry(&entry, mStreamOffset, slice_cp_offsets);
+    mIndexSegments.back()->AddIndexEntry(&entry, mStreamOffset, mSliceCPOffsets);
 }
 
 void OP1AIndexTable::WriteCBESegments(File *mxf_file, Partition *partition, bool final_write)
@@ -775,7 +882,6 @@ void OP1AIndexTable::WriteVBESegments(File *mxf_file, Partition *partition, vect
     size_t i;
     for (i = 0; i < segments.size(); i++) {
         IndexTableSegment *segment = segments[i]->GetSegment();
-        ByteArray *entries = segments[i]->GetEntries();
 
         segment->writeHeader(mxf_file, (uint32_t)mDeltaEntries.size(), (uint32_t)segment->getIndexDuration());
 
@@ -789,7 +895,7 @@ void OP1AIndexTable::WriteVBESegments(File *mxf_file, Partition *partition, vect
         }
 
         segment->writeIndexEntryArrayHeader(mxf_file, mSliceCount, 0, (uint32_t)segment->getIndexDuration());
-        mxf_file->write(entries->GetBytes(), entries->GetSize());
+        segments[i]->WriteEntries(mxf_file);
 
         partition->fillToKag(mxf_file);
     }
@@ -331,6 +331,11 @@ void OP1ATrack::WriteSamples(const unsigned char *data, uint32_t size, uint32_t
     mOP1AFile->WriteSamples(mTrackIndex, data, size, num_samples);
 }
 
+void OP1ATrack::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    mOP1AFile->WriteSample(mTrackIndex, data_array, array_size);
+}
+
 mxfUL OP1ATrack::GetEssenceContainerUL() const
 {
     return mDescriptorHelper->GetEssenceContainerUL();
@@ -464,6 +469,16 @@ void OP1ATrack::WriteSampleInt(const CDataBuffer *data_array, uint32_t array_siz
     mCPManager->WriteSample(mTrackIndex, data_array, array_size);
 }
 
+void OP1ATrack::WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(data_array && array_size);
+
+    // tracks that pass the sample data through unchanged override this method to avoid the copy
+    uint32_t size;
+    const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+    WriteSamplesInt(data, size, 1);
+}
+
 void OP1ATrack::CompleteEssenceKeyAndTrackNum(uint8_t track_count)
 {
     mxf_complete_essence_element_key(&mEssenceElementKey,
@@ -43,6 +43,7 @@
 
 #include <bmx/mxf_reader/EssenceChunkHelper.h>
 #include <bmx/mxf_reader/MXFFileReader.h>
+#include <bmx/mxf_reader/MXFIndexCache.h>
 #include <bmx/mxf_helper/PictureMXFDescriptorHelper.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -222,6 +223,45 @@ void EssenceChunkHelper::CreateEssenceChunkIndex(int64_t first_edit_unit_size)
     mIsComplete = true;
 }
 
+void EssenceChunkHelper::WriteIndexCache(MXFIndexCache *cache)
+{
+    cache->WriteUInt8((uint8_t)mFileReader->mWrappingType);
+    cache->WriteUInt32((uint32_t)mNumIndexedPartitions);
+
+    cache->WriteUInt32((uint32_t)mEssenceChunks.size());
+    size_t i;
+    for (i = 0; i < mEssenceChunks.size(); i++) {
+        cache->WriteInt64(mEssenceChunks[i].file_position);
+        cache->WriteInt64(mEssenceChunks[i].essence_offset);
+        cache->WriteInt64(mEssenceChunks[i].size);
+        cache->WriteUInt8(mEssenceChunks[i].is_complete);
+        cache->WriteUInt32((uint32_t)mEssenceChunks[i].partition_id);
+        cache->WriteUL(&mEssenceChunks[i].element_key);
+    }
+}
+
+void EssenceChunkHelper::ReadIndexCache(MXFIndexCache *cache)
+{
+    BMX_ASSERT(mEssenceChunks.empty());
+
+    mFileReader->mWrappingType = (MXFEssenceWrappingType)cache->ReadUInt8();
+    mNumIndexedPartitions = cache->ReadUInt32();
+
+    uint32_t num_chunks = cache->ReadUInt32();
+    mEssenceChunks.resize(num_chunks);
+    uint32_t i;
+    for (i = 0; i < num_chunks; i++) {
+        mEssenceChunks[i].file_position  = cache->ReadInt64();
+        mEssenceChunks[i].essence_offset = cache->ReadInt64();
+        mEssenceChunks[i].size           = cache->ReadInt64();
+        mEssenceChunks[i].is_complete    = cache->ReadUInt8() != 0;
+        mEssenceChunks[i].partition_id   = cache->ReadUInt32();
+        cache->ReadUL(&mEssenceChunks[i].element_key);
+    }
+
+    mIsComplete = true;
+}
+
 void EssenceChunkHelper::AppendChunk(size_t partition_id, int64_t file_position, const mxfKey *element_key,
                                      uint8_t element_llen, uint64_t element_len)
 {
@@ -285,6 +325,38 @@ void EssenceChunkHelper::UpdateLastChunk(int64_t file_position, bool is_end)
     }
 }
 
+void EssenceChunkHelper::ExtendLastChunk(int64_t essence_offset)
+{
+    // the incomplete last chunk is known to contain essence up to essence_offset, e.g. from an index table
+    // segment read from a growing file
+    if (!mEssenceChunks.empty() &&
+        !mEssenceChunks.back().is_complete &&
+        essence_offset > mEssenceChunks.back().essence_offset + mEssenceChunks.back().size)
+    {
+        mEssenceChunks.back().size = essence_offset - mEssenceChunks.back().essence_offset;
+    }
+}
+
+void EssenceChunkHelper::DiscardChunks(int64_t essence_offset)
+{
+    // delete the complete chunks that end before essence_offset, keeping the last chunk
+    size_t num_discard = 0;
+    while (num_discard + 1 < mEssenceChunks.size() &&
+           mEssenceChunks[num_discard].is_complete &&
+           mEssenceChunks[num_discard].essence_offset + mEssenceChunks[num_discard].size <= essence_offset)
+    {
+        num_discard++;
+    }
+    if (num_discard == 0)
+        return;
+
+    mEssenceChunks.erase(mEssenceChunks.begin(), mEssenceChunks.begin() + num_discard);
+    if (mLastEssenceChunk >= num_discard)
+        mLastEssenceChunk -= num_discard;
+    else
+        mLastEssenceChunk = 0;
+}
+
 void EssenceChunkHelper::SetIsComplete()
 {
     mIsComplete = true;
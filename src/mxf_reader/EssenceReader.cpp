@@ -43,9 +43,12 @@
 
 #include <bmx/mxf_reader/EssenceReader.h>
 #include <bmx/mxf_reader/MXFFileReader.h>
+#include <bmx/mxf_reader/MXFIndexCache.h>
 #include <bmx/mxf_helper/PictureMXFDescriptorHelper.h>
 #include <bmx/mxf_helper/SoundMXFDescriptorHelper.h>
+#include <bmx/MXFBufferFile.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -57,6 +60,32 @@ using namespace bmx;
 using namespace mxfpp;
 
 
+#define MAX_CP_BUFFER_SIZE      (64 * 1024 * 1024)
+
+#define PARTITION_SCAN_BLOCK_SIZE   (64 * 1024)
+#define PARTITION_SCAN_MAX_SIZE     (32 * 1024 * 1024)
+
+
+static const unsigned char PARTITION_PACK_PREFIX[13] =
+    {0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01, 0x0d, 0x01, 0x02, 0x01, 0x01};
+
+
+
+static uint32_t get_uint32(const unsigned char *bytes)
+{
+    return ((uint32_t)bytes[0] << 24) |
+           ((uint32_t)bytes[1] << 16) |
+           ((uint32_t)bytes[2] << 8)  |
+            (uint32_t)bytes[3];
+}
+
+static uint64_t get_uint64(const unsigned char *bytes)
+{
+    return ((uint64_t)get_uint32(bytes) << 32) | get_uint32(bytes + 4);
+}
+
+
+
 EssenceReaderBuffer::EssenceReaderBuffer(MXFFileReader *file_reader)
 {
     mFileReader = file_reader;
@@ -132,6 +161,19 @@ Frame* EssenceReaderBuffer::GetFrame(uint32_t track_index)
 }
 
 void EssenceReaderBuffer::PushFrames(uint32_t actual_read_num_samples)
+{
+    mPushFrames.clear();
+    TakeFrames(actual_read_num_samples, &mPushFrames);
+
+    uint32_t t;
+    for (t = 0; t < mPushFrames.size(); t++) {
+        if (mPushFrames[t])
+            mFileReader->GetInternalTrackReader(t)->GetFrameBuffer()->PushFrame(mPushFrames[t]);
+    }
+    mPushFrames.clear();
+}
+
+void EssenceReaderBuffer::TakeFrames(uint32_t actual_read_num_samples, vector<Frame*> *frames)
 {
     uint32_t t;
     for (t = 0; t < mFileReader->GetNumInternalTrackReaders(); t++) {
@@ -140,8 +182,7 @@ void EssenceReaderBuffer::PushFrames(uint32_t actual_read_num_samples)
             frame = GetFrame(t)->Clone();
         else
             frame = TakeFrame(t);
-        if (frame)
-            mFileReader->GetInternalTrackReader(t)->GetFrameBuffer()->PushFrame(frame);
+        frames->push_back(frame);
     }
 
     if (mBufferFrames)
@@ -152,6 +193,11 @@ void EssenceReaderBuffer::PushFrames(uint32_t actual_read_num_samples)
     mCurrentFrame = GetBufferSize(); // i.e. not set
 }
 
+void EssenceReaderBuffer::Reset()
+{
+    Clear();
+}
+
 Frame* EssenceReaderBuffer::TakeFrame(uint32_t track_index)
 {
     BMX_ASSERT(track_index < mTrackFrames.size() && mCurrentFrame < mTrackFrames[track_index].size());
@@ -185,8 +231,10 @@ void EssenceReaderBuffer::Clear()
     for (t = 0; t < mTrackFrames.size(); t++) {
         size_t num_frames = mTrackFrames[t].size();
         size_t f;
-        for (f = 0; f < num_frames; f++)
-            delete mTrackFrames[t][f];
+        for (f = 0; f < num_frames; f++) {
+            if (mTrackFrames[t][f])
+                mTrackFrames[t][f]->Release();
+        }
         mTrackFrames[t].clear();
     }
     mRequestSampleCounts.clear();
@@ -200,7 +248,8 @@ void EssenceReaderBuffer::ClearBeforeFrames(size_t offset)
     for (f = 0; f < offset && !mRequestSampleCounts.empty(); f++) {
         size_t t;
         for (t = 0; t < mTrackFrames.size(); t++) {
-            delete mTrackFrames[t].front();
+            if (mTrackFrames[t].front())
+                mTrackFrames[t].front()->Release();
             mTrackFrames[t].pop_front();
         }
         mStartPosition += mRequestSampleCounts.front();
@@ -222,7 +271,8 @@ void EssenceReaderBuffer::ClearFromFrame(size_t offset)
     for (f = GetBufferSize() - 1; f >= offset; f--) {
         size_t t;
         for (t = 0; t < mTrackFrames.size(); t++) {
-            delete mTrackFrames[t].back();
+            if (mTrackFrames[t].back())
+                mTrackFrames[t].back()->Release();
             mTrackFrames[t].pop_back();
         }
         mRequestSampleCounts.pop_back();
@@ -232,12 +282,13 @@ void EssenceReaderBuffer::ClearFromFrame(size_t offset)
 
 
 
-EssenceReader::EssenceReader(MXFFileReader *file_reader, bool file_is_complete)
+EssenceReader::EssenceReader(MXFFileReader *file_reader, bool file_is_complete, MXFIndexCache *index_cache)
 : mEssenceChunkHelper(file_reader), mIndexTableHelper(file_reader), mReadFrameBuffer(file_reader)
 {
     mFileReader = file_reader;
     mFile = file_reader->mFile;
     mFileIsComplete = file_is_complete;
+    mStreaming = false;
     mFrameMetadataReader = new FrameMetadataReader(file_reader);
     mReadStartPosition = 0;
     mReadDuration = 0;
@@ -255,6 +306,23 @@ EssenceReader::EssenceReader(MXFFileReader *file_reader, bool file_is_complete)
     mLastKnownBasePosition = -1;
     mHaveFooter = file_is_complete;
     mBaseReadError = false;
+    mDiscoverFileSize = 0;
+    mCPReadCount = 0;
+    mCPBufferFilePosition = -1;
+    mCPBufferFile = new File(mxf_buffer_file_open_read(0, 0, 0));
+    mCPBuffer.SetAllocBlockSize(64 * 1024);
+    mReadPosition = 0;
+    mPrefetchDepth = 0;
+    mPrefetchMaxSize = 0;
+    mPrefetchThread = 0;
+    mPrefetchQueueSize = 0;
+    mPrefetchPosition = 0;
+    mPrefetchNumSamples = 0;
+    mPrefetchGeneration = 0;
+    mPrefetchIdle = true;
+    mPrefetchStop = false;
+    mPrefetchPaused = false;
+    mBufferFrames = false;
 
 
     // get ImageStartOffset and ImageEndOffset properties which are used in Avid uncompressed files
@@ -283,16 +351,26 @@ EssenceReader::EssenceReader(MXFFileReader *file_reader, bool file_is_complete)
     // if file is complete then read the index table segments, essence container layout and
     // determine the essence wrapping type
     if (file_is_complete) {
-        if (mFileReader->mIndexSID)
-            mIndexTableHelper.ExtractIndexTable();
-
-        // first edit unit size is used to determine the essence wrapping type
-        int64_t first_edit_unit_size = 0;
-        if (mIndexTableHelper.HaveEditUnitSize(0)) {
-            int64_t offset;
-            mIndexTableHelper.GetEditUnit(0, &offset, &first_edit_unit_size);
+        if (index_cache && index_cache->IsLoaded()) {
+            mIndexTableHelper.ReadIndexCache(index_cache);
+            mEssenceChunkHelper.ReadIndexCache(index_cache);
+        } else {
+            if (mFileReader->mIndexSID)
+                mIndexTableHelper.ExtractIndexTable();
+
+            // first edit unit size is used to determine the essence wrapping type
+            int64_t first_edit_unit_size = 0;
+            if (mIndexTableHelper.HaveEditUnitSize(0)) {
+                int64_t offset;
+                mIndexTableHelper.GetEditUnit(0, &offset, &first_edit_unit_size);
+            }
+            mEssenceChunkHelper.CreateEssenceChunkIndex(first_edit_unit_size);
+
+            if (index_cache) {
+                mIndexTableHelper.WriteIndexCache(index_cache);
+                mEssenceChunkHelper.WriteIndexCache(index_cache);
+            }
         }
-        mEssenceChunkHelper.CreateEssenceChunkIndex(first_edit_unit_size);
         BMX_ASSERT(mEssenceChunkHelper.IsComplete());
 
         // if the essence wrapping type still unknown then go with the guessed type
@@ -350,6 +428,11 @@ EssenceReader::EssenceReader(MXFFileReader *file_reader, bool file_is_complete)
     }
 
 
+    // a file that is not seekable, e.g. stdin, can only be read forwards. The index entries and essence container
+    // layout behind the read position are discarded to keep the memory use constant
+    mStreaming = (!mFile->isSeekable() && mFileReader->IsFrameWrapped());
+
+
     // set read limits
     mReadStartPosition = 0;
     if (mIndexTableHelper.IsComplete())
@@ -360,17 +443,33 @@ EssenceReader::EssenceReader(MXFFileReader *file_reader, bool file_is_complete)
 
 EssenceReader::~EssenceReader()
 {
+    StopPrefetch();
     delete mFrameMetadataReader;
+    delete mCPBufferFile;
 }
 
 void EssenceReader::SetReadLimits(int64_t start_position, int64_t duration)
+{
+    {
+        MutexLocker locker(&mReadMutex);
+        InternalSetReadLimits(start_position, duration);
+    }
+
+    // prefetched reads may have been limited by the previous read limits
+    if (mPrefetchThread) {
+        MutexLocker locker(&mPrefetchMutex);
+        RestartPrefetch(mPosition, mPrefetchNumSamples);
+    }
+}
+
+void EssenceReader::InternalSetReadLimits(int64_t start_position, int64_t duration)
 {
     if (mIndexTableHelper.IsComplete()) {
-        mReadStartPosition = LegitimisePosition(start_position);
+        mReadStartPosition = InternalLegitimisePosition(start_position);
         if (duration <= 0 || mIndexTableHelper.GetDuration() == 0)
             mReadDuration = 0;
         else
-            mReadDuration = LegitimisePosition(start_position + duration - 1) - mReadStartPosition + 1;
+            mReadDuration = InternalLegitimisePosition(start_position + duration - 1) - mReadStartPosition + 1;
     } else {
         if (start_position < 0)
             mReadStartPosition = 0;
@@ -385,46 +484,173 @@ void EssenceReader::SetReadLimits(int64_t start_position, int64_t duration)
 
 void EssenceReader::SetBufferFrames(bool enable)
 {
+    // frames are only buffered when reading synchronously
+    if (enable)
+        StopPrefetch();
+
     mReadFrameBuffer.SetBufferFrames(enable);
+    mBufferFrames = enable;
+
+    UpdatePrefetch();
+}
+
+void EssenceReader::SetContentPackageReadCount(uint32_t count)
+{
+    MutexLocker locker(&mReadMutex);
+
+    mCPReadCount = count;
+    if (count == 0) {
+        mCPBuffer.Clear();
+        mCPBufferFilePosition = -1;
+        mxf_buffer_file_set_data(mCPBufferFile->getCFile(), 0, 0, 0);
+    }
+}
+
+void EssenceReader::SetPrefetch(uint32_t depth, uint64_t max_size)
+{
+    StopPrefetch();
+
+    mPrefetchDepth = depth;
+    mPrefetchMaxSize = max_size;
+
+    UpdatePrefetch();
+}
+
+void EssenceReader::PausePrefetch(bool pause)
+{
+    mPrefetchPaused = pause;
+
+    UpdatePrefetch();
 }
 
 uint32_t EssenceReader::Read(uint32_t num_samples)
 {
+    if (mPrefetchThread)
+        return ReadPrefetched(num_samples);
+
+    int64_t position = mPosition;
+    uint32_t actual_read_num_samples = ReadSamples(position, num_samples);
+    mReadFrameBuffer.PushFrames(actual_read_num_samples);
+
+    // always be positioned num_samples after previous position
+    mPosition = position + num_samples;
+
+    return actual_read_num_samples;
+}
+
+void EssenceReader::Seek(int64_t position)
+{
+    mPosition = position;
+
+    // cancel prefetched reads that don't follow on from the new position
+    if (mPrefetchThread) {
+        MutexLocker locker(&mPrefetchMutex);
+        if (!IsPrefetchPosition(position, mPrefetchNumSamples))
+            RestartPrefetch(position, mPrefetchNumSamples);
+    }
+}
+
+int64_t EssenceReader::GetIndexedDuration() const
+{
+    MutexLocker locker(&mReadMutex);
+    return mIndexTableHelper.GetDuration();
+}
+
+bool EssenceReader::GetIndexEntry(MXFIndexEntryExt *entry, int64_t position)
+{
+    MutexLocker locker(&mReadMutex);
+
+    if (mIndexTableHelper.GetIndexEntry(entry, position)) {
+        mxfKey element_key;
+        mEssenceChunkHelper.GetKeyAndFilePosition(entry->container_offset, entry->edit_unit_size, &element_key,
+                                                  &entry->file_offset);
+        return true;
+    }
+
+    return false;
+}
+
+int64_t EssenceReader::LegitimisePosition(int64_t position)
+{
+    MutexLocker locker(&mReadMutex);
+    return InternalLegitimisePosition(position);
+}
+
+bool EssenceReader::IsComplete() const
+{
+    MutexLocker locker(&mReadMutex);
+    return InternalIsComplete();
+}
+
+int64_t EssenceReader::InternalLegitimisePosition(int64_t position) const
+{
+    if (position < 0 || mIndexTableHelper.GetDuration() == 0)
+        return 0;
+    else if (position >= mIndexTableHelper.GetDuration())
+        return mIndexTableHelper.GetDuration() - 1;
+    else
+        return position;
+}
+
+bool EssenceReader::InternalIsComplete() const
+{
+    return mEssenceChunkHelper.IsComplete() && mIndexTableHelper.IsComplete();
+}
+
+bool EssenceReader::DiscoverPartitions()
+{
+    MutexLocker locker(&mReadMutex);
+
+    try
+    {
+        // the start of the essence container is required to add the essence in the new partitions
+        if (mBasePosition < 0 && !mFileIsComplete) {
+            if (!SeekContentPackageStart())
+                return false;
+            SetContentPackageStart(0, -1, false);
+        }
+
+        return InternalDiscoverPartitions();
+    }
+    catch (...)
+    {
+        ResetState();
+        mBaseReadError = true;
+        throw;
+    }
+}
+
+uint32_t EssenceReader::ReadSamples(int64_t position, uint32_t num_samples)
+{
+    StatsTimer stats_timer(STATS_ESSENCE_READ);
     uint32_t actual_read_num_samples = 0;
-    int64_t end_position = mPosition + num_samples;
+    int64_t end_position = position + num_samples;
     mFrameMetadataReader->Reset();
 
     // get from buffer if available
-    bool have_frame = mReadFrameBuffer.PopOrPrepareRead(mPosition, num_samples, &actual_read_num_samples);
-    if (have_frame) {
-        mReadFrameBuffer.PushFrames(actual_read_num_samples);
-
-        // always be positioned num_samples after previous position
-        if (mPosition != end_position)
-            Seek(end_position);
-
+    if (mReadFrameBuffer.PopOrPrepareRead(position, num_samples, &actual_read_num_samples))
         return actual_read_num_samples;
-    }
 
     // read samples if within read limits
+    mReadPosition = position;
     if (mReadDuration > 0 &&
-        mPosition < mReadStartPosition + mReadDuration &&
+        mReadPosition < mReadStartPosition + mReadDuration &&
         end_position > 0)
     {
         // adjust sample count and seek to start of data if needed
         uint32_t first_sample_offset = 0;
         uint32_t read_num_samples = num_samples;
-        if (mPosition < 0) {
-            first_sample_offset = (uint32_t)(-mPosition);
+        if (mReadPosition < 0) {
+            first_sample_offset = (uint32_t)(-mReadPosition);
             read_num_samples -= first_sample_offset;
-            Seek(0);
+            mReadPosition = 0;
         }
-        if (mPosition + read_num_samples > mReadStartPosition + mReadDuration)
-            read_num_samples -= (uint32_t)(mPosition + read_num_samples - (mReadStartPosition + mReadDuration));
+        if (mReadPosition + read_num_samples > mReadStartPosition + mReadDuration)
+            read_num_samples -= (uint32_t)(mReadPosition + read_num_samples - (mReadStartPosition + mReadDuration));
         BMX_ASSERT(read_num_samples > 0);
 
         // read the samples
-        int64_t start_position = mPosition;
+        int64_t start_position = mReadPosition;
         if (mFileReader->IsClipWrapped())
             actual_read_num_samples = ReadClipWrappedSamples(read_num_samples);
         else
@@ -443,6 +669,7 @@ uint32_t EssenceReader::Read(uint32_t num_samples)
         for (i = 0; i < mFileReader->GetNumInternalTrackReaders(); i++) {
             Frame *frame = mReadFrameBuffer.GetFrame(i);
             if (frame) {
+                stats_timer.AddBytes(frame->GetSize());
                 frame->first_sample_offset = first_sample_offset;
                 frame->temporal_offset     = temporal_offset;
                 frame->key_frame_offset    = key_frame_offset;
@@ -452,53 +679,253 @@ uint32_t EssenceReader::Read(uint32_t num_samples)
                     mFileReader->GetInternalTrackReader(i)->GetTrackInfo()->file_track_number);
             }
         }
+
+        if (mStreaming)
+            DiscardIndex(start_position);
     }
 
-    mReadFrameBuffer.PushFrames(actual_read_num_samples);
+    return actual_read_num_samples;
+}
 
-    // always be positioned num_samples after previous position
-    if (mPosition != end_position)
-        Seek(end_position);
+uint32_t EssenceReader::ReadPrefetched(uint32_t num_samples)
+{
+    int64_t position = mPosition;
+    PrefetchRead *read = 0;
+    {
+        MutexLocker locker(&mPrefetchMutex);
+
+        if (!IsPrefetchPosition(position, num_samples))
+            RestartPrefetch(position, num_samples);
+
+        while (mPrefetchQueue.empty() && !mPrefetchIdle)
+            mPrefetchCondition.Wait(&mPrefetchMutex);
+
+        if (!mPrefetchQueue.empty()) {
+            read = mPrefetchQueue.front();
+            mPrefetchQueue.pop_front();
+            mPrefetchQueueSize -= read->size;
+            mPrefetchCondition.Broadcast();
+        }
+    }
+
+    if (read) {
+        if (read->read_error) {
+            string message = read->error_message;
+            DeletePrefetchRead(read);
+            throw BMXException(message);
+        }
+
+        size_t t;
+        for (t = 0; t < read->frames.size(); t++) {
+            if (read->frames[t])
+                mFileReader->GetInternalTrackReader((uint32_t)t)->GetFrameBuffer()->PushFrame(read->frames[t]);
+        }
+        uint32_t num_read = read->num_read;
+        delete read;
+
+        mPosition = position + num_samples;
+        return num_read;
+    }
+
+    // the prefetch thread is idle, e.g. the position is outside the read limits or a read has failed,
+    // and so read synchronously and restart prefetching from the next position
+    uint32_t actual_read_num_samples;
+    {
+        MutexLocker locker(&mReadMutex);
+        actual_read_num_samples = ReadSamples(position, num_samples);
+        mReadFrameBuffer.PushFrames(actual_read_num_samples);
+    }
+    mPosition = position + num_samples;
+
+    {
+        MutexLocker locker(&mPrefetchMutex);
+        RestartPrefetch(mPosition, num_samples);
+    }
 
     return actual_read_num_samples;
 }
 
-void EssenceReader::Seek(int64_t position)
+void EssenceReader::UpdatePrefetch()
 {
-    mPosition = position;
+    if (mPrefetchDepth > 0 && !mPrefetchPaused && !mBufferFrames)
+        StartPrefetch();
+    else
+        StopPrefetch();
 }
 
-bool EssenceReader::GetIndexEntry(MXFIndexEntryExt *entry, int64_t position)
+void EssenceReader::StartPrefetch()
 {
-    if (mIndexTableHelper.GetIndexEntry(entry, position)) {
-        mxfKey element_key;
-        mEssenceChunkHelper.GetKeyAndFilePosition(entry->container_offset, entry->edit_unit_size, &element_key,
-                                                  &entry->file_offset);
-        return true;
+    if (mPrefetchThread)
+        return;
+
+    mPrefetchStop = false;
+    mPrefetchIdle = true;
+    mPrefetchPosition = mPosition;
+    mPrefetchNumSamples = 0;
+    mPrefetchThread = new PrefetchThread(this);
+    try
+    {
+        mPrefetchThread->Start();
     }
+    catch (...)
+    {
+        delete mPrefetchThread;
+        mPrefetchThread = 0;
+        throw;
+    }
+}
 
-    return false;
+void EssenceReader::StopPrefetch()
+{
+    if (!mPrefetchThread)
+        return;
+
+    {
+        MutexLocker locker(&mPrefetchMutex);
+        mPrefetchStop = true;
+        mPrefetchCondition.Broadcast();
+    }
+    mPrefetchThread->Join();
+    delete mPrefetchThread;
+    mPrefetchThread = 0;
+
+    ClearPrefetchQueue();
 }
 
-int64_t EssenceReader::LegitimisePosition(int64_t position)
+void EssenceReader::RestartPrefetch(int64_t position, uint32_t num_samples)
 {
-    if (position < 0 || mIndexTableHelper.GetDuration() == 0)
-        return 0;
-    else if (position >= mIndexTableHelper.GetDuration())
-        return mIndexTableHelper.GetDuration() - 1;
-    else
-        return position;
+    ClearPrefetchQueue();
+
+    mPrefetchPosition = position;
+    mPrefetchNumSamples = num_samples;
+    mPrefetchGeneration++;
+    mPrefetchIdle = (num_samples == 0);
+    mPrefetchCondition.Broadcast();
 }
 
-bool EssenceReader::IsComplete() const
+bool EssenceReader::IsPrefetchPosition(int64_t position, uint32_t num_samples)
 {
-    return mEssenceChunkHelper.IsComplete() && mIndexTableHelper.IsComplete();
+    if (mPrefetchQueue.empty()) {
+        return mPrefetchPosition == position && mPrefetchNumSamples == num_samples;
+    } else {
+        return mPrefetchQueue.front()->position == position &&
+               mPrefetchQueue.front()->num_samples == num_samples;
+    }
+}
+
+void EssenceReader::ClearPrefetchQueue()
+{
+    size_t i;
+    for (i = 0; i < mPrefetchQueue.size(); i++)
+        DeletePrefetchRead(mPrefetchQueue[i]);
+    mPrefetchQueue.clear();
+    mPrefetchQueueSize = 0;
+}
+
+void EssenceReader::DeletePrefetchRead(PrefetchRead *read)
+{
+    size_t i;
+    for (i = 0; i < read->frames.size(); i++) {
+        if (read->frames[i])
+            read->frames[i]->Release();
+    }
+    delete read;
+}
+
+void EssenceReader::RunPrefetch()
+{
+    MutexLocker locker(&mPrefetchMutex);
+
+    while (!mPrefetchStop) {
+        // wait for a (re)start or space in the queue. The queue always has space for 1 read
+        if (mPrefetchIdle ||
+            (!mPrefetchQueue.empty() &&
+                (mPrefetchQueue.size() >= mPrefetchDepth || mPrefetchQueueSize >= mPrefetchMaxSize)))
+        {
+            mPrefetchCondition.Wait(&mPrefetchMutex);
+            continue;
+        }
+
+        PrefetchRead *read = new PrefetchRead;
+        read->position    = mPrefetchPosition;
+        read->num_samples = mPrefetchNumSamples;
+        read->num_read    = 0;
+        read->size        = 0;
+        read->read_error  = false;
+        uint32_t generation = mPrefetchGeneration;
+
+        mPrefetchMutex.Unlock();
+        bool have_read = PrefetchReadSamples(read);
+        mPrefetchMutex.Lock();
+
+        if (mPrefetchStop || generation != mPrefetchGeneration) {
+            // restarted or stopped whilst reading
+            DeletePrefetchRead(read);
+        } else if (!have_read) {
+            DeletePrefetchRead(read);
+            mPrefetchIdle = true;
+        } else {
+            mPrefetchQueue.push_back(read);
+            mPrefetchQueueSize += read->size;
+            if (!read->read_error)
+                mPrefetchPosition += read->num_samples;
+            // go idle after a failed or short read, e.g. when the end of a growing file was reached.
+            // The next Read() will be done synchronously and will restart prefetching
+            if (read->read_error || read->num_read < read->num_samples)
+                mPrefetchIdle = true;
+        }
+        mPrefetchCondition.Broadcast();
+    }
+}
+
+bool EssenceReader::PrefetchReadSamples(PrefetchRead *read)
+{
+    MutexLocker locker(&mReadMutex);
+
+    // positions outside the read limits are left to synchronous reads
+    if (mReadDuration <= 0 ||
+        read->position < mReadStartPosition ||
+        read->position - mReadStartPosition >= mReadDuration)
+    {
+        return false;
+    }
+
+    try
+    {
+        read->num_read = ReadSamples(read->position, read->num_samples);
+        mReadFrameBuffer.TakeFrames(read->num_read, &read->frames);
+
+        size_t i;
+        for (i = 0; i < read->frames.size(); i++) {
+            if (read->frames[i])
+                read->size += read->frames[i]->GetSize();
+        }
+    }
+    catch (const MXFException &ex)
+    {
+        read->read_error = true;
+        read->error_message = ex.getMessage();
+    }
+    catch (const BMXException &ex)
+    {
+        read->read_error = true;
+        read->error_message = ex.what();
+    }
+    catch (...)
+    {
+        read->read_error = true;
+        read->error_message = "Unknown prefetch read error";
+    }
+    if (read->read_error)
+        mReadFrameBuffer.Reset();
+
+    return true;
 }
 
 uint32_t EssenceReader::ReadClipWrappedSamples(uint32_t num_samples)
 {
     // for incomplete clip wrapped files only support seeking to position 0
-    if (!IsComplete() && mPosition == 0 && !SeekEssence(mPosition))
+    if (!InternalIsComplete() && mReadPosition == 0 && !SeekEssence(mReadPosition))
         return 0;
 
     Frame *frame = mReadFrameBuffer.GetFrame(0);
@@ -511,9 +938,9 @@ uint32_t EssenceReader::ReadClipWrappedSamples(uint32_t num_samples)
         int64_t file_position, size;
         mxfKey element_key;
         if (mImageStartOffset || mImageEndOffset) {
-            GetEditUnitGroup(mPosition, 1, &element_key, &file_position, &size, &num_cont_samples);
+            GetEditUnitGroup(mReadPosition, 1, &element_key, &file_position, &size, &num_cont_samples);
         } else {
-            GetEditUnitGroup(mPosition, num_samples - total_num_samples, &element_key, &file_position, &size,
+            GetEditUnitGroup(mReadPosition, num_samples - total_num_samples, &element_key, &file_position, &size,
                              &num_cont_samples);
         }
 
@@ -539,7 +966,7 @@ uint32_t EssenceReader::ReadClipWrappedSamples(uint32_t num_samples)
             }
 
             if (frame->IsEmpty()) {
-                frame->ec_position         = mPosition;
+                frame->ec_position         = mReadPosition;
                 frame->temporal_reordering = mIndexTableHelper.GetTemporalReordering(0);
                 frame->cp_file_position    = current_file_position - mImageEndOffset - size;
                 frame->file_position       = frame->cp_file_position;
@@ -554,7 +981,7 @@ uint32_t EssenceReader::ReadClipWrappedSamples(uint32_t num_samples)
             current_file_position = file_position + size;
         }
 
-        mPosition += num_cont_samples;
+        mReadPosition += num_cont_samples;
         total_num_samples += num_cont_samples;
     }
 
@@ -564,22 +991,36 @@ uint32_t EssenceReader::ReadClipWrappedSamples(uint32_t num_samples)
 
 uint32_t EssenceReader::ReadFrameWrappedSamples(uint32_t num_samples)
 {
-    int64_t start_position = mPosition;
+    int64_t start_position = mReadPosition;
+
+    // the track readers are held in a member to avoid allocations in every read
+    ElementTrackReaders *enabled_track_readers = &mElementTrackReaders;
+    enabled_track_readers->clear();
 
-    map<uint32_t, MXFTrackReader*> enabled_track_readers;
     uint32_t i;
     for (i = 0; i < num_samples; i++) {
+        // read whole content packages from a buffer that is filled using a single read for a run of
+        // indexed, contiguous content packages
+        if (mCPReadCount > 0 &&
+            mIndexTableHelper.HaveEditUnitSize(mReadPosition) &&
+            GetIndexedFilePosition(mReadPosition) >= 0)
+        {
+            ReadBufferedContentPackage(start_position, enabled_track_readers);
+            mReadPosition++;
+            continue;
+        }
+
         int64_t cp_file_position;
         int64_t size;
-        if (!SeekEssence(mPosition))
+        if (!SeekEssence(mReadPosition))
             return i;
-        if (mIndexTableHelper.HaveEditUnitSize(mPosition)) {
+        if (mIndexTableHelper.HaveEditUnitSize(mReadPosition)) {
             mxfKey dummy_key = g_Null_Key;
-            GetEditUnit(mPosition, &dummy_key, &cp_file_position, &size);
+            GetEditUnit(mReadPosition, &dummy_key, &cp_file_position, &size);
             BMX_ASSERT(cp_file_position == mFilePosition);
-        } else if (mIndexTableHelper.HaveEditUnitOffset(mPosition)) {
+        } else if (mIndexTableHelper.HaveEditUnitOffset(mReadPosition)) {
             size = 0;
-            cp_file_position = mEssenceChunkHelper.GetFilePosition(mIndexTableHelper.GetEditUnitOffset(mPosition));
+            cp_file_position = mEssenceChunkHelper.GetFilePosition(mIndexTableHelper.GetEditUnitOffset(mReadPosition));
             BMX_ASSERT(cp_file_position == mFilePosition);
         } else {
             size = 0;
@@ -598,39 +1039,8 @@ uint32_t EssenceReader::ReadFrameWrappedSamples(uint32_t num_samples)
             bool processed_metadata = mFrameMetadataReader->ProcessFrameMetadata(&key, len);
 
             if (!processed_metadata && (mxf_is_gc_essence_element(&key) || mxf_avid_is_essence_element(&key))) {
-                uint32_t track_number = mxf_get_track_number(&key);
-                MXFTrackReader *track_reader = 0;
-                Frame *frame = 0;
-                if (enabled_track_readers.find(track_number) == enabled_track_readers.end()) {
-                    // frame does not yet exist - create it if track is enabled
-                    track_reader = mFileReader->GetInternalTrackReaderByNumber(track_number);
-                    if (start_position == mPosition && track_reader && track_reader->IsEnabled()) {
-                        frame = mReadFrameBuffer.GetFrame((uint32_t)track_reader->GetTrackIndex());
-
-                        BMX_CHECK(cp_num_read <= UINT32_MAX);
-
-                        frame->ec_position         = start_position;
-                        frame->cp_file_position    = cp_file_position;
-                        frame->file_position       = cp_file_position + cp_num_read - (mxfKey_extlen + llen);
-                        frame->kl_size             = mxfKey_extlen + llen;
-                        frame->file_id             = mFileReader->GetFileId();
-                        frame->element_key         = key;
-                        if (mIndexTableHelper.HaveEditUnit(start_position)) {
-                            frame->temporal_reordering =
-                                mIndexTableHelper.GetTemporalReordering((uint32_t)(cp_num_read - (mxfKey_extlen + llen)));
-                        }
-
-                        enabled_track_readers[track_number] = track_reader;
-                    } else {
-                        enabled_track_readers[track_number] = 0;
-                    }
-                } else {
-                    // frame exists if track is enabled - get it
-                    track_reader = enabled_track_readers[track_number];
-                    if (track_reader)
-                        frame = mReadFrameBuffer.GetFrame((uint32_t)track_reader->GetTrackIndex());
-                }
-
+                Frame *frame = GetElementFrame(start_position, enabled_track_readers, &key, llen, cp_file_position,
+                                               cp_num_read - (mxfKey_extlen + llen));
                 if (frame) {
                     BMX_CHECK(len <= UINT32_MAX);
 
@@ -655,16 +1065,173 @@ uint32_t EssenceReader::ReadFrameWrappedSamples(uint32_t num_samples)
         }
 
         if (size == 0) {
-            mIndexTableHelper.UpdateIndex(mPosition, mEssenceChunkHelper.GetEssenceOffset(cp_file_position),
+            mIndexTableHelper.UpdateIndex(mReadPosition, mEssenceChunkHelper.GetEssenceOffset(cp_file_position),
                                           cp_num_read);
         }
 
-        mPosition++;
+        mReadPosition++;
     }
 
     return num_samples;
 }
 
+void EssenceReader::ReadBufferedContentPackage(int64_t start_position,
+                                               ElementTrackReaders *enabled_track_readers)
+{
+    int64_t cp_file_position;
+    int64_t size;
+    mxfKey dummy_key = g_Null_Key;
+    GetEditUnit(mReadPosition, &dummy_key, &cp_file_position, &size);
+
+    try
+    {
+        if (mCPBufferFilePosition < 0 ||
+            cp_file_position < mCPBufferFilePosition ||
+            cp_file_position + size > mCPBufferFilePosition + mCPBuffer.GetSize())
+        {
+            FillContentPackageBuffer(cp_file_position, size);
+        }
+
+        // the file is not positioned at the content package start after reading from the buffer
+        SetContentPackageStart(mReadPosition, cp_file_position, true);
+        ResetState();
+
+        mCPBufferFile->seek(cp_file_position, SEEK_SET);
+        mFrameMetadataReader->SetFile(mCPBufferFile);
+
+        mxfKey key;
+        uint8_t llen;
+        uint64_t len;
+        int64_t cp_num_read = 0;
+        while (cp_num_read < size) {
+            mCPBufferFile->readKL(&key, &llen, &len);
+            if (cp_num_read == 0) {
+                if (mEssenceStartKey == g_Null_Key)
+                    mEssenceStartKey = key;
+                else if (key != mEssenceStartKey)
+                    BMX_EXCEPTION(("First element in content package has different key than before"));
+            }
+            cp_num_read += mxfKey_extlen + llen;
+
+            int64_t value_file_position = mCPBufferFile->tell();
+            bool processed_metadata = mFrameMetadataReader->ProcessFrameMetadata(&key, len);
+
+            if (!processed_metadata && (mxf_is_gc_essence_element(&key) || mxf_avid_is_essence_element(&key))) {
+                Frame *frame = GetElementFrame(start_position, enabled_track_readers, &key, llen, cp_file_position,
+                                               cp_num_read - (mxfKey_extlen + llen));
+                if (frame) {
+                    BMX_CHECK(len <= UINT32_MAX);
+                    BMX_CHECK(value_file_position + (int64_t)len <= mCPBufferFilePosition + mCPBuffer.GetSize());
+
+                    frame->Grow((uint32_t)len);
+                    memcpy(frame->GetBytesAvailable(),
+                           mCPBuffer.GetBytes() + (value_file_position - mCPBufferFilePosition),
+                           (uint32_t)len);
+                    frame->IncrementSize((uint32_t)len);
+                    frame->num_samples++;
+                }
+            }
+
+            cp_num_read += len;
+            mCPBufferFile->seek(cp_file_position + cp_num_read, SEEK_SET);
+        }
+        if (cp_num_read != size) {
+           BMX_EXCEPTION(("Read content package size (0x%" PRIx64 ") does not match size in index (0x%" PRIx64 ") "
+                          "at file position 0x%" PRIx64,
+                          cp_num_read, size, cp_file_position + cp_num_read));
+        }
+
+        mFrameMetadataReader->SetFile(mFile);
+    }
+    catch (...)
+    {
+        mFrameMetadataReader->SetFile(mFile);
+        mBaseReadError = true;
+        throw;
+    }
+}
+
+void EssenceReader::FillContentPackageBuffer(int64_t cp_file_position, int64_t cp_size)
+{
+    // extend the run whilst the next content packages are indexed, contiguous and within the read limits
+    int64_t buffer_size = cp_size;
+    uint32_t num_cps = 1;
+    while (num_cps < mCPReadCount &&
+           mReadPosition + num_cps - mReadStartPosition < mReadDuration &&
+           mIndexTableHelper.HaveEditUnitSize(mReadPosition + num_cps))
+    {
+        int64_t next_file_position;
+        int64_t next_size;
+        mxfKey dummy_key = g_Null_Key;
+        if (GetIndexedFilePosition(mReadPosition + num_cps) != cp_file_position + buffer_size)
+            break;
+        GetEditUnit(mReadPosition + num_cps, &dummy_key, &next_file_position, &next_size);
+        if (buffer_size + next_size > MAX_CP_BUFFER_SIZE)
+            break;
+        buffer_size += next_size;
+        num_cps++;
+    }
+    BMX_CHECK(buffer_size <= UINT32_MAX);
+
+    mCPBufferFilePosition = -1;
+    mCPBuffer.SetSize(0);
+    mCPBuffer.Allocate((uint32_t)buffer_size);
+
+    mFile->seek(cp_file_position, SEEK_SET);
+    uint32_t num_read = mFile->read(mCPBuffer.GetBytes(), (uint32_t)buffer_size);
+    if (num_read < cp_size) {
+        BMX_EXCEPTION(("Failed to read content package at file position 0x%" PRIx64 ": read %u of %" PRId64 " bytes",
+                       cp_file_position, num_read, cp_size));
+    }
+    mCPBuffer.SetSize(num_read);
+    mCPBufferFilePosition = cp_file_position;
+    mxf_buffer_file_set_data(mCPBufferFile->getCFile(), mCPBuffer.GetBytes(), mCPBuffer.GetSize(),
+                             mCPBufferFilePosition);
+}
+
+Frame* EssenceReader::GetElementFrame(int64_t start_position, ElementTrackReaders *enabled_track_readers,
+                                      const mxfKey *key, uint8_t llen, int64_t cp_file_position,
+                                      int64_t element_offset)
+{
+    uint32_t track_number = mxf_get_track_number(key);
+    MXFTrackReader *track_reader = 0;
+    Frame *frame = 0;
+    size_t i;
+    for (i = 0; i < enabled_track_readers->size(); i++) {
+        if ((*enabled_track_readers)[i].first == track_number)
+            break;
+    }
+    if (i >= enabled_track_readers->size()) {
+        // frame does not yet exist - create it if track is enabled
+        track_reader = mFileReader->GetInternalTrackReaderByNumber(track_number);
+        if (start_position == mReadPosition && track_reader && track_reader->IsEnabled()) {
+            frame = mReadFrameBuffer.GetFrame((uint32_t)track_reader->GetTrackIndex());
+
+            BMX_CHECK(element_offset <= UINT32_MAX);
+
+            frame->ec_position         = start_position;
+            frame->cp_file_position    = cp_file_position;
+            frame->file_position       = cp_file_position + element_offset;
+            frame->kl_size             = mxfKey_extlen + llen;
+            frame->file_id             = mFileReader->GetFileId();
+            frame->element_key         = *key;
+            if (mIndexTableHelper.HaveEditUnit(start_position))
+                frame->temporal_reordering = mIndexTableHelper.GetTemporalReordering((uint32_t)element_offset);
+
+            enabled_track_readers->push_back(make_pair(track_number, track_reader));
+        } else {
+            enabled_track_readers->push_back(make_pair(track_number, (MXFTrackReader*)0));
+        }
+    } else {
+        // frame exists if track is enabled - get it
+        track_reader = (*enabled_track_readers)[i].second;
+        if (track_reader)
+            frame = mReadFrameBuffer.GetFrame((uint32_t)track_reader->GetTrackIndex());
+    }
+
+    return frame;
+}
+
 void EssenceReader::GetEditUnit(int64_t position, mxfKey *element_key, int64_t *file_position, int64_t *size)
 {
     int64_t essence_offset, essence_size;
@@ -793,6 +1360,11 @@ bool EssenceReader::SeekEssence(int64_t base_position)
         if (mAtCPStart && base_position == mBasePosition)
             return true;
 
+        if (mStreaming && base_position < mBasePosition) {
+            BMX_EXCEPTION(("Failed to seek back to position %" PRId64 " from position %" PRId64 " in a stream",
+                           base_position, mBasePosition));
+        }
+
         // if the file position is known then seek to it
         int64_t file_position;
         if (mLastKnownBasePosition == base_position)
@@ -818,6 +1390,17 @@ bool EssenceReader::SeekEssence(int64_t base_position)
             SetContentPackageStart(mLastKnownBasePosition, mLastKnownFilePosition, true);
         }
 
+        // the partitions and index table segments written to a growing file since the last known position
+        // may provide the file position
+        if (base_position > mLastKnownBasePosition + 1 && InternalDiscoverPartitions()) {
+            file_position = GetIndexedFilePosition(base_position);
+            if (file_position >= 0) {
+                mFile->seek(file_position, SEEK_SET);
+                SetContentPackageStart(base_position, file_position, true);
+                return true;
+            }
+        }
+
         // read until the requested position or fail
         mxfKey key;
         uint8_t llen;
@@ -983,10 +1566,11 @@ bool EssenceReader::SeekContentPackageStart()
     bool have_start_key = (mEssenceStartKey != g_Null_Key);
 
     if (mxf_is_partition_pack(&mNextKey))
-        ReadNextPartition(&mNextKey, mNextLLen, mNextLen);
+        partition_id = ReadNextPartition(&mNextKey, mNextLLen, mNextLen);
+    else
+        partition_id = FindPartition(mFile->tell());
     ResetNextKL();
 
-    partition_id = mFile->getPartitions().size() - 1;
     partition = mFile->getPartitions()[partition_id];
 
     bool at_cp_start = false;
@@ -998,8 +1582,7 @@ bool EssenceReader::SeekContentPackageStart()
         {
             if (partition->getBodySID() == mFileReader->mBodySID)
                 mEssenceChunkHelper.UpdateLastChunk(mFile->tell() - mxfKey_extlen - llen, true);
-            ReadNextPartition(&key, llen, len);
-            partition_id++;
+            partition_id = ReadNextPartition(&key, llen, len);
             partition = mFile->getPartitions()[partition_id];
         }
         else if (mxf_equals_key(&key, &g_RandomIndexPack_key))
@@ -1017,6 +1600,8 @@ bool EssenceReader::SeekContentPackageStart()
         }
         else if (mxf_is_index_table_segment(&key))
         {
+            // the segments read from a stream provide the temporal and key frame offsets. They are discarded
+            // once the read position has passed them
             if (!mIndexTableHelper.IsComplete() && partition->getIndexSID() == mFileReader->mIndexSID) {
                 int64_t end_offset = mIndexTableHelper.ReadIndexTableSegment(len);
                 // if in footer then file is complete if the index table segment covers the last content package
@@ -1043,7 +1628,7 @@ bool EssenceReader::SeekContentPackageStart()
                     mEssenceChunkHelper.AppendChunk(partition_id, mFile->tell(), &key, llen, len);
             } else {
                 if (!mEssenceChunkHelper.IsComplete() &&
-                    mEssenceChunkHelper.GetNumIndexedPartitions() < mFile->getPartitions().size())
+                    mEssenceChunkHelper.GetNumIndexedPartitions() <= partition_id)
                 {
                     mEssenceChunkHelper.AppendChunk(partition_id, mFile->tell(), &key, llen, len);
                 }
@@ -1063,11 +1648,19 @@ bool EssenceReader::SeekContentPackageStart()
     return at_cp_start;
 }
 
-void EssenceReader::ReadNextPartition(const mxfKey *key, uint8_t llen, uint64_t len)
+size_t EssenceReader::ReadNextPartition(const mxfKey *key, uint8_t llen, uint64_t len)
 {
     int64_t partition_pos = mFile->tell() - mxfKey_extlen - llen;
-    BMX_ASSERT(partition_pos >= 0 &&
-               mFile->getPartitions().back()->getThisPartition() < (uint64_t)partition_pos);
+    BMX_ASSERT(partition_pos >= 0);
+
+    // the partition is already known if it was discovered or read before seeking backwards
+    if (mFile->getPartitions().back()->getThisPartition() >= (uint64_t)partition_pos) {
+        size_t partition_id = FindPartition(partition_pos);
+        BMX_CHECK_M(mFile->getPartitions()[partition_id]->getThisPartition() == (uint64_t)partition_pos,
+                    ("Partition pack at file position 0x%" PRIx64 " is not a known partition", partition_pos));
+        mFile->skip(len);
+        return partition_id;
+    }
 
     mFile->readNextPartition(key, len);
 
@@ -1083,6 +1676,237 @@ void EssenceReader::ReadNextPartition(const mxfKey *key, uint8_t llen, uint64_t
         if (partition->getIndexByteCount() == 0)
             SetFileIsComplete();
     }
+
+    return mFile->getPartitions().size() - 1;
+}
+
+size_t EssenceReader::FindPartition(int64_t file_position)
+{
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    size_t i;
+    for (i = partitions.size(); i > 1; i--) {
+        if ((int64_t)partitions[i - 1]->getThisPartition() <= file_position)
+            break;
+    }
+
+    return i - 1;
+}
+
+bool EssenceReader::InternalDiscoverPartitions()
+{
+    // the new essence is only added to a frame wrapped essence container layout that is known up to the
+    // last known partition
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    if (mHaveFooter || !mFile->isSeekable() || !mFileReader->IsFrameWrapped() ||
+        mEssenceChunkHelper.IsComplete() || mEssenceChunkHelper.GetNumIndexedPartitions() == 0 ||
+        (partitions.back()->getBodySID() == mFileReader->mBodySID &&
+            mEssenceChunkHelper.GetNumIndexedPartitions() < partitions.size()))
+    {
+        return false;
+    }
+
+    int64_t file_size = mFile->size();
+    if (file_size <= mDiscoverFileSize)
+        return false;
+
+    size_t num_partitions = partitions.size();
+    int64_t file_position = mFile->tell();
+    try
+    {
+        // follow the PreviousPartition links from the last partition back to the last known partition
+        int64_t known_position = (int64_t)partitions.back()->getThisPartition();
+        vector<DiscoveredPartition> new_partitions;
+        DiscoveredPartition partition;
+        if (FindLastPartition(known_position, file_size, &partition)) {
+            new_partitions.push_back(partition);
+            while (partition.previous_position > known_position) {
+                if (!ReadDiscoveredPartition(partition.previous_position, file_size, &partition))
+                    break;
+                new_partitions.push_back(partition);
+            }
+            if (partition.previous_position != known_position) {
+                log_debug("Partition pack links from the end of the growing file don't lead back to the last "
+                          "known partition at 0x%" PRIx64 "\n", known_position);
+                new_partitions.clear();
+            }
+        }
+
+        // add the partitions in file order up to the footer or a partition that is still being written
+        vector<size_t> index_partition_ids;
+        size_t i;
+        for (i = new_partitions.size(); i > 0; i--) {
+            if (!AddDiscoveredPartition(new_partitions[i - 1], file_size, &index_partition_ids))
+                break;
+        }
+
+        if (!index_partition_ids.empty() && !mIndexTableHelper.IsComplete()) {
+            mIndexTableHelper.AppendPartitionIndexSegments(index_partition_ids);
+
+            int64_t duration = mIndexTableHelper.GetDuration();
+            if (duration > 0 && mIndexTableHelper.HaveEditUnitOffset(duration - 1))
+                mEssenceChunkHelper.ExtendLastChunk(mIndexTableHelper.GetEditUnitOffset(duration - 1));
+        }
+
+        mFile->seek(file_position, SEEK_SET);
+    }
+    catch (...)
+    {
+        mFile->seek(file_position, SEEK_SET);
+        throw;
+    }
+
+    mDiscoverFileSize = file_size;
+
+    return partitions.size() > num_partitions;
+}
+
+bool EssenceReader::FindLastPartition(int64_t min_position, int64_t file_size, DiscoveredPartition *partition)
+{
+    // search backwards from the end of the file for the last partition pack, limited to the tail of the file
+    int64_t scan_start = min_position + 1;
+    if (file_size - PARTITION_SCAN_MAX_SIZE > scan_start)
+        scan_start = file_size - PARTITION_SCAN_MAX_SIZE;
+
+    ByteArray buffer(PARTITION_SCAN_BLOCK_SIZE + mxfKey_extlen);
+    int64_t block_end = file_size;
+    while (block_end > scan_start) {
+        int64_t block_start = block_end - PARTITION_SCAN_BLOCK_SIZE;
+        if (block_start < scan_start)
+            block_start = scan_start;
+
+        // overlap with the next block to find a key that straddles the two
+        int64_t read_end = block_end + mxfKey_extlen;
+        if (read_end > file_size)
+            read_end = file_size;
+        mFile->seek(block_start, SEEK_SET);
+        uint32_t num_read = mFile->read(buffer.GetBytes(), (uint32_t)(read_end - block_start));
+
+        uint32_t offset;
+        for (offset = (uint32_t)(block_end - block_start); offset > 0; offset--) {
+            if (offset - 1 + mxfKey_extlen <= num_read &&
+                memcmp(buffer.GetBytes() + offset - 1, PARTITION_PACK_PREFIX, sizeof(PARTITION_PACK_PREFIX)) == 0 &&
+                ReadDiscoveredPartition(block_start + offset - 1, file_size, partition))
+            {
+                return true;
+            }
+        }
+
+        block_end = block_start;
+    }
+
+    return false;
+}
+
+bool EssenceReader::ReadDiscoveredPartition(int64_t position, int64_t file_size, DiscoveredPartition *partition)
+{
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+    unsigned char bytes[64];
+
+    // the pack is only used if it has been completely written and its ThisPartition is the file position
+    try
+    {
+        mFile->seek(position, SEEK_SET);
+        mFile->readKL(&key, &llen, &len);
+        if (!mxf_is_partition_pack(&key) || len < sizeof(bytes) ||
+            position + mxfKey_extlen + llen + len > (uint64_t)file_size ||
+            mFile->read(bytes, (uint32_t)sizeof(bytes)) != sizeof(bytes))
+        {
+            return false;
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    if (mxf_is_footer_partition_pack(&key))
+        return false;
+    if (get_uint64(&bytes[8]) != (uint64_t)position || get_uint64(&bytes[16]) >= (uint64_t)position)
+        return false;
+
+    partition->position          = position;
+    partition->previous_position = (int64_t)get_uint64(&bytes[16]);
+    partition->header_byte_count = get_uint64(&bytes[32]);
+    partition->index_byte_count  = get_uint64(&bytes[40]);
+    partition->index_sid         = get_uint32(&bytes[48]);
+    partition->body_sid          = get_uint32(&bytes[60]);
+
+    return true;
+}
+
+bool EssenceReader::AddDiscoveredPartition(const DiscoveredPartition &partition, int64_t file_size,
+                                           vector<size_t> *index_partition_ids)
+{
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+    mxfKey essence_key = g_Null_Key;
+    uint8_t essence_llen = 0;
+    uint64_t essence_len = 0;
+    int64_t essence_position = -1;
+
+    // check that the header metadata, index table segments and the first essence KL have been written
+    try
+    {
+        mFile->seek(partition.position, SEEK_SET);
+        mFile->readKL(&key, &llen, &len);
+        mFile->skip(len);
+        while (true)
+        {
+            if (mFile->tell() >= file_size)
+                return false;
+
+            mFile->readNextNonFillerKL(&key, &llen, &len);
+
+            if (mxf_is_partition_pack(&key)) {
+                break;
+            } else if (mxf_is_header_metadata(&key)) {
+                if (partition.header_byte_count > mxfKey_extlen + llen + len)
+                    mFile->skip(partition.header_byte_count - (mxfKey_extlen + llen));
+                else
+                    mFile->skip(len);
+            } else if (mxf_is_index_table_segment(&key)) {
+                if (partition.index_byte_count > mxfKey_extlen + llen + len)
+                    mFile->skip(partition.index_byte_count - (mxfKey_extlen + llen));
+                else
+                    mFile->skip(len);
+            } else if (mxf_is_gc_essence_element(&key) || mxf_avid_is_essence_element(&key)) {
+                essence_key      = key;
+                essence_llen     = llen;
+                essence_len      = len;
+                essence_position = mFile->tell();
+                break;
+            } else {
+                mFile->skip(len);
+            }
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    bool have_essence = (partition.body_sid == mFileReader->mBodySID);
+    if (have_essence &&
+        (essence_position < 0 || (mEssenceStartKey != g_Null_Key && essence_key != mEssenceStartKey)))
+    {
+        return false;
+    }
+
+    mFile->seek(partition.position, SEEK_SET);
+    mFile->readKL(&key, &llen, &len);
+    mFile->readNextPartition(&key, len);
+    size_t partition_id = mFile->getPartitions().size() - 1;
+
+    mEssenceChunkHelper.UpdateLastChunk(partition.position, true);
+    if (have_essence)
+        mEssenceChunkHelper.AppendChunk(partition_id, essence_position, &essence_key, essence_llen, essence_len);
+    if (partition.index_sid == mFileReader->mIndexSID && partition.index_byte_count > 0)
+        index_partition_ids->push_back(partition_id);
+
+    return true;
 }
 
 void EssenceReader::SetHaveFooter()
@@ -1099,7 +1923,16 @@ void EssenceReader::SetFileIsComplete()
     mFileIsComplete = true;
     mIndexTableHelper.SetIsComplete();
 
-    SetReadLimits(mReadStartPosition, mReadDuration);
+    InternalSetReadLimits(mReadStartPosition, mReadDuration);
+}
+
+void EssenceReader::DiscardIndex(int64_t position)
+{
+    if (!mIndexTableHelper.HaveEditUnitOffset(position))
+        return;
+
+    mEssenceChunkHelper.DiscardChunks(mIndexTableHelper.GetEditUnitOffset(position));
+    mIndexTableHelper.DiscardSegments(position);
 }
 
 void EssenceReader::SetNextKL(const mxfKey *key, uint8_t llen, uint64_t len)
@@ -375,6 +375,13 @@ FrameMetadataReader::~FrameMetadataReader()
         delete mReaders[i];
 }
 
+void FrameMetadataReader::SetFile(File *file)
+{
+    size_t i;
+    for (i = 0; i < mReaders.size(); i++)
+        mReaders[i]->SetFile(file);
+}
+
 void FrameMetadataReader::Reset()
 {
     size_t i;
@@ -39,12 +39,17 @@
 #include <cstdio>
 #include <cstring>
 
+#include <algorithm>
+
 #include <libMXF++/MXF.h>
 
 #include <mxf/mxf_avid.h>
 
 #include <bmx/mxf_reader/IndexTableHelper.h>
 #include <bmx/mxf_reader/MXFFileReader.h>
+#include <bmx/mxf_reader/MXFIndexCache.h>
+#include <bmx/MXFBufferFile.h>
+#include <bmx/ByteArray.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -54,15 +59,19 @@ using namespace bmx;
 using namespace mxfpp;
 
 
-// temporal offset (1) + key frame offset (1) + flags (1) + stream offset (8)
-#define INTERNAL_INDEX_ENTRY_SIZE   11
+// temporal offset (1) + key frame offset (1) + flags (1). The stream offsets are held in a separate array
+#define INTERNAL_INDEX_ENTRY_SIZE   3
 
 #define RUNTIME_INDEX_SEGMENT_SIZE  1500
 
+// index table segments in partitions that are close together are read using a single file read
+#define INDEX_READ_MAX_GAP          (64 * 1024)
+#define INDEX_READ_MAX_SIZE         (16 * 1024 * 1024)
+
 #define GET_TEMPORAL_OFFSET(pos)    (*((int8_t*)&mIndexEntries[(pos) * INTERNAL_INDEX_ENTRY_SIZE]))
 #define GET_KEY_FRAME_OFFSET(pos)   (*((int8_t*)&mIndexEntries[(pos) * INTERNAL_INDEX_ENTRY_SIZE + 1]))
 #define GET_FLAGS(pos)              (*((uint8_t*)&mIndexEntries[(pos) * INTERNAL_INDEX_ENTRY_SIZE + 2]))
-#define GET_STREAM_OFFSET(pos)      (*((int64_t*)&mIndexEntries[(pos) * INTERNAL_INDEX_ENTRY_SIZE + 3]))
+#define GET_STREAM_OFFSET(pos)      (mStreamOffsets[pos])
 
 #define SEG_END(seg)    (seg->getIndexStartPosition() + seg->getIndexDuration())
 #define SEG_START(seg)  (seg->getIndexStartPosition())
@@ -94,6 +103,7 @@ IndexTableHelperSegment::IndexTableHelperSegment()
 : IndexTableSegment()
 {
     mIndexEntries = 0;
+    mStreamOffsets = 0;
     mAllocIndexEntries = 0;
     mNumIndexEntries = 0;
     mEntriesStart = 0;
@@ -107,6 +117,7 @@ IndexTableHelperSegment::IndexTableHelperSegment()
 IndexTableHelperSegment::~IndexTableHelperSegment()
 {
     delete [] mIndexEntries;
+    delete [] mStreamOffsets;
 }
 
 void IndexTableHelperSegment::ReadIndexTableSegment(File *file, uint64_t segment_len)
@@ -206,6 +217,7 @@ int IndexTableHelperSegment::GetEditUnit(int64_t position, int8_t *temporal_offs
     } else {
         if (mHavePairedIndexEntries)
             rel_position *= 2;
+        rel_position += mEntriesStart;
 
         *temporal_offset  = GET_TEMPORAL_OFFSET(rel_position);
         *key_frame_offset = GET_KEY_FRAME_OFFSET(rel_position);
@@ -232,6 +244,7 @@ void IndexTableHelperSegment::AppendIndexEntry(uint32_t num_entries, int8_t temp
     if (!mIndexEntries) {
         BMX_CHECK(num_entries > 0);
         mIndexEntries = new unsigned char[INTERNAL_INDEX_ENTRY_SIZE * num_entries];
+        mStreamOffsets = new int64_t[num_entries];
         mAllocIndexEntries = num_entries;
     }
 
@@ -279,10 +292,12 @@ void IndexTableHelperSegment::UpdateStartPosition(int64_t position)
     BMX_ASSERT(position >= getIndexStartPosition());
     BMX_ASSERT(position - getIndexStartPosition() < getIndexDuration());
 
-    uint32_t diff_entries = (uint32_t)(getIndexStartPosition() - position);
+    uint32_t diff_entries = (uint32_t)(position - getIndexStartPosition());
     if (mHavePairedIndexEntries)
         diff_entries *= 2;
     mEntriesStart += diff_entries;
+    mNumIndexEntries -= diff_entries;
+    setIndexDuration(getIndexDuration() - (position - getIndexStartPosition()));
     setIndexStartPosition(position);
 }
 
@@ -308,12 +323,96 @@ void IndexTableHelperSegment::CopyIndexEntries(const IndexTableHelperSegment *fr
         num_entries *= 2;
 
     mIndexEntries = new unsigned char[INTERNAL_INDEX_ENTRY_SIZE * num_entries];
-    memcpy(mIndexEntries, from_segment->mIndexEntries, INTERNAL_INDEX_ENTRY_SIZE * num_entries);
+    mStreamOffsets = new int64_t[num_entries];
+    memcpy(mIndexEntries, &from_segment->mIndexEntries[from_segment->mEntriesStart * INTERNAL_INDEX_ENTRY_SIZE],
+           INTERNAL_INDEX_ENTRY_SIZE * num_entries);
+    memcpy(mStreamOffsets, &from_segment->mStreamOffsets[from_segment->mEntriesStart],
+           sizeof(*mStreamOffsets) * num_entries);
     mAllocIndexEntries = num_entries;
     mNumIndexEntries = num_entries;
     mHavePairedIndexEntries = from_segment->mHavePairedIndexEntries;
 }
 
+void IndexTableHelperSegment::WriteIndexCache(MXFIndexCache *cache)
+{
+    cache->WriteRational(getIndexEditRate());
+    cache->WriteInt64(getIndexStartPosition());
+    cache->WriteInt64(getIndexDuration());
+    cache->WriteUInt32(getEditUnitByteCount());
+    cache->WriteUInt32(getIndexSID());
+    cache->WriteUInt32(getBodySID());
+    cache->WriteUInt8(_cSegment.sliceCount);
+    cache->WriteUInt8(_cSegment.posTableCount);
+
+    uint32_t num_delta_entries = 0;
+    const MXFDeltaEntry *delta_entry = _cSegment.deltaEntryArray;
+    while (delta_entry) {
+        num_delta_entries++;
+        delta_entry = delta_entry->next;
+    }
+    cache->WriteUInt32(num_delta_entries);
+    delta_entry = _cSegment.deltaEntryArray;
+    while (delta_entry) {
+        cache->WriteUInt8((uint8_t)delta_entry->posTableIndex);
+        cache->WriteUInt8(delta_entry->slice);
+        cache->WriteUInt32(delta_entry->elementData);
+        delta_entry = delta_entry->next;
+    }
+
+    cache->WriteUInt8(mIsFileIndexSegment);
+    cache->WriteUInt8(mHaveExtraIndexEntries);
+    cache->WriteUInt8(mHavePairedIndexEntries);
+    cache->WriteInt64(mIndexEndOffset);
+    cache->WriteInt64(mEssenceStartOffset);
+
+    cache->WriteUInt32(mNumIndexEntries);
+    uint32_t i;
+    for (i = mEntriesStart; i < mEntriesStart + mNumIndexEntries; i++) {
+        cache->WriteUInt8((uint8_t)GET_TEMPORAL_OFFSET(i));
+        cache->WriteUInt8((uint8_t)GET_KEY_FRAME_OFFSET(i));
+        cache->WriteUInt8(GET_FLAGS(i));
+        cache->WriteInt64(GET_STREAM_OFFSET(i));
+    }
+}
+
+void IndexTableHelperSegment::ReadIndexCache(MXFIndexCache *cache)
+{
+    BMX_ASSERT(!mIndexEntries);
+
+    setIndexEditRate(cache->ReadRational());
+    setIndexStartPosition(cache->ReadInt64());
+    setIndexDuration(cache->ReadInt64());
+    setEditUnitByteCount(cache->ReadUInt32());
+    setIndexSID(cache->ReadUInt32());
+    setBodySID(cache->ReadUInt32());
+    _cSegment.sliceCount    = cache->ReadUInt8();
+    _cSegment.posTableCount = cache->ReadUInt8();
+
+    uint32_t num_delta_entries = cache->ReadUInt32();
+    uint32_t i;
+    for (i = 0; i < num_delta_entries; i++) {
+        int8_t pos_table_index = (int8_t)cache->ReadUInt8();
+        uint8_t slice = cache->ReadUInt8();
+        uint32_t element_data = cache->ReadUInt32();
+        appendDeltaEntry(pos_table_index, slice, element_data);
+    }
+
+    mIsFileIndexSegment     = cache->ReadUInt8() != 0;
+    mHaveExtraIndexEntries  = cache->ReadUInt8() != 0;
+    mHavePairedIndexEntries = cache->ReadUInt8() != 0;
+    mIndexEndOffset         = cache->ReadInt64();
+    mEssenceStartOffset     = cache->ReadInt64();
+
+    uint32_t num_index_entries = cache->ReadUInt32();
+    for (i = 0; i < num_index_entries; i++) {
+        int8_t temporal_offset = (int8_t)cache->ReadUInt8();
+        int8_t key_frame_offset = (int8_t)cache->ReadUInt8();
+        uint8_t flags = cache->ReadUInt8();
+        int64_t stream_offset = cache->ReadInt64();
+        AppendIndexEntry(num_index_entries, temporal_offset, key_frame_offset, flags, stream_offset);
+    }
+}
+
 
 
 
@@ -323,10 +422,12 @@ IndexTableHelper::IndexTableHelper(MXFFileReader *file_reader)
     mFile = file_reader->mFile;
     mIsComplete = false;
     mLastEditUnitSegment = 0;
+    mSegmentStartsValid = false;
     mEditUnitSize = 0;
     mEssenceDataSize = 0;
     mEditRate = ZERO_RATIONAL;
     mDuration = 0;
+    mDiscardedDuration = 0;
 }
 
 IndexTableHelper::~IndexTableHelper()
@@ -338,70 +439,88 @@ IndexTableHelper::~IndexTableHelper()
 
 void IndexTableHelper::ExtractIndexTable()
 {
-    mxfKey key;
-    uint8_t llen;
-    uint64_t len;
-
-    const vector<Partition*> &partitions = mFileReader->mFile->getPartitions();
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    vector<size_t> index_partitions;
+    uint64_t max_body_offset = 0;
     size_t i;
     for (i = 0; i < partitions.size(); i++) {
-        const Partition *partition = partitions[i];
-
-        if (partition->getIndexSID() != mFileReader->mIndexSID)
-            continue;
+        if (partitions[i]->getIndexSID() == mFileReader->mIndexSID)
+            index_partitions.push_back(i);
+        if (partitions[i]->getBodySID() == mFileReader->mBodySID && partitions[i]->getBodyOffset() > max_body_offset)
+            max_body_offset = partitions[i]->getBodyOffset();
+    }
 
-        // find the start of the first index table segment
-        mFile->seek(partition->getThisPartition(), SEEK_SET);
-        mFile->readKL(&key, &llen, &len);
-        mFile->skip(len);
-        while (true)
+    // a complete index table repeated in the footer partition (e.g. OP1AFile::SetRepeatIndexTable) avoids
+    // having to read the index table segments in all the other partitions
+    vector<IndexTableHelperSegment*> footer_segments;
+    if (index_partitions.size() > 1 && partitions[index_partitions.back()]->isFooter()) {
+        try
         {
-            mFile->readNextNonFillerKL(&key, &llen, &len);
-
-            if (mxf_is_partition_pack(&key) || mxf_is_index_table_segment(&key))
-                break;
-            else if (mxf_is_header_metadata(&key) && partition->getHeaderByteCount() > mxfKey_extlen + llen + len)
-                mFile->skip(partition->getHeaderByteCount() - (mxfKey_extlen + llen));
-            else
-                mFile->skip(len);
+            ReadPartitionIndexSegments(mFile, index_partitions.back(), &footer_segments);
+        }
+        catch (...)
+        {
+            for (i = 0; i < footer_segments.size(); i++)
+                delete footer_segments[i];
+            throw;
         }
 
-        // parse the index table segments
-        if (mxf_is_index_table_segment(&key)) {
-            uint64_t num_read = mxfKey_extlen + llen;
-            uint64_t index_byte_count = partition->getIndexByteCount();
-            while (true)
-            {
-                if (mxf_is_index_table_segment(&key)) {
-                    ReadIndexTableSegment(len);
-                } else if (mxf_is_filler(&key)) {
-                    mFile->skip(len);
-                } else {
-                    num_read -= mxfKey_extlen + llen;
-                    break;
-                }
-                num_read += len;
+        if (IsCompleteIndexTable(footer_segments, max_body_offset)) {
+            InsertSegments(footer_segments);
+            mIsComplete = true;
+            return;
+        }
 
-                if (index_byte_count > 0 && num_read >= index_byte_count)
-                    break;
-                if (index_byte_count == 0 && i == partitions.size() - 1 && mFile->tell() >= mFile->size())
-                    break;
+        index_partitions.pop_back();
+    }
 
-                mFile->readKL(&key, &llen, &len);
-                num_read += mxfKey_extlen + llen;
-            }
-            if (index_byte_count > 0 && num_read != index_byte_count) {
-                log_warn("Index byte count %" PRIu64 " does not equal value in partition pack %" PRIu64 "\n",
-                         num_read, index_byte_count);
-            }
-        } else {
-            log_warn("Failed to find an index table segment in partition with IndexSID = %u\n", mFileReader->mIndexSID);
-        }
+    // read the other partitions in file order and insert the footer segments last as before
+    try
+    {
+        ReadIndexPartitions(index_partitions);
     }
+    catch (...)
+    {
+        for (i = 0; i < footer_segments.size(); i++)
+            delete footer_segments[i];
+        throw;
+    }
+    InsertSegments(footer_segments);
 
     mIsComplete = !mSegments.empty();
 }
 
+void IndexTableHelper::WriteIndexCache(MXFIndexCache *cache)
+{
+    cache->WriteUInt8(mIsComplete);
+    cache->WriteRational(mEditRate);
+    cache->WriteUInt32(mEditUnitSize);
+    cache->WriteInt64(mDuration);
+
+    cache->WriteUInt32((uint32_t)mSegments.size());
+    size_t i;
+    for (i = 0; i < mSegments.size(); i++)
+        mSegments[i]->WriteIndexCache(cache);
+}
+
+void IndexTableHelper::ReadIndexCache(MXFIndexCache *cache)
+{
+    BMX_ASSERT(mSegments.empty());
+
+    mIsComplete   = cache->ReadUInt8() != 0;
+    mEditRate     = cache->ReadRational();
+    mEditUnitSize = cache->ReadUInt32();
+    mDuration     = cache->ReadInt64();
+
+    uint32_t num_segments = cache->ReadUInt32();
+    uint32_t i;
+    for (i = 0; i < num_segments; i++) {
+        mSegments.push_back(new IndexTableHelperSegment());
+        mSegments.back()->ReadIndexCache(cache);
+    }
+    mSegmentStartsValid = false;
+}
+
 void IndexTableHelper::SetEssenceDataSize(int64_t size)
 {
     mEssenceDataSize = size;
@@ -427,6 +546,7 @@ void IndexTableHelper::SetConstantEditUnitSize(Rational edit_rate, uint32_t size
     IndexTableHelperSegment *segment = mSegments.back();
     segment->setIndexEditRate(edit_rate);
     segment->setEditUnitByteCount(size);
+    mSegmentStartsValid = false;
 
     mEditRate = edit_rate;
     mEditUnitSize = size;
@@ -434,32 +554,44 @@ void IndexTableHelper::SetConstantEditUnitSize(Rational edit_rate, uint32_t size
 
 int64_t IndexTableHelper::ReadIndexTableSegment(uint64_t len)
 {
-    auto_ptr<IndexTableHelperSegment> new_segment(new IndexTableHelperSegment());
-    new_segment->ReadIndexTableSegment(mFileReader->mFile, len);
+    IndexTableHelperSegment *segment = ReadSegment(mFile, len);
+    if (!segment)
+        return -1;
+
+    return InsertSegment(segment);
+}
+
+void IndexTableHelper::AppendPartitionIndexSegments(const vector<size_t> &partition_ids)
+{
+    vector<IndexTableHelperSegment*> segments;
+    size_t i;
     try
     {
-        new_segment->ProcessIndexTableSegment(mEditRate);
+        for (i = 0; i < partition_ids.size(); i++)
+            ReadPartitionIndexSegments(mFile, partition_ids[i], &segments);
     }
-    catch (const BMXException&)
+    catch (...)
     {
-        log_warn("Ignoring index table segment that is invalid or could not be processed\n");
-        return -1;
+        for (i = 0; i < segments.size(); i++)
+            delete segments[i];
+        throw;
     }
 
-    int64_t end_offset = -1;
-    if (new_segment->getIndexDuration() >= 0)
-        end_offset = new_segment->getIndexStartPosition() + new_segment->getIndexDuration();
-
-    if (new_segment->HaveConstantEditUnitSize())
-        InsertCBEIndexSegment(new_segment);
-    else
-        InsertVBEIndexSegment(new_segment);
-    // don't use new_segment from here onwards
-
-    if (mSegments.size() == 1)
-        mEditRate = mSegments.back()->getIndexEditRate();
+    // segments that would leave a gap after the current duration are dropped. They are read again when the
+    // essence reader gets to their partition
+    int64_t end_position = mDuration;
+    for (i = 0; i < segments.size(); i++) {
+        if (SEG_START(segments[i]) > end_position)
+            break;
+        if (SEG_END(segments[i]) > end_position)
+            end_position = SEG_END(segments[i]);
+    }
+    size_t j;
+    for (j = i; j < segments.size(); j++)
+        delete segments[j];
+    segments.resize(i);
 
-    return end_offset;
+    InsertSegments(segments);
 }
 
 void IndexTableHelper::UpdateIndex(int64_t position, int64_t essence_offset, int64_t size)
@@ -497,11 +629,36 @@ void IndexTableHelper::UpdateIndex(int64_t position, int64_t essence_offset, int
             mSegments.back()->AppendIndexEntry(0, 0, 0, 0, essence_offset);
 
         mSegments.push_back(segment.release());
+        mSegmentStartsValid = false;
     }
 
     mDuration++;
 }
 
+void IndexTableHelper::DiscardSegments(int64_t position)
+{
+    // delete the segments that end before position. The last segment is kept so that index entries
+    // can continue to be appended
+    size_t num_discard = 0;
+    while (num_discard + 1 < mSegments.size() &&
+           mSegments[num_discard]->getIndexStartPosition() +
+                mSegments[num_discard]->getIndexDuration() <= position)
+    {
+        num_discard++;
+    }
+    if (num_discard == 0)
+        return;
+
+    size_t i;
+    for (i = 0; i < num_discard; i++)
+        delete mSegments[i];
+    mSegments.erase(mSegments.begin(), mSegments.begin() + num_discard);
+
+    mDiscardedDuration = mSegments.front()->getIndexStartPosition();
+    mLastEditUnitSegment = 0;
+    mSegmentStartsValid = false;
+}
+
 void IndexTableHelper::SetIsComplete()
 {
     mIsComplete = true;
@@ -512,7 +669,7 @@ void IndexTableHelper::SetIsComplete()
 
 bool IndexTableHelper::HaveEditUnit(int64_t position) const
 {
-    return !mSegments.empty() && position >= 0 && position < mDuration;
+    return !mSegments.empty() && position >= mDiscardedDuration && position < mDuration;
 }
 
 void IndexTableHelper::GetEditUnit(int64_t position, int8_t *temporal_offset, int8_t *key_frame_offset, uint8_t *flags,
@@ -521,36 +678,25 @@ void IndexTableHelper::GetEditUnit(int64_t position, int8_t *temporal_offset, in
     BMX_ASSERT(!mSegments.empty());
     BMX_CHECK(mDuration == 0 || position < mDuration);
 
-    int result = mSegments[mLastEditUnitSegment]->GetEditUnit(position, temporal_offset, key_frame_offset, flags,
+    // try the last used segment and the one after it first to avoid a search when reading sequentially
+    int result = -1;
+    if (mLastEditUnitSegment < mSegments.size()) {
+        result = mSegments[mLastEditUnitSegment]->GetEditUnit(position, temporal_offset, key_frame_offset, flags,
                                                               offset);
+        if (result == -1 && mLastEditUnitSegment + 1 < mSegments.size()) {
+            result = mSegments[mLastEditUnitSegment + 1]->GetEditUnit(position, temporal_offset, key_frame_offset,
+                                                                      flags, offset);
+            if (result == 0)
+                mLastEditUnitSegment++;
+        }
+    }
     if (result < 0) {
-        // TODO: binary search
-        if (result == -2) {
-            // segment is before mLastEditUnitSegment
-            size_t i;
-            for (i = mLastEditUnitSegment; i > 0; i--) {
-                result = mSegments[i - 1]->GetEditUnit(position, temporal_offset, key_frame_offset, flags,
-                                                       offset);
-                if (result >= 0) {
-                    mLastEditUnitSegment = i - 1;
-                    break;
-                } else if (result == -1) {
-                    break;
-                }
-            }
-        } else {
-            // segment is after mLastEditUnitSegment
-            size_t i;
-            for (i = mLastEditUnitSegment + 1; i < mSegments.size(); i++) {
-                result = mSegments[i]->GetEditUnit(position, temporal_offset, key_frame_offset, flags,
-                                                   offset);
-                if (result >= 0) {
-                    mLastEditUnitSegment = i;
-                    break;
-                } else if (result == -2) {
-                    break;
-                }
-            }
+        size_t segment_index = FindSegment(position);
+        if (segment_index < mSegments.size()) {
+            result = mSegments[segment_index]->GetEditUnit(position, temporal_offset, key_frame_offset, flags,
+                                                           offset);
+            if (result == 0)
+                mLastEditUnitSegment = segment_index;
         }
     }
     BMX_CHECK_M(result == 0,
@@ -583,7 +729,8 @@ void IndexTableHelper::GetEditUnit(int64_t position, int64_t *offset, int64_t *s
 
 bool IndexTableHelper::HaveEditUnitOffset(int64_t position) const
 {
-    return position == 0 || (!mSegments.empty() && position >= 0 && position < mDuration);
+    return (position == 0 && mDiscardedDuration == 0) ||
+           (!mSegments.empty() && position >= mDiscardedDuration && position < mDuration);
 }
 
 int64_t IndexTableHelper::GetEditUnitOffset(int64_t position)
@@ -698,6 +845,16 @@ void IndexTableHelper::InsertVBEIndexSegment(auto_ptr<IndexTableHelperSegment> &
     if (mEditUnitSize > 0)
         BMX_EXCEPTION(("Can't mix VBE and CBE index table segments"));
 
+    // the part of a segment that indexes edit units discarded behind the read position of a stream is dropped
+    if (mDiscardedDuration > 0) {
+        if (SEG_END(new_segment) <= mDiscardedDuration) {
+            new_segment_ap.reset(0);
+            return;
+        }
+        if (SEG_START(new_segment) < mDiscardedDuration)
+            new_segment->UpdateStartPosition(mDiscardedDuration);
+    }
+
     // update or remove existing segments
     int64_t new_duration = 0;
     vector<IndexTableHelperSegment*>::iterator iter = mSegments.begin();
@@ -725,7 +882,8 @@ void IndexTableHelper::InsertVBEIndexSegment(auto_ptr<IndexTableHelperSegment> &
                 // existing segment ends after new segment
                 segment->UpdateStartPosition(SEG_END(new_segment));
             }
-        } else if (SEG_START(segment) >= SEG_END(new_segment)) {
+        }
+        if (!deleted_segment && SEG_START(*iter) >= SEG_END(new_segment)) {
             // existing (shortened) segment is after new segment
             iter = mSegments.insert(iter, new_segment);
             new_segment_ap.release();
@@ -738,7 +896,7 @@ void IndexTableHelper::InsertVBEIndexSegment(auto_ptr<IndexTableHelperSegment> &
         }
     }
     if (iter == mSegments.end()) {
-        if (( mSegments.empty() && SEG_START(new_segment) != 0) ||
+        if (( mSegments.empty() && SEG_START(new_segment) != mDiscardedDuration) ||
             (!mSegments.empty() && SEG_START(new_segment) != SEG_END(mSegments.back())))
         {
             // TODO: add support for sparse index tables
@@ -754,7 +912,26 @@ void IndexTableHelper::InsertVBEIndexSegment(auto_ptr<IndexTableHelperSegment> &
         }
     }
 
-    mDuration = new_duration;
+    // the segments start at 0, or at the first edit unit that was not discarded
+    mDuration = SEG_START(mSegments.front()) + new_duration;
+}
+
+size_t IndexTableHelper::FindSegment(int64_t position)
+{
+    if (!mSegmentStartsValid) {
+        mSegmentStarts.resize(mSegments.size());
+        size_t i;
+        for (i = 0; i < mSegments.size(); i++)
+            mSegmentStarts[i] = mSegments[i]->getIndexStartPosition();
+        mSegmentStartsValid = true;
+    }
+
+    // segments are ordered and don't overlap, so the candidate is the last one starting at or before position
+    vector<int64_t>::const_iterator iter = upper_bound(mSegmentStarts.begin(), mSegmentStarts.end(), position);
+    if (iter == mSegmentStarts.begin())
+        return mSegments.size();
+
+    return (size_t)(iter - mSegmentStarts.begin()) - 1;
 }
 
 IndexTableHelperSegment* IndexTableHelper::CreateStartSegment(IndexTableHelperSegment *segment, uint32_t duration)
@@ -768,3 +945,266 @@ IndexTableHelperSegment* IndexTableHelper::CreateStartSegment(IndexTableHelperSe
     return new_segment.release();
 }
 
+
+IndexTableHelperSegment* IndexTableHelper::ReadSegment(File *file, uint64_t len)
+{
+    auto_ptr<IndexTableHelperSegment> new_segment(new IndexTableHelperSegment());
+    new_segment->ReadIndexTableSegment(file, len);
+    try
+    {
+        new_segment->ProcessIndexTableSegment(mEditRate);
+    }
+    catch (const BMXException&)
+    {
+        log_warn("Ignoring index table segment that is invalid or could not be processed\n");
+        return 0;
+    }
+
+    return new_segment.release();
+}
+
+int64_t IndexTableHelper::InsertSegment(IndexTableHelperSegment *segment)
+{
+    auto_ptr<IndexTableHelperSegment> new_segment(segment);
+
+    int64_t end_offset = -1;
+    if (new_segment->getIndexDuration() >= 0)
+        end_offset = new_segment->getIndexStartPosition() + new_segment->getIndexDuration();
+
+    if (new_segment->HaveConstantEditUnitSize())
+        InsertCBEIndexSegment(new_segment);
+    else
+        InsertVBEIndexSegment(new_segment);
+    // don't use new_segment from here onwards
+    mSegmentStartsValid = false;
+
+    if (mSegments.size() == 1)
+        mEditRate = mSegments.back()->getIndexEditRate();
+
+    return end_offset;
+}
+
+void IndexTableHelper::InsertSegments(vector<IndexTableHelperSegment*> &segments)
+{
+    size_t i = 0;
+    try
+    {
+        for (; i < segments.size(); i++) {
+            IndexTableHelperSegment *segment = segments[i];
+            segments[i] = 0;
+            InsertSegment(segment);
+        }
+    }
+    catch (...)
+    {
+        for (; i < segments.size(); i++)
+            delete segments[i];
+        segments.clear();
+        throw;
+    }
+    segments.clear();
+}
+
+void IndexTableHelper::ReadPartitionIndexSegments(File *file, size_t partition_id,
+                                                  vector<IndexTableHelperSegment*> *segments)
+{
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    const Partition *partition = partitions[partition_id];
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+
+    // find the start of the first index table segment
+    file->seek(partition->getThisPartition(), SEEK_SET);
+    file->readKL(&key, &llen, &len);
+    file->skip(len);
+    while (true)
+    {
+        file->readNextNonFillerKL(&key, &llen, &len);
+
+        if (mxf_is_partition_pack(&key) || mxf_is_index_table_segment(&key))
+            break;
+        else if (mxf_is_header_metadata(&key) && partition->getHeaderByteCount() > mxfKey_extlen + llen + len)
+            file->skip(partition->getHeaderByteCount() - (mxfKey_extlen + llen));
+        else
+            file->skip(len);
+    }
+
+    // parse the index table segments
+    if (mxf_is_index_table_segment(&key)) {
+        uint64_t num_read = mxfKey_extlen + llen;
+        uint64_t index_byte_count = partition->getIndexByteCount();
+        while (true)
+        {
+            if (mxf_is_index_table_segment(&key)) {
+                IndexTableHelperSegment *segment = ReadSegment(file, len);
+                if (segment) {
+                    if (segments)
+                        segments->push_back(segment);
+                    else
+                        InsertSegment(segment);
+                }
+            } else if (mxf_is_filler(&key)) {
+                file->skip(len);
+            } else {
+                num_read -= mxfKey_extlen + llen;
+                break;
+            }
+            num_read += len;
+
+            if (index_byte_count > 0 && num_read >= index_byte_count)
+                break;
+            if (index_byte_count == 0 && partition_id == partitions.size() - 1 && file->tell() >= file->size())
+                break;
+
+            file->readKL(&key, &llen, &len);
+            num_read += mxfKey_extlen + llen;
+        }
+        if (index_byte_count > 0 && num_read != index_byte_count) {
+            log_warn("Index byte count %" PRIu64 " does not equal value in partition pack %" PRIu64 "\n",
+                     num_read, index_byte_count);
+        }
+    } else {
+        log_warn("Failed to find an index table segment in partition with IndexSID = %u\n", mFileReader->mIndexSID);
+    }
+}
+
+void IndexTableHelper::ReadIndexPartitions(const vector<size_t> &partition_ids)
+{
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    ByteArray buffer;
+    File buffer_file(mxf_buffer_file_open_read(0, 0, 0));
+
+    size_t i = 0;
+    while (i < partition_ids.size()) {
+        // group partitions whose index table segments are close together into a single read
+        int64_t read_start = partitions[partition_ids[i]]->getThisPartition();
+        int64_t read_end = GetIndexReadEnd(partition_ids[i]);
+        size_t group_end = i + 1;
+        if (read_end >= 0) {
+            while (group_end < partition_ids.size()) {
+                int64_t next_start = partitions[partition_ids[group_end]]->getThisPartition();
+                int64_t next_end = GetIndexReadEnd(partition_ids[group_end]);
+                if (next_end < 0 ||
+                    next_start - read_end > INDEX_READ_MAX_GAP ||
+                    next_end - read_start > INDEX_READ_MAX_SIZE)
+                {
+                    break;
+                }
+                read_end = next_end;
+                group_end++;
+            }
+        }
+        if (read_end < 0 || read_end - read_start > INDEX_READ_MAX_SIZE) {
+            ReadPartitionIndexSegments(mFile, partition_ids[i], 0);
+            i++;
+            continue;
+        }
+
+        buffer.SetSize(0);
+        buffer.Allocate((uint32_t)(read_end - read_start));
+        mFile->seek(read_start, SEEK_SET);
+        uint32_t num_read = mFile->read(buffer.GetBytes(), (uint32_t)(read_end - read_start));
+        buffer.SetSize(num_read);
+        mxf_buffer_file_set_data(buffer_file.getCFile(), buffer.GetBytes(), buffer.GetSize(), read_start);
+
+        vector<IndexTableHelperSegment*> segments;
+        size_t j;
+        for (; i < group_end; i++) {
+            // the segments are only inserted once the whole partition has been parsed so that a re-read
+            // doesn't insert them twice
+            bool buffer_read_failed = false;
+            try
+            {
+                ReadPartitionIndexSegments(&buffer_file, partition_ids[i], &segments);
+            }
+            catch (const MXFException&)
+            {
+                buffer_read_failed = true;
+            }
+            catch (const BMXException&)
+            {
+                buffer_read_failed = true;
+            }
+            catch (...)
+            {
+                for (j = 0; j < segments.size(); j++)
+                    delete segments[j];
+                throw;
+            }
+
+            if (buffer_read_failed) {
+                for (j = 0; j < segments.size(); j++)
+                    delete segments[j];
+                segments.clear();
+
+                // the index table segments extend beyond the estimated size. Read from the file instead
+                log_debug("Re-reading index table segments in partition at 0x%" PRIx64 " from file\n",
+                          partitions[partition_ids[i]]->getThisPartition());
+                ReadPartitionIndexSegments(mFile, partition_ids[i], 0);
+            } else {
+                InsertSegments(segments);
+            }
+        }
+    }
+}
+
+int64_t IndexTableHelper::GetIndexReadEnd(size_t partition_id)
+{
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    Partition *partition = partitions[partition_id];
+    if (partition->getIndexByteCount() == 0)
+        return -1;
+
+    // partition pack (with 9 byte llen) followed by a KAG alignment filler, the header metadata and
+    // the index table segments
+    int64_t end = partition->getThisPartition() +
+                  mxfKey_extlen + 9 + 88 + 16 * partition->getEssenceContainers().size() +
+                  mxfKey_extlen + 9 + partition->getKagSize() +
+                  partition->getHeaderByteCount() + partition->getIndexByteCount();
+    if (partition_id + 1 < partitions.size() && end > (int64_t)partitions[partition_id + 1]->getThisPartition())
+        end = partitions[partition_id + 1]->getThisPartition();
+
+    return end;
+}
+
+bool IndexTableHelper::IsCompleteIndexTable(const vector<IndexTableHelperSegment*> &segments,
+                                            uint64_t max_body_offset)
+{
+    if (segments.empty() || !mSegments.empty())
+        return false;
+
+    // require contiguous segments starting at position 0 with a consistent edit rate and index type
+    bool is_cbe = segments[0]->HaveConstantEditUnitSize();
+    int64_t end_position = 0;
+    int64_t cbe_end_offset = 0;
+    size_t i;
+    for (i = 0; i < segments.size(); i++) {
+        IndexTableHelperSegment *segment = segments[i];
+        if (SEG_START(segment) != end_position ||
+            segment->getIndexEditRate() != segments[0]->getIndexEditRate() ||
+            segment->HaveConstantEditUnitSize() != is_cbe ||
+            (SEG_DUR(segment) == 0 && i + 1 < segments.size()))
+        {
+            return false;
+        }
+        end_position = SEG_END(segment);
+        if (is_cbe)
+            cbe_end_offset += SEG_DUR(segment) * segment->GetEditUnitSize();
+    }
+
+    // require that the index covers the essence data in the last essence container partition
+    if (is_cbe) {
+        return SEG_DUR(segments.back()) == 0 || cbe_end_offset > (int64_t)max_body_offset;
+    } else {
+        IndexTableHelperSegment *last_segment = segments.back();
+        int8_t temporal_offset;
+        int8_t key_frame_offset;
+        uint8_t flags;
+        int64_t last_offset;
+        return SEG_DUR(last_segment) > 0 &&
+               last_segment->GetEditUnit(SEG_END(last_segment) - 1, &temporal_offset, &key_frame_offset, &flags,
+                                         &last_offset) == 0 &&
+               last_offset >= (int64_t)max_body_offset;
+    }
+}
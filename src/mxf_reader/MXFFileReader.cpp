@@ -48,6 +48,7 @@
 #include <bmx/st436/ST436Element.h>
 #include <bmx/MXFHTTPFile.h>
 #include <bmx/MXFUtils.h>
+#include <bmx/Stats.h>
 #include <bmx/Utils.h>
 #include <bmx/BMXException.h>
 #include <bmx/Logging.h>
@@ -162,6 +163,10 @@ MXFFileReader::MXFFileReader()
     mEssenceReader = 0;
     mRequireFrameInfoCount = 0;
     mST436ManifestCount = 2;
+    mCPReadCount = 0;
+    mPrefetchDepth = 0;
+    mPrefetchMaxSize = 0;
+    mIndexCacheEnabled = false;
 
     mDataModel = new DataModel();
     mHeaderMetadata = new AvidHeaderMetadata(mDataModel);
@@ -226,6 +231,27 @@ void MXFFileReader::SetST436ManifestFrameCount(uint32_t count)
     mST436ManifestCount = count;
 }
 
+void MXFFileReader::SetContentPackageReadCount(uint32_t count)
+{
+    mCPReadCount = count;
+    if (mEssenceReader)
+        mEssenceReader->SetContentPackageReadCount(count);
+}
+
+void MXFFileReader::SetPrefetch(uint32_t depth, uint64_t max_size)
+{
+    mPrefetchDepth = depth;
+    mPrefetchMaxSize = max_size;
+    if (mEssenceReader)
+        mEssenceReader->SetPrefetch(depth, max_size);
+}
+
+void MXFFileReader::SetIndexCache(bool enable, const string &cache_dir)
+{
+    mIndexCacheEnabled = enable;
+    mIndexCacheDir = cache_dir;
+}
+
 void MXFFileReader::SetFileIndex(MXFFileIndex *file_index, bool take_ownership)
 {
     if (mFileId != (size_t)(-1))
@@ -340,15 +366,33 @@ MXFFileReader::OpenResult MXFFileReader::Open(File *file, const URI &abs_uri, co
         }
 
 
-        // try read all partitions find and get last partition with header metadata
+        // restore the partitions from the index cache if it is up to date, otherwise try read all
+        // partitions find and get last partition with header metadata
+
+        auto_ptr<MXFIndexCache> index_cache;
+        string index_cache_filename;
+        int64_t file_size = 0;
+        int64_t modified_time = 0;
+        if (mIndexCacheEnabled && mFile->isSeekable() && !filename.empty() &&
+            get_file_status(filename, &file_size, &modified_time))
+        {
+            index_cache_filename = MXFIndexCache::GetCacheFilename(filename, mIndexCacheDir);
+            index_cache.reset(ReadIndexCache(index_cache_filename, file_size, modified_time));
+        }
 
         bool file_is_complete;
-        if (mFile->isSeekable()) {
+        if (index_cache.get()) {
+            file_is_complete = true;
+        } else if (mFile->isSeekable()) {
             file_is_complete = mFile->readPartitions();
             if (!file_is_complete) {
                 BMX_ASSERT(mFile->getPartitions().size() == 1);
                 if (mFile->getPartition(0).isClosed() || mFile->getPartition(0).getFooterPartition() != 0)
                     log_warn("Failed to read all partitions. File may be incomplete or invalid\n");
+            } else if (!index_cache_filename.empty()) {
+                index_cache.reset(new MXFIndexCache());
+                index_cache->SetFileInfo(file_size, modified_time, mFile->getPartitions().back()->getThisPartition());
+                WritePartitionsIndexCache(index_cache.get());
             }
         } else {
             file_is_complete = false;
@@ -385,7 +429,9 @@ MXFFileReader::OpenResult MXFFileReader::Open(File *file, const URI &abs_uri, co
 
         // create internal essence reader
         if (!mInternalTrackReaders.empty()) {
-            mEssenceReader = new EssenceReader(this, file_is_complete);
+            mEssenceReader = new EssenceReader(this, file_is_complete, index_cache.get());
+            mEssenceReader->SetContentPackageReadCount(mCPReadCount);
+            mEssenceReader->SetPrefetch(mPrefetchDepth, mPrefetchMaxSize);
 
             CheckRequireFrameInfo();
             if (mRequireFrameInfoCount > 0)
@@ -419,6 +465,9 @@ MXFFileReader::OpenResult MXFFileReader::Open(File *file, const URI &abs_uri, co
                 mTrackReaders[i]->SetEmptyFrames(mEmptyFrames);
         }
 
+        if (index_cache.get() && !index_cache->IsLoaded())
+            index_cache->Write(index_cache_filename);
+
 
         result = MXF_RESULT_SUCCESS;
     }
@@ -572,6 +621,9 @@ void MXFFileReader::SetReadLimits(int64_t start_position, int64_t duration, bool
 
 uint32_t MXFFileReader::Read(uint32_t num_samples, bool is_top)
 {
+    // external readers are included in the top-level read
+    StatsTimer stats_timer(STATS_MXF_READ, is_top);
+
     mReadError = false;
     mReadErrorMessage.clear();
 
@@ -822,6 +874,17 @@ int64_t MXFFileReader::GetFixedLeadFillerOffset() const
     return fixed_offset;
 }
 
+int64_t MXFFileReader::UpdateIndexedDuration()
+{
+    if (!mEssenceReader)
+        return 0;
+
+    mEssenceReader->DiscoverPartitions();
+
+    int64_t duration = FROM_ESS_READER_POS(mEssenceReader->GetIndexedDuration());
+    return duration > 0 ? duration : 0;
+}
+
 MXFTrackReader* MXFFileReader::GetTrackReader(size_t index) const
 {
     BMX_CHECK(index < mTrackReaders.size());
@@ -2139,6 +2202,7 @@ void MXFFileReader::ExtractFrameInfo()
 {
     int64_t ess_reader_pos = mEssenceReader->GetPosition();
 
+    mEssenceReader->PausePrefetch(true);
     SetTemporaryFrameBuffer(true);
     if (!mFile->isSeekable())
       mEssenceReader->SetBufferFrames(true);
@@ -2166,7 +2230,8 @@ void MXFFileReader::ExtractFrameInfo()
             for (i = 0; i < mInternalTrackReaders.size(); i++) {
                 Frame *frame = mInternalTrackReaders[i]->GetFrameBuffer()->GetLastFrame(true);
                 if (!frame || frame->IsEmpty()) {
-                    delete frame;
+                    if (frame)
+                        frame->Release();
                     frame = 0;
                     continue;
                 }
@@ -2223,7 +2288,7 @@ void MXFFileReader::ExtractFrameInfo()
                     }
                 }
 
-                delete frame;
+                frame->Release();
                 frame = 0;
                 have_first = true;
             }
@@ -2238,19 +2303,114 @@ void MXFFileReader::ExtractFrameInfo()
             if (have_first) // good enough to continue
                 mRequireFrameInfoCount = 0;
         }
-        delete frame;
+        if (frame)
+            frame->Release();
     }
     catch (...)
     {
-        delete frame;
+        if (frame)
+            frame->Release();
     }
 
     SetTemporaryFrameBuffer(false);
     if (!mFile->isSeekable())
       mEssenceReader->SetBufferFrames(false);
+    mEssenceReader->PausePrefetch(false);
     mEssenceReader->Seek(ess_reader_pos);
 }
 
+MXFIndexCache* MXFFileReader::ReadIndexCache(const string &cache_filename, int64_t file_size, int64_t modified_time)
+{
+    auto_ptr<MXFIndexCache> cache(new MXFIndexCache());
+    if (!cache->Read(cache_filename))
+        return 0;
+
+    // check the cache matches the file and header partition pack, and that a footer partition pack is
+    // found at the cached position
+    Partition &header_partition = mFile->getPartition(0);
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+    if (!cache->MatchesFile(file_size, modified_time) ||
+        cache->ReadUInt64() != header_partition.getThisPartition() ||
+        cache->ReadUInt64() != header_partition.getHeaderByteCount() ||
+        cache->ReadUInt64() != header_partition.getFooterPartition() ||
+        cache->GetFooterPosition() >= file_size ||
+        !mxf_file_seek(mFile->getCFile(), cache->GetFooterPosition(), SEEK_SET) ||
+        !mxf_read_kl(mFile->getCFile(), &key, &llen, &len) ||
+        !mxf_is_footer_partition_pack(&key))
+    {
+        log_debug("Ignoring out of date index cache file '%s'\n", cache_filename.c_str());
+        return 0;
+    }
+
+    uint32_t num_partitions = cache->ReadUInt32();
+    uint32_t i;
+    for (i = 0; i < num_partitions; i++) {
+        Partition &partition = mFile->createPartition();
+        MXFPartition *c_partition = partition.getCPartition();
+        cache->ReadUL(&c_partition->key);
+        c_partition->majorVersion      = cache->ReadUInt16();
+        c_partition->minorVersion      = cache->ReadUInt16();
+        c_partition->kagSize           = cache->ReadUInt32();
+        c_partition->thisPartition     = cache->ReadUInt64();
+        c_partition->previousPartition = cache->ReadUInt64();
+        c_partition->footerPartition   = cache->ReadUInt64();
+        c_partition->headerByteCount   = cache->ReadUInt64();
+        c_partition->indexByteCount    = cache->ReadUInt64();
+        c_partition->indexSID          = cache->ReadUInt32();
+        c_partition->bodyOffset        = cache->ReadUInt64();
+        c_partition->bodySID           = cache->ReadUInt32();
+        cache->ReadUL(&c_partition->operationalPattern);
+
+        // replace any labels copied from the previous partition
+        mxf_clear_list(&c_partition->essenceContainers);
+        uint32_t num_labels = cache->ReadUInt32();
+        uint32_t j;
+        for (j = 0; j < num_labels; j++) {
+            mxfUL label;
+            cache->ReadUL(&label);
+            partition.addEssenceContainer(&label);
+        }
+    }
+
+    return cache.release();
+}
+
+void MXFFileReader::WritePartitionsIndexCache(MXFIndexCache *cache)
+{
+    const vector<Partition*> &partitions = mFile->getPartitions();
+    cache->WriteUInt64(partitions[0]->getThisPartition());
+    cache->WriteUInt64(partitions[0]->getHeaderByteCount());
+    cache->WriteUInt64(partitions[0]->getFooterPartition());
+
+    // the header partition pack has already been read when the cache is used
+    cache->WriteUInt32((uint32_t)(partitions.size() - 1));
+    size_t i;
+    for (i = 1; i < partitions.size(); i++) {
+        const MXFPartition *c_partition = partitions[i]->getCPartition();
+        cache->WriteUL(&c_partition->key);
+        cache->WriteUInt16(c_partition->majorVersion);
+        cache->WriteUInt16(c_partition->minorVersion);
+        cache->WriteUInt32(c_partition->kagSize);
+        cache->WriteUInt64(c_partition->thisPartition);
+        cache->WriteUInt64(c_partition->previousPartition);
+        cache->WriteUInt64(c_partition->footerPartition);
+        cache->WriteUInt64(c_partition->headerByteCount);
+        cache->WriteUInt64(c_partition->indexByteCount);
+        cache->WriteUInt32(c_partition->indexSID);
+        cache->WriteUInt64(c_partition->bodyOffset);
+        cache->WriteUInt32(c_partition->bodySID);
+        cache->WriteUL(&c_partition->operationalPattern);
+
+        vector<mxfUL> labels = partitions[i]->getEssenceContainers();
+        cache->WriteUInt32((uint32_t)labels.size());
+        size_t j;
+        for (j = 0; j < labels.size(); j++)
+            cache->WriteUL(&labels[j]);
+    }
+}
+
 void MXFFileReader::StartRead()
 {
     size_t i;
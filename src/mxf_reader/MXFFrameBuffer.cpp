@@ -141,7 +141,7 @@ Frame* MXFFrameBuffer::CreateFrame()
 void MXFFrameBuffer::PushFrame(Frame *frame)
 {
     if (frame->IsEmpty() && !mEmptyFrames) {
-        delete frame;
+        frame->Release();
         return;
     }
 
@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <bmx/mxf_reader/MXFIndexCache.h>
+#include <bmx/CRC32.h>
+#include <bmx/Utils.h>
+#include <bmx/BMXException.h>
+#include <bmx/Logging.h>
+
+using namespace std;
+using namespace bmx;
+
+
+#define CACHE_FILE_SUFFIX   ".bmxidx"
+#define CACHE_VERSION       2
+
+// magic (4) + version (4) + file size (8) + modified time (8) + footer position (8) + data size (4) + data crc (4)
+#define CACHE_HEADER_SIZE   40
+
+static const unsigned char CACHE_MAGIC[4] = {'B', 'M', 'X', 'I'};
+
+#if defined(_MSC_VER)
+#define ATOMIC_INCREMENT(var)   InterlockedIncrement((volatile LONG*)&(var))
+#else
+#define ATOMIC_INCREMENT(var)   __sync_add_and_fetch(&(var), 1)
+#endif
+
+// distinguishes the temporary files of cache writers in the same process, e.g. batch jobs
+static long g_temp_file_count = 0;
+
+
+
+static void set_uint32(unsigned char *bytes, uint32_t value)
+{
+    bytes[0] = (unsigned char)(value >> 24);
+    bytes[1] = (unsigned char)(value >> 16);
+    bytes[2] = (unsigned char)(value >> 8);
+    bytes[3] = (unsigned char)(value);
+}
+
+static void set_uint64(unsigned char *bytes, uint64_t value)
+{
+    set_uint32(bytes,     (uint32_t)(value >> 32));
+    set_uint32(bytes + 4, (uint32_t)(value));
+}
+
+static uint32_t get_uint32(const unsigned char *bytes)
+{
+    return ((uint32_t)bytes[0] << 24) |
+           ((uint32_t)bytes[1] << 16) |
+           ((uint32_t)bytes[2] << 8)  |
+            (uint32_t)bytes[3];
+}
+
+static uint64_t get_uint64(const unsigned char *bytes)
+{
+    return ((uint64_t)get_uint32(bytes) << 32) | get_uint32(bytes + 4);
+}
+
+static uint32_t calc_crc32(const unsigned char *data, uint32_t size)
+{
+    uint32_t crc;
+    crc32_init(&crc);
+    crc32_update(&crc, data, size);
+    crc32_final(&crc);
+    return crc;
+}
+
+
+
+string MXFIndexCache::GetCacheFilename(const string &mxf_filename, const string &cache_dir)
+{
+    if (cache_dir.empty())
+        return mxf_filename + CACHE_FILE_SUFFIX;
+    else
+        return get_abs_filename(cache_dir, strip_path(mxf_filename)) + CACHE_FILE_SUFFIX;
+}
+
+MXFIndexCache::MXFIndexCache()
+{
+    mFileSize = -1;
+    mModifiedTime = -1;
+    mFooterPosition = -1;
+    mIsLoaded = false;
+    mData.SetAllocBlockSize(64 * 1024);
+    mReadPosition = 0;
+}
+
+MXFIndexCache::~MXFIndexCache()
+{
+}
+
+void MXFIndexCache::SetFileInfo(int64_t file_size, int64_t modified_time, int64_t footer_position)
+{
+    mFileSize = file_size;
+    mModifiedTime = modified_time;
+    mFooterPosition = footer_position;
+}
+
+bool MXFIndexCache::Read(const string &filename)
+{
+    int64_t cache_file_size;
+    int64_t cache_modified_time;
+    if (!get_file_status(filename, &cache_file_size, &cache_modified_time))
+        return false;
+
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file)
+        return false;
+
+    unsigned char header[CACHE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+    {
+        log_warn("Ignoring invalid index cache file '%s'\n", filename.c_str());
+        fclose(file);
+        return false;
+    }
+    if (get_uint32(&header[4]) != CACHE_VERSION) {
+        log_debug("Ignoring index cache file '%s' with version %u\n", filename.c_str(), get_uint32(&header[4]));
+        fclose(file);
+        return false;
+    }
+
+    // check the data size before allocating so that a corrupt size is ignored rather than failing the allocation
+    uint32_t data_size = get_uint32(&header[32]);
+    if (CACHE_HEADER_SIZE + (int64_t)data_size != cache_file_size) {
+        log_warn("Ignoring truncated or corrupt index cache file '%s'\n", filename.c_str());
+        fclose(file);
+        return false;
+    }
+    mData.Allocate(data_size);
+    if (fread(mData.GetBytes(), 1, data_size, file) != data_size ||
+        calc_crc32(mData.GetBytes(), data_size) != get_uint32(&header[36]))
+    {
+        log_warn("Ignoring truncated or corrupt index cache file '%s'\n", filename.c_str());
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    mData.SetSize(data_size);
+    mReadPosition = 0;
+    mFileSize = (int64_t)get_uint64(&header[8]);
+    mModifiedTime = (int64_t)get_uint64(&header[16]);
+    mFooterPosition = (int64_t)get_uint64(&header[24]);
+    mIsLoaded = true;
+
+    return true;
+}
+
+bool MXFIndexCache::Write(const string &filename)
+{
+    unsigned char header[CACHE_HEADER_SIZE];
+    memcpy(header, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    set_uint32(&header[4], CACHE_VERSION);
+    set_uint64(&header[8], (uint64_t)mFileSize);
+    set_uint64(&header[16], (uint64_t)mModifiedTime);
+    set_uint64(&header[24], (uint64_t)mFooterPosition);
+    set_uint32(&header[32], mData.GetSize());
+    set_uint32(&header[36], calc_crc32(mData.GetBytes(), mData.GetSize()));
+
+    // write to a temporary file in the same directory and rename it so that a reader, or another
+    // writer for the same MXF file, never sees a partially written cache file. The temporary file name is
+    // unique to the writer in this process
+    long temp_count = ATOMIC_INCREMENT(g_temp_file_count);
+    char temp_suffix[64];
+#if defined(_WIN32)
+    bmx_snprintf(temp_suffix, sizeof(temp_suffix), ".tmp%d_%ld", _getpid(), temp_count);
+#else
+    bmx_snprintf(temp_suffix, sizeof(temp_suffix), ".tmp%d_%ld", (int)getpid(), temp_count);
+#endif
+    string temp_filename = filename + temp_suffix;
+
+    FILE *file = fopen(temp_filename.c_str(), "wb");
+    if (!file) {
+        log_warn("Failed to open index cache file '%s' for writing: %s\n",
+                 temp_filename.c_str(), bmx_strerror(errno).c_str());
+        return false;
+    }
+
+    bool result = (fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+                   fwrite(mData.GetBytes(), 1, mData.GetSize(), file) == mData.GetSize());
+    if (fclose(file) != 0)
+        result = false;
+    if (!result) {
+        log_warn("Failed to write index cache file '%s'\n", temp_filename.c_str());
+        remove(temp_filename.c_str());
+        return false;
+    }
+
+#if defined(_WIN32)
+    // rename() does not replace an existing file on Windows
+    remove(filename.c_str());
+#endif
+    if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+        log_warn("Failed to rename index cache file '%s' to '%s': %s\n",
+                 temp_filename.c_str(), filename.c_str(), bmx_strerror(errno).c_str());
+        remove(temp_filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool MXFIndexCache::MatchesFile(int64_t file_size, int64_t modified_time) const
+{
+    return mFileSize == file_size && mModifiedTime == modified_time;
+}
+
+void MXFIndexCache::WriteUInt8(uint8_t value)
+{
+    mData.Append(&value, 1);
+}
+
+void MXFIndexCache::WriteUInt16(uint16_t value)
+{
+    unsigned char bytes[2];
+    bytes[0] = (unsigned char)(value >> 8);
+    bytes[1] = (unsigned char)(value);
+    mData.Append(bytes, sizeof(bytes));
+}
+
+void MXFIndexCache::WriteUInt32(uint32_t value)
+{
+    unsigned char bytes[4];
+    set_uint32(bytes, value);
+    mData.Append(bytes, sizeof(bytes));
+}
+
+void MXFIndexCache::WriteUInt64(uint64_t value)
+{
+    unsigned char bytes[8];
+    set_uint64(bytes, value);
+    mData.Append(bytes, sizeof(bytes));
+}
+
+void MXFIndexCache::WriteInt64(int64_t value)
+{
+    WriteUInt64((uint64_t)value);
+}
+
+void MXFIndexCache::WriteUL(const UL *value)
+{
+    mData.Append((const unsigned char*)value, sizeof(*value));
+}
+
+void MXFIndexCache::WriteRational(Rational value)
+{
+    WriteUInt32((uint32_t)value.numerator);
+    WriteUInt32((uint32_t)value.denominator);
+}
+
+uint8_t MXFIndexCache::ReadUInt8()
+{
+    return *ReadBytes(1);
+}
+
+uint16_t MXFIndexCache::ReadUInt16()
+{
+    const unsigned char *bytes = ReadBytes(2);
+    return ((uint16_t)bytes[0] << 8) | bytes[1];
+}
+
+uint32_t MXFIndexCache::ReadUInt32()
+{
+    return get_uint32(ReadBytes(4));
+}
+
+uint64_t MXFIndexCache::ReadUInt64()
+{
+    return get_uint64(ReadBytes(8));
+}
+
+int64_t MXFIndexCache::ReadInt64()
+{
+    return (int64_t)ReadUInt64();
+}
+
+void MXFIndexCache::ReadUL(UL *value)
+{
+    memcpy(value, ReadBytes(sizeof(*value)), sizeof(*value));
+}
+
+Rational MXFIndexCache::ReadRational()
+{
+    Rational value;
+    value.numerator   = (int32_t)ReadUInt32();
+    value.denominator = (int32_t)ReadUInt32();
+    return value;
+}
+
+const unsigned char* MXFIndexCache::ReadBytes(uint32_t size)
+{
+    if (size > mData.GetSize() - mReadPosition)
+        BMX_EXCEPTION(("Index cache data is truncated"));
+
+    const unsigned char *bytes = mData.GetBytes() + mReadPosition;
+    mReadPosition += size;
+
+    return bytes;
+}
@@ -198,6 +198,9 @@ bool MXFTextObject::CheckIsXML()
 
 void MXFTextObject::ReadGenericStream(FILE *text_file_out, unsigned char **data_out, size_t *data_out_size)
 {
+    // the file is shared with the essence reader's prefetch thread
+    MutexLocker file_locker(mFileReader->mEssenceReader ? mFileReader->mEssenceReader->GetFileMutex() : 0);
+
     mxfpp::File *mxf_file = mFileReader->mFile;
     int64_t original_file_pos = mxf_file->tell();
     try
@@ -236,6 +236,23 @@ uint32_t RDD9ContentPackageElementData::WriteSamples(const unsigned char *data,
     return write_num_samples;
 }
 
+void RDD9ContentPackageElementData::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    if (mNumSamples == 0) {
+        if (!mElement->CheckValidSampleCount(1))
+            BMX_EXCEPTION(("Invalid sound sample count 1 for sample sequence"));
+        mNumSamples = 1;
+    }
+
+    BMX_ASSERT(mNumSamples > mNumSamplesWritten);
+
+    uint32_t size = dba_get_total_size(data_array, array_size);
+    mData.Grow(size);
+    dba_copy_data(mData.GetBytesAvailable(), mData.GetSizeAvailable(), data_array, array_size);
+    mData.IncrementSize(size);
+    mNumSamplesWritten++;
+}
+
 bool RDD9ContentPackageElementData::IsComplete() const
 {
     return mNumSamplesWritten > 0 && mNumSamplesWritten >= mNumSamples;
@@ -323,6 +340,13 @@ uint32_t RDD9ContentPackage::WriteSamples(uint32_t track_index, const unsigned c
     return mElementTrackIndexMap[track_index]->WriteSamples(data, size, num_samples);
 }
 
+void RDD9ContentPackage::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(mElementTrackIndexMap.find(track_index) != mElementTrackIndexMap.end());
+
+    mElementTrackIndexMap[track_index]->WriteSample(data_array, array_size);
+}
+
 uint32_t RDD9ContentPackage::GetSoundSampleCount() const
 {
     uint32_t min_sample_count = 0;
@@ -602,6 +626,18 @@ void RDD9ContentPackageManager::WriteSamples(uint32_t track_index, const unsigne
     }
 }
 
+void RDD9ContentPackageManager::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(data_array && array_size);
+
+    size_t cp_index = GetCurrentContentPackage(track_index);
+
+    if (cp_index >= mContentPackages.size())
+        cp_index = CreateContentPackage();
+
+    mContentPackages[cp_index]->WriteSample(track_index, data_array, array_size);
+}
+
 bool RDD9ContentPackageManager::HaveContentPackage(bool final_write)
 {
     if (final_write && !mSoundSequenceOffsetSet)
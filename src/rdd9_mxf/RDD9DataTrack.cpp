@@ -90,3 +90,14 @@ void RDD9DataTrack::WriteSamplesInt(const unsigned char *data, uint32_t size, ui
     mPosition++;
 }
 
+void RDD9DataTrack::WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_CHECK(data_array && array_size);
+
+    WriteSampleInt(data_array, array_size);
+    if (!mConstantDataSize && !mMaxDataSize)
+        mIndexTable->AddIndexEntry(mTrackIndex, mPosition, 0, 0, 0, true);
+
+    mPosition++;
+}
+
@@ -107,6 +107,12 @@ RDD9File::RDD9File(int flavour, File *mxf_file, Rational frame_rate)
     mPartitionFrameCount = 0;
     mMXFChecksumFile = 0;
 
+    // a stream output, e.g. stdout or a pipe, can only be written in a single pass
+    if (!mMXFFile->isSeekable() && !(mFlavour & RDD9_SINGLE_PASS_WRITE_FLAVOUR)) {
+        log_info("Writing in a single pass because the output file is not seekable\n");
+        mFlavour |= RDD9_SINGLE_PASS_WRITE_FLAVOUR;
+    }
+
     mTrackIdHelper.SetId("TimecodeTrack", 1);
     mTrackIdHelper.SetStartId(MXF_PICTURE_DDEF, 2);
     mTrackIdHelper.SetStartId(MXF_SOUND_DDEF,   4);
@@ -363,6 +369,16 @@ void RDD9File::WriteSamples(uint32_t track_index, const unsigned char *data, uin
     WriteContentPackages(false);
 }
 
+void RDD9File::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    if (!data_array || dba_get_total_size(data_array, array_size) == 0)
+        return;
+
+    GetTrack(track_index)->WriteSampleArrayInt(data_array, array_size);
+
+    WriteContentPackages(false);
+}
+
 void RDD9File::CompleteWrite()
 {
     BMX_ASSERT(mMXFFile);
@@ -479,6 +495,12 @@ void RDD9File::CompleteWrite()
     }
 
 
+    // write the output buffered by a stream. The seek fails if that fails, whereas the close only logs it
+
+    if (!mMXFFile->isSeekable())
+        mMXFFile->seek(mMXFFile->tell(), SEEK_SET);
+
+
     // done with the file
     delete mMXFFile;
     mMXFFile = 0;
@@ -178,6 +178,11 @@ void RDD9Track::WriteSamples(const unsigned char *data, uint32_t size, uint32_t
     mRDD9File->WriteSamples(mTrackIndex, data, size, num_samples);
 }
 
+void RDD9Track::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    mRDD9File->WriteSample(mTrackIndex, data_array, array_size);
+}
+
 mxfUL RDD9Track::GetEssenceContainerUL() const
 {
     return mDescriptorHelper->GetEssenceContainerUL();
@@ -277,6 +282,23 @@ void RDD9Track::WriteSamplesInt(const unsigned char *data, uint32_t size, uint32
     mCPManager->WriteSamples(mTrackIndex, data, size, num_samples);
 }
 
+void RDD9Track::WriteSampleInt(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(data_array && array_size);
+
+    mCPManager->WriteSample(mTrackIndex, data_array, array_size);
+}
+
+void RDD9Track::WriteSampleArrayInt(const CDataBuffer *data_array, uint32_t array_size)
+{
+    BMX_ASSERT(data_array && array_size);
+
+    // tracks that pass the sample data through unchanged override this method to avoid the copy
+    uint32_t size;
+    const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+    WriteSamplesInt(data, size, 1);
+}
+
 void RDD9Track::CompleteEssenceKeyAndTrackNum(uint8_t track_count)
 {
     mxf_complete_essence_element_key(&mEssenceElementKey,
@@ -51,6 +51,26 @@ using namespace bmx;
 #define LINE_HEADER_SIZE    14
 
 
+static const unsigned char ZERO_PADDING[3] = {0, 0, 0};
+
+
+static void append_data(vector<CDataBuffer> *data_array, const unsigned char *data, uint32_t size)
+{
+    if (size == 0)
+        return;
+
+    // extend the last buffer if the data follows on from it, e.g. for consecutive headers
+    if (!data_array->empty() && data_array->back().data + data_array->back().size == data) {
+        data_array->back().size += size;
+    } else {
+        CDataBuffer buffer;
+        buffer.data = (unsigned char*)data;
+        buffer.size = size;
+        data_array->push_back(buffer);
+    }
+}
+
+
 
 ST436Line::ST436Line(bool is_vbi_in)
 {
@@ -73,13 +93,7 @@ void ST436Line::Construct(ByteArray *data)
     uint32_t aligned_payload_size = (payload_size + 3) & ~3U;
 
     data->Grow(LINE_HEADER_SIZE + aligned_payload_size);
-    unsigned char *header_data = data->GetBytesAvailable();
-
-    mxf_set_uint16(line_number,                   header_data);
-    mxf_set_uint8(wrapping_type,                  &header_data[2]);
-    mxf_set_uint8(payload_sample_coding,          &header_data[3]);
-    mxf_set_uint16(payload_sample_count,          &header_data[4]);
-    mxf_set_array_header(aligned_payload_size, 1, &header_data[6]);
+    ConstructHeader(data->GetBytesAvailable());
     data->IncrementSize(LINE_HEADER_SIZE);
 
     if (payload_size > 0)
@@ -92,6 +106,17 @@ void ST436Line::Construct(ByteArray *data)
     }
 }
 
+void ST436Line::ConstructHeader(unsigned char *header_data)
+{
+    uint32_t aligned_payload_size = (payload_size + 3) & ~3U;
+
+    mxf_set_uint16(line_number,                   header_data);
+    mxf_set_uint8(wrapping_type,                  &header_data[2]);
+    mxf_set_uint8(payload_sample_coding,          &header_data[3]);
+    mxf_set_uint16(payload_sample_count,          &header_data[4]);
+    mxf_set_array_header(aligned_payload_size, 1, &header_data[6]);
+}
+
 void ST436Line::Parse(const unsigned char *data, uint64_t *size_inout)
 {
     uint64_t size = *size_inout;
@@ -148,6 +173,34 @@ void ST436Element::Construct(ByteArray *data)
         lines[i].Construct(data);
 }
 
+void ST436Element::Construct(ByteArray *header_data, vector<CDataBuffer> *data_array)
+{
+    if (lines.size() > UINT16_MAX)
+        BMX_EXCEPTION(("Number of ST 436 lines %" PRIszt " exceeds maximum %u", lines.size(), UINT16_MAX));
+
+    // the headers are written first so that the buffer is not reallocated after the data array references it
+    uint32_t header_size = 2 + (uint32_t)lines.size() * LINE_HEADER_SIZE;
+    header_data->SetSize(0);
+    header_data->Allocate(header_size);
+    header_data->SetSize(header_size);
+
+    unsigned char *header_bytes = header_data->GetBytes();
+    mxf_set_uint16((uint16_t)lines.size(), header_bytes);
+    size_t i;
+    for (i = 0; i < lines.size(); i++)
+        lines[i].ConstructHeader(&header_bytes[2 + i * LINE_HEADER_SIZE]);
+
+    data_array->clear();
+    append_data(data_array, header_bytes, 2);
+    for (i = 0; i < lines.size(); i++) {
+        const ST436Line &line = lines[i];
+        uint32_t aligned_payload_size = (line.payload_size + 3) & ~3U;
+        append_data(data_array, &header_bytes[2 + i * LINE_HEADER_SIZE], LINE_HEADER_SIZE);
+        append_data(data_array, line.payload_data, line.payload_size);
+        append_data(data_array, ZERO_PADDING, aligned_payload_size - line.payload_size);
+    }
+}
+
 void ST436Element::Parse(const unsigned char *data, uint64_t size)
 {
     lines.clear();
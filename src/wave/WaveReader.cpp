@@ -179,44 +179,52 @@ uint32_t WaveReader::Read(uint32_t num_samples)
     BMX_ASSERT(read_num_samples > 0);
 
 
-    // read samples
+    // create frames for the enabled tracks
     bool have_read = false;
     size_t i;
+    mTrackFrames.assign(mTracks.size(), 0);
+    mTrackFrameData.assign(mTracks.size(), 0);
     for (i = 0; i < mTracks.size(); i++) {
         if (!mTracks[i]->IsEnabled())
             continue;
 
         Frame *frame = mTracks[i]->GetFrameBuffer()->CreateFrame();
         frame->Grow(read_num_samples * mTracks[i]->GetBlockAlign());
+        mTrackFrames[i] = frame;
+        mTrackFrameData[i] = frame->GetBytesAvailable();
+        have_read = true;
+    }
 
-        // read samples directly into the frame if there is only 1 track; else read into read buffer
-        if (!have_read) {
-            unsigned char *buffer;
-            if (mTracks.size() == 1) {
-                buffer = frame->GetBytesAvailable();
-            } else {
-                mReadBuffer.Allocate(read_num_samples * mBlockAlign);
-                buffer = mReadBuffer.GetBytes();
-            }
-
-            uint32_t bytes_read = mInput->Read(buffer, read_num_samples * mBlockAlign);
-            if (bytes_read < read_num_samples * mBlockAlign) {
-                log_error("Failed to read %u samples of %u\n",
-                          read_num_samples - bytes_read / mBlockAlign, read_num_samples);
-                read_num_samples = bytes_read / mBlockAlign;
-            }
-
-            if (mTracks.size() > 1)
-                mReadBuffer.SetSize(read_num_samples * mBlockAlign);
+    // read samples directly into the frame if there is only 1 track; else read into read buffer and
+    // deinterleave all channels into the frames in a single pass
+    if (have_read) {
+        unsigned char *buffer;
+        if (mTracks.size() == 1) {
+            buffer = mTrackFrameData[0];
+        } else {
+            mReadBuffer.Allocate(read_num_samples * mBlockAlign);
+            buffer = mReadBuffer.GetBytes();
+        }
 
-            have_read = true;
+        uint32_t bytes_read = mInput->Read(buffer, read_num_samples * mBlockAlign);
+        if (bytes_read < read_num_samples * mBlockAlign) {
+            log_error("Failed to read %u samples of %u\n",
+                      read_num_samples - bytes_read / mBlockAlign, read_num_samples);
+            read_num_samples = bytes_read / mBlockAlign;
         }
 
         if (mTracks.size() > 1) {
-            deinterleave_audio(mReadBuffer.GetBytes(), mReadBuffer.GetSize(),
-                               mQuantizationBits, mChannelCount, (uint16_t)i,
-                               frame->GetBytesAvailable(), frame->GetSizeAvailable());
+            mReadBuffer.SetSize(read_num_samples * mBlockAlign);
+            deinterleave_audio_channels(mReadBuffer.GetBytes(), mReadBuffer.GetSize(),
+                                        mQuantizationBits, mChannelCount, &mTrackFrameData[0],
+                                        read_num_samples * mChannelBlockAlign);
         }
+    }
+
+    for (i = 0; i < mTracks.size(); i++) {
+        Frame *frame = mTrackFrames[i];
+        if (!frame)
+            continue;
 
         frame->SetSize(read_num_samples * mTracks[i]->GetBlockAlign());
 
@@ -78,6 +78,11 @@ void WaveTrackWriter::WriteSamples(const unsigned char *data, uint32_t size, uin
     mWriter->WriteSamples(mTrackIndex, data, size, num_samples);
 }
 
+void WaveTrackWriter::WriteSample(const CDataBuffer *data_array, uint32_t array_size)
+{
+    mWriter->WriteSample(mTrackIndex, data_array, array_size);
+}
+
 uint32_t WaveTrackWriter::GetSampleSize() const
 {
     return mWriter->mChannelBlockAlign * mChannelCount;
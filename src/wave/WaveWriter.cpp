@@ -274,6 +274,29 @@ void WaveWriter::WriteSamples(uint32_t track_index, const unsigned char *data, u
     }
 }
 
+void WaveWriter::WriteSample(uint32_t track_index, const CDataBuffer *data_array, uint32_t array_size)
+{
+    uint32_t size = dba_get_total_size(data_array, array_size);
+    if (size == 0)
+        return;
+
+    WaveTrackWriter *track = GetTrack(track_index);
+    uint16_t track_block_align = track->mChannelCount * mChannelBlockAlign;
+    BMX_CHECK(size >= track_block_align);
+
+    if (mTracks.size() == 1 && size == track_block_align) {
+        // no buffering required
+        uint32_t i;
+        for (i = 0; i < array_size; i++)
+            mOutput->Write(data_array[i].data, data_array[i].size);
+        track->mSampleCount++;
+        mSampleCount++;
+    } else {
+        const unsigned char *data = dba_gather_data(&mSampleArrayBuffer, data_array, array_size, &size);
+        WriteSamples(track_index, data, size, 1);
+    }
+}
+
 void WaveWriter::CompleteWrite()
 {
     // write remaining buffered samples
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# check that mxf2raw --gf-follow continues reading as soon as a truncated file is completed,
+# rather than after the retry delay, and that the result matches reading the complete file
+
+appsdir=../../apps
+testdir=..
+tmpdir=/tmp/gf_follow_temp$$
+
+testpcm="$tmpdir/pcm.raw"
+testm2v="$tmpdir/test_in.raw"
+testmxf="$tmpdir/gftest.mxf"
+growmxf="$tmpdir/gfgrow.mxf"
+
+# a length part way through a content package
+grow_start=2980790
+
+
+create_test_file()
+{
+    $testdir/create_test_essence -t 1 -d 24 $testpcm
+    $testdir/create_test_essence -t 14 -d 24 $testm2v
+    $appsdir/raw2bmx/raw2bmx --regtest -t op1a -o $testmxf --single-pass --part 10 --mpeg2lg_422p_hl_1080i $testm2v -q 16 --pcm $testpcm >/dev/null
+}
+
+run_test()
+{
+    head -c $grow_start $testmxf > $growmxf || return 1
+    (sleep 1; tail -c +$(($grow_start + 1)) $testmxf >> $growmxf) &
+
+    start=$(date +%s)
+    $appsdir/mxf2raw/mxf2raw --regtest --gf-follow --gf-delay 20 --gf-retries 1 --track-chksum md5 $growmxf \
+        > $tmpdir/follow.txt 2>/dev/null
+    res=$?
+    end=$(date +%s)
+    wait
+
+    test $res -eq 0 &&
+        test $(($end - $start)) -lt 10 &&
+        $appsdir/mxf2raw/mxf2raw --regtest --track-chksum md5 $growmxf > $tmpdir/complete.txt 2>/dev/null &&
+        cmp -s $tmpdir/follow.txt $tmpdir/complete.txt
+}
+
+
+mkdir -p $tmpdir
+
+create_test_file &&
+    run_test
+res=$?
+
+rm -Rf $tmpdir
+
+exit $res
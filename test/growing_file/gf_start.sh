@@ -0,0 +1,55 @@
+#!/bin/sh
+
+# check that mxf2raw --start on a growing file uses the partitions and index table segments written after
+# the file was opened and that the result matches reading from the same position in the complete file
+
+appsdir=../../apps
+testdir=..
+tmpdir=/tmp/gf_start_temp$$
+
+testpcm="$tmpdir/pcm.raw"
+testm2v="$tmpdir/test_in.raw"
+testmxf="$tmpdir/gftest.mxf"
+growmxf="$tmpdir/gfgrow.mxf"
+
+# a start frame beyond the part of the file that is available when it is opened
+start=15
+
+
+create_test_file()
+{
+    $testdir/create_test_essence -t 1 -d 24 $testpcm
+    $testdir/create_test_essence -t 14 -d 24 $testm2v
+    $appsdir/raw2bmx/raw2bmx --regtest -t op1a -o $testmxf --single-pass --part 10 --mpeg2lg_422p_hl_1080i $testm2v -q 16 --pcm $testpcm >/dev/null
+}
+
+run_test()
+{
+    # the file is opened with only the header partition and the first content packages available
+    grow_start=$(($(wc -c < $testmxf) / 4))
+    head -c $grow_start $testmxf > $growmxf || return 1
+    (sleep 1; tail -c +$(($grow_start + 1)) $testmxf >> $growmxf) &
+
+    $appsdir/mxf2raw/mxf2raw --regtest --gf-follow --gf-delay 20 --gf-retries 1 --start $start --track-chksum md5 \
+        $growmxf > $tmpdir/grow.txt 2>/dev/null
+    res=$?
+    wait
+
+    test $res -eq 0 &&
+        $appsdir/mxf2raw/mxf2raw --regtest --start $start --nopc --noro --track-chksum md5 $testmxf \
+            > $tmpdir/complete.txt 2>/dev/null &&
+        grep -i checksum $tmpdir/grow.txt > $tmpdir/grow_chksum.txt &&
+        grep -i checksum $tmpdir/complete.txt > $tmpdir/complete_chksum.txt &&
+        cmp -s $tmpdir/grow_chksum.txt $tmpdir/complete_chksum.txt
+}
+
+
+mkdir -p $tmpdir
+
+create_test_file &&
+    run_test
+res=$?
+
+rm -Rf $tmpdir
+
+exit $res
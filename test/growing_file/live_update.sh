@@ -0,0 +1,87 @@
+#!/bin/sh
+
+# check that an OP-1A file written by bmxtranswrap with --live-update from a growing input can be read
+# whilst it is being written and that the completed file matches the input
+
+appsdir=../../apps
+testdir=..
+tmpdir=/tmp/live_update_temp$$
+
+testpcm="$tmpdir/pcm.raw"
+testm2v="$tmpdir/test_in.raw"
+testmxf="$tmpdir/gftest.mxf"
+growmxf="$tmpdir/gfgrow.mxf"
+livemxf="$tmpdir/live.mxf"
+snapmxf="$tmpdir/snapshot.mxf"
+
+
+create_test_file()
+{
+    $testdir/create_test_essence -t 1 -d 24 $testpcm
+    $testdir/create_test_essence -t 14 -d 24 $testm2v
+    $appsdir/raw2bmx/raw2bmx --regtest -t op1a -o $testmxf --single-pass --part 10 --mpeg2lg_422p_hl_1080i $testm2v -q 16 --pcm $testpcm >/dev/null
+}
+
+check_invalid_interval()
+{
+    # a non-positive interval is rejected rather than ignored
+    ! $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a --live-update -5 -o $livemxf $testmxf >/dev/null 2>&1 &&
+        ! $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a --live-update 0 -o $livemxf $testmxf >/dev/null 2>&1
+}
+
+wait_for_live_update()
+{
+    # poll until the output contains a header or body partition update with a non-zero duration
+    count=0
+    while test $count -lt 50; do
+        if test -s $livemxf; then
+            cp $livemxf $snapmxf &&
+                $appsdir/mxf2raw/mxf2raw --regtest --info $snapmxf 2>/dev/null | grep -q "^  duration .*count='[1-9]" &&
+                return 0
+        fi
+        if ! kill -0 $1 2>/dev/null; then
+            return 1
+        fi
+        sleep 1
+        count=$(($count + 1))
+    done
+    return 1
+}
+
+run_test()
+{
+    grow_start=$(($(wc -c < $testmxf) / 2))
+    head -c $grow_start $testmxf > $growmxf || return 1
+
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest --gf-follow --gf-delay 60 --gf-retries 1 -t op1a --live-update 6 \
+        -o $livemxf $growmxf >/dev/null 2>&1 &
+    pid=$!
+
+    # the output is readable whilst bmxtranswrap waits for the input to grow
+    wait_for_live_update $pid
+    snap_res=$?
+
+    # complete the input only once the snapshot has been taken
+    tail -c +$(($grow_start + 1)) $testmxf >> $growmxf
+    wait $pid
+    res=$?
+
+    test $snap_res -eq 0 &&
+        test $res -eq 0 &&
+        $appsdir/mxf2raw/mxf2raw --regtest --info --track-chksum md5 --check-complete $livemxf 2>/dev/null |
+            grep -i checksum > $tmpdir/live_chksum.txt &&
+        $appsdir/mxf2raw/mxf2raw --regtest --info --track-chksum md5 $testmxf 2>/dev/null |
+            grep -i checksum > $tmpdir/input_chksum.txt &&
+        cmp -s $tmpdir/live_chksum.txt $tmpdir/input_chksum.txt
+}
+
+mkdir -p $tmpdir
+
+create_test_file &&
+    check_invalid_interval &&
+    run_test
+res=$?
+
+rm -Rf $tmpdir
+
+exit $res
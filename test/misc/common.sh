@@ -0,0 +1,126 @@
+#!/bin/sh
+
+# common functions for the tests in this directory
+# a test that checks that an option produces the same output as the default sets read_option (mxf2raw) and
+# write_option (bmxtranswrap) before sourcing this file. essence_duration can be set to change the default 24
+
+md5tool=../file_md5
+
+testdir=..
+appsdir=../../apps
+tmpdir=/tmp/$(basename $0 .sh)_temp$$
+
+essence_duration=${essence_duration:-24}
+
+
+# create_essence <name>...
+create_essence()
+{
+    for name in $@; do
+        case $name in
+            pcm)        type=1 ;;
+            dv100)      type=5 ;;
+            avci)       type=7 ;;
+            d10)        type=11 ;;
+            mpeg2lg)    type=14 ;;
+            anc)        type=43 ;;
+            *)          return 1 ;;
+        esac
+        $testdir/create_test_essence -t $type -d $essence_duration $tmpdir/$name.raw || return 1
+    done
+}
+
+# OP-1A with a video and 2 PCM tracks
+# create_op1a <name> <body partition interval, 0 for none> <raw2bmx essence option> <essence name> [<raw2bmx options>]
+create_op1a()
+{
+    if test $2 -gt 0; then
+        part="--part $2"
+    else
+        part=
+    fi
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t op1a \
+        -o $tmpdir/$1.mxf \
+        $part \
+        $5 \
+        --$3 $tmpdir/$4.raw \
+        -q 24 --locked true --pcm $tmpdir/pcm.raw \
+        -q 24 --locked true --pcm $tmpdir/pcm.raw \
+        >/dev/null
+}
+
+# clip wrapped OP-1A with a PCM track
+create_clip()
+{
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t op1a \
+        -o $tmpdir/clip.mxf \
+        --clip-wrap \
+        -q 24 --locked true --pcm $tmpdir/pcm.raw \
+        >/dev/null
+}
+
+# D10 with system items and AES-3 audio
+create_d10()
+{
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t d10 \
+        -o $tmpdir/d10.mxf \
+        -y 10:11:12:13 \
+        --d10_50 $tmpdir/d10.raw \
+        -q 16 --locked true --pcm $tmpdir/pcm.raw \
+        -q 16 --locked true --pcm $tmpdir/pcm.raw \
+        >/dev/null
+}
+
+# read_file <mxf2raw options and filename>
+read_file()
+{
+    $appsdir/mxf2raw/mxf2raw --regtest --info --track-chksum md5 $1 | sed "s:$tmpdir:/tmp:g"
+}
+
+# compare_files <filename> <filename>
+compare_files()
+{
+    $md5tool < $1 > $1.md5 &&
+        $md5tool < $2 > $2.md5 &&
+        diff $1.md5 $2.md5 >/dev/null
+}
+
+# compares reading with and without read_option
+# check_read <name> [<mxf2raw options>]
+check_read()
+{
+    read_file "$2 $tmpdir/$1.mxf" > $tmpdir/$1_default.txt &&
+        read_file "$read_option $2 $tmpdir/$1.mxf" > $tmpdir/$1_option.txt &&
+        diff $tmpdir/$1_default.txt $tmpdir/$1_option.txt >/dev/null
+}
+
+# compares transwrapping with and without write_option
+# check_write <name> [<output type> [<bmxtranswrap options>]]
+check_write()
+{
+    type=${2:-op1a}
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t $type $3 -o $tmpdir/default.mxf $tmpdir/$1.mxf >/dev/null &&
+        $appsdir/bmxtranswrap/bmxtranswrap --regtest -t $type $3 $write_option -o $tmpdir/option.mxf $tmpdir/$1.mxf \
+            >/dev/null &&
+        compare_files $tmpdir/default.mxf $tmpdir/option.mxf
+}
+
+
+# run_test <function>
+run_test()
+{
+    mkdir -p $tmpdir
+
+    $1
+    res=$?
+
+    rm -Rf $tmpdir
+
+    exit $res
+}
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+# a minimal HTTP server supporting byte range requests, used to test HTTP file access
+# usage: http_range_server.py <root dir> <port file>
+# the server listens on a free localhost port and writes the port number to <port file>
+
+import http.server
+import os
+import re
+import socket
+import socketserver
+import sys
+
+
+root_dir = sys.argv[1]
+port_filename = sys.argv[2]
+
+
+class RangeRequestHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, format, *args):
+        pass
+
+    def send_file(self, send_body):
+        path = os.path.join(root_dir, os.path.basename(self.path))
+        if not os.path.isfile(path):
+            self.send_response(404)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
+
+        size = os.path.getsize(path)
+        match = re.match(r'bytes=(\d+)-(\d*)', self.headers.get('Range', ''))
+        if match:
+            first = int(match.group(1))
+            last = int(match.group(2)) if match.group(2) else size - 1
+            if first >= size:
+                self.send_response(416)
+                self.send_header('Content-Range', 'bytes */%d' % size)
+                self.send_header('Content-Length', '0')
+                self.end_headers()
+                return
+            last = min(last, size - 1)
+            self.send_response(206)
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (first, last, size))
+        else:
+            first = 0
+            last = size - 1
+            self.send_response(200)
+        self.send_header('Accept-Ranges', 'bytes')
+        self.send_header('Content-Length', str(last - first + 1))
+        self.end_headers()
+
+        if send_body:
+            with open(path, 'rb') as f:
+                f.seek(first)
+                self.wfile.write(f.read(last - first + 1))
+
+    def do_GET(self):
+        self.send_file(True)
+
+    def do_HEAD(self):
+        self.send_file(False)
+
+
+class RangeServer(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+
+    def get_request(self):
+        conn, addr = self.socket.accept()
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        return conn, addr
+
+
+server = RangeServer(('127.0.0.1', 0), RangeRequestHandler)
+with open(port_filename, 'w') as port_file:
+    port_file.write('%d\n' % server.server_address[1])
+server.serve_forever()
@@ -0,0 +1,82 @@
+#!/bin/sh
+
+# check that jobs run in batch mode on multiple threads produce the same results as separate
+# invocations, that failed jobs are reported in the summary and that job options that change process-wide
+# state or write to stdout are rejected
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+read_checksums()
+{
+    $appsdir/mxf2raw/mxf2raw --regtest --info --track-chksum md5 $1 | grep "md5"
+}
+
+check_mxf2raw_batch()
+{
+    for name in op1a d10; do
+        $appsdir/mxf2raw/mxf2raw --regtest --info --track-chksum md5 $tmpdir/$name.mxf > $tmpdir/$name.txt || return 1
+        echo "--info --info-file $tmpdir/${name}_batch.txt --track-chksum md5 $tmpdir/$name.mxf" >> $tmpdir/mxf2raw_jobs.txt
+    done
+    echo "# jobs that fail" >> $tmpdir/mxf2raw_jobs.txt
+    echo "--info --info-file $tmpdir/missing.txt $tmpdir/missing.mxf" >> $tmpdir/mxf2raw_jobs.txt
+    echo "--info --track-chksum md5 $tmpdir/op1a.mxf" >> $tmpdir/mxf2raw_jobs.txt
+    echo "--regtest --info --info-file $tmpdir/regtest.txt $tmpdir/op1a.mxf" >> $tmpdir/mxf2raw_jobs.txt
+    echo "--stats --info --info-file $tmpdir/stats.txt $tmpdir/op1a.mxf" >> $tmpdir/mxf2raw_jobs.txt
+
+    $appsdir/mxf2raw/mxf2raw --batch $tmpdir/mxf2raw_jobs.txt --threads 3 --regtest --summary-format xml \
+        --summary $tmpdir/mxf2raw_summary.xml > $tmpdir/mxf2raw_stdout.txt 2>/dev/null
+    test $? -eq 1 &&
+        grep -q "<failed_count>4</failed_count>" $tmpdir/mxf2raw_summary.xml &&
+        ! grep -q "md5" $tmpdir/mxf2raw_stdout.txt &&
+        diff $tmpdir/op1a.txt $tmpdir/op1a_batch.txt >/dev/null &&
+        diff $tmpdir/d10.txt $tmpdir/d10_batch.txt >/dev/null
+}
+
+check_bmxtranswrap_batch()
+{
+    for name in op1a d10; do
+        $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a -o $tmpdir/${name}_single.mxf $tmpdir/$name.mxf >/dev/null || return 1
+        echo "-t op1a -o \"$tmpdir/${name}_batch.mxf\" '$tmpdir/$name.mxf'" >> $tmpdir/transwrap_jobs.txt
+    done
+
+    $appsdir/bmxtranswrap/bmxtranswrap --batch $tmpdir/transwrap_jobs.txt --threads 2 --regtest \
+        --summary $tmpdir/transwrap_summary.txt >/dev/null &&
+        grep -q "failed_count *: 0$" $tmpdir/transwrap_summary.txt &&
+        read_checksums $tmpdir/op1a_single.mxf > $tmpdir/op1a_single.md5 &&
+        read_checksums $tmpdir/op1a_batch.mxf > $tmpdir/op1a_batch.md5 &&
+        read_checksums $tmpdir/d10_single.mxf > $tmpdir/d10_single.md5 &&
+        read_checksums $tmpdir/d10_batch.mxf > $tmpdir/d10_batch.md5 &&
+        diff $tmpdir/op1a_single.md5 $tmpdir/op1a_batch.md5 >/dev/null &&
+        diff $tmpdir/d10_single.md5 $tmpdir/d10_batch.md5 >/dev/null &&
+        cmp -s $tmpdir/op1a_single.mxf $tmpdir/op1a_batch.mxf &&
+        check_bmxtranswrap_rejected
+}
+
+check_bmxtranswrap_rejected()
+{
+    echo "--regtest -t op1a -o $tmpdir/regtest.mxf $tmpdir/op1a.mxf" > $tmpdir/rejected_jobs.txt
+    echo "--stats -t op1a -o $tmpdir/stats.mxf $tmpdir/op1a.mxf" >> $tmpdir/rejected_jobs.txt
+    echo "-p -t op1a -o $tmpdir/progress.mxf $tmpdir/op1a.mxf" >> $tmpdir/rejected_jobs.txt
+
+    $appsdir/bmxtranswrap/bmxtranswrap --batch $tmpdir/rejected_jobs.txt --threads 2 \
+        --summary $tmpdir/rejected_summary.txt >/dev/null 2>&1
+    test $? -eq 1 &&
+        grep -q "failed_count *: 3$" $tmpdir/rejected_summary.txt &&
+        test ! -e $tmpdir/regtest.mxf &&
+        test ! -e $tmpdir/stats.mxf &&
+        test ! -e $tmpdir/progress.mxf
+}
+
+run_checks()
+{
+    create_essence pcm avci d10 &&
+        create_op1a op1a 0 avci100_1080i avci &&
+        create_d10 &&
+        check_mxf2raw_batch &&
+        check_bmxtranswrap_batch
+}
+
+
+run_test run_checks
@@ -0,0 +1,23 @@
+#!/bin/sh
+
+# check that coalesced content package reads produce the same output as KL by KL reads
+
+base=$(dirname $0)
+read_option="--cp-read 4"
+write_option="--cp-read 16"
+. $base/common.sh
+
+
+run_checks()
+{
+    create_essence pcm avci d10 &&
+        create_op1a op1a 10 avci100_1080i avci &&
+        create_d10 &&
+        check_read op1a &&
+        check_read op1a "--start 3 --dur 13" &&
+        check_read d10 &&
+        check_write op1a
+}
+
+
+run_test run_checks
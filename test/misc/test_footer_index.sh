@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# check that a file with the complete index table repeated in the footer partition, which is loaded without
+# reading the body partition index table segments, reads the same essence data as a file without the repeat
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+read_checksums()
+{
+    read_file "--check-end --check-complete $1" | grep "checksum"
+}
+
+check_repeat_index()
+{
+    create_op1a $1 6 $2 $3 &&
+        create_op1a $1_repeat 6 $2 $3 "--repeat-index" &&
+        read_checksums "$tmpdir/$1.mxf" > $tmpdir/$1.txt &&
+        read_checksums "$tmpdir/$1_repeat.mxf" > $tmpdir/$1_repeat.txt &&
+        test -s $tmpdir/$1.txt &&
+        diff $tmpdir/$1.txt $tmpdir/$1_repeat.txt >/dev/null &&
+        read_checksums "--start 5 --dur 13 $tmpdir/$1.mxf" > $tmpdir/$1_range.txt &&
+        read_checksums "--start 5 --dur 13 $tmpdir/$1_repeat.mxf" > $tmpdir/$1_repeat_range.txt &&
+        diff $tmpdir/$1_range.txt $tmpdir/$1_repeat_range.txt >/dev/null
+}
+
+run_checks()
+{
+    create_essence pcm mpeg2lg avci &&
+        check_repeat_index vbe mpeg2lg_422p_hl_1080i mpeg2lg &&
+        check_repeat_index cbe avci100_1080i avci
+}
+
+
+run_test run_checks
@@ -0,0 +1,55 @@
+#!/bin/sh
+
+# check that reading over HTTP produces the same output as reading the local file
+# the test is skipped if HTTP file access or python3 is not available
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+start_server()
+{
+    python3 $base/http_range_server.py $tmpdir $tmpdir/port.txt &
+    server_pid=$!
+    count=0
+    while test ! -s $tmpdir/port.txt && test $count -lt 50; do
+        sleep 0.1
+        count=$((count + 1))
+    done
+    test -s $tmpdir/port.txt && url=http://127.0.0.1:`cat $tmpdir/port.txt`
+}
+
+read_http_file()
+{
+    $appsdir/mxf2raw/mxf2raw --regtest --info --track-chksum md5 --file-chksum md5 $1 | sed "s:$tmpdir/::g;s:$url/::g"
+}
+
+check_http_read()
+{
+    read_http_file "$2 $tmpdir/$1.mxf" > $tmpdir/$1_local.txt &&
+        read_http_file "$2 $url/$1.mxf" > $tmpdir/$1_http.txt &&
+        diff $tmpdir/$1_local.txt $tmpdir/$1_http.txt >/dev/null
+}
+
+run_checks()
+{
+    server_pid=
+    create_essence pcm avci &&
+        create_op1a op1a 10 avci100_1080i avci &&
+        start_server &&
+        check_http_read op1a &&
+        check_http_read op1a "--http-min-read 4096" &&
+        check_http_read op1a "--http-min-read 4096 --start 3 --dur 13"
+    res=$?
+
+    test -n "$server_pid" && kill $server_pid
+    return $res
+}
+
+
+if ! which python3 >/dev/null 2>&1 || ! $appsdir/mxf2raw/mxf2raw -h 2>&1 | grep -q -- "--http-min-read"; then
+    # HTTP file access is not supported in this build or the test server can't be run
+    exit 77
+fi
+
+run_test run_checks
@@ -0,0 +1,66 @@
+#!/bin/sh
+
+# check that reading with the sidecar index cache, both when the cache is created and when it is
+# used to re-open the file, produces the same output as reading without the cache
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+check_cache()
+{
+    read_file "$tmpdir/$1.mxf" > $tmpdir/$1_nocache.txt &&
+        read_file "--index-cache $tmpdir/$1.mxf" > $tmpdir/$1_create.txt &&
+        test -s $tmpdir/$1.mxf.bmxidx &&
+        ! ls $tmpdir/$1.mxf.bmxidx.tmp* >/dev/null 2>&1 &&
+        read_file "--index-cache $tmpdir/$1.mxf" > $tmpdir/$1_cache.txt &&
+        diff $tmpdir/$1_nocache.txt $tmpdir/$1_create.txt >/dev/null &&
+        diff $tmpdir/$1_nocache.txt $tmpdir/$1_cache.txt >/dev/null
+}
+
+check_cache_dir()
+{
+    mkdir -p $tmpdir/cache &&
+        read_file "--index-cache-dir $tmpdir/cache --start 3 --dur 13 $tmpdir/op1a.mxf" > $tmpdir/dir_create.txt &&
+        test -s $tmpdir/cache/op1a.mxf.bmxidx &&
+        read_file "--index-cache-dir $tmpdir/cache --start 3 --dur 13 $tmpdir/op1a.mxf" > $tmpdir/dir_cache.txt &&
+        read_file "--start 3 --dur 13 $tmpdir/op1a.mxf" > $tmpdir/dir_nocache.txt &&
+        diff $tmpdir/dir_nocache.txt $tmpdir/dir_create.txt >/dev/null &&
+        diff $tmpdir/dir_nocache.txt $tmpdir/dir_cache.txt >/dev/null
+}
+
+check_stale_cache()
+{
+    # a cache for a different file with the same name must be ignored
+    cp $tmpdir/clip.mxf.bmxidx $tmpdir/op1a.mxf.bmxidx &&
+        read_file "--index-cache $tmpdir/op1a.mxf" > $tmpdir/stale.txt &&
+        diff $tmpdir/op1a_nocache.txt $tmpdir/stale.txt >/dev/null
+}
+
+check_corrupt_cache()
+{
+    # a header with a data size that doesn't match the cache file size must be ignored
+    printf 'BMXI\000\000\000\002' > $tmpdir/op1a.mxf.bmxidx &&
+        printf '\000\000\000\000\000\000\000\000\000\000\000\000' >> $tmpdir/op1a.mxf.bmxidx &&
+        printf '\000\000\000\000\000\000\000\000\000\000\000\000' >> $tmpdir/op1a.mxf.bmxidx &&
+        printf '\377\377\377\360\000\000\000\000' >> $tmpdir/op1a.mxf.bmxidx &&
+        read_file "--index-cache $tmpdir/op1a.mxf" > $tmpdir/corrupt.txt &&
+        diff $tmpdir/op1a_nocache.txt $tmpdir/corrupt.txt >/dev/null
+}
+
+run_checks()
+{
+    create_essence pcm avci d10 &&
+        create_op1a op1a 10 avci100_1080i avci &&
+        create_clip &&
+        create_d10 &&
+        check_cache op1a &&
+        check_cache clip &&
+        check_cache d10 &&
+        check_cache_dir &&
+        check_stale_cache &&
+        check_corrupt_cache
+}
+
+
+run_test run_checks
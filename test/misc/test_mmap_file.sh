@@ -0,0 +1,27 @@
+#!/bin/sh
+
+# check that memory-mapped file I/O produces the same output as the default file I/O
+
+base=$(dirname $0)
+read_option="--mmap-file"
+write_option="--mmap-file"
+. $base/common.sh
+
+
+run_checks()
+{
+    create_essence pcm avci &&
+        create_op1a op1a 10 avci100_1080i avci &&
+        create_clip &&
+        check_read op1a &&
+        check_read clip &&
+        check_write op1a
+}
+
+
+if ! $appsdir/mxf2raw/mxf2raw -h 2>&1 | grep -q -- "--mmap-file" ; then
+    # memory-mapped file I/O is not supported in this build
+    exit 77
+fi
+
+run_test run_checks
@@ -0,0 +1,60 @@
+#!/bin/sh
+
+# check that writing the Avid and AS-02 essence files in parallel with --parallel-write
+# produces the same files as writing them in the calling thread
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+create_avid()
+{
+    mkdir -p $tmpdir/avid_$1 &&
+        $appsdir/raw2bmx/raw2bmx \
+            --regtest \
+            -t avid \
+            -o $tmpdir/avid_$1/test \
+            $2 \
+            --dv100_1080i $tmpdir/dv100.raw \
+            -q 16 --locked true --pcm $tmpdir/pcm.raw \
+            -q 16 --locked true --pcm $tmpdir/pcm.raw \
+            >/dev/null
+}
+
+create_as02()
+{
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t as02 \
+        -o $tmpdir/as02_$1 \
+        --mic-file \
+        $2 \
+        --dv100_1080i $tmpdir/dv100.raw \
+        -q 16 --locked true --pcm $tmpdir/pcm.raw \
+        -q 16 --locked true --pcm $tmpdir/pcm.raw \
+        >/dev/null
+}
+
+check_avid()
+{
+    create_avid serial "" &&
+        create_avid parallel "--parallel-write" &&
+        diff -r $tmpdir/avid_serial $tmpdir/avid_parallel >/dev/null
+}
+
+check_as02()
+{
+    create_as02 serial "" &&
+        create_as02 parallel "--parallel-write" &&
+        diff -r $tmpdir/as02_serial $tmpdir/as02_parallel >/dev/null
+}
+
+run_checks()
+{
+    create_essence pcm dv100 &&
+        check_avid &&
+        check_as02
+}
+
+
+run_test run_checks
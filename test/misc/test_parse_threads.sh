@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# check that locating the MPEG-2 Long GOP frame boundaries in multiple threads produces the same
+# file as parsing in a single thread
+
+base=$(dirname $0)
+essence_duration=150
+. $base/common.sh
+
+
+create_file()
+{
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t op1a \
+        -o $tmpdir/$1.mxf \
+        $2 \
+        --mpeg2lg_422p_hl_1080i $tmpdir/mpeg2lg.raw \
+        >/dev/null
+}
+
+run_checks()
+{
+    create_essence mpeg2lg &&
+        create_file single "" &&
+        create_file multi "--parse-threads 4" &&
+        create_file multi3 "--parse-threads 3" &&
+        cmp -s $tmpdir/single.mxf $tmpdir/multi.mxf &&
+        cmp -s $tmpdir/single.mxf $tmpdir/multi3.mxf
+}
+
+
+run_test run_checks
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# check that pipelined transwrapping produces the same output as serial transwrapping and that
+# a write failure stops the pipeline cleanly
+
+base=$(dirname $0)
+write_option="--pipeline 4"
+. $base/common.sh
+
+
+# OP-1A with a multi-channel audio track
+create_op1a_mc()
+{
+    $appsdir/bmxtranswrap/bmxtranswrap \
+        --regtest \
+        -t op1a \
+        -o $tmpdir/op1a_mc.mxf \
+        --track-map "0,1" \
+        $tmpdir/op1a.mxf \
+        >/dev/null
+}
+
+check_write_failure()
+{
+    if [ ! -w /dev/full ]; then
+        return 0
+    fi
+
+    # the write fails whilst the read and convert threads are running. Expect an error exit and not a crash
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a $write_option -o /dev/full $tmpdir/op1a.mxf \
+        >/dev/null 2>&1
+    res=$?
+    test $res -ne 0 && test $res -lt 128
+}
+
+run_checks()
+{
+    create_essence pcm avci d10 &&
+        create_op1a op1a 0 avci100_1080i avci &&
+        create_d10 &&
+        create_op1a_mc &&
+        check_write op1a op1a &&
+        check_write op1a_mc op1a &&
+        check_write op1a_mc op1a "--track-map mono" &&
+        check_write d10 op1a &&
+        check_write d10 d10 &&
+        check_write op1a op1a "--rw-intl" &&
+        check_write op1a op1a "--rt 100" &&
+        check_write_failure
+}
+
+
+run_test run_checks
@@ -0,0 +1,26 @@
+#!/bin/sh
+
+# check that reading with a prefetch thread produces the same output as synchronous reads
+
+base=$(dirname $0)
+read_option="--prefetch 8"
+write_option="--prefetch 4 --prefetch-mem 1"
+. $base/common.sh
+
+
+run_checks()
+{
+    create_essence pcm avci d10 &&
+        create_op1a op1a 10 avci100_1080i avci &&
+        create_clip &&
+        create_d10 &&
+        check_read op1a &&
+        check_read op1a "--start 3 --dur 13" &&
+        check_read op1a "--cp-read 4" &&
+        check_read clip &&
+        check_read d10 &&
+        check_write op1a
+}
+
+
+run_test run_checks
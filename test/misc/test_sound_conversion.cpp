@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017, British Broadcasting Corporation
+ * All Rights Reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the British Broadcasting Corporation nor the names
+ *       of its contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// checks the sound conversion kernels against reference byte copy loops for all sample sizes, channel counts
+// up to 17 and sample counts that leave partial SIMD blocks
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <bmx/essence_parser/SoundConversion.h>
+#include <bmx/BMXException.h>
+
+using namespace std;
+using namespace bmx;
+
+
+static const uint32_t SAMPLE_COUNTS[] = {0, 1, 7, 8, 9, 15, 16, 17, 31, 33, 63, 64, 65, 129, 1602, 1920};
+static const uint32_t BITS_PER_SAMPLE[] = {8, 16, 20, 24, 32, 40};
+static const uint32_t AES3_BITS_PER_SAMPLE[] = {16, 20, 24};
+
+#define ARRAY_SIZE(a)   (sizeof(a) / sizeof((a)[0]))
+
+
+
+static void fill_random(vector<unsigned char> *data)
+{
+    size_t i;
+    for (i = 0; i < data->size(); i++)
+        (*data)[i] = (unsigned char)(rand() >> 8);
+}
+
+static void create_aes3_data(uint32_t sample_count, vector<unsigned char> *aes3_data)
+{
+    aes3_data->resize(4 + sample_count * 8 * 4);
+    fill_random(aes3_data);
+    (*aes3_data)[1] = (unsigned char)(sample_count & 0xff);
+    (*aes3_data)[2] = (unsigned char)((sample_count >> 8) & 0xff);
+}
+
+static void ref_deinterleave(const unsigned char *input_data, uint32_t block_align, uint16_t channel_count,
+                             uint16_t channel_num, uint32_t sample_count, unsigned char *output_data)
+{
+    uint32_t i, j;
+    for (i = 0; i < sample_count; i++) {
+        for (j = 0; j < block_align; j++)
+            output_data[i * block_align + j] = input_data[(i * channel_count + channel_num) * block_align + j];
+    }
+}
+
+static void ref_interleave(const unsigned char *input_data, uint32_t block_align, uint16_t channel_count,
+                           uint16_t channel_num, uint32_t sample_count, unsigned char *output_data)
+{
+    uint32_t i, j;
+    for (i = 0; i < sample_count; i++) {
+        for (j = 0; j < block_align; j++)
+            output_data[(i * channel_count + channel_num) * block_align + j] = input_data[i * block_align + j];
+    }
+}
+
+static void ref_convert_aes3(const unsigned char *aes3_data, bool ignore_valid_flags, uint32_t block_align,
+                             uint8_t channel_num, uint32_t sample_count, uint32_t output_stride,
+                             unsigned char *pcm_data)
+{
+    bool valid = ignore_valid_flags || (aes3_data[3] & (1 << channel_num));
+    uint32_t i;
+    for (i = 0; i < sample_count; i++) {
+        const unsigned char *aes3_sample = &aes3_data[4 + i * 8 * 4 + channel_num * 4];
+        unsigned char *pcm_sample = &pcm_data[i * output_stride];
+        if (!valid) {
+            memset(pcm_sample, 0, block_align);
+        } else if (block_align == 2) {
+            pcm_sample[0] = (aes3_sample[1] >> 4) | (aes3_sample[2] << 4);
+            pcm_sample[1] = (aes3_sample[2] >> 4) | (aes3_sample[3] << 4);
+        } else {
+            pcm_sample[0] = (aes3_sample[0] >> 4) | (aes3_sample[1] << 4);
+            pcm_sample[1] = (aes3_sample[1] >> 4) | (aes3_sample[2] << 4);
+            pcm_sample[2] = (aes3_sample[2] >> 4) | (aes3_sample[3] << 4);
+        }
+    }
+}
+
+static bool check_result(const vector<unsigned char> &result, const vector<unsigned char> &expected,
+                         const char *function, uint32_t bits_per_sample, uint16_t channel_count, int channel_num,
+                         uint32_t sample_count)
+{
+    if (result == expected)
+        return true;
+
+    fprintf(stderr, "%s: mismatch for %u bits per sample, %u channels, channel %d, %u samples\n",
+            function, bits_per_sample, channel_count, channel_num, sample_count);
+    return false;
+}
+
+static bool test_deinterleave(uint32_t bits_per_sample, uint16_t channel_count, uint32_t sample_count)
+{
+    uint32_t block_align = (bits_per_sample + 7) / 8;
+    vector<unsigned char> input(sample_count * channel_count * block_align);
+    fill_random(&input);
+
+    bool result = true;
+    vector<vector<unsigned char> > channel_outputs(channel_count);
+    vector<vector<unsigned char> > expected_outputs(channel_count);
+    uint16_t c;
+    for (c = 0; c < channel_count; c++) {
+        vector<unsigned char> output(sample_count * block_align);
+        vector<unsigned char> expected(sample_count * block_align);
+        deinterleave_audio(input.empty() ? 0 : &input[0], (uint32_t)input.size(), bits_per_sample,
+                           channel_count, c, output.empty() ? 0 : &output[0], (uint32_t)output.size());
+        if (!expected.empty())
+            ref_deinterleave(&input[0], block_align, channel_count, c, sample_count, &expected[0]);
+        result = check_result(output, expected, "deinterleave_audio", bits_per_sample, channel_count, c,
+                              sample_count) && result;
+
+        // every third channel is skipped
+        channel_outputs[c].resize(sample_count * block_align + 1);
+        if (c % 3 != 2)
+            expected_outputs[c] = expected;
+        expected_outputs[c].resize(sample_count * block_align + 1);
+    }
+
+    vector<unsigned char*> output_ptrs(channel_count);
+    for (c = 0; c < channel_count; c++)
+        output_ptrs[c] = (c % 3 != 2 ? &channel_outputs[c][0] : 0);
+    deinterleave_audio_channels(input.empty() ? 0 : &input[0], (uint32_t)input.size(), bits_per_sample,
+                                channel_count, &output_ptrs[0], sample_count * block_align);
+    for (c = 0; c < channel_count; c++) {
+        result = check_result(channel_outputs[c], expected_outputs[c], "deinterleave_audio_channels",
+                              bits_per_sample, channel_count, c, sample_count) && result;
+    }
+
+    return result;
+}
+
+static bool test_interleave(uint32_t bits_per_sample, uint16_t channel_count, uint32_t sample_count)
+{
+    uint32_t block_align = (bits_per_sample + 7) / 8;
+    vector<unsigned char> output(sample_count * channel_count * block_align);
+    fill_random(&output);
+    vector<unsigned char> expected = output;
+
+    bool result = true;
+    uint16_t c;
+    for (c = 0; c < channel_count; c++) {
+        vector<unsigned char> input(sample_count * block_align);
+        fill_random(&input);
+        interleave_audio(input.empty() ? 0 : &input[0], (uint32_t)input.size(), bits_per_sample,
+                         channel_count, c, output.empty() ? 0 : &output[0], (uint32_t)output.size());
+        if (!input.empty())
+            ref_interleave(&input[0], block_align, channel_count, c, sample_count, &expected[0]);
+        result = check_result(output, expected, "interleave_audio", bits_per_sample, channel_count, c,
+                              sample_count) && result;
+    }
+
+    return result;
+}
+
+static bool test_aes3(uint32_t bits_per_sample, uint8_t channel_count, uint32_t sample_count, bool ignore_valid_flags)
+{
+    uint32_t block_align = (bits_per_sample + 7) / 8;
+    vector<unsigned char> aes3_data;
+    create_aes3_data(sample_count, &aes3_data);
+
+    bool result = true;
+    vector<unsigned char> mc_output(sample_count * channel_count * block_align + 1);
+    vector<unsigned char> mc_expected(sample_count * channel_count * block_align + 1);
+    vector<vector<unsigned char> > channel_outputs(channel_count);
+    vector<vector<unsigned char> > expected_outputs(channel_count);
+    vector<unsigned char*> output_ptrs(channel_count);
+    uint8_t c;
+    for (c = 0; c < channel_count; c++) {
+        vector<unsigned char> output(sample_count * block_align + 1);
+        vector<unsigned char> expected(sample_count * block_align + 1);
+        convert_aes3_to_pcm(&aes3_data[0], (uint32_t)aes3_data.size(), ignore_valid_flags, bits_per_sample, c,
+                            &output[0], (uint32_t)output.size());
+        ref_convert_aes3(&aes3_data[0], ignore_valid_flags, block_align, c, sample_count, block_align, &expected[0]);
+        result = check_result(output, expected, "convert_aes3_to_pcm", bits_per_sample, channel_count, c,
+                              sample_count) && result;
+
+        ref_convert_aes3(&aes3_data[0], ignore_valid_flags, block_align, c, sample_count,
+                         channel_count * block_align, &mc_expected[c * block_align]);
+
+        // every third channel is skipped
+        channel_outputs[c].resize(sample_count * block_align + 1);
+        output_ptrs[c] = (c % 3 != 2 ? &channel_outputs[c][0] : 0);
+        if (c % 3 != 2)
+            expected_outputs[c] = expected;
+        else
+            expected_outputs[c].resize(sample_count * block_align + 1);
+    }
+
+    convert_aes3_to_mc_pcm(&aes3_data[0], (uint32_t)aes3_data.size(), ignore_valid_flags, bits_per_sample,
+                           channel_count, &mc_output[0], (uint32_t)mc_output.size());
+    result = check_result(mc_output, mc_expected, "convert_aes3_to_mc_pcm", bits_per_sample, channel_count, -1,
+                          sample_count) && result;
+
+    convert_aes3_to_pcm_channels(&aes3_data[0], (uint32_t)aes3_data.size(), ignore_valid_flags, bits_per_sample,
+                                 channel_count, &output_ptrs[0], sample_count * block_align + 1);
+    for (c = 0; c < channel_count; c++) {
+        result = check_result(channel_outputs[c], expected_outputs[c], "convert_aes3_to_pcm_channels",
+                              bits_per_sample, channel_count, c, sample_count) && result;
+    }
+
+    return result;
+}
+
+
+
+int main()
+{
+    bool result = true;
+    size_t b, s;
+    uint16_t c;
+
+    srand(42);
+
+    try
+    {
+        for (b = 0; b < ARRAY_SIZE(BITS_PER_SAMPLE); b++) {
+            for (c = 1; c <= 17; c++) {
+                for (s = 0; s < ARRAY_SIZE(SAMPLE_COUNTS); s++) {
+                    result = test_deinterleave(BITS_PER_SAMPLE[b], c, SAMPLE_COUNTS[s]) && result;
+                    result = test_interleave(BITS_PER_SAMPLE[b], c, SAMPLE_COUNTS[s]) && result;
+                }
+            }
+        }
+
+        for (b = 0; b < ARRAY_SIZE(AES3_BITS_PER_SAMPLE); b++) {
+            for (c = 1; c <= 8; c++) {
+                for (s = 0; s < ARRAY_SIZE(SAMPLE_COUNTS); s++) {
+                    result = test_aes3(AES3_BITS_PER_SAMPLE[b], (uint8_t)c, SAMPLE_COUNTS[s], false) && result;
+                    result = test_aes3(AES3_BITS_PER_SAMPLE[b], (uint8_t)c, SAMPLE_COUNTS[s], true) && result;
+                }
+            }
+        }
+    }
+    catch (const BMXException &ex)
+    {
+        fprintf(stderr, "Exception: %s\n", ex.what());
+        return 1;
+    }
+
+    return (result ? 0 : 1);
+}
@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# check that the --stats counters are printed by the apps in text and XML format and that enabling
+# them does not change the output files
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+check_raw2bmx()
+{
+    create_op1a nostats 0 mpeg2lg_422p_hl_1080i mpeg2lg &&
+        create_op1a stats 0 mpeg2lg_422p_hl_1080i mpeg2lg "--stats-file $tmpdir/raw2bmx_stats.txt" &&
+        cmp -s $tmpdir/nostats.mxf $tmpdir/stats.mxf &&
+        grep -q "EssenceParse:" $tmpdir/raw2bmx_stats.txt &&
+        grep -q "ClipWrite:" $tmpdir/raw2bmx_stats.txt &&
+        grep -q "FileWrite:" $tmpdir/raw2bmx_stats.txt
+}
+
+check_bmxtranswrap()
+{
+    $appsdir/bmxtranswrap/bmxtranswrap \
+        --regtest \
+        -t op1a \
+        -o $tmpdir/transwrap.mxf \
+        --stats-format xml \
+        --stats-file $tmpdir/transwrap_stats.xml \
+        $tmpdir/nostats.mxf \
+        >/dev/null &&
+        grep -q "<mxf_read>" $tmpdir/transwrap_stats.xml &&
+        grep -q "<file_read>" $tmpdir/transwrap_stats.xml &&
+        grep -q "<clip_write>" $tmpdir/transwrap_stats.xml
+}
+
+check_mxf2raw()
+{
+    read_file "$tmpdir/nostats.mxf" > $tmpdir/info.txt &&
+        read_file "--stats $tmpdir/nostats.mxf" > $tmpdir/info_stats.txt 2>$tmpdir/mxf2raw_stats.txt &&
+        grep -q "EssenceRead:" $tmpdir/mxf2raw_stats.txt &&
+        grep -q "EssenceRead:" $tmpdir/info_stats.txt &&
+        ! grep -q "EssenceRead:" $tmpdir/info.txt
+}
+
+run_checks()
+{
+    create_essence pcm mpeg2lg &&
+        check_raw2bmx &&
+        check_bmxtranswrap &&
+        check_mxf2raw
+}
+
+
+run_test run_checks
@@ -0,0 +1,72 @@
+#!/bin/sh
+
+# check that mxf2raw and bmxtranswrap read frame wrapped OP-1A files with body partitions from stdin,
+# including skipping forwards to a --start position, and that the result matches reading the file.
+# A --start position is rejected for long GOP input from stdin because the precharge is unknown
+
+base=$(dirname $0)
+essence_duration=48
+. $base/common.sh
+
+start=25
+
+
+check_mxf2raw()
+{
+    $appsdir/mxf2raw/mxf2raw --regtest --track-chksum md5 - < $tmpdir/$1.mxf 2>/dev/null |
+        grep -i checksum > $tmpdir/stdin.txt &&
+        $appsdir/mxf2raw/mxf2raw --regtest --track-chksum md5 $tmpdir/$1.mxf 2>/dev/null |
+            grep -i checksum > $tmpdir/file.txt &&
+        cmp -s $tmpdir/stdin.txt $tmpdir/file.txt &&
+        $appsdir/mxf2raw/mxf2raw --regtest --start $start $2 --track-chksum md5 - < $tmpdir/$1.mxf 2>/dev/null |
+            grep -i checksum > $tmpdir/stdin_start.txt &&
+        $appsdir/mxf2raw/mxf2raw --regtest --start $start --nopc --noro --track-chksum md5 $tmpdir/$1.mxf \
+            2>/dev/null | grep -i checksum > $tmpdir/file_start.txt &&
+        cmp -s $tmpdir/stdin_start.txt $tmpdir/file_start.txt
+}
+
+check_bmxtranswrap()
+{
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a --start $start -o $tmpdir/stdin.mxf - \
+        < $tmpdir/avci.mxf >/dev/null 2>&1 &&
+        $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a --start $start -o $tmpdir/file.mxf $tmpdir/avci.mxf \
+            >/dev/null 2>&1 &&
+        $appsdir/mxf2raw/mxf2raw --regtest --track-chksum md5 $tmpdir/stdin.mxf 2>/dev/null |
+            grep -i checksum > $tmpdir/transwrap_stdin.txt &&
+        $appsdir/mxf2raw/mxf2raw --regtest --track-chksum md5 $tmpdir/file.mxf 2>/dev/null |
+            grep -i checksum > $tmpdir/transwrap_file.txt &&
+        cmp -s $tmpdir/transwrap_stdin.txt $tmpdir/transwrap_file.txt
+}
+
+check_long_gop_start()
+{
+    # reading the whole stream is supported
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a -o $tmpdir/lg_stdin.mxf - \
+        < $tmpdir/mpeg2lg.mxf >/dev/null 2>&1 || return 1
+
+    # a start position that may not be a key frame is rejected
+    if $appsdir/bmxtranswrap/bmxtranswrap --regtest -t op1a --start $start -o $tmpdir/lg_start.mxf - \
+        < $tmpdir/mpeg2lg.mxf >/dev/null 2>&1; then
+        return 1
+    fi
+    if $appsdir/mxf2raw/mxf2raw --regtest --start $start --track-chksum md5 - \
+        < $tmpdir/mpeg2lg.mxf >/dev/null 2>&1; then
+        return 1
+    fi
+
+    return 0
+}
+
+run_checks()
+{
+    create_essence pcm avci mpeg2lg &&
+        create_op1a avci 10 avci100_1080i avci &&
+        create_op1a mpeg2lg 10 mpeg2lg_422p_hl_1080i mpeg2lg &&
+        check_mxf2raw avci "" &&
+        check_mxf2raw mpeg2lg --nopc &&
+        check_bmxtranswrap &&
+        check_long_gop_start
+}
+
+
+run_test run_checks
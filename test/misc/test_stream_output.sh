@@ -0,0 +1,76 @@
+#!/bin/sh
+
+# check that writing OP-1A to stdout and RDD-9 to a pipe produces the same files as a single pass write
+# to a regular file, that a failure to write the buffered output fails the write and that seekable
+# character devices are not treated as streams
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+# create_file <output filename or - for stdout> <raw2bmx options>
+create_file()
+{
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t op1a \
+        -o $1 \
+        $2 \
+        --mpeg2lg_422p_hl_1080i $tmpdir/mpeg2lg.raw \
+        -q 24 --locked true --pcm $tmpdir/pcm.raw \
+        2>/dev/null
+}
+
+check_stdout()
+{
+    create_file $tmpdir/single_pass.mxf --single-pass >/dev/null &&
+        create_file - "" > $tmpdir/stdout.mxf &&
+        cmp -s $tmpdir/single_pass.mxf $tmpdir/stdout.mxf &&
+        $appsdir/mxf2raw/mxf2raw --regtest --info $tmpdir/stdout.mxf >/dev/null 2>&1
+}
+
+check_pipe()
+{
+    if ! mkfifo $tmpdir/pipe.mxf 2>/dev/null; then
+        return 0
+    fi
+
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t rdd9 --single-pass -o $tmpdir/rdd9.mxf \
+        $tmpdir/single_pass.mxf >/dev/null 2>&1 || return 1
+
+    cat $tmpdir/pipe.mxf > $tmpdir/rdd9_pipe.mxf &
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t rdd9 -o $tmpdir/pipe.mxf \
+        $tmpdir/single_pass.mxf >/dev/null 2>&1
+    res=$?
+    wait
+
+    test $res -eq 0 &&
+        cmp -s $tmpdir/rdd9.mxf $tmpdir/rdd9_pipe.mxf
+}
+
+check_dev_null()
+{
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t wave -o /dev/null \
+        $tmpdir/single_pass.mxf >/dev/null 2>&1
+}
+
+check_dev_full()
+{
+    if ! test -c /dev/full; then
+        return 0
+    fi
+
+    ! create_file - "" > /dev/full
+}
+
+run_checks()
+{
+    create_essence pcm mpeg2lg &&
+        check_stdout &&
+        check_pipe &&
+        check_dev_null &&
+        check_dev_full
+}
+
+
+run_test run_checks
@@ -0,0 +1,45 @@
+#!/bin/sh
+
+# check that ANC data written as a sample assembled from several pieces produces the same output as
+# ANC data written from a single contiguous buffer
+
+base=$(dirname $0)
+. $base/common.sh
+
+
+create_inputs()
+{
+    create_op1a op1a 0 avci100_1080i avci "--anc-const 24 --anc $tmpdir/anc.raw" &&
+    $appsdir/raw2bmx/raw2bmx \
+        --regtest \
+        -t rdd9 \
+        -o $tmpdir/rdd9.mxf \
+        --anc-const 24 --anc $tmpdir/anc.raw \
+        --mpeg2lg_422p_hl_1080i $tmpdir/mpeg2lg.raw \
+        -q 16 --pcm $tmpdir/pcm.raw \
+        -q 16 --pcm $tmpdir/pcm.raw \
+        >/dev/null
+}
+
+check_anc_write()
+{
+    # the test ANC data only contains ST 2020 packets and so the 'st2020' filter passes every line. The
+    # filtered element is constructed from the input line headers and payloads and written as a
+    # sample array, whilst 'all' writes the input element unchanged
+    $appsdir/bmxtranswrap/bmxtranswrap --regtest -t $1 --anc-const 24 --pass-anc all \
+        -o $tmpdir/contiguous.mxf $tmpdir/$1.mxf >/dev/null &&
+        $appsdir/bmxtranswrap/bmxtranswrap --regtest -t $1 --anc-const 24 --pass-anc st2020 \
+            -o $tmpdir/array.mxf $tmpdir/$1.mxf >/dev/null &&
+        compare_files $tmpdir/contiguous.mxf $tmpdir/array.mxf
+}
+
+run_checks()
+{
+    create_essence pcm avci mpeg2lg anc &&
+        create_inputs &&
+        check_anc_write op1a &&
+        check_anc_write rdd9
+}
+
+
+run_test run_checks